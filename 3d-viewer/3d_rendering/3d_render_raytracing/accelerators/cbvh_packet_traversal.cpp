@@ -28,6 +28,9 @@
  */
 
 #include "cbvh_pbrt.h"
+#include "../shapes3D/ctriangle.h"
+#include <cfloat>
+#include <limits>
 #include <wx/debug.h>
 
 
@@ -35,6 +38,18 @@
 //#define BVH_PARTITION_TRAVERSAL
 
 
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define BVH_PACKET_SSE
+#include <emmintrin.h>
+
+// The AVX functions are compiled for AVX on their own, and only called if the CPU supports it
+#if defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#define BVH_PACKET_AVX
+#include <immintrin.h>
+#endif
+#endif
+
+
 #define MAX_TODOS 64
 
 
@@ -90,6 +105,490 @@ static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
 }
 
 
+/**
+ * Intersects the ray i of a packet with an object, and records the hit
+ * @return true if the ray hits the object before its previous closest hit
+ */
+static inline bool hitObject( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket,
+                              const COBJECT &aObject, unsigned int i, int aNodeNum )
+{
+    if( !aObject.Intersect( aRayPacket.m_ray[i], aHitInfoPacket[i].m_HitInfo ) )
+        return false;
+
+    aHitInfoPacket[i].m_hitresult = true;
+    aHitInfoPacket[i].m_HitInfo.m_acc_node_info = aNodeNum;
+
+    return true;
+}
+
+
+/**
+ * Tests the rays of a packet one at a time, with the ray slopes
+ */
+class SCALAR_BOX_TEST
+{
+public:
+    SCALAR_BOX_TEST( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket ) :
+            m_rayPacket( aRayPacket ),
+            m_hitInfoPacket( aHitInfoPacket )
+    {
+    }
+
+    unsigned int FirstHit( const CBBOX &aBBox, unsigned int ia ) const
+    {
+        return getFirstHit( m_rayPacket, aBBox, ia, m_hitInfoPacket );
+    }
+
+    unsigned int LastHit( const CBBOX &aBBox, unsigned int ia ) const
+    {
+        return getLastHit( m_rayPacket, aBBox, ia, m_hitInfoPacket );
+    }
+
+    /**
+     * Intersects the rays ia ... ie - 1 with an object of a leaf
+     * @return true if any ray hits the object
+     */
+    bool IntersectObject( const COBJECT &aObject, unsigned int ia, unsigned int ie,
+                          int aNodeNum )
+    {
+        bool anyHitted = false;
+
+        for( unsigned int i = ia; i < ie; ++i )
+            anyHitted |= hitObject( m_rayPacket, m_hitInfoPacket, aObject, i, aNodeNum );
+
+        return anyHitted;
+    }
+
+private:
+    const RAYPACKET &m_rayPacket;
+    HITINFO_PACKET  *m_hitInfoPacket;
+};
+
+
+#ifdef BVH_PACKET_SSE
+
+/// Grows the far distance of the slab test to stay conservative with the rounding errors
+/// (pbrt uses 1 + 2 * gamma( 3 ))
+#define BVH_PACKET_FAR_SCALE ( 1.0f + 3.0f * FLT_EPSILON )
+
+/// Tolerance of the triangle filter, so it never drops a ray that the exact test would keep
+#define BVH_PACKET_TRIANGLE_SLACK 1e-5f
+
+
+/**
+ * The rays of a packet stored by component, to test several rays against a box at once
+ */
+struct PACKET_SOA
+{
+    alignas( 32 ) float m_org[3][RAYPACKET_RAYS_PER_PACKET];
+    alignas( 32 ) float m_dir[3][RAYPACKET_RAYS_PER_PACKET];
+    alignas( 32 ) float m_invDir[3][RAYPACKET_RAYS_PER_PACKET];
+    alignas( 32 ) float m_tHit[RAYPACKET_RAYS_PER_PACKET];  ///< closest hit of each ray
+
+    PACKET_SOA( const RAYPACKET &aRayPacket, const HITINFO_PACKET *aHitInfoPacket )
+    {
+        for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+        {
+            const RAY &ray = aRayPacket.m_ray[i];
+
+            for( unsigned int axis = 0; axis < 3; ++axis )
+            {
+                m_org[axis][i] = ray.m_Origin[axis];
+                m_dir[axis][i] = ray.m_Dir[axis];
+                m_invDir[axis][i] = ray.m_InvDir[axis];
+            }
+
+            m_tHit[i] = aHitInfoPacket[i].m_HitInfo.m_tHit;
+        }
+    }
+};
+
+
+/**
+ * Slab test of the rays aRay ... aRay + 3 against a box
+ * @return a mask with a bit set for each ray that enters the box before its closest hit
+ */
+static inline int boxMaskSSE( const PACKET_SOA &aSoa, const CBBOX &aBBox, unsigned int aRay )
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    __m128 tNear = _mm_setzero_ps();
+    __m128 tFar = _mm_load_ps( &aSoa.m_tHit[aRay] );
+
+    for( unsigned int axis = 0; axis < 3; ++axis )
+    {
+        const __m128 org = _mm_load_ps( &aSoa.m_org[axis][aRay] );
+        const __m128 invDir = _mm_load_ps( &aSoa.m_invDir[axis][aRay] );
+
+        __m128 t0 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Min()[axis] ), org ), invDir );
+        __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_set1_ps( aBBox.Max()[axis] ), org ), invDir );
+
+        // A ray parallel to a slab plane, with its origin on it, gives 0 * inf = NaN.  Its
+        // origin is in the slab (as CBBOX::Intersect checks for these rays), so the slab
+        // must not limit its range.
+        const __m128 onPlane = _mm_cmpunord_ps( t0, t1 );
+
+        t0 = _mm_or_ps( _mm_and_ps( onPlane, _mm_set1_ps( -infinity ) ),
+                        _mm_andnot_ps( onPlane, t0 ) );
+        t1 = _mm_or_ps( _mm_and_ps( onPlane, _mm_set1_ps( infinity ) ),
+                        _mm_andnot_ps( onPlane, t1 ) );
+
+        tNear = _mm_max_ps( _mm_min_ps( t0, t1 ), tNear );
+        tFar = _mm_min_ps( _mm_mul_ps( _mm_max_ps( t0, t1 ),
+                                       _mm_set1_ps( BVH_PACKET_FAR_SCALE ) ),
+                           tFar );
+    }
+
+    return _mm_movemask_ps( _mm_cmple_ps( tNear, tFar ) );
+}
+
+
+/**
+ * Filters the rays of a packet that may hit a triangle, with the projection test of
+ * CTRIANGLE::Intersect done on several rays at once.  Only the rays that pass go through
+ * the exact test, that also fills the hit information.
+ */
+class TRIANGLE_PACKET_TEST
+{
+public:
+    /**
+     * @return a mask with a bit set for each ray of aRay ... aRay + 3 that may hit aTriangle
+     */
+    static int MaskSSE( const CTRIANGLE &aTriangle, const PACKET_SOA &aSoa, unsigned int aRay )
+    {
+        const unsigned int k = aTriangle.m_k;
+        const unsigned int ku = ( k + 1 ) % 3;
+        const unsigned int kv = ( k + 2 ) % 3;
+
+        const __m128 nu = _mm_set1_ps( aTriangle.m_nu );
+        const __m128 nv = _mm_set1_ps( aTriangle.m_nv );
+
+        const __m128 dk = _mm_load_ps( &aSoa.m_dir[k][aRay] );
+        const __m128 dku = _mm_load_ps( &aSoa.m_dir[ku][aRay] );
+        const __m128 dkv = _mm_load_ps( &aSoa.m_dir[kv][aRay] );
+        const __m128 ok = _mm_load_ps( &aSoa.m_org[k][aRay] );
+        const __m128 oku = _mm_load_ps( &aSoa.m_org[ku][aRay] );
+        const __m128 okv = _mm_load_ps( &aSoa.m_org[kv][aRay] );
+
+        const __m128 lnd = _mm_div_ps( _mm_set1_ps( 1.0f ),
+                                       _mm_add_ps( _mm_add_ps( dk, _mm_mul_ps( nu, dku ) ),
+                                                   _mm_mul_ps( nv, dkv ) ) );
+
+        const __m128 t = _mm_mul_ps( _mm_sub_ps( _mm_sub_ps( _mm_sub_ps(
+                                                 _mm_set1_ps( aTriangle.m_nd ), ok ),
+                                                 _mm_mul_ps( nu, oku ) ),
+                                                 _mm_mul_ps( nv, okv ) ),
+                                     lnd );
+
+        const __m128 hu = _mm_sub_ps( _mm_add_ps( oku, _mm_mul_ps( t, dku ) ),
+                                      _mm_set1_ps( aTriangle.m_vertex[0][ku] ) );
+        const __m128 hv = _mm_sub_ps( _mm_add_ps( okv, _mm_mul_ps( t, dkv ) ),
+                                      _mm_set1_ps( aTriangle.m_vertex[0][kv] ) );
+
+        const __m128 beta = _mm_add_ps( _mm_mul_ps( hv, _mm_set1_ps( aTriangle.m_bnu ) ),
+                                        _mm_mul_ps( hu, _mm_set1_ps( aTriangle.m_bnv ) ) );
+        const __m128 gamma = _mm_add_ps( _mm_mul_ps( hu, _mm_set1_ps( aTriangle.m_cnu ) ),
+                                         _mm_mul_ps( hv, _mm_set1_ps( aTriangle.m_cnv ) ) );
+
+        const __m128 slack = _mm_set1_ps( BVH_PACKET_TRIANGLE_SLACK );
+        const __m128 tHit = _mm_mul_ps( _mm_load_ps( &aSoa.m_tHit[aRay] ),
+                                        _mm_set1_ps( 1.0f + BVH_PACKET_TRIANGLE_SLACK ) );
+
+        // The comparisons are false for NaN, as the ones of the exact test
+        const __m128 minusSlack = _mm_sub_ps( _mm_setzero_ps(), slack );
+
+        __m128 mask = _mm_and_ps( _mm_cmpgt_ps( t, _mm_setzero_ps() ), _mm_cmplt_ps( t, tHit ) );
+        mask = _mm_and_ps( mask, _mm_cmpge_ps( beta, minusSlack ) );
+        mask = _mm_and_ps( mask, _mm_cmpge_ps( gamma, minusSlack ) );
+        mask = _mm_and_ps( mask, _mm_cmple_ps( _mm_add_ps( beta, gamma ),
+                                               _mm_add_ps( _mm_set1_ps( 1.0f ), slack ) ) );
+
+        return _mm_movemask_ps( mask );
+    }
+
+#ifdef BVH_PACKET_AVX
+    /**
+     * @return a mask with a bit set for each ray of aRay ... aRay + 7 that may hit aTriangle
+     */
+    __attribute__(( target( "avx" ) ))
+    static int MaskAVX( const CTRIANGLE &aTriangle, const PACKET_SOA &aSoa, unsigned int aRay )
+    {
+        const unsigned int k = aTriangle.m_k;
+        const unsigned int ku = ( k + 1 ) % 3;
+        const unsigned int kv = ( k + 2 ) % 3;
+
+        const __m256 nu = _mm256_set1_ps( aTriangle.m_nu );
+        const __m256 nv = _mm256_set1_ps( aTriangle.m_nv );
+
+        const __m256 dk = _mm256_load_ps( &aSoa.m_dir[k][aRay] );
+        const __m256 dku = _mm256_load_ps( &aSoa.m_dir[ku][aRay] );
+        const __m256 dkv = _mm256_load_ps( &aSoa.m_dir[kv][aRay] );
+        const __m256 ok = _mm256_load_ps( &aSoa.m_org[k][aRay] );
+        const __m256 oku = _mm256_load_ps( &aSoa.m_org[ku][aRay] );
+        const __m256 okv = _mm256_load_ps( &aSoa.m_org[kv][aRay] );
+
+        const __m256 lnd = _mm256_div_ps( _mm256_set1_ps( 1.0f ),
+                _mm256_add_ps( _mm256_add_ps( dk, _mm256_mul_ps( nu, dku ) ),
+                               _mm256_mul_ps( nv, dkv ) ) );
+
+        const __m256 t = _mm256_mul_ps( _mm256_sub_ps( _mm256_sub_ps( _mm256_sub_ps(
+                                                       _mm256_set1_ps( aTriangle.m_nd ), ok ),
+                                                       _mm256_mul_ps( nu, oku ) ),
+                                                       _mm256_mul_ps( nv, okv ) ),
+                                        lnd );
+
+        const __m256 hu = _mm256_sub_ps( _mm256_add_ps( oku, _mm256_mul_ps( t, dku ) ),
+                                         _mm256_set1_ps( aTriangle.m_vertex[0][ku] ) );
+        const __m256 hv = _mm256_sub_ps( _mm256_add_ps( okv, _mm256_mul_ps( t, dkv ) ),
+                                         _mm256_set1_ps( aTriangle.m_vertex[0][kv] ) );
+
+        const __m256 beta = _mm256_add_ps(
+                _mm256_mul_ps( hv, _mm256_set1_ps( aTriangle.m_bnu ) ),
+                _mm256_mul_ps( hu, _mm256_set1_ps( aTriangle.m_bnv ) ) );
+        const __m256 gamma = _mm256_add_ps(
+                _mm256_mul_ps( hu, _mm256_set1_ps( aTriangle.m_cnu ) ),
+                _mm256_mul_ps( hv, _mm256_set1_ps( aTriangle.m_cnv ) ) );
+
+        const __m256 slack = _mm256_set1_ps( BVH_PACKET_TRIANGLE_SLACK );
+        const __m256 tHit = _mm256_mul_ps( _mm256_load_ps( &aSoa.m_tHit[aRay] ),
+                                           _mm256_set1_ps( 1.0f + BVH_PACKET_TRIANGLE_SLACK ) );
+
+        const __m256 minusSlack = _mm256_sub_ps( _mm256_setzero_ps(), slack );
+
+        __m256 mask = _mm256_and_ps( _mm256_cmp_ps( t, _mm256_setzero_ps(), _CMP_GT_OQ ),
+                                     _mm256_cmp_ps( t, tHit, _CMP_LT_OQ ) );
+        mask = _mm256_and_ps( mask, _mm256_cmp_ps( beta, minusSlack, _CMP_GE_OQ ) );
+        mask = _mm256_and_ps( mask, _mm256_cmp_ps( gamma, minusSlack, _CMP_GE_OQ ) );
+        mask = _mm256_and_ps( mask, _mm256_cmp_ps( _mm256_add_ps( beta, gamma ),
+                                                   _mm256_add_ps( _mm256_set1_ps( 1.0f ), slack ),
+                                                   _CMP_LE_OQ ) );
+
+        return _mm256_movemask_ps( mask );
+    }
+#endif
+};
+
+
+#ifdef BVH_PACKET_AVX
+
+/**
+ * Slab test of the rays aRay ... aRay + 7 against a box
+ * @return a mask with a bit set for each ray that enters the box before its closest hit
+ */
+__attribute__(( target( "avx" ) ))
+static int boxMaskAVX( const PACKET_SOA &aSoa, const CBBOX &aBBox, unsigned int aRay )
+{
+    const float infinity = std::numeric_limits<float>::infinity();
+
+    __m256 tNear = _mm256_setzero_ps();
+    __m256 tFar = _mm256_load_ps( &aSoa.m_tHit[aRay] );
+
+    for( unsigned int axis = 0; axis < 3; ++axis )
+    {
+        const __m256 org = _mm256_load_ps( &aSoa.m_org[axis][aRay] );
+        const __m256 invDir = _mm256_load_ps( &aSoa.m_invDir[axis][aRay] );
+
+        __m256 t0 = _mm256_mul_ps(
+                _mm256_sub_ps( _mm256_set1_ps( aBBox.Min()[axis] ), org ), invDir );
+        __m256 t1 = _mm256_mul_ps(
+                _mm256_sub_ps( _mm256_set1_ps( aBBox.Max()[axis] ), org ), invDir );
+
+        // Same as boxMaskSSE() for the rays parallel to, and on, a slab plane
+        const __m256 onPlane = _mm256_cmp_ps( t0, t1, _CMP_UNORD_Q );
+
+        t0 = _mm256_blendv_ps( t0, _mm256_set1_ps( -infinity ), onPlane );
+        t1 = _mm256_blendv_ps( t1, _mm256_set1_ps( infinity ), onPlane );
+
+        tNear = _mm256_max_ps( _mm256_min_ps( t0, t1 ), tNear );
+        tFar = _mm256_min_ps( _mm256_mul_ps( _mm256_max_ps( t0, t1 ),
+                                             _mm256_set1_ps( BVH_PACKET_FAR_SCALE ) ),
+                              tFar );
+    }
+
+    return _mm256_movemask_ps( _mm256_cmp_ps( tNear, tFar, _CMP_LE_OQ ) );
+}
+
+#endif
+
+
+/**
+ * Tests the rays of a packet WIDTH at a time, with a slab test for the boxes and a filter
+ * for the triangles
+ */
+template <unsigned int WIDTH,
+          int ( *BOX_MASK )( const PACKET_SOA&, const CBBOX&, unsigned int ),
+          int ( *TRIANGLE_MASK )( const CTRIANGLE&, const PACKET_SOA&, unsigned int )>
+class SIMD_BOX_TEST
+{
+public:
+    SIMD_BOX_TEST( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket ) :
+            m_rayPacket( aRayPacket ),
+            m_hitInfoPacket( aHitInfoPacket ),
+            m_soa( aRayPacket, aHitInfoPacket )
+    {
+    }
+
+    unsigned int FirstHit( const CBBOX &aBBox, unsigned int ia ) const
+    {
+        const unsigned int firstGroup = ia - ia % WIDTH;
+
+        for( unsigned int group = firstGroup; group < RAYPACKET_RAYS_PER_PACKET; group += WIDTH )
+        {
+            const int mask = BOX_MASK( m_soa, aBBox, group )
+                             & rangeMask( group, ia, group + WIDTH );
+
+            if( mask )
+                return group + lowestBit( mask );
+
+            // As the scalar test, give up on the whole packet when the box is outside of it
+            if( group == firstGroup && !m_rayPacket.m_Frustum.Intersect( aBBox ) )
+                break;
+        }
+
+        return RAYPACKET_RAYS_PER_PACKET;
+    }
+
+    unsigned int LastHit( const CBBOX &aBBox, unsigned int ia ) const
+    {
+        for( unsigned int group = RAYPACKET_RAYS_PER_PACKET; group > ia - ia % WIDTH; )
+        {
+            group -= WIDTH;
+
+            const int mask = BOX_MASK( m_soa, aBBox, group )
+                             & rangeMask( group, ia, group + WIDTH );
+
+            if( mask )
+                return group + highestBit( mask ) + 1;
+        }
+
+        return ia + 1;
+    }
+
+    bool IntersectObject( const COBJECT &aObject, unsigned int ia, unsigned int ie,
+                          int aNodeNum )
+    {
+        bool anyHitted = false;
+
+        if( aObject.GetObjectType() != OBJECT3D_TYPE::TRIANGLE )
+        {
+            for( unsigned int i = ia; i < ie; ++i )
+                anyHitted |= hitRay( aObject, i, aNodeNum );
+
+            return anyHitted;
+        }
+
+        const CTRIANGLE &triangle = static_cast<const CTRIANGLE &>( aObject );
+
+        for( unsigned int group = ia - ia % WIDTH; group < ie; group += WIDTH )
+        {
+            int mask = TRIANGLE_MASK( triangle, m_soa, group ) & rangeMask( group, ia, ie );
+
+            while( mask )
+            {
+                const unsigned int i = group + lowestBit( mask );
+
+                mask &= mask - 1;
+                anyHitted |= hitRay( aObject, i, aNodeNum );
+            }
+        }
+
+        return anyHitted;
+    }
+
+private:
+    bool hitRay( const COBJECT &aObject, unsigned int i, int aNodeNum )
+    {
+        if( !hitObject( m_rayPacket, m_hitInfoPacket, aObject, i, aNodeNum ) )
+            return false;
+
+        m_soa.m_tHit[i] = m_hitInfoPacket[i].m_HitInfo.m_tHit;
+
+        return true;
+    }
+
+    /// The mask of the rays ia ... ie - 1 in the rays group ... group + WIDTH - 1
+    static int rangeMask( unsigned int group, unsigned int ia, unsigned int ie )
+    {
+        const unsigned int first = ( ia > group ) ? ia - group : 0;
+        const unsigned int last = ( ie - group < WIDTH ) ? ie - group : WIDTH;
+
+        return ( ( 1 << last ) - 1 ) & ~( ( 1 << first ) - 1 );
+    }
+
+    static unsigned int lowestBit( int aMask )
+    {
+        unsigned int bit = 0;
+
+        while( !( aMask & ( 1 << bit ) ) )
+            bit++;
+
+        return bit;
+    }
+
+    static unsigned int highestBit( int aMask )
+    {
+        unsigned int bit = WIDTH - 1;
+
+        while( !( aMask & ( 1 << bit ) ) )
+            bit--;
+
+        return bit;
+    }
+
+    const RAYPACKET &m_rayPacket;
+    HITINFO_PACKET  *m_hitInfoPacket;
+    PACKET_SOA       m_soa;
+};
+
+
+typedef SIMD_BOX_TEST<4, boxMaskSSE, TRIANGLE_PACKET_TEST::MaskSSE> SSE_BOX_TEST;
+
+#ifdef BVH_PACKET_AVX
+typedef SIMD_BOX_TEST<8, boxMaskAVX, TRIANGLE_PACKET_TEST::MaskAVX> AVX_BOX_TEST;
+#endif
+
+#endif
+
+
+static PACKET_TRAVERSAL widestPacketTraversal()
+{
+#ifdef BVH_PACKET_AVX
+    // This also runs from a static initializer, before the CPU features are known
+    __builtin_cpu_init();
+
+    if( __builtin_cpu_supports( "avx" ) )
+        return PACKET_TRAVERSAL::AVX;
+#endif
+
+#ifdef BVH_PACKET_SSE
+    return PACKET_TRAVERSAL::SSE;
+#else
+    return PACKET_TRAVERSAL::SCALAR;
+#endif
+}
+
+
+static PACKET_TRAVERSAL s_packetTraversal = widestPacketTraversal();
+
+
+PACKET_TRAVERSAL CBVH_PBRT::GetPacketTraversal()
+{
+    return s_packetTraversal;
+}
+
+
+bool CBVH_PBRT::SetPacketTraversal( PACKET_TRAVERSAL aTraversal )
+{
+    // The traversals are ordered from the narrowest to the widest
+    if( aTraversal > widestPacketTraversal() )
+        return false;
+
+    s_packetTraversal = aTraversal;
+
+    return true;
+}
+
+
 // "Large Ray Packets for Real-time Whitted Ray Tracing"
 // http://cseweb.ucsd.edu/~ravir/whitted.pdf
 
@@ -103,6 +602,38 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     if( (&m_nodes[0]) == NULL )
         return false;
 
+    switch( s_packetTraversal )
+    {
+#ifdef BVH_PACKET_AVX
+    case PACKET_TRAVERSAL::AVX:
+    {
+        AVX_BOX_TEST boxTest( aRayPacket, aHitInfoPacket );
+        return intersectRanged( aRayPacket, aHitInfoPacket, boxTest );
+    }
+#endif
+
+#ifdef BVH_PACKET_SSE
+    case PACKET_TRAVERSAL::SSE:
+    {
+        SSE_BOX_TEST boxTest( aRayPacket, aHitInfoPacket );
+        return intersectRanged( aRayPacket, aHitInfoPacket, boxTest );
+    }
+#endif
+
+    default:
+    {
+        SCALAR_BOX_TEST boxTest( aRayPacket, aHitInfoPacket );
+        return intersectRanged( aRayPacket, aHitInfoPacket, boxTest );
+    }
+    }
+}
+
+
+template <class BOX_TEST>
+bool CBVH_PBRT::intersectRanged( const RAYPACKET &aRayPacket,
+                                 HITINFO_PACKET *aHitInfoPacket,
+                                 BOX_TEST &aBoxTest ) const
+{
     bool anyHitted = false;
     int todoOffset = 0, nodeNum = 0;
     StackNode todo[MAX_TODOS];
@@ -113,7 +644,7 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     {
         const LinearBVHNode *curCell = &m_nodes[nodeNum];
 
-        ia = getFirstHit( aRayPacket, curCell->bounds, ia, aHitInfoPacket );
+        ia = aBoxTest.FirstHit( curCell->bounds, ia );
 
         if( ia < RAYPACKET_RAYS_PER_PACKET )
         {
@@ -127,30 +658,14 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
             }
             else
             {
-                const unsigned int ie = getLastHit( aRayPacket,
-                                                    curCell->bounds,
-                                                    ia,
-                                                    aHitInfoPacket );
+                const unsigned int ie = aBoxTest.LastHit( curCell->bounds, ia );
 
                 for( int j = 0; j < curCell->nPrimitives; ++j )
                 {
                     const COBJECT *obj = m_primitives[curCell->primitivesOffset + j];
 
                     if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
-                    {
-                        for( unsigned int i = ia; i < ie; ++i )
-                        {
-                            const bool hitted = obj->Intersect( aRayPacket.m_ray[i],
-                                                                aHitInfoPacket[i].m_HitInfo );
-
-                            if( hitted )
-                            {
-                                anyHitted |= hitted;
-                                aHitInfoPacket[i].m_hitresult |= hitted;
-                                aHitInfoPacket[i].m_HitInfo.m_acc_node_info = nodeNum;
-                            }
-                        }
-                    }
+                        anyHitted |= aBoxTest.IntersectObject( *obj, ia, ie, nodeNum );
                 }
             }
         }
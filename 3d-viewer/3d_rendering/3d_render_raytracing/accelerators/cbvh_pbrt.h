@@ -107,6 +107,15 @@ enum class SPLITMETHOD
 };
 
 
+/// The instructions used to test the rays of a packet against the BVH nodes
+enum class PACKET_TRAVERSAL
+{
+    SCALAR, ///< one ray at a time
+    SSE,    ///< four rays at a time
+    AVX     ///< eight rays at a time
+};
+
+
 class  CBVH_PBRT : public CGENERICACCELERATOR
 {
 public:
@@ -121,7 +130,21 @@ public:
     bool Intersect( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket ) const override;
     bool IntersectP( const RAY &aRay, float aMaxDistance ) const override;
 
+    /**
+     * @return the packet traversal in use, by default the widest one supported by the CPU
+     */
+    static PACKET_TRAVERSAL GetPacketTraversal();
+
+    /**
+     * Select the packet traversal, to compare them
+     * @return false if the CPU (or the build) does not support it, the traversal is unchanged
+     */
+    static bool SetPacketTraversal( PACKET_TRAVERSAL aTraversal );
+
 private:
+    template <class BOX_TEST>
+    bool intersectRanged( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket,
+                          BOX_TEST &aBoxTest ) const;
 
     BVHBuildNode *recursiveBuild( std::vector<BVHPrimitiveInfo> &primitiveInfo,
                                   int start,
@@ -34,6 +34,7 @@
 #include "shapes3D/clayeritem.h"
 #include "shapes3D/ccylinder.h"
 #include "shapes3D/ctriangle.h"
+#include "shapes3D/cinstance.h"
 #include "shapes2D/citemlayercsg2d.h"
 #include "shapes2D/cring2d.h"
 #include "shapes2D/cpolygon2d.h"
@@ -259,6 +260,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER* aStatusTextReporter, REPORTER* aWa
 {
     m_reloadRequested = false;
 
+    m_model_geometry.clear();
     m_model_materials.clear();
 
     COBJECT2D_STATS::Instance().ResetStats();
@@ -837,7 +839,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER* aStatusTextReporter, REPORTER* aWa
 #endif
 
 
-    load_3D_models();
+    load_3D_models( aWarningTextReporter );
 
 
 #ifdef PRINT_STATISTICS_3D_VIEWER
@@ -968,9 +970,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER* aStatusTextReporter, REPORTER* aWa
     // Create an accelerator
     // /////////////////////////////////////////////////////////////////////////
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_startAcceleratorTime = GetRunningMicroSecs();
-#endif
 
     if( m_accelerator )
     {
@@ -980,9 +980,9 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER* aStatusTextReporter, REPORTER* aWa
 
     m_accelerator = new CBVH_PBRT( m_object_container );
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endAcceleratorTime = GetRunningMicroSecs();
-#endif
+
+    m_stats_accelerator_time = stats_endAcceleratorTime - stats_startAcceleratorTime;
 
     setupMaterials();
 
@@ -1253,8 +1253,26 @@ void C3D_RENDER_RAYTRACING::add_3D_vias_and_pads_to_container()
 }
 
 
-void C3D_RENDER_RAYTRACING::load_3D_models()
+void C3D_RENDER_RAYTRACING::load_3D_models( REPORTER* aWarningTextReporter )
 {
+    // The models are loaded by the cache manager, a render without it would silently leave
+    // them out
+    if( !m_settings.Get3DCacheManager() )
+    {
+        if( aWarningTextReporter )
+            aWarningTextReporter->Report( _( "No 3D model cache: the 3D models are not loaded" ),
+                                          RPT_SEVERITY_ERROR );
+
+        return;
+    }
+
+    const double modelunit_to_3d_units_factor = m_settings.BiuTo3Dunits() *
+                                                UNITS3D_TO_UNITSPCB;
+
+    // The placed models, and how many times each model is used
+    std::vector< std::pair< const S3DMODEL *, glm::mat4 > > placedModels;
+    std::map< const S3DMODEL *, unsigned int > modelUseCount;
+
     // Go for all modules
     for( auto module : m_settings.GetBoard()->Modules() )
     {
@@ -1292,9 +1310,6 @@ void C3D_RENDER_RAYTRACING::load_3D_models()
                                             SFVEC3F( 0.0f, 0.0f, 1.0f ) );
             }
 
-            const double modelunit_to_3d_units_factor = m_settings.BiuTo3Dunits() *
-                                                        UNITS3D_TO_UNITSPCB;
-
             moduleMatrix = glm::scale( moduleMatrix,
                                        SFVEC3F( modelunit_to_3d_units_factor,
                                                 modelunit_to_3d_units_factor,
@@ -1341,18 +1356,68 @@ void C3D_RENDER_RAYTRACING::load_3D_models()
                                                        sM->m_Scale.y,
                                                        sM->m_Scale.z ) );
 
-                    add_3D_models( modelPtr, modelMatrix );
+                    placedModels.emplace_back( modelPtr, modelMatrix );
+                    modelUseCount[modelPtr]++;
                 }
 
                 ++sM;
             }
         }
     }
+
+    for( const auto& placedModel : placedModels )
+    {
+        // The models used more than once share their triangles. A mirroring transformation
+        // would reverse the winding of the shared triangles, so these are added in world
+        // space as the models used once.
+        if( ( modelUseCount[placedModel.first] > 1 ) &&
+            ( glm::determinant( glm::mat3( placedModel.second ) ) > 0.0f ) )
+        {
+            add_3D_model_instance( placedModel.first, placedModel.second,
+                                   modelunit_to_3d_units_factor );
+        }
+        else
+        {
+            add_3D_models( placedModel.first, placedModel.second, m_object_container );
+        }
+    }
+}
+
+
+void C3D_RENDER_RAYTRACING::add_3D_model_instance( const S3DMODEL *a3DModel,
+                                                   const glm::mat4 &aModelMatrix,
+                                                   float aModelScale )
+{
+    std::unique_ptr<MODEL_GEOMETRY> &geometry = m_model_geometry[a3DModel];
+
+    if( !geometry )
+    {
+        // The shared triangles are scaled to the 3D units, so the procedural textures that
+        // use the hit position have the same size on the instances as on the other objects
+        geometry.reset( new MODEL_GEOMETRY );
+
+        add_3D_models( a3DModel, glm::scale( glm::mat4( 1.0f ), SFVEC3F( aModelScale ) ),
+                       geometry->m_triangles );
+
+        if( !geometry->m_triangles.GetList().empty() )
+            geometry->m_accelerator.reset( new CBVH_PBRT( geometry->m_triangles ) );
+    }
+
+    if( !geometry->m_accelerator )
+        return;
+
+    const glm::mat4 instanceMatrix =
+            glm::scale( aModelMatrix, SFVEC3F( 1.0f / aModelScale ) );
+
+    m_object_container.Add( new CINSTANCE( geometry->m_accelerator.get(),
+                                           geometry->m_triangles.GetBBox(),
+                                           instanceMatrix ) );
 }
 
 
 void C3D_RENDER_RAYTRACING::add_3D_models( const S3DMODEL *a3DModel,
-                                           const glm::mat4 &aModelMatrix )
+                                           const glm::mat4 &aModelMatrix,
+                                           CGENERICCONTAINER &aDstContainer )
 {
 
     // Validate a3DModel pointers
@@ -1563,7 +1628,7 @@ void C3D_RENDER_RAYTRACING::add_3D_models( const S3DMODEL *a3DModel,
 
 
 
-                        m_object_container.Add( newTriangle );
+                        aDstContainer.Add( newTriangle );
                         newTriangle->SetMaterial( (const CMATERIAL *)&blinn_material );
 
                         if( mesh.m_Color == NULL )
@@ -37,9 +37,13 @@
 #include "clight.h"
 #include "../cpostshader_ssao.h"
 #include "cmaterial.h"
+#include "cthread_pool.h"
 #include <plugins/3dapi/c3dmodel.h>
 
 #include <map>
+#include <memory>
+
+#include <wx/image.h>
 
 /// Vector of materials
 typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
@@ -47,6 +51,16 @@ typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
 /// Maps a S3DMODEL pointer with a created CBLINN_PHONG_MATERIAL vector
 typedef std::map< const S3DMODEL * , MODEL_MATERIALS > MAP_MODEL_MATERIALS;
 
+/// The triangles of a 3D model in model space, shared by all its instances
+struct MODEL_GEOMETRY
+{
+    CCONTAINER                           m_triangles;
+    std::unique_ptr<CGENERICACCELERATOR> m_accelerator;
+};
+
+/// Maps a S3DMODEL pointer with its shared geometry
+typedef std::map< const S3DMODEL *, std::unique_ptr<MODEL_GEOMETRY> > MAP_MODEL_GEOMETRY;
+
 typedef enum
 {
     RT_RENDER_STATE_TRACING = 0,
@@ -56,6 +70,15 @@ typedef enum
     RT_RENDER_STATE_MAX
 }RT_RENDER_STATE;
 
+/// Time spent in each phase of a render to an image, in microseconds
+struct RT_RENDER_TIMES
+{
+    unsigned int m_scene;       ///< creation of the 3D objects, 0 if there was no reload
+    unsigned int m_accelerator; ///< construction of the BVH, 0 if there was no reload
+    unsigned int m_trace;       ///< tracing of all the blocks
+    unsigned int m_postShade;   ///< post processing shader, blur and final colors
+};
+
 class C3D_RENDER_RAYTRACING : public C3D_RENDER_BASE
 {
 public:
@@ -70,6 +93,21 @@ public:
 
     int GetWaitForEditingTimeOut() override;
 
+    /**
+     * @brief RenderToImage - Render the board with the current camera and settings, without
+     * any OpenGL context. It returns when the render (with the post processing) is finished.
+     * The board is reloaded first if a reload was requested.
+     * @param aSize: the size of the render. The image is cropped to a multiple of the ray
+     * packet size, as in the canvas
+     * @param aImage: receives the render
+     * @param aTimes: if not NULL, receives the time spent in each phase
+     * @param aWarningTextReporter: receives the warnings of the reload, and an error if the
+     * 3D models can't be loaded because there is no 3D cache manager
+     */
+    void RenderToImage( const wxSize &aSize, wxImage &aImage, RT_RENDER_TIMES *aTimes = NULL,
+                        REPORTER *aStatusTextReporter = NULL,
+                        REPORTER *aWarningTextReporter = NULL );
+
 private:
     bool initializeOpenGL();
     void initializeNewWindowSize();
@@ -78,6 +116,7 @@ private:
     void reload( REPORTER* aStatusTextReporter, REPORTER* aWarningTextReporter );
 
     void restart_render_state();
+    CTHREAD_POOL& threadPool();
     void rt_render_tracing( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_post_process_shade( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_post_process_blur_finish( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
@@ -134,6 +173,10 @@ private:
     /// Save the number of blocks progress of the render
     size_t m_nrBlocksRenderProgress;
 
+    /// Threads of the render passes, kept from one pass to the next.  Started by the first
+    /// pass only, as most canvases are never raytraced.
+    std::unique_ptr<CTHREAD_POOL> m_threadPool;
+
     CPOSTSHADER_SSAO m_postshader_ssao;
 
     CLIGHTCONTAINER m_lights;
@@ -186,6 +229,9 @@ private:
     unsigned int m_stats_converted_dummy_to_plane;
     unsigned int m_stats_converted_roundsegment2d_to_roundsegment;
 
+    /// Time spent to build the accelerator on the last reload, in microseconds
+    unsigned int m_stats_accelerator_time;
+
     void create_3d_object_from( CCONTAINER &aDstContainer,
                                 const COBJECT2D *aObject2D,
                                 float aZMin, float aZMax,
@@ -195,16 +241,36 @@ private:
     void add_3D_vias_and_pads_to_container();
     void insert3DViaHole( const VIA* aVia );
     void insert3DPadHole( const D_PAD* aPad );
-    void load_3D_models();
+    void load_3D_models( REPORTER* aWarningTextReporter );
     void add_3D_models( const S3DMODEL *a3DModel,
-                        const glm::mat4 &aModelMatrix );
+                        const glm::mat4 &aModelMatrix,
+                        CGENERICCONTAINER &aDstContainer );
+
+    /**
+     * Add an instance of a 3D model that shares its triangles with the other instances
+     * @param a3DModel is the model to add
+     * @param aModelMatrix is the model to world transformation
+     * @param aModelScale is the uniform scale from the model units to the 3D units, applied
+     * to the shared triangles so the procedural textures keep their size
+     */
+    void add_3D_model_instance( const S3DMODEL *a3DModel,
+                                const glm::mat4 &aModelMatrix,
+                                float aModelScale );
 
     /// Stores materials of the 3D models
     MAP_MODEL_MATERIALS m_model_materials;
 
+    /// Stores the triangles of the 3D models used by more than one footprint
+    MAP_MODEL_GEOMETRY m_model_geometry;
+
     void initialize_block_positions();
 
-    void render( GLubyte *ptrPBO, REPORTER *aStatusTextReporter );
+    /**
+     * Run the next step of the render
+     * @param aPreviewFirst: when a new render starts, draw a low quality preview of the
+     * whole view before tracing the first blocks
+     */
+    void render( GLubyte *ptrPBO, REPORTER *aStatusTextReporter, bool aPreviewFirst );
     void render_preview( GLubyte *ptrPBO );
 };
 
@@ -0,0 +1,110 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cthread_pool.cpp
+ * @brief threads kept by the raytracer for all its render passes
+ */
+
+#include "cthread_pool.h"
+#include <algorithm>
+
+
+CTHREAD_POOL::CTHREAD_POOL( size_t aThreadCount ) :
+        m_job( NULL ),
+        m_jobThreads( 0 ),
+        m_pending( 0 ),
+        m_jobId( 0 ),
+        m_exit( false )
+{
+    if( aThreadCount == 0 )
+        aThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+
+    for( size_t ii = 0; ii < aThreadCount; ++ii )
+        m_threads.emplace_back( &CTHREAD_POOL::worker, this, ii );
+}
+
+
+CTHREAD_POOL::~CTHREAD_POOL()
+{
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_exit = true;
+    }
+
+    m_jobAvailable.notify_all();
+
+    for( std::thread &thread : m_threads )
+        thread.join();
+}
+
+
+void CTHREAD_POOL::Run( const std::function<void()> &aJob, size_t aThreadCount )
+{
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    if( aThreadCount == 0 || aThreadCount > m_threads.size() )
+        aThreadCount = m_threads.size();
+
+    m_job = &aJob;
+    m_jobThreads = aThreadCount;
+    m_pending = aThreadCount;
+    m_jobId++;
+
+    m_jobAvailable.notify_all();
+
+    m_jobDone.wait( lock, [this]() { return m_pending == 0; } );
+
+    m_job = NULL;
+}
+
+
+void CTHREAD_POOL::worker( size_t aThreadIndex )
+{
+    unsigned int lastJobId = 0;
+
+    std::unique_lock<std::mutex> lock( m_mutex );
+
+    while( true )
+    {
+        m_jobAvailable.wait( lock, [&]() { return m_exit || m_jobId != lastJobId; } );
+
+        if( m_exit )
+            break;
+
+        lastJobId = m_jobId;
+
+        // The threads after the requested count sit this job out
+        if( aThreadIndex >= m_jobThreads )
+            continue;
+
+        const std::function<void()> *job = m_job;
+
+        lock.unlock();
+        ( *job )();
+        lock.lock();
+
+        if( --m_pending == 0 )
+            m_jobDone.notify_one();
+    }
+}
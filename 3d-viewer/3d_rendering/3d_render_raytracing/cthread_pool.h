@@ -0,0 +1,81 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cthread_pool.h
+ * @brief threads kept by the raytracer for all its render passes
+ */
+
+#ifndef _CTHREAD_POOL_H_
+#define _CTHREAD_POOL_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/**
+ * A set of threads started once, that run the jobs of the render passes.
+ *
+ * A job is run by several threads at the same time, which share the work between them
+ * (usually with an atomic counter), and the caller sleeps until all of them return.
+ */
+class CTHREAD_POOL
+{
+public:
+    /**
+     * @param aThreadCount is the number of threads, 0 to use one per core (at least 2)
+     */
+    explicit CTHREAD_POOL( size_t aThreadCount = 0 );
+
+    ~CTHREAD_POOL();
+
+    size_t GetThreadCount() const { return m_threads.size(); }
+
+    /**
+     * Run aJob on the threads of the pool and wait until all of them return
+     * @param aJob is the job, called once by each thread
+     * @param aThreadCount is the number of threads that run the job, 0 (or more than the
+     * threads of the pool) for all of them
+     */
+    void Run( const std::function<void()> &aJob, size_t aThreadCount = 0 );
+
+private:
+    void worker( size_t aThreadIndex );
+
+    std::vector<std::thread>     m_threads;
+
+    std::mutex                   m_mutex;
+    std::condition_variable      m_jobAvailable;
+    std::condition_variable      m_jobDone;
+
+    const std::function<void()> *m_job;         ///< The job being run, NULL when idle
+    size_t                       m_jobThreads;  ///< Number of threads that run the job
+    size_t                       m_pending;     ///< Threads that did not finish the job yet
+    unsigned int                 m_jobId;       ///< Changes with each job, to wake the threads
+    bool                         m_exit;
+};
+
+#endif // _CTHREAD_POOL_H_
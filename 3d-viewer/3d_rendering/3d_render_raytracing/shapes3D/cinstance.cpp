@@ -0,0 +1,105 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cinstance.cpp
+ * @brief
+ */
+
+#include "cinstance.h"
+#include <wx/debug.h>   // For the wxASSERT
+
+
+CINSTANCE::CINSTANCE( const CGENERICACCELERATOR *aModel, const CBBOX &aModelBBox,
+                      const glm::mat4 &aTransform ) : COBJECT( OBJECT3D_TYPE::INSTANCE )
+{
+    wxASSERT( aModel != NULL );
+
+    m_model = aModel;
+    m_invTransform = glm::inverse( aTransform );
+    m_normalMatrix = glm::transpose( glm::inverse( glm::mat3( aTransform ) ) );
+
+    m_bbox.Reset();
+    m_bbox.Set( aModelBBox );
+    m_bbox.ApplyTransformationAA( aTransform );
+    m_bbox.ScaleNextUp();
+    m_centroid = m_bbox.GetCenter();
+}
+
+
+void CINSTANCE::toModel( const RAY &aRay, RAY &aModelRay ) const
+{
+    // The direction is not normalized, so a distance along the model ray is the same
+    // distance along the world ray
+    aModelRay.Init( SFVEC3F( m_invTransform * glm::vec4( aRay.m_Origin, 1.0f ) ),
+                    SFVEC3F( m_invTransform * glm::vec4( aRay.m_Dir, 0.0f ) ) );
+}
+
+
+bool CINSTANCE::Intersect( const RAY &aRay, HITINFO &aHitInfo ) const
+{
+    RAY modelRay;
+    toModel( aRay, modelRay );
+
+    HITINFO modelHitInfo = aHitInfo;
+
+    if( !m_model->Intersect( modelRay, modelHitInfo ) )
+        return false;
+
+    aHitInfo.m_tHit = modelHitInfo.m_tHit;
+    aHitInfo.m_HitPoint = aRay.at( modelHitInfo.m_tHit );
+    aHitInfo.m_HitNormal = glm::normalize( m_normalMatrix * modelHitInfo.m_HitNormal );
+    aHitInfo.m_UV = modelHitInfo.m_UV;
+
+    // The triangle that was hit keeps the material and the colors of the model
+    aHitInfo.pHitObject = modelHitInfo.pHitObject;
+
+#ifdef RAYTRACING_RAY_STATISTICS
+    aHitInfo.m_NrRayObjTests = modelHitInfo.m_NrRayObjTests;
+    aHitInfo.m_NrTransversedNodes = modelHitInfo.m_NrTransversedNodes;
+#endif
+
+    return true;
+}
+
+
+bool CINSTANCE::IntersectP( const RAY &aRay, float aMaxDistance ) const
+{
+    RAY modelRay;
+    toModel( aRay, modelRay );
+
+    return m_model->IntersectP( modelRay, aMaxDistance );
+}
+
+
+bool CINSTANCE::Intersects( const CBBOX &aBBox ) const
+{
+    return m_bbox.Intersects( aBBox );
+}
+
+
+SFVEC3F CINSTANCE::GetDiffuseColor( const HITINFO &aHitInfo ) const
+{
+    // Not used, the hits of an instance are reported on the triangles of its model
+    return SFVEC3F( 0.0f );
+}
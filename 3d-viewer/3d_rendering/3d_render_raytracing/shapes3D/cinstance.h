@@ -0,0 +1,70 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cinstance.h
+ * @brief An instance of a 3D model whose triangles are shared with the other instances
+ */
+
+#ifndef _CINSTANCE_H_
+#define _CINSTANCE_H_
+
+#include "cobject.h"
+#include "../accelerators/caccelerator.h"
+
+/**
+ * A placed copy of a 3D model.
+ *
+ * The triangles of the model and their accelerator are built once, in model space, and
+ * each instance only stores its transformation. The rays are moved to the model space to
+ * be intersected, and the hits are moved back to the world.
+ */
+class  CINSTANCE : public COBJECT
+{
+
+public:
+    /**
+     * @param aModel is the accelerator over the triangles of the model, in model space
+     * @param aModelBBox is the bounding box of these triangles
+     * @param aTransform is the model to world transformation
+     */
+    CINSTANCE( const CGENERICACCELERATOR *aModel, const CBBOX &aModelBBox,
+               const glm::mat4 &aTransform );
+
+// Imported from COBJECT
+    bool Intersect( const RAY &aRay, HITINFO &aHitInfo ) const override;
+    bool IntersectP(const RAY &aRay , float aMaxDistance ) const override;
+    bool Intersects( const CBBOX &aBBox ) const override;
+    SFVEC3F GetDiffuseColor( const HITINFO &aHitInfo ) const override;
+
+private:
+    void toModel( const RAY &aRay, RAY &aModelRay ) const;
+
+private:
+    const CGENERICACCELERATOR *m_model;
+    glm::mat4 m_invTransform;
+    glm::mat3 m_normalMatrix;
+};
+
+
+#endif // _CINSTANCE_H_
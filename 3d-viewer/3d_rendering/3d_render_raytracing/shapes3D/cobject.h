@@ -43,6 +43,7 @@ enum class OBJECT3D_TYPE
     XYPLANE,
     ROUNDSEG,
     TRIANGLE,
+    INSTANCE,
     MAX
 };
 
@@ -94,6 +95,8 @@ public:
     const CBBOX &GetBBox() const { return m_bbox; }
 
     const SFVEC3F &GetCentroid() const { return m_centroid; }
+
+    OBJECT3D_TYPE GetObjectType() const { return m_obj_type; }
 };
 
 
@@ -72,6 +72,9 @@ public:
 private:
     void pre_calc_const();
 
+    // The packet traversal of the BVH tests several rays at once with the precomputed constants
+    friend class TRIANGLE_PACKET_TEST;
+
 private:
     SFVEC3F m_normal[3];                // 36
     SFVEC3F m_vertex[3];                // 36
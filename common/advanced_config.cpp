@@ -87,6 +87,12 @@ static const wxChar RealtimeConnectivity[] = wxT( "RealtimeConnectivity" );
  */
 static const wxChar CoroutineStackSize[] = wxT( "CoroutineStackSize" );
 
+/**
+ * Compression level of the PDF plot streams, from 0 (no compression) to 9 (the default).
+ * Lower levels plot large schematics faster, but make bigger files.
+ */
+static const wxChar PdfCompressionLevel[] = wxT( "PdfCompressionLevel" );
+
 } // namespace KEYS
 
 
@@ -168,6 +174,7 @@ ADVANCED_CFG::ADVANCED_CFG()
     m_EnableUsePinFunction = false;
     m_realTimeConnectivity = true;
     m_coroutineStackSize = AC_STACK::default_stack;
+    m_PdfCompressionLevel = 9;
 
     loadFromConfigFile();
 }
@@ -214,6 +221,9 @@ void ADVANCED_CFG::loadSettings( wxConfigBase& aCfg )
                                                &m_coroutineStackSize, AC_STACK::default_stack,
                                                AC_STACK::min_stack, AC_STACK::max_stack ) );
 
+    configParams.push_back( new PARAM_CFG_INT( true, AC_KEYS::PdfCompressionLevel,
+                                               &m_PdfCompressionLevel, 9, 0, 9 ) );
+
     wxConfigLoadSetups( &aCfg, configParams );
 
     for( auto param : configParams )
@@ -46,6 +46,9 @@ using KIGFX::COLOR4D;
 // Create only once, as seeding is *very* expensive
 static boost::uuids::random_generator randomGenerator;
 
+// Items are created from several threads when loading schematic sheets in parallel
+static std::mutex randomGeneratorMutex;
+
 // These don't have the same performance penalty, but might as well be consistent
 static boost::uuids::string_generator stringGenerator;
 static boost::uuids::nil_generator nilGenerator;
@@ -55,9 +58,13 @@ KIID niluuid( 0 );
 
 
 KIID::KIID() :
-        m_uuid( randomGenerator() ),
+        m_uuid(),
         m_cached_timestamp( 0 )
 {
+    std::lock_guard<std::mutex> lock( randomGeneratorMutex );
+
+    m_uuid = randomGenerator();
+
 #if defined(EESCHEMA)
     // JEY TODO: use legacy timestamps until new EEschema file format is in
     static timestamp_t oldTimeStamp;
@@ -210,24 +210,30 @@ const wxString PGM_BASE::AskUserForPreferredEditor( const wxString& aDefaultEdit
 }
 
 
-bool PGM_BASE::InitPgm()
+bool PGM_BASE::InitPgm( bool aHeadless )
 {
-    wxFileName pgm_name( App().argv[0] );
+    // A command line program has a console application, not a wxApp
+    wxAppConsole* app = wxAppConsole::GetInstance();
+    wxFileName    pgm_name( app->argv[0] );
 
     wxInitAllImageHandlers();
 
-    m_pgm_checker = new wxSingleInstanceChecker( pgm_name.GetName().Lower() + wxT( "-" ) +
-                                                 wxGetUserId(), GetKicadLockFilePath() );
-
-    if( m_pgm_checker->IsAnotherRunning() )
+    // Command line programs are run side by side in batch jobs, and can't ask anything
+    if( !aHeadless )
     {
-        wxString quiz = wxString::Format(
-            _( "%s is already running. Continue?" ),
-            GetChars( pgm_name.GetName() )
-            );
+        m_pgm_checker = new wxSingleInstanceChecker( pgm_name.GetName().Lower() + wxT( "-" ) +
+                                                     wxGetUserId(), GetKicadLockFilePath() );
+
+        if( m_pgm_checker->IsAnotherRunning() )
+        {
+            wxString quiz = wxString::Format(
+                _( "%s is already running. Continue?" ),
+                GetChars( pgm_name.GetName() )
+                );
 
-        if( !IsOK( NULL, quiz ) )
-            return false;
+            if( !IsOK( NULL, quiz ) )
+                return false;
+        }
     }
 
     m_settings_manager = std::unique_ptr<SETTINGS_MANAGER>( new SETTINGS_MANAGER );
@@ -250,8 +256,8 @@ bool PGM_BASE::InitPgm()
     }
 
     // Init parameters for configuration
-    App().SetVendorName( "KiCad" );
-    App().SetAppName( pgm_name.GetName().Lower() );
+    app->SetVendorName( "KiCad" );
+    app->SetAppName( pgm_name.GetName().Lower() );
 
     // Install some image handlers, mainly for help
     if( wxImage::FindHandler( wxBITMAP_TYPE_PNG ) == NULL )
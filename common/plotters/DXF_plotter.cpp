@@ -581,6 +581,36 @@ void DXF_PLOTTER::PlotPoly( const std::vector<wxPoint>& aCornerList,
 }
 
 
+void DXF_PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aCornerList,
+                            FILL_T aFill, int aWidth, void * aData )
+{
+    // Thick outlines are rebuilt as polygons, from a corner list
+    if( aWidth > 0 )
+    {
+        PLOTTER::PlotPoly( aCornerList, aFill, aWidth, aData );
+        return;
+    }
+
+    const int count = aCornerList.PointCount();
+
+    if( count <= 1 )
+        return;
+
+    const wxPoint first( aCornerList.CPoint( 0 ) );
+
+    MoveTo( first );
+
+    for( int ii = 1; ii < count; ii++ )
+        LineTo( wxPoint( aCornerList.CPoint( ii ) ) );
+
+    // Close polygon if 'fill' requested, or if the chain is closed
+    if( ( aFill || aCornerList.IsClosed() ) && wxPoint( aCornerList.CPoint( -1 ) ) != first )
+        LineTo( first );
+
+    PenFinish();
+}
+
+
 void DXF_PLOTTER::PenTo( const wxPoint& pos, char plume )
 {
     wxASSERT( outputFile );
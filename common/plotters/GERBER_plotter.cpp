@@ -43,11 +43,11 @@
 
 #include <gbr_metadata.h>
 
+#include <cstdarg>
+
 
 GERBER_PLOTTER::GERBER_PLOTTER()
 {
-    workFile  = NULL;
-    finalFile = NULL;
     m_currentApertureIdx = -1;
     m_apertureAttribute = 0;
 
@@ -102,16 +102,46 @@ void GERBER_PLOTTER::SetGerberCoordinatesFormat( int aResolution, bool aUseInche
 void GERBER_PLOTTER::emitDcode( const DPOINT& pt, int dcode )
 {
 
-    fprintf( outputFile, "X%dY%dD%02d*\n", KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+    bodyPrintf( "X%dY%dD%02d*\n", KiROUND( pt.x ), KiROUND( pt.y ), dcode );
+}
+
+void GERBER_PLOTTER::bodyPrintf( const char* aFormat, ... )
+{
+    char    buffer[256];
+    va_list args;
+
+    va_start( args, aFormat );
+    int len = vsnprintf( buffer, sizeof( buffer ), aFormat, args );
+    va_end( args );
+
+    if( len < 0 )
+        return;
+
+    if( len < (int) sizeof( buffer ) )
+    {
+        m_body.append( buffer, len );
+        return;
+    }
+
+    // Too long for the buffer (long net attributes): format it again in place
+    size_t start = m_body.size();
+    m_body.resize( start + len + 1 );
+
+    va_start( args, aFormat );
+    vsnprintf( &m_body[start], len + 1, aFormat, args );
+    va_end( args );
+
+    m_body.resize( start + len );
 }
 
+
 void GERBER_PLOTTER::ClearAllAttributes()
 {
     // Remove all attributes from object attributes dictionary (TO. and TA commands)
     if( m_useX2format )
-        fputs( "%TD*%\n", outputFile );
+        m_body += "%TD*%\n";
     else
-        fputs( "G04 #@! TD*\n", outputFile );
+        m_body += "G04 #@! TD*\n";
 
     m_objectAttributesDictionnary.clear();
 }
@@ -125,9 +155,9 @@ void GERBER_PLOTTER::clearNetAttribute()
 
     // Remove all net attributes from object attributes dictionary
     if( m_useX2format )
-        fputs( "%TD*%\n", outputFile );
+        m_body += "%TD*%\n";
     else
-        fputs( "G04 #@! TD*\n", outputFile );
+        m_body += "G04 #@! TD*\n";
 
     m_objectAttributesDictionnary.clear();
 }
@@ -171,12 +201,12 @@ void GERBER_PLOTTER::formatNetAttribute( GBR_NETLIST_METADATA* aData )
         clearNetAttribute();
 
     if( !short_attribute_string.empty() )
-        fputs( short_attribute_string.c_str(), outputFile );
+        m_body += short_attribute_string;
 
     if( m_useX2format && !aData->m_ExtraData.IsEmpty() )
     {
         std::string extra_data = TO_UTF8( aData->m_ExtraData );
-        fputs( extra_data.c_str(), outputFile );
+        m_body += extra_data;
     }
 }
 
@@ -185,18 +215,13 @@ bool GERBER_PLOTTER::StartPlot()
 {
     wxASSERT( outputFile );
 
-    finalFile = outputFile;     // the actual gerber file will be created later
-
-    // Create a temporary filename to store gerber file
-    // note tmpfile() does not work under Vista and W7 in user mode
-    m_workFilename = filename + wxT(".tmp");
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
-    outputFile = workFile;
-    wxASSERT( outputFile );
-
     if( outputFile == NULL )
         return false;
 
+    // The header goes straight to the file, the body is kept in memory until the aperture
+    // list which precedes it is complete
+    m_body.clear();
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -246,37 +271,18 @@ bool GERBER_PLOTTER::StartPlot()
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
-
     wxASSERT( outputFile );
 
-    /* Outfile is actually a temporary file i.e. workFile */
-    fputs( "M02*\n", outputFile );
-    fflush( outputFile );
+    // Placement of apertures in RS274X: the file now ends with "G04 APERTURE LIST*"
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
 
-    fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
-    wxASSERT( workFile );
-    outputFile = finalFile;
+    m_body += "M02*\n";
+    fwrite( m_body.data(), 1, m_body.size(), outputFile );
 
-    // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
-    {
-        fputs( line, outputFile );
-
-        char* substr = strtok( line, "\n\r" );
+    std::string().swap( m_body );
 
-        if( substr && strcmp( substr, "G04 APERTURE LIST*" ) == 0 )
-        {
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
-    }
-
-    fclose( workFile );
-    fclose( finalFile );
-    ::wxRemoveFile( m_workFilename );
+    fclose( outputFile );
     outputFile = 0;
 
     return true;
@@ -313,27 +319,21 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int width, void* aData )
 int GERBER_PLOTTER::GetOrCreateAperture( const wxSize& aSize,
                         APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
 {
-    int last_D_code = 9;
-
     // Search an existing aperture
-    for( int idx = 0; idx < (int)m_apertures.size(); ++idx )
-    {
-        APERTURE* tool = &m_apertures[idx];
-        last_D_code = tool->m_DCode;
+    auto it = m_apertureIndex.find( APERTURE_KEY{ aType, aSize, aApertureAttribute } );
 
-        if( (tool->m_Type == aType) && (tool->m_Size == aSize) &&
-            (tool->m_ApertureAttribute == aApertureAttribute) )
-            return idx;
-    }
+    if( it != m_apertureIndex.end() )
+        return it->second;
 
     // Allocate a new aperture
     APERTURE new_tool;
     new_tool.m_Size  = aSize;
     new_tool.m_Type  = aType;
-    new_tool.m_DCode = last_D_code + 1;
+    new_tool.m_DCode = FIRST_DCODE_VALUE + m_apertures.size();
     new_tool.m_ApertureAttribute = aApertureAttribute;
 
     m_apertures.push_back( new_tool );
+    m_apertureIndex[ APERTURE_KEY{ aType, aSize, aApertureAttribute } ] = m_apertures.size() - 1;
 
     return m_apertures.size() - 1;
 }
@@ -354,7 +354,7 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           aSize,
     {
         // Pick an existing aperture or create a new one
         m_currentApertureIdx = GetOrCreateAperture( aSize, aType, aApertureAttribute );
-        fprintf( outputFile, "D%d*\n", m_apertures[m_currentApertureIdx].m_DCode );
+        bodyPrintf( "D%d*\n", m_apertures[m_currentApertureIdx].m_DCode );
     }
 }
 
@@ -542,18 +542,18 @@ void GERBER_PLOTTER::plotArc( const wxPoint& aCenter, double aStAngle, double aE
     DPOINT devEnd = userToDeviceCoordinates( end );
     DPOINT devCenter = userToDeviceCoordinates( aCenter ) - userToDeviceCoordinates( start );
 
-    fprintf( outputFile, "G75*\n" );        // Multiquadrant (360 degrees) mode
+    m_body += "G75*\n";          // Multiquadrant (360 degrees) mode
 
     if( aStAngle < aEndAngle )
-        fprintf( outputFile, "G03*\n" );    // Active circular interpolation, CCW
+        m_body += "G03*\n";      // Active circular interpolation, CCW
     else
-        fprintf( outputFile, "G02*\n" );    // Active circular interpolation, CW
+        m_body += "G02*\n";      // Active circular interpolation, CW
 
-    fprintf( outputFile, "X%dY%dI%dJ%dD01*\n",
-             KiROUND( devEnd.x ), KiROUND( devEnd.y ),
-             KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
+    bodyPrintf( "X%dY%dI%dJ%dD01*\n",
+                KiROUND( devEnd.x ), KiROUND( devEnd.y ),
+                KiROUND( devCenter.x ), KiROUND( devCenter.y ) );
 
-    fprintf( outputFile, "G01*\n" ); // Back to linear interpol (perhaps useless here).
+    m_body += "G01*\n";   // Back to linear interpol (perhaps useless here).
 }
 
 
@@ -573,7 +573,7 @@ void GERBER_PLOTTER::PlotGerberRegion( const std::vector< wxPoint >& aCornerList
 
         if( !attrib.empty() )
         {
-            fputs( attrib.c_str(), outputFile );
+            m_body += attrib;
             clearTA_AperFunction = true;
         }
     }
@@ -585,11 +585,11 @@ void GERBER_PLOTTER::PlotGerberRegion( const std::vector< wxPoint >& aCornerList
     {
         if( m_useX2format )
         {
-            fputs( "%TD.AperFunction*%\n", outputFile );
+            m_body += "%TD.AperFunction*%\n";
         }
         else
         {
-            fputs( "G04 #@! TD.AperFunction*\n", outputFile );
+            m_body += "G04 #@! TD.AperFunction*\n";
         }
     }
 }
@@ -610,10 +610,10 @@ void GERBER_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
 
     if( aFill )
     {
-        fputs( "G36*\n", outputFile );
+        m_body += "G36*\n";
 
         MoveTo( aCornerList[0] );
-        fputs( "G01*\n", outputFile );      // Set linear interpolation.
+        m_body += "G01*\n";      // Set linear interpolation.
 
         for( unsigned ii = 1; ii < aCornerList.size(); ii++ )
             LineTo( aCornerList[ii] );
@@ -622,7 +622,7 @@ void GERBER_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
         if( aCornerList[0] != aCornerList[aCornerList.size()-1] )
             FinishTo( aCornerList[0] );
 
-        fputs( "G37*\n", outputFile );
+        m_body += "G37*\n";
     }
 
     if( aWidth > 0 )    // Draw the polyline/polygon outline
@@ -644,6 +644,59 @@ void GERBER_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
 }
 
 
+void GERBER_PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aCornerList,
+                               FILL_T aFill, int aWidth, void * aData )
+{
+    const int count = aCornerList.PointCount();
+
+    if( count <= 1 )
+        return;
+
+    // Same as the corner list version, but the vertices are read from the chain:
+    // zone fills can have a lot of them, and copying them is not useful
+    GBR_METADATA* gbr_metadata = static_cast<GBR_METADATA*>( aData );
+
+    if( gbr_metadata )
+        formatNetAttribute( &gbr_metadata->m_NetlistMetadata );
+
+    const wxPoint first( aCornerList.CPoint( 0 ) );
+    const wxPoint last( aCornerList.CPoint( -1 ) );
+
+    if( aFill )
+    {
+        m_body += "G36*\n";
+
+        MoveTo( first );
+        m_body += "G01*\n";      // Set linear interpolation.
+
+        for( int ii = 1; ii < count; ii++ )
+            LineTo( wxPoint( aCornerList.CPoint( ii ) ) );
+
+        // If the polygon is not closed, close it:
+        if( first != last )
+            FinishTo( first );
+
+        m_body += "G37*\n";
+    }
+
+    if( aWidth > 0 )    // Draw the polyline/polygon outline
+    {
+        SetCurrentLineWidth( aWidth, gbr_metadata );
+
+        MoveTo( first );
+
+        for( int ii = 1; ii < count; ii++ )
+            LineTo( wxPoint( aCornerList.CPoint( ii ) ) );
+
+        // Ensure the thick outline is closed for filled polygons and closed chains
+        if( ( aFill || aCornerList.IsClosed() ) && last != first )
+            LineTo( first );
+
+        PenFinish();
+    }
+}
+
+
 void GERBER_PLOTTER::ThickSegment( const wxPoint& start, const wxPoint& end, int width,
                             EDA_DRAW_MODE_T tracemode, void* aData )
 {
@@ -934,7 +987,7 @@ void GERBER_PLOTTER::FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aS
 
             if( !attrib.empty() )
             {
-                fputs( attrib.c_str(), outputFile );
+                m_body += attrib;
                 clearTA_AperFunction = true;
             }
         }
@@ -947,11 +1000,11 @@ void GERBER_PLOTTER::FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aS
         {
             if( m_useX2format )
             {
-                fputs( "%TD.AperFunction*%\n", outputFile );
+                m_body += "%TD.AperFunction*%\n";
             }
             else
             {
-                fputs( "G04 #@! TD.AperFunction*\n", outputFile );
+                m_body += "G04 #@! TD.AperFunction*\n";
             }
         }
     }
@@ -1044,8 +1097,8 @@ void GERBER_PLOTTER::plotRoundRectAsRegion( const wxPoint& aRectCenter, const wx
         rr_edge.m_center += aRectCenter;
     }
 
-    fputs( "G36*\n", outputFile );      // Start region
-    fputs( "G01*\n", outputFile );      // Set linear interpolation.
+    m_body += "G36*\n";      // Start region
+    m_body += "G01*\n";      // Set linear interpolation.
     MoveTo( rr_outline[0].m_start );    // Start point of region
 
     for( RR_EDGE& rr_edge: rr_outline )
@@ -1060,7 +1113,7 @@ void GERBER_PLOTTER::plotRoundRectAsRegion( const wxPoint& aRectCenter, const wx
             LineTo( rr_edge.m_end );
     }
 
-    fputs( "G37*\n", outputFile );      // Close region
+    m_body += "G37*\n";      // Close region
 }
 
 
@@ -1204,7 +1257,7 @@ void GERBER_PLOTTER::Text( const wxPoint& aPos, const COLOR4D aColor,
 void GERBER_PLOTTER::SetLayerPolarity( bool aPositive )
 {
     if( aPositive )
-        fprintf( outputFile, "%%LPD*%%\n" );
+        m_body += "%LPD*%\n";
     else
-        fprintf( outputFile, "%%LPC*%%\n" );
+        m_body += "%LPC*%\n";
 }
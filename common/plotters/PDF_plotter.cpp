@@ -27,7 +27,11 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <algorithm>
+#include <thread>
+
 #include <fctsys.h>
+#include <advanced_config.h>
 #include <pgm_base.h>
 #include <trigo.h>
 #include <eda_base_frame.h>
@@ -36,11 +40,32 @@
 #include <plotter.h>
 #include <macros.h>
 #include <kicad_string.h>
+#include <geometry/shape_line_chain.h>
 #include <wx/zstream.h>
 #include <wx/mstream.h>
 #include <math/util.h>      // for KiROUND
 
 
+PDF_PLOTTER::PDF_PLOTTER() :
+        pageTreeHandle( 0 ),
+        fontResDictHandle( 0 ),
+        xObjectDictHandle( 0 ),
+        pageStreamHandle( 0 ),
+        workFile( NULL ),
+        m_blockStart( -1 ),
+        m_blockPenWidth( 0 )
+{
+    SetCompressionLevel( ADVANCED_CFG::GetCfg().m_PdfCompressionLevel );
+}
+
+
+void PDF_PLOTTER::SetCompressionLevel( int aLevel )
+{
+    m_compressionLevel = std::max( (int) wxZ_NO_COMPRESSION,
+                                   std::min( aLevel, (int) wxZ_BEST_COMPRESSION ) );
+}
+
+
 /*
  * Open or create the plot file aFullFilename
  * return true if success, false if the file cannot be created/opened
@@ -306,6 +331,36 @@ void PDF_PLOTTER::PlotPoly( const std::vector< wxPoint >& aCornerList,
 }
 
 
+void PDF_PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aCornerList,
+                            FILL_T aFill, int aWidth, void * aData )
+{
+    wxASSERT( workFile );
+    const int count = aCornerList.PointCount();
+
+    if( count <= 1 )
+        return;
+
+    SetCurrentLineWidth( aWidth );
+
+    DPOINT pos = userToDeviceCoordinates( wxPoint( aCornerList.CPoint( 0 ) ) );
+    fprintf( workFile, "%g %g m\n", pos.x, pos.y );
+
+    for( int ii = 1; ii < count; ii++ )
+    {
+        pos = userToDeviceCoordinates( wxPoint( aCornerList.CPoint( ii ) ) );
+        fprintf( workFile, "%g %g l\n", pos.x, pos.y );
+    }
+
+    // Close path and stroke(/fill); 's' closes the outline of a closed chain
+    char op = 'b';
+
+    if( aFill == NO_FILL )
+        op = aCornerList.IsClosed() ? 's' : 'S';
+
+    fprintf( workFile, "%c\n", op );
+}
+
+
 void PDF_PLOTTER::PenTo( const wxPoint& pos, char plume )
 {
     wxASSERT( workFile );
@@ -478,19 +533,16 @@ void PDF_PLOTTER::closePdfObject()
  * Pass -1 (default) for a fresh object. Especially from PDF 1.5 streams
  * can contain a lot of things, but for the moment we only handle page
  * content.
+ * The stream is accumulated in a temporary file; the object itself is written
+ * when its compression is done, see flushPdfStreams()
  */
 int PDF_PLOTTER::startPdfStream(int handle)
 {
     wxASSERT( outputFile );
     wxASSERT( !workFile );
-    handle = startPdfObject( handle );
 
-    // This is guaranteed to be handle+1 but needs to be allocated since
-    // you could allocate more object during stream preparation
-    streamLengthHandle = allocPdfObject();
-    fprintf( outputFile,
-             "<< /Length %d 0 R /Filter /FlateDecode >>\n" // Length is deferred
-             "stream\n", handle + 1 );
+    if( handle < 0 )
+        handle = allocPdfObject();
 
     // Open a temporary file to accumulate the stream
     workFilename = filename + wxT(".tmp");
@@ -501,7 +553,7 @@ int PDF_PLOTTER::startPdfStream(int handle)
 
 
 /**
- * Finish the current PDF stream (writes the deferred length, too)
+ * Finish the current PDF stream, and queue it for compression
  */
 void PDF_PLOTTER::closePdfStream()
 {
@@ -515,11 +567,11 @@ void PDF_PLOTTER::closePdfStream()
         return;
     }
 
-    // Rewind the file, read in the page stream and DEFLATE it
+    // Rewind the file and read in the page stream
     fseek( workFile, 0, SEEK_SET );
-    unsigned char *inbuf = new unsigned char[stream_len];
+    std::string content( stream_len, '\0' );
 
-    int rc = fread( inbuf, 1, stream_len, workFile );
+    int rc = fread( &content[0], 1, stream_len, workFile );
     wxASSERT( rc == stream_len );
     (void) rc;
 
@@ -528,40 +580,147 @@ void PDF_PLOTTER::closePdfStream()
     workFile = 0;
     ::wxRemoveFile( workFilename );
 
-    // NULL means memos owns the memory, but provide a hint on optimum size needed.
-    wxMemoryOutputStream    memos( NULL, std::max( 2000l, stream_len ) ) ;
+    queuePdfStream( pageStreamHandle, std::string(), std::move( content ) );
 
-    {
-        /* Somewhat standard parameters to compress in DEFLATE. The PDF spec is
-         * misleading, it says it wants a DEFLATE stream but it really want a ZLIB
-         * stream! (a DEFLATE stream would be generated with -15 instead of 15)
-         * rc = deflateInit2( &zstrm, Z_BEST_COMPRESSION, Z_DEFLATED, 15,
-         *                    8, Z_DEFAULT_STRATEGY );
-         */
+    // Bound the memory used by the streams waiting for the file: once a stream per core is
+    // compressing, wait for the oldest one
+    flushPdfStreams( std::max( 1u, std::thread::hardware_concurrency() ) );
+}
 
-        wxZlibOutputStream      zos( memos, wxZ_BEST_COMPRESSION, wxZLIB_ZLIB );
 
-        zos.Write( inbuf, stream_len );
+/**
+ * DEFLATE a stream. The PDF spec is misleading, it says it wants a DEFLATE stream
+ * but it really want a ZLIB stream! (a DEFLATE stream would be generated with -15
+ * instead of 15)
+ * rc = deflateInit2( &zstrm, Z_BEST_COMPRESSION, Z_DEFLATED, 15,
+ *                    8, Z_DEFAULT_STRATEGY );
+ */
+static std::string deflateStream( const std::string& aContent, int aLevel )
+{
+    // NULL means memos owns the memory, but provide a hint on optimum size needed.
+    wxMemoryOutputStream memos( NULL, std::max<size_t>( 2000, aContent.size() ) );
 
-        delete[] inbuf;
+    {
+        wxZlibOutputStream zos( memos, aLevel, wxZLIB_ZLIB );
 
+        zos.Write( aContent.data(), aContent.size() );
     }   // flush the zip stream using zos destructor
 
     wxStreamBuffer* sb = memos.GetOutputStreamBuffer();
 
-    unsigned out_count = sb->Tell();
+    return std::string( static_cast<const char*>( sb->GetBufferStart() ), sb->Tell() );
+}
 
-    fwrite( sb->GetBufferStart(), 1, out_count, outputFile );
 
-    fputs( "endstream\n", outputFile );
-    closePdfObject();
+void PDF_PLOTTER::queuePdfStream( int aHandle, const std::string& aDict, std::string aContent )
+{
+    PENDING_STREAM stream;
 
-    // Writing the deferred length as an indirect object
-    startPdfObject( streamLengthHandle );
-    fprintf( outputFile, "%u\n", out_count );
-    closePdfObject();
+    stream.m_Handle = aHandle;
+    stream.m_Dict = aDict;
+    stream.m_Data = std::async( std::launch::async, deflateStream, std::move( aContent ),
+                                m_compressionLevel );
+
+    m_pendingStreams.push_back( std::move( stream ) );
+}
+
+
+void PDF_PLOTTER::flushPdfStreams( size_t aMaxPending )
+{
+    while( m_pendingStreams.size() > aMaxPending )
+    {
+        PENDING_STREAM& stream = m_pendingStreams.front();
+        std::string     data = stream.m_Data.get();
+
+        // The length is known now, so it is a direct object
+        startPdfObject( stream.m_Handle );
+        fprintf( outputFile,
+                 "<< /Length %u /Filter /FlateDecode%s >>\n"
+                 "stream\n", (unsigned) data.size(), stream.m_Dict.c_str() );
+
+        fwrite( data.data(), 1, data.size(), outputFile );
+
+        fputs( "endstream\n", outputFile );
+        closePdfObject();
+
+        m_pendingStreams.pop_front();
+    }
+}
+
+
+/**
+ * Reusable blocks are written as Form XObjects: the block is captured from the page
+ * stream, and replaced by a reference to the form holding the same content.
+ */
+void PDF_PLOTTER::StartReusableBlock()
+{
+    wxASSERT( workFile );
+    wxASSERT( m_blockStart < 0 );
+
+    PenFinish();
+
+    // Start from a known pen width, so that identical blocks have identical contents
+    m_blockPenWidth = currentPenWidth;
+    currentPenWidth = -1;
+
+    m_blockStart = ftell( workFile );
+}
+
+
+void PDF_PLOTTER::EndReusableBlock()
+{
+    wxASSERT( workFile );
+    wxASSERT( m_blockStart >= 0 );
+
+    PenFinish();
+
+    long blockEnd = ftell( workFile );
+    std::string content( blockEnd - m_blockStart, '\0' );
+
+    fseek( workFile, m_blockStart, SEEK_SET );
+
+    if( !content.empty() )
+    {
+        int rc = fread( &content[0], 1, content.size(), workFile );
+        wxASSERT( rc == (int) content.size() );
+        (void) rc;
+    }
+
+    // The form reference overwrites the block: the stream ends at the current position
+    // (see closePdfStream()), so the leftover bytes after it are ignored
+    fseek( workFile, m_blockStart, SEEK_SET );
+    m_blockStart = -1;
+
+    if( content.empty() )
+        return;
+
+    auto form = m_formHandles.find( content );
+
+    if( form == m_formHandles.end() )
+    {
+        int handle = allocPdfObject();
+
+        // The form is in the page coordinate system; its bounding box is generous, since
+        // nothing outside the page is visible anyway
+        wxSize size = pageInfo.GetSizeMils();
+        char   dict[256];
+
+        snprintf( dict, sizeof( dict ),
+                  " /Type /XObject /Subtype /Form /BBox [%d %d %d %d]"
+                  " /Resources << /ProcSet [/PDF /Text /ImageC /ImageB] /Font %d 0 R >>",
+                  -size.x * 10, -size.y * 10, size.x * 20, size.y * 20, fontResDictHandle );
+
+        queuePdfStream( handle, dict, content );
+        form = m_formHandles.emplace( std::move( content ), handle ).first;
+    }
+
+    fprintf( workFile, "/KicadForm%d Do\n", form->second );
+
+    // The graphic state set by the form does not last after it
+    currentPenWidth = m_blockPenWidth;
 }
 
+
 /**
  * Starts a new page in the PDF document
  */
@@ -616,12 +775,14 @@ void PDF_PLOTTER::ClosePage()
              "/Parent %d 0 R\n"
              "/Resources <<\n"
              "    /ProcSet [/PDF /Text /ImageC /ImageB]\n"
-             "    /Font %d 0 R >>\n"
+             "    /Font %d 0 R\n"
+             "    /XObject %d 0 R >>\n"
              "/MediaBox [0 0 %d %d]\n"
              "/Contents %d 0 R\n"
              ">>\n",
              pageTreeHandle,
              fontResDictHandle,
+             xObjectDictHandle,
              int( ceil( psPaperSize.x * BIGPTsPERMIL ) ),
              int( ceil( psPaperSize.y * BIGPTsPERMIL ) ),
              pageStreamHandle );
@@ -643,6 +804,7 @@ bool PDF_PLOTTER::StartPlot()
     // First things first: the customary null object
     xrefTable.clear();
     xrefTable.push_back( 0 );
+    m_formHandles.clear();
 
     /* The header (that's easy!). The second line is binary junk required
        to make the file binary from the beginning (the important thing is
@@ -657,6 +819,9 @@ bool PDF_PLOTTER::StartPlot()
        (it *could* be inherited via the Pages tree */
     fontResDictHandle = allocPdfObject();
 
+    // And the same for the forms of the reusable blocks
+    xObjectDictHandle = allocPdfObject();
+
     /* Now, the PDF is read from the end, (more or less)... so we start
        with the page stream for page 1. Other more important stuff is written
        at the end */
@@ -672,6 +837,9 @@ bool PDF_PLOTTER::EndPlot()
     // Close the current page (often the only one)
     ClosePage();
 
+    // Write the streams still compressing
+    flushPdfStreams();
+
     /* We need to declare the resources we're using (fonts in particular)
        The useful standard one is the Helvetica family. Adding external fonts
        is *very* involved! */
@@ -716,6 +884,16 @@ bool PDF_PLOTTER::EndPlot()
     fputs( ">>\n", outputFile );
     closePdfObject();
 
+    // Named form dictionary, for the reusable blocks
+    startPdfObject( xObjectDictHandle );
+    fputs( "<<\n", outputFile );
+
+    for( const auto& form : m_formHandles )
+        fprintf( outputFile, "    /KicadForm%d %d 0 R\n", form.second, form.second );
+
+    fputs( ">>\n", outputFile );
+    closePdfObject();
+
     /* The page tree: it's a B-tree but luckily we only have few pages!
        So we use just an array... The handle was allocated at the beginning,
        now we instantiate the corresponding object */
@@ -101,6 +101,7 @@
 #include <plotter.h>
 #include <macros.h>
 #include <kicad_string.h>
+#include <geometry/shape_line_chain.h>
 
 #include <cstdint>
 #include <wx/mstream.h>
@@ -579,6 +580,54 @@ void SVG_PLOTTER::PlotPoly( const std::vector<wxPoint>& aCornerList,
 }
 
 
+void SVG_PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aCornerList,
+                            FILL_T aFill, int aWidth, void * aData )
+{
+    const int count = aCornerList.PointCount();
+
+    if( count <= 1 )
+        return;
+
+    setFillMode( aFill );
+    SetCurrentLineWidth( aWidth );
+    fprintf( outputFile, "<path ");
+
+    switch( aFill )
+    {
+    case NO_FILL:
+        setSVGPlotStyle( false, "fill:none" );
+        break;
+
+    case FILLED_WITH_BG_BODYCOLOR:
+    case FILLED_SHAPE:
+        setSVGPlotStyle( false, "fill-rule:evenodd;" );
+        break;
+    }
+
+    DPOINT pos = userToDeviceCoordinates( wxPoint( aCornerList.CPoint( 0 ) ) );
+    fprintf( outputFile, "d=\"M %g,%g\n", pos.x, pos.y );
+
+    for( int ii = 1; ii < count - 1; ii++ )
+    {
+        pos = userToDeviceCoordinates( wxPoint( aCornerList.CPoint( ii ) ) );
+        fprintf( outputFile, "%g,%g\n", pos.x, pos.y );
+    }
+
+    // A closed chain does not repeat its first point, so its last one has to be written
+    // before closing the path
+    if( aCornerList.CPoint( 0 ) == aCornerList.CPoint( -1 ) )
+    {
+        fprintf( outputFile, "Z\" /> \n" );
+    }
+    else
+    {
+        pos = userToDeviceCoordinates( wxPoint( aCornerList.CPoint( -1 ) ) );
+        fprintf( outputFile, "%g,%g\n%s\" /> \n", pos.x, pos.y,
+                 aCornerList.IsClosed() ? "Z" : "" );
+    }
+}
+
+
 /**
  * Postscript-likes at the moment are the only plot engines supporting bitmaps...
  */
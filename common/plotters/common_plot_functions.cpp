@@ -57,6 +57,99 @@ wxString GetDefaultPlotExtension( PLOT_FORMAT aFormat )
 }
 
 
+/**
+ * Plot one item of the worksheet
+ */
+static void plotWorkSheetItem( PLOTTER* plotter, WS_DRAW_ITEM_BASE* item,
+                               const COLOR4D& plotColor )
+{
+    plotter->SetCurrentLineWidth( PLOTTER::USE_DEFAULT_LINE_WIDTH );
+
+    switch( item->Type() )
+    {
+    case WSG_LINE_T:
+        {
+            WS_DRAW_ITEM_LINE* line = (WS_DRAW_ITEM_LINE*) item;
+            plotter->SetCurrentLineWidth( line->GetPenWidth() );
+            plotter->MoveTo( line->GetStart() );
+            plotter->FinishTo( line->GetEnd() );
+        }
+        break;
+
+    case WSG_RECT_T:
+        {
+            WS_DRAW_ITEM_RECT* rect = (WS_DRAW_ITEM_RECT*) item;
+            plotter->Rect( rect->GetStart(), rect->GetEnd(), NO_FILL, rect->GetPenWidth() );
+        }
+        break;
+
+    case WSG_TEXT_T:
+        {
+            WS_DRAW_ITEM_TEXT* text = (WS_DRAW_ITEM_TEXT*) item;
+            plotter->Text( text->GetTextPos(), plotColor, text->GetShownText(),
+                           text->GetTextAngle(), text->GetTextSize(),
+                           text->GetHorizJustify(), text->GetVertJustify(),
+                           text->GetPenWidth(), text->IsItalic(), text->IsBold(),
+                           text->IsMultilineAllowed() );
+        }
+        break;
+
+    case WSG_POLY_T:
+        {
+            WS_DRAW_ITEM_POLYPOLYGONS* poly = (WS_DRAW_ITEM_POLYPOLYGONS*) item;
+            std::vector<wxPoint> points;
+
+            for( int idx = 0; idx < poly->GetPolygons().OutlineCount(); ++idx )
+            {
+                points.clear();
+                SHAPE_LINE_CHAIN& outline = poly->GetPolygons().Outline( idx );
+
+                for( int ii = 0; ii < outline.PointCount(); ii++ )
+                    points.emplace_back( outline.CPoint( ii ).x, outline.CPoint( ii ).y );
+
+                plotter->PlotPoly(  points, FILLED_SHAPE, poly->GetPenWidth() );
+            }
+        }
+        break;
+
+    case WSG_BITMAP_T:
+        {
+            WS_DRAW_ITEM_BITMAP* drawItem = (WS_DRAW_ITEM_BITMAP*) item;
+            auto*                bitmap = (WS_DATA_ITEM_BITMAP*) drawItem->GetPeer();
+
+            if( bitmap->m_ImageBitmap == NULL )
+                break;
+
+            bitmap->m_ImageBitmap->PlotImage( plotter, drawItem->GetPosition(), plotColor,
+                                              PLOTTER::USE_DEFAULT_LINE_WIDTH );
+        }
+        break;
+
+    default:
+        wxFAIL_MSG( "PlotWorkSheet(): Unknown worksheet item." );
+        break;
+    }
+}
+
+
+/**
+ * @return true if the item changes from page to page: texts with format symbols,
+ * such as the sheet number
+ */
+static bool isPageSpecific( WS_DRAW_ITEM_BASE* item )
+{
+    if( item->Type() != WSG_TEXT_T )
+        return false;
+
+    WS_DATA_ITEM* peer = item->GetPeer();
+
+    if( !peer || peer->GetType() != WS_DATA_ITEM::WS_TEXT )
+        return true;
+
+    return static_cast<WS_DATA_ITEM_TEXT*>( peer )->m_TextBase.Contains( wxT( "%" ) );
+}
+
+
 void PlotWorkSheet( PLOTTER* plotter, const TITLE_BLOCK& aTitleBlock,
                     const PAGE_INFO& aPageInfo, int aSheetNumber, int aNumberOfSheets,
                     const wxString &aSheetDesc, const wxString &aFilename, const COLOR4D aColor )
@@ -87,74 +180,21 @@ void PlotWorkSheet( PLOTTER* plotter, const TITLE_BLOCK& aTitleBlock,
 
     drawList.BuildWorkSheetGraphicList( aPageInfo, aTitleBlock );
 
-    // Draw item list
+    // Draw item list.  The items which are the same on every page are plotted first, in a
+    // block the plotter can store only once.
+    plotter->StartReusableBlock();
+
     for( WS_DRAW_ITEM_BASE* item = drawList.GetFirst(); item; item = drawList.GetNext() )
     {
-        plotter->SetCurrentLineWidth( PLOTTER::USE_DEFAULT_LINE_WIDTH );
-
-        switch( item->Type() )
-        {
-        case WSG_LINE_T:
-            {
-                WS_DRAW_ITEM_LINE* line = (WS_DRAW_ITEM_LINE*) item;
-                plotter->SetCurrentLineWidth( line->GetPenWidth() );
-                plotter->MoveTo( line->GetStart() );
-                plotter->FinishTo( line->GetEnd() );
-            }
-            break;
-
-        case WSG_RECT_T:
-            {
-                WS_DRAW_ITEM_RECT* rect = (WS_DRAW_ITEM_RECT*) item;
-                plotter->Rect( rect->GetStart(), rect->GetEnd(), NO_FILL, rect->GetPenWidth() );
-            }
-            break;
-
-        case WSG_TEXT_T:
-            {
-                WS_DRAW_ITEM_TEXT* text = (WS_DRAW_ITEM_TEXT*) item;
-                plotter->Text( text->GetTextPos(), plotColor, text->GetShownText(),
-                               text->GetTextAngle(), text->GetTextSize(),
-                               text->GetHorizJustify(), text->GetVertJustify(),
-                               text->GetPenWidth(), text->IsItalic(), text->IsBold(),
-                               text->IsMultilineAllowed() );
-            }
-            break;
-
-        case WSG_POLY_T:
-            {
-                WS_DRAW_ITEM_POLYPOLYGONS* poly = (WS_DRAW_ITEM_POLYPOLYGONS*) item;
-                std::vector<wxPoint> points;
-
-                for( int idx = 0; idx < poly->GetPolygons().OutlineCount(); ++idx )
-                {
-                    points.clear();
-                    SHAPE_LINE_CHAIN& outline = poly->GetPolygons().Outline( idx );
-
-                    for( int ii = 0; ii < outline.PointCount(); ii++ )
-                        points.emplace_back( outline.CPoint( ii ).x, outline.CPoint( ii ).y );
-
-                    plotter->PlotPoly(  points, FILLED_SHAPE, poly->GetPenWidth() );
-                }
-            }
-            break;
-
-        case WSG_BITMAP_T:
-            {
-                WS_DRAW_ITEM_BITMAP* drawItem = (WS_DRAW_ITEM_BITMAP*) item;
-                auto*                bitmap = (WS_DATA_ITEM_BITMAP*) drawItem->GetPeer();
-
-                if( bitmap->m_ImageBitmap == NULL )
-                    break;
+        if( !isPageSpecific( item ) )
+            plotWorkSheetItem( plotter, item, plotColor );
+    }
 
-                bitmap->m_ImageBitmap->PlotImage( plotter, drawItem->GetPosition(), plotColor,
-                                                  PLOTTER::USE_DEFAULT_LINE_WIDTH );
-            }
-            break;
+    plotter->EndReusableBlock();
 
-        default:
-            wxFAIL_MSG( "PlotWorkSheet(): Unknown worksheet item." );
-            break;
-        }
+    for( WS_DRAW_ITEM_BASE* item = drawList.GetFirst(); item; item = drawList.GetNext() )
+    {
+        if( isPageSpecific( item ) )
+            plotWorkSheetItem( plotter, item, plotColor );
     }
 }
@@ -588,7 +588,9 @@ void PLOTTER::PlotPoly( const SHAPE_LINE_CHAIN& aCornerList, FILL_T aFill,
     for( int ii = 0; ii < aCornerList.PointCount(); ii++ )
         cornerList.emplace_back( aCornerList.CPoint( ii ) );
 
-    if( aCornerList.IsClosed() && cornerList.front() != cornerList.back() )
+    // Filled polygons are always closed
+    if( ( aCornerList.IsClosed() || aFill != NO_FILL )
+            && cornerList.front() != cornerList.back() )
         cornerList.emplace_back( aCornerList.CPoint( 0 ) );
 
     PlotPoly( cornerList, aFill, aWidth, aData );
@@ -90,13 +90,13 @@ for layer_info in plot_plan:
     else:
         popt.SetSkipPlotNPTH_Pads( False )
 
+    # The layer is only queued here, with the current plot options:
+    # all the queued layers are plotted at once by PlotJobs()
     pctl.SetLayer(layer_info[1])
-    pctl.OpenPlotfile(layer_info[0], PLOT_FORMAT_GERBER, layer_info[2])
+    pctl.AddPlotJob(layer_info[0], PLOT_FORMAT_GERBER, layer_info[2])
     print 'plot %s' % pctl.GetPlotFileName()
     if gen_job_file == True:
         jobfile_writer.AddGbrFile( layer_info[1], os.path.basename(pctl.GetPlotFileName()) );
-    if pctl.PlotLayer() == False:
-        print "plot error"
 
 #generate internal copper layers, if any
 lyrcnt = board.GetCopperLayerCount();
@@ -105,15 +105,14 @@ for innerlyr in range ( 1, lyrcnt-1 ):
     popt.SetSkipPlotNPTH_Pads( True );
     pctl.SetLayer(innerlyr)
     lyrname = 'inner%s' % innerlyr
-    pctl.OpenPlotfile(lyrname, PLOT_FORMAT_GERBER, "inner")
+    pctl.AddPlotJob(lyrname, PLOT_FORMAT_GERBER, "inner")
     print 'plot %s' % pctl.GetPlotFileName()
-    if pctl.PlotLayer() == False:
-        print "plot error"
 
+# Plot the queued layers, each one in its own file, on all the cores
+jobcount = pctl.GetPlotJobCount()
 
-# At the end you have to close the last plot, otherwise you don't know when
-# the object will be recycled!
-pctl.ClosePlot()
+if pctl.PlotJobs() != jobcount:
+    print "plot error"
 
 # Fabricators need drill files.
 # sometimes a drill map file is asked (for verification purpose)
@@ -32,8 +32,11 @@
 
 #include <wx/regex.h>
 #include <algorithm>
-#include <vector>
+#include <map>
+#include <tuple>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include <fctsys.h>
 #include <refdes_utils.h>
@@ -46,7 +49,10 @@
 void SCH_REFERENCE_LIST::RemoveItem( unsigned int aIndex )
 {
     if( aIndex < flatList.size() )
+    {
         flatList.erase( flatList.begin() + aIndex );
+        m_refByPath.clear();
+    }
 }
 
 
@@ -168,13 +174,16 @@ int SCH_REFERENCE_LIST::FindUnit( size_t aIndex, int aUnit )
 
 int SCH_REFERENCE_LIST::FindRefByPath( const wxString& aPath ) const
 {
-    for( size_t i = 0; i < flatList.size(); ++i )
+    if( m_refByPath.empty() )
     {
-        if( flatList[i].GetPath() == aPath )
-            return i;
+        // Keep the first reference for duplicate paths
+        for( size_t i = 0; i < flatList.size(); ++i )
+            m_refByPath.emplace( flatList[i].GetPath(), (int) i );
     }
 
-    return -1;
+    auto it = m_refByPath.find( aPath );
+
+    return it != m_refByPath.end() ? it->second : -1;
 }
 
 
@@ -221,35 +230,32 @@ int SCH_REFERENCE_LIST::GetLastReference( int aIndex, int aMinValue )
 
 int SCH_REFERENCE_LIST::CreateFirstFreeRefId( std::vector<int>& aIdList, int aFirstValue )
 {
-    int expectedId = aFirstValue;
-
     // We search for expected Id a value >= aFirstValue.
     // Skip existing Id < aFirstValue
-    unsigned ii = 0;
+    size_t first = std::lower_bound( aIdList.begin(), aIdList.end(), aFirstValue )
+                   - aIdList.begin();
 
-    for( ; ii < aIdList.size(); ii++ )
-    {
-        if( expectedId <= aIdList[ii] )
-            break;
-    }
+    // Ids are sorted by increasing value, from aFirstValue, and each one is stored only once.
+    // So they are consecutive up to the first hole in list, which can be found by bisection
+    // instead of testing all the Ids in use.
+    size_t lo = first;
+    size_t hi = aIdList.size();
 
-    // Ids are sorted by increasing value, from aFirstValue
-    // So we search from aFirstValue the first not used value, i.e. the first hole in list.
-    for( ; ii < aIdList.size(); ii++ )
+    while( lo < hi )
     {
-        if( expectedId != aIdList[ii] )    // This id is not yet used.
-        {
-            // Insert this free Id, in order to keep list sorted
-            aIdList.insert( aIdList.begin() + ii, expectedId );
-            return expectedId;
-        }
+        size_t mid = ( lo + hi ) / 2;
 
-        expectedId++;
+        if( aIdList[mid] == aFirstValue + int( mid - first ) )
+            lo = mid + 1;
+        else
+            hi = mid;
     }
 
-    // All existing Id are tested, and all values are found in use.
-    // So Create a new one.
-    aIdList.push_back( expectedId );
+    int expectedId = aFirstValue + int( lo - first );
+
+    // Insert this free Id, in order to keep list sorted.  If all the existing Id are in use,
+    // this creates a new one at the end of the list.
+    aIdList.insert( aIdList.begin() + lo, expectedId );
     return expectedId;
 }
 
@@ -278,6 +284,105 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     int LastReferenceNumber = 0;
     int NumberOfUnits, Unit;
 
+    /* Large designs have tens of thousands of references, so the lookups done for each
+     * reference go through indexes built once here rather than scanning the whole list:
+     *   - the reference numbers in use and the references using them, by reference prefix,
+     *     which replaces GetRefsInUse() and FindUnit()
+     *   - the references not yet annotated which can receive another unit of a package, by
+     *     reference prefix, value, library symbol name and sheet when numbering by sheet
+     *   - the references of each component instance
+     *   - the locked unit list of each component instance
+     */
+    typedef std::pair<SCH_COMPONENT*, wxString> INSTANCE_KEY;
+    typedef std::tuple<wxString, wxString, wxString, wxString> UNITS_KEY;
+
+    std::unordered_map< wxString, std::map< int, std::vector<unsigned> > > refNumbers;
+    std::map< UNITS_KEY, std::vector<unsigned> > freeUnits;
+    std::map< INSTANCE_KEY, std::vector<unsigned> > instances;
+    std::map< INSTANCE_KEY, SCH_REFERENCE_LIST* > lockedLists;
+
+    auto instanceKey = []( const SCH_REFERENCE& aRef ) -> INSTANCE_KEY
+    {
+        return INSTANCE_KEY( aRef.GetComp(), aRef.GetSheetPath().Path().AsString() );
+    };
+
+    auto unitsKey = [aUseSheetNum]( const SCH_REFERENCE& aRef ) -> UNITS_KEY
+    {
+        return UNITS_KEY( aRef.GetRef(), aRef.m_Value->GetText(),
+                          aRef.m_RootCmp->GetLibId().GetLibItemName().wx_str(),
+                          aUseSheetNum ? aRef.GetSheetPath().Path().AsString() : wxString() );
+    };
+
+    for( unsigned ii = 0; ii < flatList.size(); ii++ )
+    {
+        SCH_REFERENCE& ref = flatList[ii];
+
+        refNumbers[ ref.GetRef() ][ ref.m_NumRef ].push_back( ii );
+        instances[ instanceKey( ref ) ].push_back( ii );
+
+        if( ref.m_IsNew )
+            freeUnits[ unitsKey( ref ) ].push_back( ii );
+    }
+
+    // A component can be in more than one locked list; the first one is used.
+    for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
+    {
+        for( unsigned thisRefI = 0; thisRefI < pair.second.GetCount(); ++thisRefI )
+            lockedLists.emplace( instanceKey( pair.second[thisRefI] ), &pair.second );
+    }
+
+    // Changes the number of the reference at aIndex, keeping refNumbers up to date
+    auto setNumRef = [&]( unsigned aIndex, int aNumRef )
+    {
+        SCH_REFERENCE& ref = flatList[aIndex];
+
+        if( ref.m_NumRef == aNumRef )
+            return;
+
+        std::map< int, std::vector<unsigned> >& numbers = refNumbers[ ref.GetRef() ];
+        std::vector<unsigned>&                  users = numbers[ ref.m_NumRef ];
+
+        users.erase( std::find( users.begin(), users.end(), aIndex ) );
+
+        if( users.empty() )
+            numbers.erase( ref.m_NumRef );
+
+        ref.m_NumRef = aNumRef;
+        numbers[ aNumRef ].push_back( aIndex );
+    };
+
+    // Same as GetRefsInUse()
+    auto getRefsInUse = [&]( unsigned aIndex, std::vector<int>& aIdList, int aMinRefId )
+    {
+        const std::map< int, std::vector<unsigned> >& numbers =
+                refNumbers[ flatList[aIndex].GetRef() ];
+
+        aIdList.clear();
+
+        for( auto it = numbers.lower_bound( aMinRefId ); it != numbers.end(); ++it )
+            aIdList.push_back( it->first );
+    };
+
+    // Same as FindUnit()
+    auto findUnit = [&]( unsigned aIndex, int aUnit ) -> int
+    {
+        const std::map< int, std::vector<unsigned> >& numbers =
+                refNumbers[ flatList[aIndex].GetRef() ];
+
+        auto users = numbers.find( flatList[aIndex].m_NumRef );
+
+        if( users == numbers.end() )
+            return -1;
+
+        for( unsigned ii : users->second )
+        {
+            if( ii != aIndex && !flatList[ii].m_IsNew && flatList[ii].m_Unit == aUnit )
+                return (int) ii;
+        }
+
+        return -1;
+    };
+
     /* calculate index of the first component with the same reference prefix
      * than the current component.  All components having the same reference
      * prefix will receive a reference number with consecutive values:
@@ -309,7 +414,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
     // This is the list of all Id already in use for a given reference prefix.
     // Will be refilled for each new reference prefix.
     std::vector<int>idList;
-    GetRefsInUse( first, idList, minRefId );
+    getRefsInUse( first, idList, minRefId );
 
     for( unsigned ii = 0; ii < flatList.size(); ii++ )
     {
@@ -320,22 +425,10 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
 
         // Check whether this component is in aLockedUnitMap.
         SCH_REFERENCE_LIST* lockedList = NULL;
-        for( SCH_MULTI_UNIT_REFERENCE_MAP::value_type& pair : aLockedUnitMap )
-        {
-            unsigned n_refs = pair.second.GetCount();
+        auto                locked = lockedLists.find( instanceKey( ref_unit ) );
 
-            for( unsigned thisRefI = 0; thisRefI < n_refs; ++thisRefI )
-            {
-                SCH_REFERENCE &thisRef = pair.second[thisRefI];
-
-                if( thisRef.IsSameInstance( ref_unit ) )
-                {
-                    lockedList = &pair.second;
-                    break;
-                }
-            }
-            if( lockedList != NULL ) break;
-        }
+        if( locked != lockedLists.end() )
+            lockedList = locked->second;
 
         if(  ( flatList[first].CompareRef( ref_unit ) != 0 )
           || ( aUseSheetNum && ( flatList[first].m_SheetNum != ref_unit.m_SheetNum ) )  )
@@ -349,7 +442,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             else
                 minRefId = aStartNumber + 1;
 
-            GetRefsInUse( first, idList, minRefId );
+            getRefsInUse( first, idList, minRefId );
         }
 
         // Annotation of one part per package components (trivial case).
@@ -358,7 +451,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             if( ref_unit.m_IsNew )
             {
                 LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-                ref_unit.m_NumRef = LastReferenceNumber;
+                setNumRef( ii, LastReferenceNumber );
             }
 
             ref_unit.m_Unit  = 1;
@@ -373,7 +466,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
         if( ref_unit.m_IsNew )
         {
             LastReferenceNumber = CreateFirstFreeRefId( idList, minRefId );
-            ref_unit.m_NumRef = LastReferenceNumber;
+            setNumRef( ii, LastReferenceNumber );
 
             if( !ref_unit.IsUnitsLocked() )
                 ref_unit.m_Unit = 1;
@@ -406,9 +499,14 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     continue;
 
                 // Find the matching component
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                auto matches = instances.find( instanceKey( thisRef ) );
+
+                if( matches == instances.end() )
+                    continue;
+
+                for( unsigned jj : matches->second )
                 {
-                    if( ! thisRef.IsSameInstance( flatList[jj] ) )
+                    if( jj <= ii )
                         continue;
 
                     wxString ref_candidate = buildFullReference( ref_unit, thisRef.m_Unit );
@@ -418,7 +516,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     // multiunits components have duplicate references)
                     if( inUseRefs.find( ref_candidate ) == inUseRefs.end() )
                     {
-                        flatList[jj].m_NumRef = ref_unit.m_NumRef;
+                        setNumRef( jj, ref_unit.m_NumRef );
                         flatList[jj].m_Unit = thisRef.m_Unit;
                         flatList[jj].m_IsNew = false;
                         flatList[jj].m_Flag = 1;
@@ -435,37 +533,27 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
             * we search for others parts that have the same value and the same
             * reference prefix (ref without ref number)
             */
+            std::vector<unsigned>& candidates = freeUnits[ unitsKey( ref_unit ) ];
+
             for( Unit = 1; Unit <= NumberOfUnits; Unit++ )
             {
                 if( ref_unit.m_Unit == Unit )
                     continue;
 
-                int found = FindUnit( ii, Unit );
+                int found = findUnit( ii, Unit );
 
                 if( found >= 0 )
                     continue; // this unit exists for this reference (unit already annotated)
 
                 // Search a component to annotate ( same prefix, same value, not annotated)
-                for( unsigned jj = ii + 1; jj < flatList.size(); jj++ )
+                for( auto it = std::upper_bound( candidates.begin(), candidates.end(), ii );
+                     it != candidates.end(); ++it )
                 {
-                    auto& cmp_unit = flatList[jj];
+                    auto& cmp_unit = flatList[*it];
 
                     if( cmp_unit.m_Flag )    // already tested
                         continue;
 
-                    if( cmp_unit.CompareRef( ref_unit ) != 0 )
-                        continue;
-
-                    if( cmp_unit.CompareValue( ref_unit ) != 0 )
-                        continue;
-
-                    if( cmp_unit.CompareLibName( ref_unit ) != 0 )
-                        continue;
-
-                    if( aUseSheetNum &&
-                            cmp_unit.GetSheetPath().Cmp( ref_unit.GetSheetPath() ) != 0 )
-                        continue;
-
                     if( !cmp_unit.m_IsNew )
                         continue;
 
@@ -473,7 +561,7 @@ void SCH_REFERENCE_LIST::Annotate( bool aUseSheetNum, int aSheetIntervalId, int
                     if( !cmp_unit.IsUnitsLocked()
                         || ( cmp_unit.m_Unit == Unit ) )
                     {
-                        cmp_unit.m_NumRef = ref_unit.m_NumRef;
+                        setNumRef( *it, ref_unit.m_NumRef );
                         cmp_unit.m_Unit   = Unit;
                         cmp_unit.m_Flag   = 1;
                         cmp_unit.m_IsNew  = false;
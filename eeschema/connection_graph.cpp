@@ -18,10 +18,12 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <atomic>
 #include <list>
 #include <thread>
 #include <algorithm>
 #include <future>
+#include <map>
 #include <vector>
 #include <unordered_map>
 #include <profile.h>
@@ -38,7 +40,6 @@
 #include <sch_sheet_path.h>
 #include <sch_text.h>
 
-#include <advanced_config.h>
 #include <connection_graph.h>
 #include <widgets/ui_common.h>
 
@@ -335,9 +336,6 @@ CONNECTION_SUBGRAPH::PRIORITY CONNECTION_SUBGRAPH::GetDriverPriority( SCH_ITEM*
 }
 
 
-bool CONNECTION_GRAPH::m_allowRealTime = true;
-
-
 void CONNECTION_GRAPH::Reset()
 {
     for( auto& subgraph : m_subgraphs )
@@ -355,6 +353,12 @@ void CONNECTION_GRAPH::Reset()
     m_net_name_to_subgraphs_map.clear();
     m_local_label_cache.clear();
     m_global_label_cache.clear();
+    m_name_key_to_subgraphs_map.clear();
+    m_subgraph_to_name_keys_map.clear();
+    m_sheet_list.clear();
+    m_sheet_screens.clear();
+    m_screen_item_counts.clear();
+    m_bus_alias_signature.Empty();
     m_last_net_code = 1;
     m_last_bus_code = 1;
     m_last_subgraph_code = 1;
@@ -364,10 +368,23 @@ void CONNECTION_GRAPH::Reset()
 void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnconditional )
 {
     PROF_COUNTER recalc_time;
+
+    if( !aUnconditional )
+    {
+        if( updateIncrementally( aSheetList ) )
+        {
+            recalc_time.Stop();
+            wxLogTrace( "CONN_PROFILE", "Incremental recalculate time %0.4f ms",
+                        recalc_time.msecs() );
+            return;
+        }
+
+        wxLogTrace( "CONN", "Incremental update not possible, rebuilding the whole graph" );
+    }
+
     PROF_COUNTER update_items;
 
-    if( aUnconditional )
-        Reset();
+    Reset();
 
     for( const SCH_SHEET_PATH& sheet : aSheetList )
     {
@@ -375,16 +392,22 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 
         for( auto item : sheet.LastScreen()->Items() )
         {
-            if( item->IsConnectable() && ( aUnconditional || item->IsConnectivityDirty() ) )
+            if( item->IsConnectable() )
                 items.push_back( item );
         }
 
+        m_sheet_list.push_back( sheet );
+        m_sheet_screens.push_back( sheet.LastScreen() );
+        m_screen_item_counts[ sheet.LastScreen() ] = items.size();
+
         updateItemConnectivity( sheet, items );
 
         // UpdateDanglingState() also adds connected items for SCH_TEXT
         sheet.LastScreen()->TestDanglingEnds( &sheet );
     }
 
+    m_bus_alias_signature = busAliasSignature( aSheetList );
+
     update_items.Stop();
     wxLogTrace( "CONN_PROFILE", "UpdateItemConnectivity() %0.4f ms", update_items.msecs() );
 
@@ -397,17 +420,6 @@ void CONNECTION_GRAPH::Recalculate( const SCH_SHEET_LIST& aSheetList, bool aUnco
 
     recalc_time.Stop();
     wxLogTrace( "CONN_PROFILE", "Recalculate time %0.4f ms", recalc_time.msecs() );
-
-#ifndef DEBUG
-    // Pressure relief valve for release builds
-    const double max_recalc_time_msecs = 250.;
-
-    if( m_allowRealTime && ADVANCED_CFG::GetCfg().m_realTimeConnectivity &&
-        recalc_time.msecs() > max_recalc_time_msecs )
-    {
-        m_allowRealTime = false;
-    }
-#endif
 }
 
 
@@ -1378,6 +1390,27 @@ void CONNECTION_GRAPH::buildConnectionGraph()
         m_net_code_to_subgraphs_map[ key ].push_back( subgraph );
     }
 
+    // The name caches may still point to absorbed subgraphs, which are deleted below.  Point
+    // them to the subgraph that took over instead, so that they can be updated incrementally.
+    auto resolve_absorbed = [] ( auto& aCache )
+    {
+        for( auto& it : aCache )
+        {
+            for( auto& subgraph : it.second )
+            {
+                while( subgraph->m_absorbed )
+                    subgraph = subgraph->m_absorbed_by;
+            }
+        }
+    };
+
+    resolve_absorbed( m_global_label_cache );
+    resolve_absorbed( m_local_label_cache );
+    resolve_absorbed( m_net_name_to_subgraphs_map );
+
+    for( CONNECTION_SUBGRAPH* subgraph : m_driver_subgraphs )
+        indexSubgraphNames( subgraph );
+
     // Clean up and deallocate stale subgraphs
     m_subgraphs.erase( std::remove_if( m_subgraphs.begin(), m_subgraphs.end(),
             [&]( const CONNECTION_SUBGRAPH* sg )
@@ -1396,241 +1429,829 @@ void CONNECTION_GRAPH::buildConnectionGraph()
 }
 
 
-int CONNECTION_GRAPH::assignNewNetCode( SCH_CONNECTION& aConnection )
+bool CONNECTION_GRAPH::updateIncrementally( const SCH_SHEET_LIST& aSheetList )
 {
-    int code;
+    // New, removed or re-pointed sheets change the hierarchy itself
+    if( m_screen_item_counts.empty() || aSheetList.size() != m_sheet_list.size() )
+        return false;
 
-    if( m_net_name_to_code_map.count( aConnection.Name() ) )
-    {
-        code = m_net_name_to_code_map.at( aConnection.Name() );
-    }
-    else
+    for( size_t i = 0; i < aSheetList.size(); i++ )
     {
-        code = m_last_net_code++;
-        m_net_name_to_code_map[ aConnection.Name() ] = code;
+        if( aSheetList[i] != m_sheet_list[i] || aSheetList[i].LastScreen() != m_sheet_screens[i] )
+            return false;
     }
 
-    aConnection.SetNetCode( code );
-
-    return code;
-}
+    // Bus aliases are not items, and can change the members of any bus
+    if( busAliasSignature( aSheetList ) != m_bus_alias_signature )
+        return false;
 
+    PROF_COUNTER find_changes;
 
-void CONNECTION_GRAPH::assignNetCodesToBus( SCH_CONNECTION* aConnection )
-{
-    auto connections_to_check( aConnection->Members() );
+    // A screen has changed if it has new or modified items (which are marked dirty), or if
+    // items were removed from it
+    std::unordered_set<SCH_SCREEN*> changed_screens;
 
-    for( unsigned i = 0; i < connections_to_check.size(); i++ )
+    for( auto& it : m_screen_item_counts )
     {
-        auto member = connections_to_check[i];
+        SCH_SCREEN* screen = it.first;
+        size_t      count = 0;
+        bool        dirty = false;
 
-        if( member->IsBus() )
+        for( SCH_ITEM* item : screen->Items() )
         {
-            connections_to_check.insert( connections_to_check.end(),
-                                         member->Members().begin(),
-                                         member->Members().end() );
-            continue;
+            if( item->IsConnectable() )
+            {
+                count++;
+                dirty |= item->IsConnectivityDirty();
+            }
         }
 
-        assignNewNetCode( *member );
+        if( dirty || count != it.second )
+            changed_screens.insert( screen );
+
+        it.second = count;
     }
-}
 
+    if( changed_screens.empty() )
+        return true;
 
-void CONNECTION_GRAPH::propagateToNeighbors( CONNECTION_SUBGRAPH* aSubgraph )
-{
-    SCH_CONNECTION* conn = aSubgraph->m_driver_connection;
-    std::vector<CONNECTION_SUBGRAPH*> search_list;
-    std::unordered_set<CONNECTION_SUBGRAPH*> visited;
-    std::vector<SCH_CONNECTION*> stale_bus_members;
+    std::unordered_set<SCH_SHEET_PATH> changed_sheets;
 
-    auto visit = [&] ( CONNECTION_SUBGRAPH* aParent ) {
-        for( SCH_SHEET_PIN* pin : aParent->m_hier_pins )
-        {
-            SCH_SHEET_PATH path = aParent->m_sheet;
-            path.push_back( pin->GetParent() );
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        if( changed_screens.count( sheet.LastScreen() ) )
+            changed_sheets.insert( sheet );
+    }
 
-            if( !m_sheet_to_subgraphs_map.count( path ) )
-                continue;
+    // Find every subgraph that may have to change.  Items may have been deleted from the
+    // changed sheets, so only the cached names of the subgraphs there can be used.
 
-            for( auto candidate : m_sheet_to_subgraphs_map.at( path ) )
-            {
-                if( !candidate->m_strong_driver ||
-                    candidate->m_hier_ports.empty() ||
-                    visited.count( candidate ) )
-                    continue;
+    std::unordered_set<CONNECTION_SUBGRAPH*> affected;
+    std::vector<CONNECTION_SUBGRAPH*>        search_list;
+    std::unordered_set<wxString>             searched_names;
 
-                for( SCH_HIERLABEL* label : candidate->m_hier_ports )
-                {
-                    if( label->GetShownText() == pin->GetShownText() )
-                    {
-                        wxLogTrace( "CONN", "%lu: found child %lu (%s)", aParent->m_code,
-                                    candidate->m_code, candidate->m_driver_connection->Name() );
+    auto add_subgraph = [&] ( CONNECTION_SUBGRAPH* aSubgraph )
+    {
+        if( affected.insert( aSubgraph ).second )
+            search_list.push_back( aSubgraph );
+    };
 
-                        candidate->m_hier_parent = aParent;
+    auto add_name = [&] ( const wxString& aName )
+    {
+        if( !searched_names.insert( aName ).second )
+            return;
 
-                        search_list.push_back( candidate );
-                        break;
-                    }
-                }
-            }
-        }
+        auto it = m_name_key_to_subgraphs_map.find( aName );
 
-        for( SCH_HIERLABEL* label : aParent->m_hier_ports )
+        if( it != m_name_key_to_subgraphs_map.end() )
         {
-            SCH_SHEET_PATH path = aParent->m_sheet;
-            path.pop_back();
+            for( CONNECTION_SUBGRAPH* subgraph : it->second )
+                add_subgraph( subgraph );
+        }
+    };
 
-            if( !m_sheet_to_subgraphs_map.count( path ) )
-                continue;
+    for( CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        if( changed_sheets.count( subgraph->m_sheet ) )
+            add_subgraph( subgraph );
+    }
 
-            for( auto candidate : m_sheet_to_subgraphs_map.at( path ) )
+    for( const SCH_SHEET_PATH& sheet : changed_sheets )
+    {
+        // The changed items may link to nets elsewhere that they were not part of before
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( item->IsConnectable() )
             {
-                if( candidate->m_hier_pins.empty() ||
-                    visited.count( candidate ) ||
-                    ( candidate->m_driver_connection->Type() !=
-                      aParent->m_driver_connection->Type() ) )
-                    continue;
+                for( const wxString& name : itemNameKeys( item, sheet ) )
+                    add_name( name );
+            }
+        }
+
+        // Sheet pins and hierarchical labels may have been added, removed or renamed, so
+        // consider all the hierarchical links of the sheet
+        SCH_SHEET_PATH parent = sheet;
+        parent.pop_back();
 
+        if( !changed_sheets.count( parent ) && m_sheet_to_subgraphs_map.count( parent ) )
+        {
+            for( CONNECTION_SUBGRAPH* candidate : m_sheet_to_subgraphs_map.at( parent ) )
+            {
                 for( SCH_SHEET_PIN* pin : candidate->m_hier_pins )
                 {
-                    SCH_SHEET_PATH pin_path = path;
-                    pin_path.push_back( pin->GetParent() );
-
-                    if( pin_path != aParent->m_sheet )
-                        continue;
-
-                    if( label->GetShownText() == pin->GetShownText() )
+                    if( pin->GetParent() == sheet.Last() )
                     {
-                        wxLogTrace( "CONN", "%lu: found additional parent %lu (%s)",
-                                    aParent->m_code, candidate->m_code,
-                                    candidate->m_driver_connection->Name() );
-
-                        search_list.push_back( candidate );
+                        add_subgraph( candidate );
                         break;
                     }
                 }
             }
-      }
-    };
+        }
 
-    auto propagate_bus_neighbors = [&]( CONNECTION_SUBGRAPH* aParentGraph ) {
-        for( const auto& kv : aParentGraph->m_bus_neighbors )
+        for( const auto& it : m_sheet_to_subgraphs_map )
         {
-            for( CONNECTION_SUBGRAPH* neighbor : kv.second )
-            {
-                // May have been absorbed but won't have been deleted
-                while( neighbor->m_absorbed )
-                    neighbor = neighbor->m_absorbed_by;
-
-                SCH_CONNECTION* parent = aParentGraph->m_driver_connection;
-
-                // Now member may be out of date, since we just cloned the
-                // connection from higher up in the hierarchy.  We need to
-                // figure out what the actual new connection is.
-                SCH_CONNECTION* member = matchBusMember( parent, kv.first.get() );
+            if( it.first.size() != sheet.size() + 1 )
+                continue;
 
-                if( !member )
-                {
-                    // Try harder: we might match on a secondary driver
-                    for( CONNECTION_SUBGRAPH* sg : kv.second )
-                    {
-                        if( sg->m_multiple_drivers )
-                        {
-                            SCH_SHEET_PATH sheet = sg->m_sheet;
+            SCH_SHEET_PATH child_parent = it.first;
+            child_parent.pop_back();
 
-                            for( SCH_ITEM* driver : sg->m_drivers )
-                            {
-                                auto c = getDefaultConnection( driver, sheet );
-                                member = matchBusMember( parent, c.get() );
+            if( child_parent != sheet )
+                continue;
 
-                                if( member )
-                                    break;
-                            }
-                        }
+            for( CONNECTION_SUBGRAPH* candidate : it.second )
+            {
+                if( !candidate->m_hier_ports.empty() )
+                    add_subgraph( candidate );
+            }
+        }
+    }
 
-                        if( member )
-                            break;
-                    }
-                }
+    for( unsigned i = 0; i < search_list.size(); i++ )
+    {
+        CONNECTION_SUBGRAPH* subgraph = search_list[i];
 
-                // This is bad, probably an ERC error
-                if( !member )
-                {
-                    wxLogTrace( "CONN", "Could not match bus member %s in %s",
-                                kv.first->Name(), parent->Name() );
-                    continue;
-                }
+        if( m_subgraph_to_name_keys_map.count( subgraph ) )
+        {
+            for( const wxString& name : m_subgraph_to_name_keys_map.at( subgraph ) )
+                add_name( name );
+        }
 
-                auto neighbor_conn = neighbor->m_driver_connection;
-                auto neighbor_name = neighbor_conn->Name();
+        if( !changed_sheets.count( subgraph->m_sheet ) )
+        {
+            for( CONNECTION_SUBGRAPH* neighbor : hierarchyNeighbors( subgraph, changed_sheets ) )
+                add_subgraph( neighbor );
+        }
+    }
 
-                // Matching name: no update needed
-                if( neighbor_name == member->Name() )
-                    continue;
+    find_changes.Stop();
+    wxLogTrace( "CONN_PROFILE", "Finding %lu affected subgraphs on %lu changed sheets %0.4f ms",
+                affected.size(), changed_sheets.size(), find_changes.msecs() );
 
-                // Safety check against infinite recursion
-                wxASSERT( neighbor_conn->IsNet() );
+    // The items of the affected subgraphs on the other sheets keep their graphical
+    // connectivity, and only need a new connection
+    std::vector<std::pair<SCH_SHEET_PATH, SCH_ITEM*>> kept_items;
 
-                wxLogTrace( "CONN", "%lu (%s) connected to bus member %s (local %s)",
-                        neighbor->m_code, neighbor_name, member->Name(), member->LocalName() );
+    for( CONNECTION_SUBGRAPH* subgraph : affected )
+    {
+        if( changed_sheets.count( subgraph->m_sheet ) )
+            continue;
 
-                // Take whichever name is higher priority
-                if( CONNECTION_SUBGRAPH::GetDriverPriority( neighbor->m_driver )
-                    >= CONNECTION_SUBGRAPH::PRIORITY::POWER_PIN )
-                {
-                    member->Clone( *neighbor_conn );
-                    stale_bus_members.push_back( member );
-                }
-                else
-                {
-                    neighbor_conn->Clone( *member );
-                    neighbor->UpdateItemConnections();
+        for( SCH_ITEM* item : subgraph->m_items )
+            kept_items.emplace_back( subgraph->m_sheet, item );
+    }
 
-                    recacheSubgraphName( neighbor, neighbor_name );
+    removeSubgraphs( affected );
 
-                    // Recurse onto this neighbor in case it needs to re-propagate
-                    neighbor->m_dirty = true;
-                    propagateToNeighbors( neighbor );
-                }
-            }
-        }
-    };
+    // Rebuild in a scratch graph, so that the subgraphs left alone can't be picked up by the
+    // build, but with the same codes for the same names
+    CONNECTION_GRAPH rebuilt( m_frame );
 
-    // If we are a bus, we must propagate to local neighbors and then the hierarchy
-    if( conn->IsBus() )
-        propagate_bus_neighbors( aSubgraph );
+    rebuilt.m_net_name_to_code_map = m_net_name_to_code_map;
+    rebuilt.m_bus_name_to_code_map = m_bus_name_to_code_map;
+    rebuilt.m_last_net_code = m_last_net_code;
+    rebuilt.m_last_bus_code = m_last_bus_code;
+    rebuilt.m_last_subgraph_code = m_last_subgraph_code;
 
-    // If we don't have any hier pins (i.e. no children), nothing to do
-    if( aSubgraph->m_hier_pins.empty() )
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
     {
-        // If we also don't have any parents, we'll never be visited again
-        if( aSubgraph->m_hier_ports.empty() )
-            aSubgraph->m_dirty = false;
-
-        return;
-    }
+        if( !changed_sheets.count( sheet ) )
+            continue;
 
-    // If we do have hier ports, skip this subgraph as it will be visited by a parent
-    // TODO(JE) this will leave the subgraph dirty if there is no matching parent subgraph,
-    // which should be flagged as an ERC error
-    if( !aSubgraph->m_hier_ports.empty() )
-        return;
+        std::vector<SCH_ITEM*> items;
 
-    visited.insert( aSubgraph );
+        for( auto item : sheet.LastScreen()->Items() )
+        {
+            if( item->IsConnectable() )
+                items.push_back( item );
+        }
 
-    wxLogTrace( "CONN", "Propagating %lu (%s) to subsheets",
-                aSubgraph->m_code, aSubgraph->m_driver_connection->Name() );
+        rebuilt.updateItemConnectivity( sheet, items );
 
-    visit( aSubgraph );
+        sheet.LastScreen()->TestDanglingEnds( &sheet );
+    }
 
-    for( unsigned i = 0; i < search_list.size(); i++ )
+    for( const auto& it : kept_items )
     {
-        auto child = search_list[i];
+        SCH_ITEM*       item = it.second;
+        SCH_CONNECTION* conn = item->InitializeConnection( it.first );
 
-        visited.insert( child );
+        // Same bus/net property as set by updateItemConnectivity()
+        switch( item->Type() )
+        {
+        case SCH_LINE_T:
+            conn->SetType( item->GetLayer() == LAYER_BUS ? CONNECTION_TYPE::BUS :
+                                                           CONNECTION_TYPE::NET );
+            break;
 
-        visit( child );
+        case SCH_BUS_BUS_ENTRY_T:
+            conn->SetType( CONNECTION_TYPE::BUS );
+            break;
+
+        case SCH_BUS_WIRE_ENTRY_T:
+            conn->SetType( CONNECTION_TYPE::NET );
+            break;
+
+        default:
+            break;
+        }
+
+        rebuilt.m_items.insert( item );
+    }
+
+    rebuilt.buildConnectionGraph();
+
+    // If a rebuilt net can still be linked to a subgraph that was left alone, the search
+    // above missed something: start over rather than produce a wrong netlist
+    for( CONNECTION_SUBGRAPH* subgraph : rebuilt.m_driver_subgraphs )
+    {
+        for( const wxString& name : rebuilt.m_subgraph_to_name_keys_map.at( subgraph ) )
+        {
+            if( m_name_key_to_subgraphs_map.count( name ) )
+            {
+                wxLogTrace( "CONN", "%lu (%s) is linked to a net outside the update by %s",
+                            subgraph->m_code, subgraph->m_driver_connection->Name(), name );
+                return false;
+            }
+        }
+
+        if( !hierarchyNeighbors( subgraph, {} ).empty() )
+        {
+            wxLogTrace( "CONN", "%lu (%s) has a hierarchical link outside the update",
+                        subgraph->m_code, subgraph->m_driver_connection->Name() );
+            return false;
+        }
+    }
+
+    merge( rebuilt, changed_sheets );
+
+    return true;
+}
+
+
+std::vector<wxString> CONNECTION_GRAPH::nameKeys( const CONNECTION_SUBGRAPH* aSubgraph )
+{
+    std::vector<wxString> keys;
+    const wxString        path = aSubgraph->m_sheet.PathHumanReadable();
+
+    std::vector<SCH_CONNECTION*> connections = { aSubgraph->m_driver_connection };
+
+    for( unsigned i = 0; i < connections.size(); i++ )
+    {
+        SCH_CONNECTION* conn = connections[i];
+        wxString        name = conn->Name();
+
+        keys.push_back( name );
+
+        // Weakly driven nets get a suffix when their name conflicts with another one
+        if( !conn->Suffix().IsEmpty() && name.EndsWith( conn->Suffix() ) )
+            keys.push_back( name.Left( name.length() - conn->Suffix().length() ) );
+
+        // Bus members link to same-sheet nets by their local name
+        if( i > 0 )
+            keys.push_back( path + conn->Name( true ) );
+
+        for( const auto& member : conn->Members() )
+            connections.push_back( member.get() );
+    }
+
+    for( SCH_ITEM* driver : aSubgraph->m_drivers )
+    {
+        wxString name = aSubgraph->GetNameForDriver( driver );
+
+        switch( CONNECTION_SUBGRAPH::GetDriverPriority( driver ) )
+        {
+        case CONNECTION_SUBGRAPH::PRIORITY::PIN:
+        case CONNECTION_SUBGRAPH::PRIORITY::POWER_PIN:
+        case CONNECTION_SUBGRAPH::PRIORITY::GLOBAL:
+            keys.push_back( name );
+            break;
+
+        default:
+            keys.push_back( path + name );
+            break;
+        }
+    }
+
+    std::sort( keys.begin(), keys.end() );
+    keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+
+    return keys;
+}
+
+
+std::vector<wxString> CONNECTION_GRAPH::itemNameKeys( SCH_ITEM* aItem,
+                                                      const SCH_SHEET_PATH& aSheet )
+{
+    std::vector<wxString> keys;
+    const wxString        path = aSheet.PathHumanReadable();
+
+    auto add_label = [&] ( SCH_ITEM* aLabel, const wxString& aText )
+    {
+        keys.push_back( aLabel->Type() == SCH_GLOBAL_LABEL_T ? aText : path + aText );
+
+        auto conn = std::make_shared<SCH_CONNECTION>( aLabel, aSheet );
+        conn->ConfigureFromLabel( aText );
+
+        std::vector<SCH_CONNECTION*> members = { conn.get() };
+
+        for( unsigned i = 0; i < members.size(); i++ )
+        {
+            if( i > 0 )
+                keys.push_back( path + members[i]->Name( true ) );
+
+            for( const auto& member : members[i]->Members() )
+                members.push_back( member.get() );
+        }
+    };
+
+    switch( aItem->Type() )
+    {
+    case SCH_LABEL_T:
+    case SCH_GLOBAL_LABEL_T:
+    case SCH_HIER_LABEL_T:
+        add_label( aItem, static_cast<SCH_TEXT*>( aItem )->GetText() );
+        break;
+
+    case SCH_SHEET_T:
+        for( SCH_SHEET_PIN* pin : static_cast<SCH_SHEET*>( aItem )->GetPins() )
+            add_label( pin, pin->GetText() );
+
+        break;
+
+    case SCH_COMPONENT_T:
+        for( SCH_PIN* pin : static_cast<SCH_COMPONENT*>( aItem )->GetSchPins( &aSheet ) )
+        {
+            if( pin->IsPowerConnection() )
+                keys.push_back( pin->GetName() );
+        }
+
+        break;
+
+    default:
+        break;
+    }
+
+    return keys;
+}
+
+
+void CONNECTION_GRAPH::indexSubgraphNames( CONNECTION_SUBGRAPH* aSubgraph )
+{
+    std::vector<wxString>& keys = m_subgraph_to_name_keys_map[aSubgraph];
+
+    keys = nameKeys( aSubgraph );
+
+    for( const wxString& key : keys )
+        m_name_key_to_subgraphs_map[key].push_back( aSubgraph );
+}
+
+
+void CONNECTION_GRAPH::unindexSubgraphNames( CONNECTION_SUBGRAPH* aSubgraph )
+{
+    auto it = m_subgraph_to_name_keys_map.find( aSubgraph );
+
+    if( it == m_subgraph_to_name_keys_map.end() )
+        return;
+
+    for( const wxString& key : it->second )
+    {
+        auto& vec = m_name_key_to_subgraphs_map.at( key );
+        vec.erase( std::remove( vec.begin(), vec.end(), aSubgraph ), vec.end() );
+
+        if( vec.empty() )
+            m_name_key_to_subgraphs_map.erase( key );
+    }
+
+    m_subgraph_to_name_keys_map.erase( it );
+}
+
+
+std::vector<CONNECTION_SUBGRAPH*> CONNECTION_GRAPH::hierarchyNeighbors(
+        const CONNECTION_SUBGRAPH* aSubgraph, const std::unordered_set<SCH_SHEET_PATH>& aSkipSheets )
+{
+    std::vector<CONNECTION_SUBGRAPH*> neighbors;
+
+    // Same matching as in propagateToNeighbors()
+    for( SCH_SHEET_PIN* pin : aSubgraph->m_hier_pins )
+    {
+        SCH_SHEET_PATH path = aSubgraph->m_sheet;
+        path.push_back( pin->GetParent() );
+
+        if( aSkipSheets.count( path ) || !m_sheet_to_subgraphs_map.count( path ) )
+            continue;
+
+        for( CONNECTION_SUBGRAPH* candidate : m_sheet_to_subgraphs_map.at( path ) )
+        {
+            for( SCH_HIERLABEL* label : candidate->m_hier_ports )
+            {
+                if( label->GetShownText() == pin->GetShownText() )
+                {
+                    neighbors.push_back( candidate );
+                    break;
+                }
+            }
+        }
+    }
+
+    if( !aSubgraph->m_hier_ports.empty() )
+    {
+        SCH_SHEET_PATH path = aSubgraph->m_sheet;
+        path.pop_back();
+
+        if( aSkipSheets.count( path ) || !m_sheet_to_subgraphs_map.count( path ) )
+            return neighbors;
+
+        for( CONNECTION_SUBGRAPH* candidate : m_sheet_to_subgraphs_map.at( path ) )
+        {
+            for( SCH_SHEET_PIN* pin : candidate->m_hier_pins )
+            {
+                SCH_SHEET_PATH pin_path = path;
+                pin_path.push_back( pin->GetParent() );
+
+                if( pin_path != aSubgraph->m_sheet )
+                    continue;
+
+                bool match = false;
+
+                for( SCH_HIERLABEL* label : aSubgraph->m_hier_ports )
+                {
+                    if( label->GetShownText() == pin->GetShownText() )
+                    {
+                        match = true;
+                        break;
+                    }
+                }
+
+                if( match )
+                {
+                    neighbors.push_back( candidate );
+                    break;
+                }
+            }
+        }
+    }
+
+    return neighbors;
+}
+
+
+void CONNECTION_GRAPH::removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs )
+{
+    auto is_removed = [&] ( const CONNECTION_SUBGRAPH* aSubgraph ) -> bool
+    {
+        return aSubgraphs.count( const_cast<CONNECTION_SUBGRAPH*>( aSubgraph ) ) > 0;
+    };
+
+    auto remove_from = [&] ( auto& aVec )
+    {
+        aVec.erase( std::remove_if( aVec.begin(), aVec.end(), is_removed ), aVec.end() );
+    };
+
+    auto remove_from_map = [&] ( auto& aMap )
+    {
+        for( auto it = aMap.begin(); it != aMap.end(); )
+        {
+            remove_from( it->second );
+
+            if( it->second.empty() )
+                it = aMap.erase( it );
+            else
+                ++it;
+        }
+    };
+
+    remove_from( m_subgraphs );
+    remove_from( m_driver_subgraphs );
+    remove_from_map( m_sheet_to_subgraphs_map );
+    remove_from_map( m_global_label_cache );
+    remove_from_map( m_local_label_cache );
+    remove_from_map( m_net_name_to_subgraphs_map );
+    remove_from_map( m_net_code_to_subgraphs_map );
+
+    // Their items may have been deleted.  The ones still in the schematic are put back by
+    // the rebuild.
+    for( CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        for( SCH_ITEM* item : subgraph->m_items )
+            m_items.erase( item );
+
+        unindexSubgraphNames( subgraph );
+        delete subgraph;
+    }
+}
+
+
+void CONNECTION_GRAPH::merge( CONNECTION_GRAPH& aOther,
+                              const std::unordered_set<SCH_SHEET_PATH>& aRebuiltSheets )
+{
+    auto append = [] ( auto& aTo, const auto& aFrom )
+    {
+        for( const auto& it : aFrom )
+            aTo[it.first].insert( aTo[it.first].end(), it.second.begin(), it.second.end() );
+    };
+
+    m_subgraphs.insert( m_subgraphs.end(), aOther.m_subgraphs.begin(), aOther.m_subgraphs.end() );
+    m_driver_subgraphs.insert( m_driver_subgraphs.end(), aOther.m_driver_subgraphs.begin(),
+                               aOther.m_driver_subgraphs.end() );
+
+    append( m_sheet_to_subgraphs_map, aOther.m_sheet_to_subgraphs_map );
+    append( m_global_label_cache, aOther.m_global_label_cache );
+    append( m_local_label_cache, aOther.m_local_label_cache );
+    append( m_net_name_to_subgraphs_map, aOther.m_net_name_to_subgraphs_map );
+    append( m_net_code_to_subgraphs_map, aOther.m_net_code_to_subgraphs_map );
+    append( m_name_key_to_subgraphs_map, aOther.m_name_key_to_subgraphs_map );
+
+    m_subgraph_to_name_keys_map.insert( aOther.m_subgraph_to_name_keys_map.begin(),
+                                        aOther.m_subgraph_to_name_keys_map.end() );
+
+    m_items.insert( aOther.m_items.begin(), aOther.m_items.end() );
+
+    m_invisible_power_pins.erase( std::remove_if( m_invisible_power_pins.begin(),
+                                                  m_invisible_power_pins.end(),
+                                  [&] ( const std::pair<SCH_SHEET_PATH, SCH_PIN*>& aPin )
+                                  {
+                                      return aRebuiltSheets.count( aPin.first ) > 0;
+                                  } ),
+                                  m_invisible_power_pins.end() );
+
+    m_invisible_power_pins.insert( m_invisible_power_pins.end(),
+                                   aOther.m_invisible_power_pins.begin(),
+                                   aOther.m_invisible_power_pins.end() );
+
+    // aOther started from our codes, so it has all of them
+    m_net_name_to_code_map.swap( aOther.m_net_name_to_code_map );
+    m_bus_name_to_code_map.swap( aOther.m_bus_name_to_code_map );
+    m_last_net_code = aOther.m_last_net_code;
+    m_last_bus_code = aOther.m_last_bus_code;
+    m_last_subgraph_code = aOther.m_last_subgraph_code;
+
+    // We own the subgraphs now
+    aOther.m_subgraphs.clear();
+    aOther.m_driver_subgraphs.clear();
+}
+
+
+wxString CONNECTION_GRAPH::busAliasSignature( const SCH_SHEET_LIST& aSheetList )
+{
+    std::unordered_set<SCH_SCREEN*> screens;
+    wxString                        signature;
+
+    for( const SCH_SHEET_PATH& sheet : aSheetList )
+    {
+        if( !screens.insert( sheet.LastScreen() ).second )
+            continue;
+
+        for( const auto& alias : sheet.LastScreen()->GetBusAliases() )
+        {
+            signature << alias->GetName() << "{";
+
+            for( const wxString& member : alias->Members() )
+                signature << member << " ";
+
+            signature << "}";
+        }
+    }
+
+    return signature;
+}
+
+
+int CONNECTION_GRAPH::assignNewNetCode( SCH_CONNECTION& aConnection )
+{
+    int code;
+
+    if( m_net_name_to_code_map.count( aConnection.Name() ) )
+    {
+        code = m_net_name_to_code_map.at( aConnection.Name() );
+    }
+    else
+    {
+        code = m_last_net_code++;
+        m_net_name_to_code_map[ aConnection.Name() ] = code;
+    }
+
+    aConnection.SetNetCode( code );
+
+    return code;
+}
+
+
+void CONNECTION_GRAPH::assignNetCodesToBus( SCH_CONNECTION* aConnection )
+{
+    auto connections_to_check( aConnection->Members() );
+
+    for( unsigned i = 0; i < connections_to_check.size(); i++ )
+    {
+        auto member = connections_to_check[i];
+
+        if( member->IsBus() )
+        {
+            connections_to_check.insert( connections_to_check.end(),
+                                         member->Members().begin(),
+                                         member->Members().end() );
+            continue;
+        }
+
+        assignNewNetCode( *member );
+    }
+}
+
+
+void CONNECTION_GRAPH::propagateToNeighbors( CONNECTION_SUBGRAPH* aSubgraph )
+{
+    SCH_CONNECTION* conn = aSubgraph->m_driver_connection;
+    std::vector<CONNECTION_SUBGRAPH*> search_list;
+    std::unordered_set<CONNECTION_SUBGRAPH*> visited;
+    std::vector<SCH_CONNECTION*> stale_bus_members;
+
+    auto visit = [&] ( CONNECTION_SUBGRAPH* aParent ) {
+        for( SCH_SHEET_PIN* pin : aParent->m_hier_pins )
+        {
+            SCH_SHEET_PATH path = aParent->m_sheet;
+            path.push_back( pin->GetParent() );
+
+            if( !m_sheet_to_subgraphs_map.count( path ) )
+                continue;
+
+            for( auto candidate : m_sheet_to_subgraphs_map.at( path ) )
+            {
+                if( !candidate->m_strong_driver ||
+                    candidate->m_hier_ports.empty() ||
+                    visited.count( candidate ) )
+                    continue;
+
+                for( SCH_HIERLABEL* label : candidate->m_hier_ports )
+                {
+                    if( label->GetShownText() == pin->GetShownText() )
+                    {
+                        wxLogTrace( "CONN", "%lu: found child %lu (%s)", aParent->m_code,
+                                    candidate->m_code, candidate->m_driver_connection->Name() );
+
+                        candidate->m_hier_parent = aParent;
+
+                        search_list.push_back( candidate );
+                        break;
+                    }
+                }
+            }
+        }
+
+        for( SCH_HIERLABEL* label : aParent->m_hier_ports )
+        {
+            SCH_SHEET_PATH path = aParent->m_sheet;
+            path.pop_back();
+
+            if( !m_sheet_to_subgraphs_map.count( path ) )
+                continue;
+
+            for( auto candidate : m_sheet_to_subgraphs_map.at( path ) )
+            {
+                if( candidate->m_hier_pins.empty() ||
+                    visited.count( candidate ) ||
+                    ( candidate->m_driver_connection->Type() !=
+                      aParent->m_driver_connection->Type() ) )
+                    continue;
+
+                for( SCH_SHEET_PIN* pin : candidate->m_hier_pins )
+                {
+                    SCH_SHEET_PATH pin_path = path;
+                    pin_path.push_back( pin->GetParent() );
+
+                    if( pin_path != aParent->m_sheet )
+                        continue;
+
+                    if( label->GetShownText() == pin->GetShownText() )
+                    {
+                        wxLogTrace( "CONN", "%lu: found additional parent %lu (%s)",
+                                    aParent->m_code, candidate->m_code,
+                                    candidate->m_driver_connection->Name() );
+
+                        search_list.push_back( candidate );
+                        break;
+                    }
+                }
+            }
+      }
+    };
+
+    auto propagate_bus_neighbors = [&]( CONNECTION_SUBGRAPH* aParentGraph ) {
+        for( const auto& kv : aParentGraph->m_bus_neighbors )
+        {
+            for( CONNECTION_SUBGRAPH* neighbor : kv.second )
+            {
+                // May have been absorbed but won't have been deleted
+                while( neighbor->m_absorbed )
+                    neighbor = neighbor->m_absorbed_by;
+
+                SCH_CONNECTION* parent = aParentGraph->m_driver_connection;
+
+                // Now member may be out of date, since we just cloned the
+                // connection from higher up in the hierarchy.  We need to
+                // figure out what the actual new connection is.
+                SCH_CONNECTION* member = matchBusMember( parent, kv.first.get() );
+
+                if( !member )
+                {
+                    // Try harder: we might match on a secondary driver
+                    for( CONNECTION_SUBGRAPH* sg : kv.second )
+                    {
+                        if( sg->m_multiple_drivers )
+                        {
+                            SCH_SHEET_PATH sheet = sg->m_sheet;
+
+                            for( SCH_ITEM* driver : sg->m_drivers )
+                            {
+                                auto c = getDefaultConnection( driver, sheet );
+                                member = matchBusMember( parent, c.get() );
+
+                                if( member )
+                                    break;
+                            }
+                        }
+
+                        if( member )
+                            break;
+                    }
+                }
+
+                // This is bad, probably an ERC error
+                if( !member )
+                {
+                    wxLogTrace( "CONN", "Could not match bus member %s in %s",
+                                kv.first->Name(), parent->Name() );
+                    continue;
+                }
+
+                auto neighbor_conn = neighbor->m_driver_connection;
+                auto neighbor_name = neighbor_conn->Name();
+
+                // Matching name: no update needed
+                if( neighbor_name == member->Name() )
+                    continue;
+
+                // Safety check against infinite recursion
+                wxASSERT( neighbor_conn->IsNet() );
+
+                wxLogTrace( "CONN", "%lu (%s) connected to bus member %s (local %s)",
+                        neighbor->m_code, neighbor_name, member->Name(), member->LocalName() );
+
+                // Take whichever name is higher priority
+                if( CONNECTION_SUBGRAPH::GetDriverPriority( neighbor->m_driver )
+                    >= CONNECTION_SUBGRAPH::PRIORITY::POWER_PIN )
+                {
+                    member->Clone( *neighbor_conn );
+                    stale_bus_members.push_back( member );
+                }
+                else
+                {
+                    neighbor_conn->Clone( *member );
+                    neighbor->UpdateItemConnections();
+
+                    recacheSubgraphName( neighbor, neighbor_name );
+
+                    // Recurse onto this neighbor in case it needs to re-propagate
+                    neighbor->m_dirty = true;
+                    propagateToNeighbors( neighbor );
+                }
+            }
+        }
+    };
+
+    // If we are a bus, we must propagate to local neighbors and then the hierarchy
+    if( conn->IsBus() )
+        propagate_bus_neighbors( aSubgraph );
+
+    // If we don't have any hier pins (i.e. no children), nothing to do
+    if( aSubgraph->m_hier_pins.empty() )
+    {
+        // If we also don't have any parents, we'll never be visited again
+        if( aSubgraph->m_hier_ports.empty() )
+            aSubgraph->m_dirty = false;
+
+        return;
+    }
+
+    // If we do have hier ports, skip this subgraph as it will be visited by a parent
+    // TODO(JE) this will leave the subgraph dirty if there is no matching parent subgraph,
+    // which should be flagged as an ERC error
+    if( !aSubgraph->m_hier_ports.empty() )
+        return;
+
+    visited.insert( aSubgraph );
+
+    wxLogTrace( "CONN", "Propagating %lu (%s) to subsheets",
+                aSubgraph->m_code, aSubgraph->m_driver_connection->Name() );
+
+    visit( aSubgraph );
+
+    for( unsigned i = 0; i < search_list.size(); i++ )
+    {
+        auto child = search_list[i];
+
+        visited.insert( child );
+
+        visit( child );
 
         child->m_dirty = false;
     }
@@ -1918,6 +2539,12 @@ int CONNECTION_GRAPH::RunERC()
             error_count++;
     }
 
+    // Checks between all the pins of a net, which may span several subgraphs
+    error_count += ercCheckPins();
+
+    if( g_ErcSettings->IsTestEnabled( ERCE_SIMILAR_LABELS ) )
+        error_count += ercCheckSimilarLabels();
+
     return error_count;
 }
 
@@ -2329,3 +2956,394 @@ bool CONNECTION_GRAPH::ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph )
 
     return true;
 }
+
+
+std::vector<CONNECTION_GRAPH::PIN_ERC_ISSUE> CONNECTION_GRAPH::ercCheckNetPins(
+        const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs ) const
+{
+    std::vector<PIN_ERC_ISSUE> issues;
+    std::vector<std::pair<SCH_PIN*, const SCH_SHEET_PATH*>> pins;
+    bool has_no_connect = false;
+
+    for( const CONNECTION_SUBGRAPH* subgraph : aSubgraphs )
+    {
+        if( subgraph->m_no_connect )
+            has_no_connect = true;
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            if( item->Type() == SCH_PIN_T )
+                pins.emplace_back( static_cast<SCH_PIN*>( item ), &subgraph->m_sheet );
+        }
+    }
+
+    // Positions of the pins of each electrical type, in increasing order.  This lets us find
+    // the first pin conflicting with a given one, and the minimal connection of the net seen
+    // from a given pin, without comparing every pair of pins of big nets (such as GND).
+    const int typeCount = ELECTRICAL_PINTYPES_TOTAL;
+    std::vector<std::vector<size_t>> pinsOfType( typeCount );
+
+    for( size_t ii = 0; ii < pins.size(); ii++ )
+        pinsOfType[static_cast<int>( pins[ii].first->GetType() )].push_back( ii );
+
+    // A pin is reported as the second pin of at most one pin to pin conflict
+    std::vector<bool> reported( pins.size(), false );
+    bool              driver_checked = false;
+
+    for( size_t ii = 0; ii < pins.size(); ii++ )
+    {
+        ELECTRICAL_PINTYPE ref_type = pins[ii].first->GetType();
+        int                min_conn = ( ref_type == ELECTRICAL_PINTYPE::PT_NC ) ? NPI : NOC;
+        size_t             conflict = pins.size();
+
+        if( has_no_connect )
+            min_conn = std::max( NET_NC, min_conn );
+
+        for( int type = 0; type < typeCount; type++ )
+        {
+            const std::vector<size_t>& others = pinsOfType[type];
+            ELECTRICAL_PINTYPE         test_type = static_cast<ELECTRICAL_PINTYPE>( type );
+
+            // The pin itself doesn't count
+            if( others.empty() || ( others.size() == 1 && others[0] == ii ) )
+                continue;
+
+            min_conn = std::max( GetMinimalConnection( ref_type, test_type ), min_conn );
+
+            if( GetPinConflictLevel( ref_type, test_type ) != OK )
+            {
+                auto next = std::upper_bound( others.begin(), others.end(), ii );
+
+                if( next != others.end() )
+                    conflict = std::min( conflict, *next );
+            }
+        }
+
+        if( conflict < pins.size() && !reported[conflict] )
+        {
+            ELECTRICAL_PINTYPE test_type = pins[conflict].first->GetType();
+            bool               is_error = GetPinConflictLevel( ref_type, test_type ) == ERR;
+
+            issues.push_back( { is_error ? ERCE_PIN_TO_PIN_ERROR : ERCE_PIN_TO_PIN_WARNING,
+                                pins[ii].first, pins[ii].second,
+                                pins[conflict].first, pins[conflict].second } );
+            reported[conflict] = true;
+        }
+
+        // Only the first pin of a net which isn't driven is reported
+        if( !driver_checked && min_conn < NET_NC )
+        {
+            if( min_conn == NOD )
+            {
+                issues.push_back( { ERCE_PIN_NOT_DRIVEN, pins[ii].first, pins[ii].second,
+                                    nullptr, nullptr } );
+            }
+
+            driver_checked = true;
+        }
+    }
+
+    return issues;
+}
+
+
+int CONNECTION_GRAPH::ercCheckPins()
+{
+    int error_count = 0;
+    std::vector<const std::vector<CONNECTION_SUBGRAPH*>*> nets;
+
+    for( const auto& net : m_net_code_to_subgraphs_map )
+        nets.push_back( &net.second );
+
+    std::vector<std::vector<PIN_ERC_ISSUE>> issues( nets.size() );
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+            ( nets.size() + 3 ) / 4 );
+
+    std::atomic<size_t> nextNet( 0 );
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    auto check_lambda = [&nextNet, &nets, &issues, this]() -> size_t
+    {
+        for( size_t netId = nextNet++; netId < nets.size(); netId = nextNet++ )
+            issues[netId] = ercCheckNetPins( *nets[netId] );
+
+        return 1;
+    };
+
+    if( parallelThreadCount <= 1 )
+        check_lambda();
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, check_lambda );
+
+        // Finalize the threads
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    // Markers are created once the threads are done: building the pin descriptions and
+    // adding items to the screens isn't thread safe
+    for( const std::vector<PIN_ERC_ISSUE>& netIssues : issues )
+    {
+        for( const PIN_ERC_ISSUE& issue : netIssues )
+        {
+            SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
+
+            if( issue.m_pinB )
+            {
+                marker->SetData( issue.m_code, issue.m_pinA->GetTransformedPosition(),
+                                 issue.m_pinA->GetDescription( issue.m_sheetA ),
+                                 issue.m_pinA->m_Uuid,
+                                 issue.m_pinB->GetDescription( issue.m_sheetB ),
+                                 issue.m_pinB->m_Uuid );
+            }
+            else
+            {
+                marker->SetData( issue.m_code, issue.m_pinA->GetTransformedPosition(),
+                                 issue.m_pinA->GetDescription( issue.m_sheetA ),
+                                 issue.m_pinA->m_Uuid );
+            }
+
+            issue.m_sheetA->LastScreen()->Append( marker );
+            error_count++;
+        }
+    }
+
+    // Check that a pin appears in only one net.  This check is necessary because multi-unit
+    // components that have shared pins could be wired to different nets.
+    if( !g_ErcSettings->IsTestEnabled( ERCE_DIFFERENT_UNIT_NET ) )
+        return error_count;
+
+    std::unordered_map<wxString, wxString> pin_to_net_map;
+    wxString msg;
+
+    for( const auto& net : m_net_code_to_subgraphs_map )
+    {
+        const wxString& net_name = net.first.first;
+
+        for( const CONNECTION_SUBGRAPH* subgraph : net.second )
+        {
+            for( SCH_ITEM* item : subgraph->m_items )
+            {
+                if( item->Type() != SCH_PIN_T )
+                    continue;
+
+                SCH_PIN*       pin = static_cast<SCH_PIN*>( item );
+                SCH_COMPONENT* comp = pin->GetParentComponent();
+
+                if( !comp )
+                    continue;
+
+                wxString ref = comp->GetRef( &subgraph->m_sheet );
+                wxString pin_name = ref + "_" + pin->GetNumber();
+                auto     it = pin_to_net_map.find( pin_name );
+
+                if( it == pin_to_net_map.end() )
+                {
+                    pin_to_net_map[pin_name] = net_name;
+                }
+                else if( it->second != net_name )
+                {
+                    msg.Printf( _( "Pin %s on %s is connected to both %s and %s" ),
+                                pin->GetNumber(),
+                                ref,
+                                it->second,
+                                net_name );
+
+                    wxPoint pos = pin->GetTransformedPosition();
+
+                    SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
+                    marker->SetData( ERCE_DIFFERENT_UNIT_NET, pos, msg, pos );
+                    subgraph->m_sheet.LastScreen()->Append( marker );
+                    error_count++;
+                }
+            }
+        }
+    }
+
+    return error_count;
+}
+
+
+int CONNECTION_GRAPH::ercCheckSimilarLabels()
+{
+    struct LABEL_INSTANCE
+    {
+        SCH_ITEM*             m_item;     ///< The label, or the power pin
+        const SCH_SHEET_PATH* m_sheet;
+        wxString              m_text;     ///< The label text, bus member or power pin name
+        wxPoint               m_pos;
+        bool                  m_global;
+    };
+
+    typedef std::pair<SCH_SHEET_PATH, wxString> SHEET_TEXT;
+
+    std::vector<LABEL_INSTANCE> labels;
+
+    // A bus label stands for the nets of its members, so these are compared instead of its text
+    auto addBusMembers = [&]( SCH_TEXT* aLabel, const SCH_SHEET_PATH* aSheet,
+                              const SCH_CONNECTION* aBus )
+    {
+        bool                               global = aLabel->Type() == SCH_GLOBAL_LABEL_T;
+        std::vector<const SCH_CONNECTION*> buses = { aBus };
+
+        while( !buses.empty() )
+        {
+            const SCH_CONNECTION* bus = buses.back();
+            buses.pop_back();
+
+            for( const std::shared_ptr<SCH_CONNECTION>& member : bus->Members() )
+            {
+                // Vector buses nested in a bus group
+                if( member->IsBus() )
+                    buses.push_back( member.get() );
+                else
+                    labels.push_back( { aLabel, aSheet, member->Name( true ),
+                                        aLabel->GetPosition(), global } );
+            }
+        }
+    };
+
+    // Sheet pins are not taken into account: they are seen only from the child sheet, and
+    // any mismatch with the child sheet's hierarchical labels is already reported by ERC
+    for( const CONNECTION_SUBGRAPH* subgraph : m_subgraphs )
+    {
+        const SCH_CONNECTION* driver_conn = subgraph->m_driver_connection;
+        bool is_bus = driver_conn && driver_conn->IsBus();
+
+        for( SCH_ITEM* item : subgraph->m_items )
+        {
+            switch( item->Type() )
+            {
+            case SCH_LABEL_T:
+            case SCH_GLOBAL_LABEL_T:
+            case SCH_HIER_LABEL_T:
+            {
+                SCH_TEXT* text = static_cast<SCH_TEXT*>( item );
+
+                if( !is_bus )
+                {
+                    labels.push_back( { text, &subgraph->m_sheet, text->GetShownText(),
+                                        text->GetPosition(), item->Type() == SCH_GLOBAL_LABEL_T } );
+                }
+                else if( item == subgraph->m_driver )
+                {
+                    addBusMembers( text, &subgraph->m_sheet, driver_conn );
+                }
+                else
+                {
+                    // The other labels of the bus don't always name the same members
+                    SCH_CONNECTION conn( item, subgraph->m_sheet );
+                    conn.ConfigureFromLabel( text->GetShownText() );
+                    addBusMembers( text, &subgraph->m_sheet, &conn );
+                }
+
+                break;
+            }
+
+            case SCH_PIN_T:
+            {
+                SCH_PIN* pin = static_cast<SCH_PIN*>( item );
+
+                // Power pins connect to the net of their name, in the whole project
+                if( pin->IsPowerConnection() )
+                {
+                    labels.push_back( { pin, &subgraph->m_sheet, pin->GetName(),
+                                        pin->GetTransformedPosition(), true } );
+                }
+
+                break;
+            }
+
+            default:
+                break;
+            }
+        }
+    }
+
+    // Number of instances of each label, used to pick the label the marker is attached to
+    std::map<wxString, int>   global_count;
+    std::map<SHEET_TEXT, int> sheet_count;
+
+    // One label for each text: project wide for global labels, and per sheet for all labels
+    std::map<wxString, const LABEL_INSTANCE*>   global_labels;
+    std::map<SHEET_TEXT, const LABEL_INSTANCE*> sheet_labels;
+
+    for( const LABEL_INSTANCE& label : labels )
+    {
+        SHEET_TEXT key( *label.m_sheet, label.m_text );
+
+        if( label.m_global )
+        {
+            global_count[label.m_text]++;
+            global_labels.emplace( label.m_text, &label );
+        }
+
+        sheet_count[key]++;
+        sheet_labels.emplace( key, &label );
+    }
+
+    // Different texts which are equal when compared case insensitively
+    std::map<wxString, std::vector<const LABEL_INSTANCE*>>   similar_globals;
+    std::map<SHEET_TEXT, std::vector<const LABEL_INSTANCE*>> similar_in_sheet;
+
+    for( const auto& entry : global_labels )
+        similar_globals[entry.first.Lower()].push_back( entry.second );
+
+    for( const auto& entry : sheet_labels )
+    {
+        SHEET_TEXT key( entry.first.first, entry.first.second.Lower() );
+        similar_in_sheet[key].push_back( entry.second );
+    }
+
+    auto count = [&]( const LABEL_INSTANCE* aLabel ) -> int
+    {
+        if( aLabel->m_global )
+            return global_count[aLabel->m_text];
+
+        return sheet_count[SHEET_TEXT( *aLabel->m_sheet, aLabel->m_text )];
+    };
+
+    int error_count = 0;
+
+    // The marker goes on the label with fewer instances, which is the likely mistake
+    auto report = [&]( const LABEL_INSTANCE* aLabelA, const LABEL_INSTANCE* aLabelB )
+    {
+        if( count( aLabelA ) > count( aLabelB ) )
+            std::swap( aLabelA, aLabelB );
+
+        SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
+        marker->SetData( EDA_UNITS::UNSCALED, ERCE_SIMILAR_LABELS, aLabelA->m_pos,
+                         aLabelA->m_item, aLabelB->m_item );
+        aLabelA->m_sheet->LastScreen()->Append( marker );
+        error_count++;
+    };
+
+    for( const auto& group : similar_globals )
+    {
+        for( size_t ii = 0; ii < group.second.size(); ii++ )
+        {
+            for( size_t jj = ii + 1; jj < group.second.size(); jj++ )
+                report( group.second[ii], group.second[jj] );
+        }
+    }
+
+    for( const auto& group : similar_in_sheet )
+    {
+        for( size_t ii = 0; ii < group.second.size(); ii++ )
+        {
+            for( size_t jj = ii + 1; jj < group.second.size(); jj++ )
+            {
+                // Global labels were compared with each other above
+                if( group.second[ii]->m_global && group.second[jj]->m_global )
+                    continue;
+
+                report( group.second[ii], group.second[jj] );
+            }
+        }
+    }
+
+    return error_count;
+}
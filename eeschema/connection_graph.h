@@ -39,6 +39,7 @@
 class SCH_EDIT_FRAME;
 class SCH_HIERLABEL;
 class SCH_PIN;
+class SCH_SCREEN;
 class SCH_SHEET_PIN;
 
 
@@ -210,6 +211,10 @@ typedef std::map<NET_NAME_CODE, std::vector<CONNECTION_SUBGRAPH*>> NET_MAP;
 class CONNECTION_GRAPH
 {
 public:
+    /**
+     * @param aFrame is the schematic editor frame, used for the ERC markers.  It can be null
+     *               when the graph is only used to generate netlists.
+     */
     CONNECTION_GRAPH( SCH_EDIT_FRAME* aFrame )
             : m_last_net_code( 1 ),
               m_last_bus_code( 1 ),
@@ -227,6 +232,9 @@ public:
     /**
      * Updates the connection graph for the given list of sheets.
      *
+     * Unless a full recalculation is requested, only the nets that can be affected by items
+     * with dirty connectivity are rebuilt (see updateIncrementally()).
+     *
      * @param aSheetList is the list of possibly modified sheets
      * @param aUnconditional is true if an unconditional full recalculation should be done
      */
@@ -260,9 +268,6 @@ public:
 
     const NET_MAP& GetNetMap() const { return m_net_code_to_subgraphs_map; }
 
-    // TODO(JE) Remove this when pressure valve is removed
-    static bool m_allowRealTime;
-
 private:
 
     std::unordered_set<SCH_ITEM*> m_items;
@@ -295,6 +300,22 @@ private:
 
     NET_MAP m_net_code_to_subgraphs_map;
 
+    /// Driven subgraphs by each of the names they can be linked to other subgraphs with
+    std::unordered_map<wxString, std::vector<CONNECTION_SUBGRAPH*>> m_name_key_to_subgraphs_map;
+
+    std::unordered_map<CONNECTION_SUBGRAPH*, std::vector<wxString>> m_subgraph_to_name_keys_map;
+
+    /// The sheets (and their screens) the graph was last updated for
+    SCH_SHEET_LIST m_sheet_list;
+
+    std::vector<SCH_SCREEN*> m_sheet_screens;
+
+    /// Number of connectable items on each screen at the last update
+    std::unordered_map<SCH_SCREEN*, size_t> m_screen_item_counts;
+
+    /// Bus alias definitions at the last update, see busAliasSignature()
+    wxString m_bus_alias_signature;
+
     int m_last_net_code;
 
     int m_last_bus_code;
@@ -351,6 +372,66 @@ private:
      */
     void buildConnectionGraph();
 
+    /**
+     * Updates the graph for the items with dirty connectivity, leaving alone the nets that
+     * they can't have an effect on.
+     *
+     * The graphical connectivity is updated for each sheet that has new, modified or removed
+     * items.  The subgraphs on these sheets are thrown away, along with every subgraph that
+     * they are (or may become) linked to by name or through the hierarchy, and all of them
+     * are rebuilt in a scratch graph which is then merged into this one.
+     *
+     * @param aSheetList is the list of sheets of the schematic
+     * @return false if the changes can't be handled incrementally and the graph must be
+     *         rebuilt from scratch
+     */
+    bool updateIncrementally( const SCH_SHEET_LIST& aSheetList );
+
+    /**
+     * Returns the names a driven subgraph can be linked to other subgraphs by: its net name,
+     * the names of all its drivers and those of its bus members.  Local names are prefixed
+     * with the sheet path so that they only match on the same sheet.
+     */
+    static std::vector<wxString> nameKeys( const CONNECTION_SUBGRAPH* aSubgraph );
+
+    /**
+     * Returns the names the labels, sheet pins and power pins of an item can create links
+     * with, in the same format as nameKeys()
+     */
+    std::vector<wxString> itemNameKeys( SCH_ITEM* aItem, const SCH_SHEET_PATH& aSheet );
+
+    void indexSubgraphNames( CONNECTION_SUBGRAPH* aSubgraph );
+
+    void unindexSubgraphNames( CONNECTION_SUBGRAPH* aSubgraph );
+
+    /**
+     * Finds the subgraphs on the parent and child sheets that are linked to a subgraph by
+     * hierarchical pins and labels.
+     *
+     * @param aSubgraph is the subgraph to find the neighbors of
+     * @param aSkipSheets are sheets whose subgraphs are not considered
+     */
+    std::vector<CONNECTION_SUBGRAPH*> hierarchyNeighbors( const CONNECTION_SUBGRAPH* aSubgraph,
+            const std::unordered_set<SCH_SHEET_PATH>& aSkipSheets );
+
+    /**
+     * Removes subgraphs from the graph and all its caches, and deletes them.  Their items are
+     * removed from the graph as well.
+     */
+    void removeSubgraphs( const std::unordered_set<CONNECTION_SUBGRAPH*>& aSubgraphs );
+
+    /**
+     * Moves the subgraphs of a graph built for a part of the schematic into this one
+     *
+     * @param aOther is the graph to take the subgraphs from
+     * @param aRebuiltSheets are the sheets whose items were all rebuilt in aOther
+     */
+    void merge( CONNECTION_GRAPH& aOther,
+                const std::unordered_set<SCH_SHEET_PATH>& aRebuiltSheets );
+
+    /// Returns a string that changes when any bus alias definition changes
+    static wxString busAliasSignature( const SCH_SHEET_LIST& aSheetList );
+
     /**
      * Helper to assign a new net code to a connection
      *
@@ -454,6 +535,48 @@ private:
      */
     bool ercCheckLabels( const CONNECTION_SUBGRAPH* aSubgraph );
 
+    /// A problem found between two pins of a net (or with a single pin if m_pinB is null)
+    struct PIN_ERC_ISSUE
+    {
+        int                   m_code;
+        SCH_PIN*              m_pinA;
+        const SCH_SHEET_PATH* m_sheetA;
+        SCH_PIN*              m_pinB;
+        const SCH_SHEET_PATH* m_sheetB;
+    };
+
+    /**
+     * Checks the pins of one net for conflicting electrical types, as set in the pin
+     * conflicts map, and for a missing driver
+     *
+     * This doesn't touch the schematic, so it can run for several nets at once: the issues
+     * found are returned to be turned into markers afterwards.
+     *
+     * @param  aSubgraphs     are the subgraphs making up the net
+     * @return                the issues found
+     */
+    std::vector<PIN_ERC_ISSUE> ercCheckNetPins(
+            const std::vector<CONNECTION_SUBGRAPH*>& aSubgraphs ) const;
+
+    /**
+     * Checks all nets for pin conflicts, undriven nets and for shared pins of multi-unit
+     * components connected to different nets
+     *
+     * @return                the number of errors found
+     */
+    int ercCheckPins();
+
+    /**
+     * Checks for labels which are different but are equal when compared case insensitively
+     *
+     * Bus labels are compared through the names of their members, and power pins through
+     * their name, as global labels.  Global labels are compared with all the other global
+     * labels, local and hierarchical labels with all the labels of their sheet.
+     *
+     * @return                the number of errors found
+     */
+    int ercCheckSimilarLabels();
+
 };
 
 #endif
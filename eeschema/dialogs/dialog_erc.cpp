@@ -35,7 +35,6 @@
 #include <reporter.h>
 #include <wildcards_and_files_ext.h>
 #include <sch_view.h>
-#include <netlist_object.h>
 #include <sch_marker.h>
 #include <sch_component.h>
 #include <connection_graph.h>
@@ -208,7 +207,8 @@ void DIALOG_ERC::TestErc( REPORTER& aReporter )
         TestConflictingBusAliases();
     }
 
-    // The connection graph has a whole set of ERC checks it can run
+    // The connection graph has a whole set of ERC checks it can run, including the checks
+    // between the pins and the labels of each net
     aReporter.ReportTail( _( "Checking conflicts...\n" ) );
     m_parent->RecalculateConnections( NO_CLEANUP );
     g_ConnectionGraph->RunERC();
@@ -220,102 +220,6 @@ void DIALOG_ERC::TestErc( REPORTER& aReporter )
         TestMultiunitFootprints( sheets );
     }
 
-    std::unique_ptr<NETLIST_OBJECT_LIST> objectsConnectedList( m_parent->BuildNetListBase() );
-
-    // Reset the connection type indicator
-    objectsConnectedList->ResetConnectionsType();
-
-    unsigned lastItemIdx = 0;
-    unsigned nextItemIdx = 0;
-    int      MinConn = NOC;
-
-    // Check that a pin appears in only one net.  This check is necessary because multi-unit
-    // components that have shared pins could be wired to different nets.
-    std::unordered_map<wxString, wxString> pin_to_net_map;
-
-    // The netlist generated by SCH_EDIT_FRAME::BuildNetListBase is sorted by net number, which
-    // means we can group netlist items into ranges that live in the same net. The range from
-    // nextItem to the current item (exclusive) needs to be checked against the current item.
-    // The lastItem variable is used as a helper to pass the last item's number from one loop
-    // iteration to the next, which simplifies the initial pass.
-    aReporter.ReportTail( _( "Checking connections...\n" ), RPT_SEVERITY_INFO );
-    for( unsigned itemIdx = 0; itemIdx < objectsConnectedList->size(); itemIdx++ )
-    {
-        auto item = objectsConnectedList->GetItem( itemIdx );
-        auto lastItem = objectsConnectedList->GetItem( lastItemIdx );
-
-        auto lastNet = lastItem->GetNet();
-        auto net = item->GetNet();
-
-        wxASSERT_MSG( lastNet <= net, wxT( "Netlist not correctly ordered" ) );
-
-        if( lastNet != net )
-        {
-            // New net found:
-            MinConn      = NOC;
-            nextItemIdx = itemIdx;
-        }
-
-        switch( item->m_Type )
-        {
-        // These items do not create erc problems
-        case NETLIST_ITEM::ITEM_UNSPECIFIED:
-        case NETLIST_ITEM::SEGMENT:
-        case NETLIST_ITEM::BUS:
-        case NETLIST_ITEM::JUNCTION:
-        case NETLIST_ITEM::LABEL:
-        case NETLIST_ITEM::BUSLABELMEMBER:
-        case NETLIST_ITEM::PINLABEL:
-        case NETLIST_ITEM::GLOBBUSLABELMEMBER:
-            break;
-
-        // TODO(JE) Port this to the new system
-        case NETLIST_ITEM::PIN:
-        {
-            // Check if this pin has appeared before on a different net
-            if( item->m_Link && g_ErcSettings->IsTestEnabled( ERCE_DIFFERENT_UNIT_NET ) )
-            {
-                wxString ref = item->GetComponentParent()->GetRef( &item->m_SheetPath );
-                wxString pin_name = ref + "_" + item->m_PinNum;
-                wxString msg;
-
-                if( pin_to_net_map.count( pin_name ) == 0 )
-                {
-                    pin_to_net_map[pin_name] = item->GetNetName();
-                }
-                else if( pin_to_net_map[pin_name] != item->GetNetName() )
-                {
-                    msg.Printf( _( "Pin %s on %s is connected to both %s and %s" ),
-                                item->m_PinNum,
-                                ref,
-                                pin_to_net_map[pin_name],
-                                item->GetNetName() );
-
-                    SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
-                    marker->SetData( ERCE_DIFFERENT_UNIT_NET, item->m_Start, msg, item->m_Start );
-                    item->m_SheetPath.LastScreen()->Append( marker );
-                }
-            }
-
-            // Look for ERC problems between pins:
-            TestOthersItems( objectsConnectedList.get(), itemIdx, nextItemIdx, &MinConn );
-            break;
-        }
-        default:
-        break;
-        }
-
-        lastItemIdx = itemIdx;
-    }
-
-    // Test similar labels (i;e. labels which are identical when
-    // using case insensitive comparisons)
-    if( g_ErcSettings->IsTestEnabled( ERCE_SIMILAR_LABELS ) )
-    {
-        aReporter.ReportTail( _( "Checking labels...\n" ), RPT_SEVERITY_INFO );
-        objectsConnectedList->TestforSimilarLabels();
-    }
-
     // Display diags:
     m_markerTreeModel->SetProvider( m_markerProvider );
 
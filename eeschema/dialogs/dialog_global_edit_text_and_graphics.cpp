@@ -98,7 +98,7 @@ DIALOG_GLOBAL_EDIT_TEXT_AND_GRAPHICS::DIALOG_GLOBAL_EDIT_TEXT_AND_GRAPHICS( SCH_
     m_hasChange = false;
 
     // TODO(JE) remove once real-time connectivity is a given
-    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         m_parent->RecalculateConnections( NO_CLEANUP );
 
     m_sdbSizerButtonsOK->SetDefault();
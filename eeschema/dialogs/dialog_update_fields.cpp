@@ -99,7 +99,7 @@ bool DIALOG_UPDATE_FIELDS::TransferDataToWindow()
     {
         for( auto component : m_components )
         {
-            const std::unique_ptr< LIB_PART >&  part = component->GetPartRef();
+            const std::shared_ptr< LIB_PART >&  part = component->GetPartRef();
 
             if( !part )
                 continue;
@@ -145,7 +145,7 @@ void DIALOG_UPDATE_FIELDS::updateFields( SCH_COMPONENT* aComponent )
     std::vector<SCH_FIELD*> oldFields;
     SCH_FIELDS newFields;
 
-    std::unique_ptr< LIB_PART >& libPart = aComponent->GetPartRef();
+    std::shared_ptr< LIB_PART >& libPart = aComponent->GetPartRef();
 
     if( !libPart )    // the symbol is not found in lib: cannot update fields
         return;
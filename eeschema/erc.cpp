@@ -32,7 +32,6 @@
 #include <sch_draw_panel.h>
 #include <kicad_string.h>
 #include <sch_edit_frame.h>
-#include <netlist_object.h>
 #include <lib_pin.h>
 #include <erc.h>
 #include <sch_marker.h>
@@ -126,6 +125,10 @@ int DefaultPinMap[ELECTRICAL_PINTYPES_TOTAL][ELECTRICAL_PINTYPES_TOTAL] =
 /* NC */ { ERR, ERR,  ERR,  ERR,  ERR,  ERR,  ERR,  ERR,  ERR,  ERR,  ERR }
 };
 
+// PinMap starts with the default levels, before the schematic setup is ever opened: the
+// connection graph ERC reads it for the pin to pin conflicts
+static const bool s_pinMapInit = ( memcpy( PinMap, DefaultPinMap, sizeof( PinMap ) ), true );
+
 
 /**
  * Look up table which gives the minimal drive for a pair of connected pins on
@@ -301,365 +304,13 @@ int TestMultiunitFootprints( SCH_SHEET_LIST& aSheetList )
 }
 
 
-void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst, int aMinConn, int aDiag )
-{
-    if( aDiag == OK || aMinConn < 1 || aNetItemRef->m_Type != NETLIST_ITEM::PIN )
-        return;
-
-    SCH_PIN* pin = static_cast<SCH_PIN*>( aNetItemRef->m_Comp );
-
-    /* Create new marker for ERC error. */
-    SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
-    aNetItemRef->m_SheetPath.LastScreen()->Append( marker );
-
-    if( aNetItemTst == NULL)
-    {
-        if( aMinConn == NOD )    /* Nothing driving the net. */
-        {
-            marker->SetData( ERCE_PIN_NOT_DRIVEN, aNetItemRef->m_Start,
-                             pin->GetDescription( &aNetItemRef->m_SheetPath ), pin->m_Uuid );
-            return;
-        }
-    }
-
-    if( aNetItemTst && aNetItemTst->m_Type == NETLIST_ITEM::PIN )  /* Error between 2 pins */
-    {
-        SCH_PIN* pinB = static_cast<SCH_PIN*>( aNetItemTst->m_Comp );
-
-        marker->SetData( aDiag == ERR ? ERCE_PIN_TO_PIN_ERROR : ERCE_PIN_TO_PIN_WARNING,
-                         aNetItemRef->m_Start,
-                         pin->GetDescription( &aNetItemRef->m_SheetPath ), pin->m_Uuid,
-                         pinB->GetDescription( &aNetItemTst->m_SheetPath ), pinB->m_Uuid );
-    }
-}
-
-
-void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion )
-{
-    unsigned netItemTst = aNetStart;
-    ELECTRICAL_PINTYPE jj;
-    int erc = OK;
-
-    /* Analysis of the table of connections. */
-    ELECTRICAL_PINTYPE ref_elect_type = aList->GetItem( aNetItemRef )->m_ElectricalPinType;
-    int local_minconn = NOC;
-
-    if( ref_elect_type == ELECTRICAL_PINTYPE::PT_NC )
-        local_minconn = NPI;
-
-    /* Test pins connected to NetItemRef */
-    for( ; ; netItemTst++ )
-    {
-        if( aNetItemRef == netItemTst )
-            continue;
-
-        // We examine only a given net. We stop the search if the net changes
-        if( ( netItemTst >= aList->size() ) // End of list
-            || ( aList->GetItemNet( aNetItemRef ) !=
-                 aList->GetItemNet( netItemTst ) ) ) // End of net
-        {
-            /* End net code found: minimum connection test. */
-            if( ( *aMinConnexion < NET_NC ) && ( local_minconn < NET_NC ) )
-            {
-                /* Not connected or not driven pin. */
-                bool seterr = true;
-
-                if( local_minconn == NOC && aList->GetItemType( aNetItemRef ) == NETLIST_ITEM::PIN )
-                {
-                    /* This pin is not connected: for multiple part per
-                     * package, and duplicated pin,
-                     * search for another instance of this pin
-                     * this will be flagged only if all instances of this pin
-                     * are not connected
-                     * TODO test also if instances connected are connected to
-                     * the same net
-                     */
-                    for( unsigned duplicate = 0; duplicate < aList->size(); duplicate++ )
-                    {
-                        if( aList->GetItemType( duplicate ) != NETLIST_ITEM::PIN )
-                            continue;
-
-                        if( duplicate == aNetItemRef )
-                            continue;
-
-                        if( aList->GetItem( aNetItemRef )->m_PinNum !=
-                            aList->GetItem( duplicate )->m_PinNum )
-                            continue;
-
-                        if( ( (SCH_COMPONENT*) aList->GetItem( aNetItemRef )->
-                             m_Link )->GetRef( &aList->GetItem( aNetItemRef )-> m_SheetPath ) !=
-                            ( (SCH_COMPONENT*) aList->GetItem( duplicate )->m_Link )
-                           ->GetRef( &aList->GetItem( duplicate )->m_SheetPath ) )
-                            continue;
-
-                        // Same component and same pin. Do dot create error for this pin
-                        // if the other pin is connected (i.e. if duplicate net has another
-                        // item)
-                        if( (duplicate > 0)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate - 1 ) ) )
-                            seterr = false;
-
-                        if( (duplicate < aList->size() - 1)
-                          && ( aList->GetItemNet( duplicate ) ==
-                               aList->GetItemNet( duplicate + 1 ) ) )
-                            seterr = false;
-                    }
-                }
-
-                if( seterr )
-                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR );
-
-                *aMinConnexion = DRV;   // inhibiting other messages of this
-                                       // type for the net.
-            }
-            return;
-        }
-
-        switch( aList->GetItemType( netItemTst ) )
-        {
-        case NETLIST_ITEM::ITEM_UNSPECIFIED:
-        case NETLIST_ITEM::SEGMENT:
-        case NETLIST_ITEM::BUS:
-        case NETLIST_ITEM::JUNCTION:
-        case NETLIST_ITEM::LABEL:
-        case NETLIST_ITEM::HIERLABEL:
-        case NETLIST_ITEM::BUSLABELMEMBER:
-        case NETLIST_ITEM::HIERBUSLABELMEMBER:
-        case NETLIST_ITEM::SHEETBUSLABELMEMBER:
-        case NETLIST_ITEM::SHEETLABEL:
-        case NETLIST_ITEM::GLOBLABEL:
-        case NETLIST_ITEM::GLOBBUSLABELMEMBER:
-        case NETLIST_ITEM::PINLABEL:
-            break;
-
-        case NETLIST_ITEM::NOCONNECT:
-            local_minconn = std::max( NET_NC, local_minconn );
-            break;
-
-        case NETLIST_ITEM::PIN:
-            jj            = aList->GetItem( netItemTst )->m_ElectricalPinType;
-            local_minconn = std::max(
-                    MinimalReq[static_cast<int>( ref_elect_type )][static_cast<int>( jj )],
-                    local_minconn );
-
-            if( netItemTst <= aNetItemRef )
-                break;
-
-            if( erc == OK )
-            {
-                erc = PinMap[static_cast<int>( ref_elect_type )][static_cast<int>( jj )];
-
-                if( erc != OK )
-                {
-                    if( aList->GetConnectionType( netItemTst ) == NET_CONNECTION::UNCONNECTED )
-                    {
-                        Diagnose( aList->GetItem( aNetItemRef ), aList->GetItem( netItemTst ),
-                                  0, erc );
-                        aList->SetConnectionType( netItemTst,
-                                                  NET_CONNECTION::NOCONNECT_SYMBOL_PRESENT );
-                    }
-                }
-            }
-
-            break;
-        }
-    }
-}
-
-// this code try to detect similar labels, i.e. labels which are identical
-// when they are compared using case insensitive coparisons.
-
-
-// A helper struct to compare NETLIST_OBJECT items by sheetpath and label texts
-// for a std::set<NETLIST_OBJECT*> container
-// the full text is "sheetpath+label" for local labels and "label" for global labels
-struct compare_labels
-{
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 ) const
-    {
-        wxString str1 = lab1->m_SheetPath.PathAsString() + lab1->m_Label;
-        wxString str2 = lab2->m_SheetPath.PathAsString() + lab2->m_Label;
-
-        return str1.Cmp( str2 ) < 0;
-    }
-};
-
-struct compare_label_names
-{
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 ) const
-    {
-        return lab1->m_Label.Cmp( lab2->m_Label ) < 0;
-    }
-};
-
-struct compare_paths
-{
-    bool operator() ( const NETLIST_OBJECT* lab1, const NETLIST_OBJECT* lab2 ) const
-    {
-        return lab1->m_SheetPath.Path() < lab2->m_SheetPath.Path();
-    }
-};
-
-// Helper functions to build the warning messages about Similar Labels:
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aRef );
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
-
-
-void NETLIST_OBJECT_LIST::TestforSimilarLabels()
-{
-    // Similar labels which are different when using case sensitive comparisons
-    // but are equal when using case insensitive comparisons
-
-    // list of all labels (used the better item to build diag messages)
-    std::vector<NETLIST_OBJECT*> fullLabelList;
-    // list of all labels , each label appears only once (used to to detect similar labels)
-    std::set<NETLIST_OBJECT*, compare_labels> uniqueLabelList;
-    wxString msg;
-
-    // Build a list of differents labels. If inside a given sheet there are
-    // more than one given label, only one label is stored.
-    // not also the sheet labels are not taken in account for 2 reasons:
-    //  * they are in the root sheet but they are seen only from the child sheet
-    //  * any mismatch between child sheet hierarchical labels and the sheet label
-    //    already detected by ERC
-    for( unsigned netItem = 0; netItem < size(); ++netItem )
-    {
-        switch( GetItemType( netItem ) )
-        {
-        case NETLIST_ITEM::LABEL:
-        case NETLIST_ITEM::BUSLABELMEMBER:
-        case NETLIST_ITEM::PINLABEL:
-        case NETLIST_ITEM::GLOBBUSLABELMEMBER:
-        case NETLIST_ITEM::HIERLABEL:
-        case NETLIST_ITEM::HIERBUSLABELMEMBER:
-        case NETLIST_ITEM::GLOBLABEL:
-            // add this label in lists
-            uniqueLabelList.insert( GetItem( netItem ) );
-            fullLabelList.push_back( GetItem( netItem ) );
-            break;
-
-        case NETLIST_ITEM::SHEETLABEL:
-        case NETLIST_ITEM::SHEETBUSLABELMEMBER:
-        default:
-            break;
-        }
-    }
-
-    // build global labels and compare
-    std::set<NETLIST_OBJECT*, compare_label_names> loc_labelList;
-
-    for( auto it = uniqueLabelList.begin(); it != uniqueLabelList.end(); ++it )
-    {
-        if( (*it)->IsLabelGlobal() )
-            loc_labelList.insert( *it );
-    }
-
-    // compare global labels (same label names appears only once in list)
-    for( auto it = loc_labelList.begin(); it != loc_labelList.end(); ++it )
-    {
-        auto it_aux = it;
-
-        for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-        {
-            if( (*it)->m_Label.CmpNoCase( (*it_aux)->m_Label ) == 0 )
-            {
-                // Create new marker for ERC.
-                int cntA = countIndenticalLabels( fullLabelList, *it );
-                int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                if( cntA <= cntB )
-                    SimilarLabelsDiagnose( (*it), (*it_aux) );
-                else
-                    SimilarLabelsDiagnose( (*it_aux), (*it) );
-            }
-        }
-    }
-
-    // Build paths list
-    std::set<NETLIST_OBJECT*, compare_paths> pathsList;
-
-    for( NETLIST_OBJECT* label : uniqueLabelList )
-        pathsList.insert( label );
-
-    // Examine each label inside a sheet path:
-    for( NETLIST_OBJECT* candidate : pathsList )
-    {
-        loc_labelList.clear();
-
-        for( NETLIST_OBJECT* uniqueLabel : uniqueLabelList)
-        {
-            if( candidate->m_SheetPath.Path() == uniqueLabel->m_SheetPath.Path() )
-                loc_labelList.insert( uniqueLabel );
-        }
-
-        // at this point, loc_labelList contains labels of the current sheet path.
-        // Detect similar labels (same label names appears only once in list)
-
-        for( auto ref_it = loc_labelList.begin(); ref_it != loc_labelList.end(); ++ref_it )
-        {
-            NETLIST_OBJECT* ref_item = *ref_it;
-            auto it_aux = ref_it;
-
-            for( ++it_aux; it_aux != loc_labelList.end(); ++it_aux )
-            {
-                // global label versus global label was already examined.
-                // here, at least one label must be local
-                if( ref_item->IsLabelGlobal() && ( *it_aux )->IsLabelGlobal() )
-                    continue;
-
-                if( ref_item->m_Label.CmpNoCase( ( *it_aux )->m_Label ) == 0 )
-                {
-                    // Create new marker for ERC.
-                    int cntA = countIndenticalLabels( fullLabelList, ref_item );
-                    int cntB = countIndenticalLabels( fullLabelList, *it_aux );
-
-                    if( cntA <= cntB )
-                        SimilarLabelsDiagnose( ref_item, ( *it_aux ) );
-                    else
-                        SimilarLabelsDiagnose( ( *it_aux ), ref_item );
-                }
-            }
-        }
-    }
-}
-
-
-// Helper function: count the number of labels identical to aLabel
-//  for global label: global labels in the full project
-//  for local label: all labels in the current sheet
-static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aRef )
+int GetPinConflictLevel( ELECTRICAL_PINTYPE aPinA, ELECTRICAL_PINTYPE aPinB )
 {
-    int count = 0;
-
-    if( aRef->IsLabelGlobal() )
-    {
-        for( auto i : aList)
-        {
-            if( i->IsLabelGlobal() && i->m_Label == aRef->m_Label )
-                count++;
-        }
-    }
-    else
-    {
-        for( auto i : aList)
-        {
-            if( i->m_Label == aRef->m_Label && i->m_SheetPath.Path() == aRef->m_SheetPath.Path() )
-                count++;
-        }
-    }
-
-    return count;
+    return PinMap[static_cast<int>( aPinA )][static_cast<int>( aPinB )];
 }
 
 
-// Helper function: creates a marker for similar labels ERC warning
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB )
+int GetMinimalConnection( ELECTRICAL_PINTYPE aPinA, ELECTRICAL_PINTYPE aPinB )
 {
-    // Create new marker for ERC.
-    SCH_MARKER* marker = new SCH_MARKER( MARKER_BASE::MARKER_ERC );
-    marker->SetData( EDA_UNITS::UNSCALED, ERCE_SIMILAR_LABELS, aItemA->m_Start,
-                     aItemA->m_Comp, aItemB->m_Comp );
-    aItemA->m_SheetPath.LastScreen()->Append( marker );
+    return MinimalReq[static_cast<int>( aPinA )][static_cast<int>( aPinB )];
 }
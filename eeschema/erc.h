@@ -30,9 +30,9 @@
 #ifndef _ERC_H
 #define _ERC_H
 
+#include <pin_type.h>
+
 
-class NETLIST_OBJECT;
-class NETLIST_OBJECT_LIST;
 class SCH_SHEET_LIST;
 
 /* For ERC markers: error types (used in diags, and to set the color):
@@ -84,24 +84,16 @@ enum ERCE_T
 
 
 /**
- * Performs ERC testing and creates an ERC marker to show the ERC problem for aNetItemRef
- * or between aNetItemRef and aNetItemTst.
- *  if MinConn < 0: this is an error on labels
+ * @return the ERC level (OK, WAR or ERR) of a connection between a pin of type \a aPinA and
+ * a pin of type \a aPinB, as set in the pin conflicts map
  */
-void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst, int MinConnexion,
-               int Diag );
+int GetPinConflictLevel( ELECTRICAL_PINTYPE aPinA, ELECTRICAL_PINTYPE aPinB );
 
 /**
- * Perform ERC testing for electrical conflicts between \a NetItemRef and other items
- * (mainly pin) on the same net.
- * @param aList = a reference to the list of connected objects
- * @param aNetItemRef = index in list of the current object
- * @param aNetStart = index in list of net objects of the first item
- * @param aMinConnexion = a pointer to a variable to store the minimal connection
- * found( NOD, DRV, NPI, NET_NC)
+ * @return the minimal connection state (NOD, DRV or NPI) of a net where a pin of type
+ * \a aPinA is connected to a pin of type \a aPinB
  */
-void TestOthersItems( NETLIST_OBJECT_LIST* aList, unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion );
+int GetMinimalConnection( ELECTRICAL_PINTYPE aPinA, ELECTRICAL_PINTYPE aPinB );
 
 /**
  * Function TestDuplicateSheetNames( )
@@ -76,6 +76,22 @@ public:
         m_graph( aGraph )
     {}
 
+    /**
+     * Constructor for use without a schematic frame, such as from the command line.
+     *
+     * @param aLibTable is the symbol library table used to resolve the library URIs.
+     * @param aMasterList is the flat netlist; it can be empty when the nets are written
+     *                    from \a aGraph.
+     * @param aGraph is the connection graph of the schematic.
+     */
+    NETLIST_EXPORTER_GENERIC( SYMBOL_LIB_TABLE* aLibTable,
+                              NETLIST_OBJECT_LIST* aMasterList,
+                              CONNECTION_GRAPH* aGraph ) :
+        NETLIST_EXPORTER( aMasterList ),
+        m_libTable( aLibTable ),
+        m_graph( aGraph )
+    {}
+
     /**
      * Function WriteNetlist
      * writes to specified output file
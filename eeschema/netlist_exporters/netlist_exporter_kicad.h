@@ -44,6 +44,12 @@ public:
         NETLIST_EXPORTER_GENERIC( aFrame, aMasterList, aGraph )
     {}
 
+    NETLIST_EXPORTER_KICAD( SYMBOL_LIB_TABLE* aLibTable,
+                            NETLIST_OBJECT_LIST* aMasterList,
+                            CONNECTION_GRAPH* aGraph ) :
+        NETLIST_EXPORTER_GENERIC( aLibTable, aMasterList, aGraph )
+    {}
+
     /**
      * Function WriteNetlist
      * writes to specified output file
@@ -174,8 +174,7 @@ SCH_COMPONENT::SCH_COMPONENT( const SCH_COMPONENT& aComponent ) :
     m_lib_id      = aComponent.m_lib_id;
     m_isInNetlist = aComponent.m_isInNetlist;
 
-    if( aComponent.m_part )
-        m_part.reset( new LIB_PART( *aComponent.m_part.get() ) );
+    m_part = aComponent.m_part;
 
     const_cast<KIID&>( m_Uuid ) = aComponent.m_Uuid;
 
@@ -335,6 +334,20 @@ bool SCH_COMPONENT::Resolve( PART_LIBS* aLibs )
 
 
 bool SCH_COMPONENT::Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
+{
+    m_part = LoadLibSymbol( m_lib_id, aLibTable, aCacheLib );
+
+    // This will also clear the pin map and library symbol pin pointers if the symbol
+    // was not found.
+    UpdatePins();
+
+    return m_part != nullptr;
+}
+
+
+std::unique_ptr< LIB_PART > SCH_COMPONENT::LoadLibSymbol( const LIB_ID& aLibId,
+                                                          SYMBOL_LIB_TABLE& aLibTable,
+                                                          PART_LIB* aCacheLib )
 {
     std::unique_ptr< LIB_PART > part;
 
@@ -348,9 +361,9 @@ bool SCH_COMPONENT::Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
         // LIB_TABLE_BASE::LoadSymbol() throws an IO_ERROR if the the library nickname
         // is not found in the table so check if the library still exists in the table
         // before attempting to load the symbol.
-        if( m_lib_id.IsValid() && aLibTable.HasLibrary( m_lib_id.GetLibNickname() ) )
+        if( aLibId.IsValid() && aLibTable.HasLibrary( aLibId.GetLibNickname() ) )
         {
-            LIB_PART* tmp = aLibTable.LoadSymbol( m_lib_id );
+            LIB_PART* tmp = aLibTable.LoadSymbol( aLibId );
 
             if( tmp )
             {
@@ -363,11 +376,11 @@ bool SCH_COMPONENT::Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
         // format is implemented.
         if( !part && aCacheLib )
         {
-            wxString libId = m_lib_id.Format().wx_str();
+            wxString libId = aLibId.Format().wx_str();
             libId.Replace( ":", "_" );
             wxLogTrace( traceSymbolResolver,
                         "Library symbol %s not found falling back to cache library.",
-                        m_lib_id.Format().wx_str() );
+                        aLibId.Format().wx_str() );
             LIB_PART* tmp = aCacheLib->FindPart( libId );
 
             if( tmp )
@@ -378,25 +391,18 @@ bool SCH_COMPONENT::Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib )
         }
 
         if( part )
-        {
-            m_part.reset( part.release() );
-            UpdatePins();
-            return true;
-        }
+            return part;
     }
     catch( const IO_ERROR& ioe )
     {
         wxLogTrace( traceSymbolResolver, "I/O error %s resolving library symbol %s", ioe.What(),
-                    m_lib_id.Format().wx_str() );
+                    aLibId.Format().wx_str() );
     }
 
     wxLogTrace( traceSymbolResolver, "Cannot resolve library symbol %s",
-                m_lib_id.Format().wx_str() );
-
-    m_part.reset();
-    UpdatePins();     // This will clear the pin map and library symbol pin pointers.
+                aLibId.Format().wx_str() );
 
-    return false;
+    return nullptr;
 }
 
 
@@ -438,8 +444,8 @@ void SCH_COMPONENT::ResolveAll(
             if( curr_libid != next_cmp->m_lib_id )
                 break;
 
-            if( cmp->m_part )
-                next_cmp->m_part.reset( new LIB_PART( *cmp->m_part.get() ) );
+            // Components using the same library symbol share it
+            next_cmp->m_part = cmp->m_part;
 
             next_cmp->UpdatePins();
 
@@ -631,13 +637,20 @@ void SCH_COMPONENT::SetRef( const SCH_SHEET_PATH* sheet, const wxString& ref )
     {
         if( instance.m_Path == path )
         {
+            // The reference is part of the default net names of the pins
+            if( instance.m_Reference != ref )
+                SetConnectivityDirty();
+
             instance.m_Reference = ref;
             notInArray = false;
         }
     }
 
     if( notInArray )
+    {
         AddHierarchicalReference( path, ref, m_unit );
+        SetConnectivityDirty();
+    }
 
     SCH_FIELD* rf = GetField( REFERENCE );
 
@@ -924,10 +937,8 @@ void SCH_COMPONENT::SwapData( SCH_ITEM* aItem )
 
     std::swap( m_lib_id, component->m_lib_id );
 
-    LIB_PART* part = component->m_part.release();
-    component->m_part.reset( m_part.release() );
+    std::swap( m_part, component->m_part );
     component->UpdatePins();
-    m_part.reset( part );
     UpdatePins();
 
     std::swap( m_Pos, component->m_Pos );
@@ -989,6 +1000,8 @@ void SCH_COMPONENT::ClearAnnotation( SCH_SHEET_PATH* aSheetPath )
     // But this call cannot made here.
     m_Fields[REFERENCE].SetText( defRef ); //for drawing.
 
+    // The reference is part of the default net names of the pins
+    SetConnectivityDirty();
     SetModified();
 }
 
@@ -1689,9 +1702,7 @@ SCH_COMPONENT& SCH_COMPONENT::operator=( const SCH_ITEM& aItem )
 
         m_lib_id    = c->m_lib_id;
 
-        LIB_PART* libSymbol = c->m_part ? new LIB_PART( *c->m_part.get() ) : nullptr;
-
-        m_part.reset( libSymbol );
+        m_part      = c->m_part;
         m_Pos       = c->m_Pos;
         m_unit      = c->m_unit;
         m_convert   = c->m_convert;
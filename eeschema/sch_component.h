@@ -119,7 +119,9 @@ private:
     SCH_FIELDS  m_Fields;       ///< Variable length list of fields.
 
     ///< A flattened copy of a LIB_PART found in the PROJECT's libraries to for this component.
-    std::unique_ptr< LIB_PART > m_part;
+    ///< It is shared by all the components using the same library symbol, so it must not be
+    ///< modified: give the component its own copy instead.
+    std::shared_ptr< LIB_PART > m_part;
 
     SCH_PINS    m_pins;         ///< a SCH_PIN for every LIB_PIN (across all units)
     SCH_PIN_MAP m_pinMap;       ///< the component's pins mapped by LIB_PIN*
@@ -204,7 +206,11 @@ public:
 
     const LIB_ID& GetLibId() const        { return m_lib_id; }
 
-    std::unique_ptr< LIB_PART >& GetPartRef() { return m_part; }
+    /**
+     * The library symbol may be shared with other components: to change it, reset the
+     * pointer to a modified copy rather than modifying the symbol.
+     */
+    std::shared_ptr< LIB_PART >& GetPartRef() { return m_part; }
 
     /**
      * Return information about the aliased parts
@@ -225,6 +231,16 @@ public:
 
     bool Resolve( SYMBOL_LIB_TABLE& aLibTable, PART_LIB* aCacheLib = NULL );
 
+    /**
+     * Load the flattened library symbol \a aLibId from \a aLibTable, or from \a aCacheLib
+     * if it is not found there.
+     *
+     * @return the symbol, or NULL if it cannot be found.
+     */
+    static std::unique_ptr< LIB_PART > LoadLibSymbol( const LIB_ID& aLibId,
+                                                      SYMBOL_LIB_TABLE& aLibTable,
+                                                      PART_LIB* aCacheLib = NULL );
+
     static void ResolveAll( std::vector<SCH_COMPONENT*>& aComponents, SYMBOL_LIB_TABLE& aLibTable,
             PART_LIB* aCacheLib = NULL );
 
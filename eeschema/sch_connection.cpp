@@ -311,7 +311,7 @@ void SCH_CONNECTION::SetSuffix( const wxString& aSuffix )
 
 void SCH_CONNECTION::AppendInfoToMsgPanel( MSG_PANEL_ITEMS& aList ) const
 {
-    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         return;
 
     wxString msg, group_name;
@@ -363,7 +363,7 @@ void SCH_CONNECTION::AppendInfoToMsgPanel( MSG_PANEL_ITEMS& aList ) const
 
 void SCH_CONNECTION::AppendDebugInfoToMsgPanel( MSG_PANEL_ITEMS& aList ) const
 {
-    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         return;
 
     // These messages are not flagged as translatable, because they are only debug messages
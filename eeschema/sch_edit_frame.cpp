@@ -598,8 +598,8 @@ void SCH_EDIT_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
-    if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity && CONNECTION_GRAPH::m_allowRealTime )
-        RecalculateConnections( NO_CLEANUP );
+    if( ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
+        RecalculateConnections( NO_CLEANUP, true );
 
     GetCanvas()->Refresh();
 }
@@ -995,7 +995,7 @@ void SCH_EDIT_FRAME::AddItemToScreenAndUndoList( SCH_ITEM* aItem, bool aUndoAppe
 
         // Update connectivity info for new item
         if( !aItem->IsMoving() )
-            RecalculateConnections( LOCAL_CLEANUP );
+            RecalculateConnections( LOCAL_CLEANUP, true );
     }
 
     aItem->ClearFlags( IS_NEW );
@@ -1059,7 +1059,7 @@ void SCH_EDIT_FRAME::UpdateTitle()
 }
 
 
-void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
+void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags, bool aIncremental )
 {
     SCH_SHEET_LIST list( g_RootSheet );
     PROF_COUNTER   timer;
@@ -1078,7 +1078,7 @@ void SCH_EDIT_FRAME::RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags )
     timer.Stop();
     wxLogTrace( "CONN_PROFILE", "SchematicCleanUp() %0.4f ms", timer.msecs() );
 
-    g_ConnectionGraph->Recalculate( list, true );
+    g_ConnectionGraph->Recalculate( list, !aIncremental );
 }
 
 
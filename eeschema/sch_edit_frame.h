@@ -1029,8 +1029,12 @@ public:
 
     /**
      * Generates the connection data for the entire schematic hierarchy.
+     *
+     * @param aCleanupFlags selects the sheets to clean up first
+     * @param aIncremental only updates the nets affected by items with dirty connectivity,
+     *                     instead of rebuilding them all
      */
-    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags );
+    void RecalculateConnections( SCH_CLEANUP_FLAGS aCleanupFlags, bool aIncremental = false );
 
     /**
      * Allows Eeschema to install its preferences panels into the preferences dialog.
@@ -21,9 +21,12 @@
  */
 
 #include <algorithm>
+#include <atomic>
 #include <boost/algorithm/string/join.hpp>
 #include <cctype>
+#include <future>
 #include <set>
+#include <thread>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
@@ -582,6 +585,9 @@ void SCH_LEGACY_PLUGIN::init( KIWAY* aKiway, const PROPERTIES* aProperties )
     m_kiway = aKiway;
     m_cache = NULL;
     m_out = NULL;
+    m_parseOnly = false;
+    m_parsedItems.clear();
+    m_rootModified = false;
 }
 
 
@@ -651,82 +657,184 @@ SCH_SHEET* SCH_LEGACY_PLUGIN::Load( const wxString& aFileName, KIWAY* aKiway,
 }
 
 
-// Everything below this comment is recursive.  Modify with care.
-
 void SCH_LEGACY_PLUGIN::loadHierarchy( SCH_SHEET* aSheet )
 {
-    SCH_SCREEN* screen = NULL;
-
-    if( !aSheet->GetScreen() )
+    // A sheet file to parse, with the plugin parsing it on a worker thread
+    struct SHEET_LOAD
     {
-        // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object only
-        // stores the file name and extension.  Add the project path to the file name and
-        // extension to compare when calling SCH_SHEET::SearchHierarchy().
-        wxFileName fileName = aSheet->GetFileName();
+        SCH_SHEET*                           sheet;
+        wxFileName                           fileName;
+        std::unique_ptr< SCH_LEGACY_PLUGIN > parser;
+        std::exception_ptr                   error;
+    };
 
-        if( !fileName.IsAbsolute() )
-            fileName.MakeAbsolute( m_currentPath.top() );
+    // The sheets of the current level of the hierarchy, with the path their file names are
+    // relative to.  Sheet files are only known once their parent sheet file has been parsed,
+    // so the hierarchy is loaded breadth first with all the new files of a level parsed
+    // concurrently.
+    std::vector< std::pair< SCH_SHEET*, wxString > > level;
 
-        // Save the current path so that it gets restored when decending and ascending the
-        // sheet hierarchy which allows for sheet schematic files to be nested in folders
-        // relative to the last path a schematic was loaded from.
-        wxLogTrace( traceSchLegacyPlugin, "Saving path    \"%s\"", m_currentPath.top() );
-        m_currentPath.push( fileName.GetPath() );
-        wxLogTrace( traceSchLegacyPlugin, "Current path   \"%s\"", m_currentPath.top() );
-        wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
+    level.emplace_back( aSheet, m_currentPath.top() );
 
-        m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+    while( !level.empty() )
+    {
+        std::vector< SHEET_LOAD > loads;
 
-        if( screen )
+        for( const auto& pending : level )
         {
-            aSheet->SetScreen( screen );
+            SCH_SHEET* sheet = pending.first;
+
+            if( sheet->GetScreen() )
+                continue;
+
+            // SCH_SCREEN objects store the full path and file name where the SCH_SHEET object
+            // only stores the file name and extension.  Add the path of the parent sheet file
+            // to the file name and extension to compare when calling
+            // SCH_SHEET::SearchHierarchy().  This allows for sheet schematic files to be nested
+            // in folders relative to the sheet file they are used in.
+            wxFileName fileName = sheet->GetFileName();
+
+            if( !fileName.IsAbsolute() )
+                fileName.MakeAbsolute( pending.second );
+
+            SCH_SCREEN* screen = NULL;
+
+            // Screens created earlier in this level are already in the hierarchy, so each
+            // file is only parsed once however many sheets use it.
+            m_rootSheet->SearchHierarchy( fileName.GetFullPath(), &screen );
+
+            if( screen )
+            {
+                sheet->SetScreen( screen );
+
+                // Do not need to load the sub-sheets - this is done for the sheet which
+                // loads the screen.
+                continue;
+            }
 
-            // Do not need to load the sub-sheets - this has already been done.
+            wxLogTrace( traceSchLegacyPlugin, "Loading        \"%s\"", fileName.GetFullPath() );
+
+            sheet->SetScreen( new SCH_SCREEN( m_kiway ) );
+            sheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+
+            SHEET_LOAD load;
+            load.sheet = sheet;
+            load.fileName = fileName;
+            load.parser.reset( new SCH_LEGACY_PLUGIN );
+            load.parser->init( m_kiway, m_props );
+            load.parser->m_rootSheet = m_rootSheet;
+            load.parser->m_parseOnly = true;
+            loads.push_back( std::move( load ) );
         }
+
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       loads.size() );
+
+        std::atomic<size_t> nextLoad( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto load_lambda = [&nextLoad, &loads]() -> size_t
+        {
+            for( size_t ii = nextLoad++; ii < loads.size(); ii = nextLoad++ )
+            {
+                SHEET_LOAD& load = loads[ii];
+
+                try
+                {
+                    load.parser->loadFile( load.fileName.GetFullPath(), load.sheet->GetScreen() );
+                }
+                catch( ... )
+                {
+                    load.error = std::current_exception();
+                }
+            }
+
+            return 1;
+        };
+
+        if( parallelThreadCount <= 1 )
+            load_lambda();
         else
         {
-            aSheet->SetScreen( new SCH_SCREEN( m_kiway ) );
-            aSheet->GetScreen()->SetFileName( fileName.GetFullPath() );
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, load_lambda );
 
-            try
+            // Finalize the threads
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii].wait();
+        }
+
+        std::vector< std::pair< SCH_SHEET*, wxString > > nextLevel;
+
+        // Finish the loads in order, on this thread: inserting the items in the screen needs
+        // their bounding boxes, which is not thread safe.
+        for( SHEET_LOAD& load : loads )
+        {
+            SCH_SCREEN* screen = load.sheet->GetScreen();
+
+            for( SCH_ITEM* item : load.parser->m_parsedItems )
+                screen->Append( item );
+
+            load.parser->m_parsedItems.clear();
+
+            if( load.parser->m_rootModified )
+                setRootModified();
+
+            m_version = load.parser->m_version;
+
+            if( load.error )
             {
-                loadFile( fileName.GetFullPath(), aSheet->GetScreen() );
-                for( auto aItem : aSheet->GetScreen()->Items().OfType( SCH_SHEET_T ) )
+                try
+                {
+                    std::rethrow_exception( load.error );
+                }
+                catch( const IO_ERROR& ioe )
                 {
-                    assert( aItem->Type() == SCH_SHEET_T );
-                    auto sheet = static_cast<SCH_SHEET*>( aItem );
-
-                    // Set the parent to aSheet.  This effectively creates a method to find
-                    // the root sheet from any sheet so a pointer to the root sheet does not
-                    // need to be stored globally.  Note: this is not the same as a hierarchy.
-                    // Complex hierarchies can have multiple copies of a sheet.  This only
-                    // provides a simple tree to find the root sheet.
-                    sheet->SetParent( aSheet );
-
-                    // Recursion starts here.
-                    loadHierarchy( sheet );
+                    // If there is a problem loading the root sheet, there is no recovery.
+                    if( load.sheet == m_rootSheet )
+                        throw;
+
+                    // For all subsheets, queue up the error message for the caller.
+                    if( !m_error.IsEmpty() )
+                        m_error += "\n";
+
+                    m_error += ioe.What();
                 }
+
+                continue;
             }
-            catch( const IO_ERROR& ioe )
+
+            for( auto aItem : screen->Items().OfType( SCH_SHEET_T ) )
             {
-                // If there is a problem loading the root sheet, there is no recovery.
-                if( aSheet == m_rootSheet )
-                    throw( ioe );
+                assert( aItem->Type() == SCH_SHEET_T );
+                auto sheet = static_cast<SCH_SHEET*>( aItem );
 
-                // For all subsheets, queue up the error message for the caller.
-                if( !m_error.IsEmpty() )
-                    m_error += "\n";
+                // Set the parent to the sheet.  This effectively creates a method to find
+                // the root sheet from any sheet so a pointer to the root sheet does not
+                // need to be stored globally.  Note: this is not the same as a hierarchy.
+                // Complex hierarchies can have multiple copies of a sheet.  This only
+                // provides a simple tree to find the root sheet.
+                sheet->SetParent( load.sheet );
 
-                m_error += ioe.What();
+                nextLevel.emplace_back( sheet, load.fileName.GetPath() );
             }
         }
 
-        m_currentPath.pop();
-        wxLogTrace( traceSchLegacyPlugin, "Restoring path \"%s\"", m_currentPath.top() );
+        level.swap( nextLevel );
     }
 }
 
 
+void SCH_LEGACY_PLUGIN::setRootModified()
+{
+    // The plugins parsing sheet files on worker threads leave it to loadHierarchy()
+    if( m_parseOnly )
+        m_rootModified = true;
+    else if( m_rootSheet && m_rootSheet->GetScreen() )
+        m_rootSheet->GetScreen()->SetModify();
+}
+
+
 void SCH_LEGACY_PLUGIN::loadFile( const wxString& aFileName, SCH_SCREEN* aScreen )
 {
     FILE_LINE_READER reader( aFileName );
@@ -759,6 +867,14 @@ void SCH_LEGACY_PLUGIN::LoadContent( LINE_READER& aReader, SCH_SCREEN* aScreen,
     if( m_rootSheet == nullptr )
         m_rootSheet = g_RootSheet;
 
+    auto append = [&]( SCH_ITEM* aItem )
+    {
+        if( m_parseOnly )
+            m_parsedItems.push_back( aItem );
+        else
+            aScreen->Append( aItem );
+    };
+
     while( aReader.ReadLine() )
     {
         char* line = aReader.Line();
@@ -771,21 +887,21 @@ void SCH_LEGACY_PLUGIN::LoadContent( LINE_READER& aReader, SCH_SCREEN* aScreen,
         if( strCompare( "$Descr", line ) )
             loadPageSettings( aReader, aScreen );
         else if( strCompare( "$Comp", line ) )
-            aScreen->Append( loadComponent( aReader ) );
+            append( loadComponent( aReader ) );
         else if( strCompare( "$Sheet", line ) )
-            aScreen->Append( loadSheet( aReader ) );
+            append( loadSheet( aReader ) );
         else if( strCompare( "$Bitmap", line ) )
-            aScreen->Append( loadBitmap( aReader ) );
+            append( loadBitmap( aReader ) );
         else if( strCompare( "Connection", line ) )
-            aScreen->Append( loadJunction( aReader ) );
+            append( loadJunction( aReader ) );
         else if( strCompare( "NoConn", line ) )
-            aScreen->Append( loadNoConnect( aReader ) );
+            append( loadNoConnect( aReader ) );
         else if( strCompare( "Wire", line ) )
-            aScreen->Append( loadWire( aReader ) );
+            append( loadWire( aReader ) );
         else if( strCompare( "Entry", line ) )
-            aScreen->Append( loadBusEntry( aReader ) );
+            append( loadBusEntry( aReader ) );
         else if( strCompare( "Text", line ) )
-            aScreen->Append( loadText( aReader ) );
+            append( loadText( aReader ) );
         else if( strCompare( "BusAlias", line ) )
             aScreen->AddBusAlias( loadBusAlias( aReader, aScreen ) );
         else if( strCompare( "$EndSCHEMATC", line ) )
@@ -1545,8 +1661,7 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 unit = 1;
 
                 // Set the file as modified so the user can be warned.
-                if( m_rootSheet && m_rootSheet->GetScreen() )
-                    m_rootSheet->GetScreen()->SetModify();
+                setRootModified();
             }
 
             component->SetUnit( unit );
@@ -1559,8 +1674,7 @@ SCH_COMPONENT* SCH_LEGACY_PLUGIN::loadComponent( LINE_READER& aReader )
                 convert = 1;
 
                 // Set the file as modified so the user can be warned.
-                if( m_rootSheet && m_rootSheet->GetScreen() )
-                    m_rootSheet->GetScreen()->SetModify();
+                setRootModified();
             }
 
             component->SetConvert( convert );
@@ -26,11 +26,13 @@
 #include <memory>
 #include <sch_io_mgr.h>
 #include <stack>
+#include <vector>
 #include <general.h>
 
 
 class KIWAY;
 class LINE_READER;
+class SCH_ITEM;
 class SCH_SCREEN;
 class SCH_SHEET;
 class SCH_BITMAP;
@@ -140,6 +142,7 @@ public:
 
 private:
     void loadHierarchy( SCH_SHEET* aSheet );
+    void setRootModified();
     void loadHeader( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadPageSettings( LINE_READER& aReader, SCH_SCREEN* aScreen );
     void loadFile( const wxString& aFileName, SCH_SCREEN* aScreen );
@@ -182,6 +185,15 @@ protected:
     OUTPUTFORMATTER*     m_out;        ///< The output formatter for saving SCH_SCREEN objects.
     SCH_LEGACY_PLUGIN_CACHE* m_cache;
 
+    /**
+     * Set for the plugins parsing sheet files on worker threads in loadHierarchy().  These
+     * collect the items in m_parsedItems instead of adding them to the screen and only note
+     * changes to the root sheet in m_rootModified, so that the loading thread can apply both.
+     */
+    bool                    m_parseOnly;
+    std::vector<SCH_ITEM*>  m_parsedItems;
+    bool                    m_rootModified;
+
     /// initialize PLUGIN like a constructor would.
     void init( KIWAY* aKiway, const PROPERTIES* aProperties = nullptr );
 };
@@ -35,6 +35,7 @@
 #include <sch_text.h>
 
 #include <map>
+#include <unordered_map>
 
 class SCH_REFERENCE;
 class SCH_REFERENCE_LIST;
@@ -213,6 +214,10 @@ class SCH_REFERENCE_LIST
 private:
     std::vector <SCH_REFERENCE> flatList;
 
+    /// Index in flatList of the first reference with a given path, built by FindRefByPath()
+    /// and cleared whenever the list is changed or reordered.
+    mutable std::unordered_map<wxString, int> m_refByPath;
+
 public:
     /** Constructor
      */
@@ -251,6 +256,7 @@ public:
     void AddItem( SCH_REFERENCE& aItem )
     {
         flatList.push_back( aItem );
+        m_refByPath.clear();
     }
 
     /**
@@ -355,6 +361,7 @@ public:
     void SortByXCoordinate()
     {
         sort( flatList.begin(), flatList.end(), sortByXPosition );
+        m_refByPath.clear();
     }
 
     /**
@@ -374,6 +381,7 @@ public:
     void SortByYCoordinate()
     {
         sort( flatList.begin(), flatList.end(), sortByYPosition );
+        m_refByPath.clear();
     }
 
     /**
@@ -384,6 +392,7 @@ public:
     void SortByTimeStamp()
     {
         sort( flatList.begin(), flatList.end(), sortByTimeStamp );
+        m_refByPath.clear();
     }
 
     /**
@@ -404,6 +413,7 @@ public:
     void SortByRefAndValue()
     {
         sort( flatList.begin(), flatList.end(), sortByRefAndValue );
+        m_refByPath.clear();
     }
 
     /**
@@ -420,6 +430,7 @@ public:
     void SortByReferenceOnly()
     {
         sort( flatList.begin(), flatList.end(), sortByReferenceOnly );
+        m_refByPath.clear();
     }
 
     /**
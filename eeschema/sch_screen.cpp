@@ -33,6 +33,7 @@
 #include <eda_rect.h>
 #include <eeschema_id.h>
 #include <fctsys.h>
+#include <geometry/packed_rtree.h>
 #include <gr_basic.h>
 #include <gr_text.h>
 #include <id.h>
@@ -66,6 +67,8 @@
 #include <algorithm>
 #include <future>
 #include <array>
+#include <map>
+#include <unordered_map>
 
 // TODO(JE) Debugging only
 #include <profile.h>
@@ -777,12 +780,86 @@ bool SCH_SCREEN::TestDanglingEnds( const SCH_SHEET_PATH* aPath )
     std::vector< DANGLING_END_ITEM > endPoints;
     bool hasStateChanged = false;
 
+    // Each item and the index of its first end point in endPoints
+    std::vector< std::pair<SCH_ITEM*, size_t> > itemEnds;
+
     for( SCH_ITEM* item : Items() )
+    {
+        itemEnds.emplace_back( item, endPoints.size() );
         item->GetEndPoints( endPoints );
+    }
 
-    for( SCH_ITEM* item : Items() )
+    // An end point can only connect to the end points at the same position, or to a wire or
+    // bus passing through it.  Index the former by position and the latter by the bounding box
+    // of the segment, so that each item only has to look at its neighbours.
+    std::unordered_map< wxPoint, std::vector<size_t> > pointIndex;
+    PACKED_RTREE<size_t>                               segmentIndex;
+
+    for( size_t ii = 0; ii < endPoints.size(); ii++ )
+    {
+        switch( endPoints[ii].GetType() )
+        {
+        case WIRE_START_END:
+        case BUS_START_END:
+            // The end of the segment is always the next entry
+            segmentIndex.Add( BOX2I( endPoints[ii].GetPosition(),
+                                     endPoints[ii + 1].GetPosition()
+                                             - endPoints[ii].GetPosition() ),
+                              ii );
+            break;
+
+        case WIRE_END_END:
+        case BUS_END_END:
+            break;
+
+        default:
+            pointIndex[ endPoints[ii].GetPosition() ].push_back( ii );
+            break;
+        }
+    }
+
+    segmentIndex.Build();
+
+    std::vector< size_t >            candidates;
+    std::vector< DANGLING_END_ITEM > nearEndPoints;
+
+    auto addSegment = [&candidates]( size_t aStart ) -> bool
     {
-        if( item->UpdateDanglingState( endPoints, aPath ) )
+        candidates.push_back( aStart );
+        candidates.push_back( aStart + 1 );
+        return true;
+    };
+
+    for( size_t ii = 0; ii < itemEnds.size(); ii++ )
+    {
+        SCH_ITEM* item = itemEnds[ii].first;
+        size_t    first = itemEnds[ii].second;
+        size_t    last = ii + 1 < itemEnds.size() ? itemEnds[ii + 1].second : endPoints.size();
+
+        candidates.clear();
+
+        for( size_t jj = first; jj < last; jj++ )
+        {
+            const wxPoint& pos = endPoints[jj].GetPosition();
+            auto           it = pointIndex.find( pos );
+
+            if( it != pointIndex.end() )
+                candidates.insert( candidates.end(), it->second.begin(), it->second.end() );
+
+            segmentIndex.Search( BOX2I( pos, VECTOR2I( 0, 0 ) ), addSegment );
+        }
+
+        // Keep the order of the full list: UpdateDanglingState() expects the end of a segment
+        // right after its start, and some items stop at the first match.
+        std::sort( candidates.begin(), candidates.end() );
+        candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+
+        nearEndPoints.clear();
+
+        for( size_t idx : candidates )
+            nearEndPoints.push_back( endPoints[idx] );
+
+        if( item->UpdateDanglingState( nearEndPoints, aPath ) )
             hasStateChanged = true;
     }
 
@@ -1143,8 +1220,103 @@ void SCH_SCREENS::DeleteAllMarkers( enum MARKER_BASE::TYPEMARKER aMarkerType )
 
 void SCH_SCREENS::UpdateSymbolLinks( bool aForce )
 {
+    std::vector<SCH_SCREEN*> screens;
+
     for( SCH_SCREEN* screen = GetFirst(); screen; screen = GetNext() )
-        screen->UpdateSymbolLinks( aForce );
+    {
+        if( !screen->IsEmpty() )
+            screens.push_back( screen );
+    }
+
+    if( !screens.empty() )
+    {
+        SYMBOL_LIB_TABLE* libs = screens[0]->Prj().SchSymbolLibTable();
+        PART_LIB*         cacheLib = screens[0]->Prj().SchLibs()->GetCacheLibrary();
+        int               mod_hash = libs->GetModifyHash();
+
+        std::vector< std::vector<SCH_COMPONENT*> >  cmps( screens.size() );
+        std::vector< char >                         resolve( screens.size() );
+        std::map< LIB_ID, std::shared_ptr<LIB_PART> > symbols;
+
+        // Neither the symbol libraries nor the bounding boxes needed by the R-trees are thread
+        // safe.  So each library symbol is loaded once for all the screens and the R-trees are
+        // updated here, and only linking the symbols and rebuilding the pins runs in parallel.
+        for( size_t ii = 0; ii < screens.size(); ++ii )
+        {
+            SCH_SCREEN* screen = screens[ii];
+
+            for( auto aItem : screen->Items().OfType( SCH_COMPONENT_T ) )
+                cmps[ii].push_back( static_cast<SCH_COMPONENT*>( aItem ) );
+
+            for( auto cmp : cmps[ii] )
+                screen->Remove( cmp );
+
+            // Must we resolve?
+            resolve[ii] = ( screen->m_modification_sync != mod_hash ) || aForce;
+
+            if( !resolve[ii] )
+                continue;
+
+            for( auto cmp : cmps[ii] )
+            {
+                if( !symbols.count( cmp->GetLibId() ) )
+                {
+                    symbols[ cmp->GetLibId() ] =
+                            SCH_COMPONENT::LoadLibSymbol( cmp->GetLibId(), *libs, cacheLib );
+                }
+            }
+        }
+
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                screens.size() );
+
+        std::atomic<size_t> nextScreen( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto update_lambda = [&]() -> size_t
+        {
+            for( auto i = nextScreen++; i < screens.size(); i = nextScreen++ )
+            {
+                for( auto cmp : cmps[i] )
+                {
+                    if( resolve[i] )
+                    {
+                        // All the components using a library symbol share it
+                        cmp->GetPartRef() = symbols.at( cmp->GetLibId() );
+                    }
+
+                    // Resolving will update the pin caches but we must ensure that this
+                    // happens even if the libraries don't change.
+                    cmp->UpdatePins();
+                }
+            }
+
+            return 1;
+        };
+
+        if( parallelThreadCount <= 1 )
+            update_lambda();
+        else
+        {
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, update_lambda );
+
+            // Finalize the threads
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii].wait();
+        }
+
+        for( size_t ii = 0; ii < screens.size(); ++ii )
+        {
+            if( resolve[ii] )
+                screens[ii]->m_modification_sync = mod_hash;     // note the last mod_hash
+
+            // Changing the symbol may adjust the bbox of the symbol.  This re-inserts the
+            // item with the new bbox
+            for( auto cmp : cmps[ii] )
+                screens[ii]->Append( cmp );
+        }
+    }
 
     SCH_SHEET_LIST sheets( g_RootSheet );
 
@@ -115,6 +115,8 @@ private:
     /// List of bus aliases stored in this screen
     std::unordered_set< std::shared_ptr< BUS_ALIAS > > m_aliases;
 
+    friend class SCH_SCREENS;   // UpdateSymbolLinks() relinks the screens in parallel
+
 public:
 
     /**
@@ -285,6 +287,9 @@ public:
 
     /**
      * Test all of the connectable objects in the schematic for unused connection points.
+     *
+     * The end points are indexed by position, so each item is only tested against the end
+     * points and wires or buses near its own end points.
      * @param aPath is a sheet path to pass to UpdateDanglingState if desired
      * @return True if any connection state changes were made.
      */
@@ -837,7 +837,7 @@ int SCH_EDITOR_CONTROL::UpdateNetHighlighting( const TOOL_EVENT& aEvent )
 int SCH_EDITOR_CONTROL::HighlightNetCursor( const TOOL_EVENT& aEvent )
 {
     // TODO(JE) remove once real-time connectivity is a given
-    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+    if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         m_frame->RecalculateConnections( NO_CLEANUP );
 
     std::string  tool = aEvent.GetCommandStr().get();
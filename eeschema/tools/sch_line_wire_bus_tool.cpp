@@ -115,7 +115,7 @@ private:
         Clear();
 
         // TODO(JE) remove once real-time is enabled
-        if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity || !CONNECTION_GRAPH::m_allowRealTime )
+        if( !ADVANCED_CFG::GetCfg().m_realTimeConnectivity )
         {
             frame->RecalculateConnections( NO_CLEANUP );
 
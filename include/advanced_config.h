@@ -88,6 +88,11 @@ public:
      */
     int m_coroutineStackSize;
 
+    /**
+     * Compression level of the PDF plot streams, from 0 (none) to 9 (best)
+     */
+    int m_PdfCompressionLevel;
+
 
 private:
     ADVANCED_CFG();
@@ -25,6 +25,8 @@
 #ifndef BASIC_GAL_H
 #define BASIC_GAL_H
 
+#include <mutex>
+
 #include <eda_rect.h>
 
 #include <gal/stroke_font.h>
@@ -167,4 +169,9 @@ private:
 
 extern BASIC_GAL basic_gal;
 
+/// basic_gal keeps the text attributes and the output of the current text: code measuring
+/// or drawing texts through it holds this lock, so that boards can be plotted from
+/// several threads
+extern std::mutex basic_gal_mutex;
+
 #endif      // define BASIC_GAL_H
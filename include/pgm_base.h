@@ -320,9 +320,11 @@ public:
      *  - fonts
      * <p>
      * But nothing relating to DSOs or projects.
+     * @param aHeadless is true for command line programs, which don't check for another
+     *                  running instance (and never ask the user anything)
      * @return bool - true if success, false if failure and program is to terminate.
      */
-    bool InitPgm();
+    bool InitPgm( bool aHeadless = false );
 
     // The PGM_* classes can have difficulties at termination if they
     // are not destroyed soon enough.  Relying on a static destructor can be
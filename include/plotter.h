@@ -32,6 +32,10 @@
 #ifndef PLOT_COMMON_H_
 #define PLOT_COMMON_H_
 
+#include <deque>
+#include <future>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <math/box2.h>
 #include <gr_text.h>
@@ -496,6 +500,21 @@ public:
      */
     virtual void EndBlock( void* aData ) {}
 
+    /**
+     * Start a group of drawing items which is likely to be plotted again, identically,
+     * on other pages of the same plot (for instance the fixed part of the worksheet).
+     * Plotters able to reference such a group instead of repeating it store it once;
+     * the graphic state set inside the group does not last after EndReusableBlock().
+     * for most of plotters: do nothing
+     */
+    virtual void StartReusableBlock() {}
+
+    /**
+     * End the group of drawing items started by StartReusableBlock()
+     * for most of plotters: do nothing
+     */
+    virtual void EndReusableBlock() {}
+
 
 protected:
     // These are marker subcomponents
@@ -861,12 +880,7 @@ protected:
 class PDF_PLOTTER : public PSLIKE_PLOTTER
 {
 public:
-    PDF_PLOTTER() : pageStreamHandle( 0 ), workFile( NULL )
-    {
-        // Avoid non initialized variables:
-        pageStreamHandle = streamLengthHandle = fontResDictHandle = 0;
-        pageTreeHandle = 0;
-    }
+    PDF_PLOTTER();
 
     virtual PLOT_FORMAT GetPlotterType() const override
     {
@@ -895,6 +909,21 @@ public:
     virtual void SetCurrentLineWidth( int width, void* aData = NULL ) override;
     virtual void SetDash( PLOT_DASH_TYPE dashed ) override;
 
+    /**
+     * Set the zlib compression level of the content streams, from 0 (no compression,
+     * fastest) to 9 (smallest files).  The default comes from the advanced config.
+     */
+    void SetCompressionLevel( int aLevel );
+
+    int GetCompressionLevel() const { return m_compressionLevel; }
+
+    /**
+     * A reusable block is written as a Form XObject, shared by all the pages plotting
+     * exactly the same content.
+     */
+    virtual void StartReusableBlock() override;
+    virtual void EndReusableBlock() override;
+
     /** PDF can have multiple pages, so SetPageSettings can be called
      * with the outputFile open (but not inside a page stream!) */
     virtual void SetViewport( const wxPoint& aOffset, double aIusPerDecimil,
@@ -909,6 +938,11 @@ public:
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH,
                            void * aData = NULL ) override;
+    /**
+     * Polygon plotted straight from the chain vertices, without a corner list copy
+     */
+    virtual void PlotPoly( const SHAPE_LINE_CHAIN& aCornerList, FILL_T aFill,
+                           int aWidth = USE_DEFAULT_LINE_WIDTH, void* aData = nullptr ) override;
 
     virtual void PenTo( const wxPoint& pos, char plume ) override;
 
@@ -936,14 +970,42 @@ protected:
     void closePdfObject();
     int startPdfStream(int handle = -1);
     void closePdfStream();
+
+    /**
+     * Compress \a aContent in the background as the stream of the object \a aHandle.
+     * @param aDict are the entries of the stream dictionary, besides its length and filter
+     */
+    void queuePdfStream( int aHandle, const std::string& aDict, std::string aContent );
+
+    /**
+     * Write the queued streams to the file, in queue order, until at most
+     * \a aMaxPending streams are left compressing
+     */
+    void flushPdfStreams( size_t aMaxPending = 0 );
+
+    /// A content stream being compressed, waiting to be written to the file
+    struct PENDING_STREAM
+    {
+        int                      m_Handle;
+        std::string              m_Dict;
+        std::future<std::string> m_Data;
+    };
+
     int pageTreeHandle;		 /// Handle to the root of the page tree object
     int fontResDictHandle;	 /// Font resource dictionary
+    int xObjectDictHandle;       /// Form XObjects resource dictionary
     std::vector<int> pageHandles;/// Handles to the page objects
     int pageStreamHandle;	 /// Handle of the page content object
-    int streamLengthHandle;      /// Handle to the deferred stream length
     wxString workFilename;
     FILE* workFile;  	         /// Temporary file to costruct the stream before zipping
     std::vector<long> xrefTable; /// The PDF xref offset table
+
+    int m_compressionLevel;
+    std::deque<PENDING_STREAM> m_pendingStreams;
+
+    long m_blockStart;           /// Offset of the reusable block in workFile, or -1
+    int  m_blockPenWidth;        /// The pen width before the reusable block
+    std::unordered_map<std::string, int> m_formHandles;  /// Form XObjects, by content
 };
 
 class SVG_PLOTTER : public PSLIKE_PLOTTER
@@ -984,6 +1046,11 @@ public:
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH,
                            void * aData = NULL ) override;
+    /**
+     * Polygon plotted straight from the chain vertices, without a corner list copy
+     */
+    virtual void PlotPoly( const SHAPE_LINE_CHAIN& aCornerList, FILL_T aFill,
+                           int aWidth = USE_DEFAULT_LINE_WIDTH, void* aData = nullptr ) override;
 
     virtual void PlotImage( const wxImage& aImage, const wxPoint& aPos,
                             double aScaleFactor ) override;
@@ -1210,6 +1277,12 @@ public:
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH,
                            void* aData = nullptr ) override;
+    /**
+     * Gerber polygon plotted straight from the chain vertices (zone fills, mainly),
+     * without a corner list copy
+     */
+    virtual void PlotPoly( const SHAPE_LINE_CHAIN& aCornerList, FILL_T aFill,
+                           int aWidth = USE_DEFAULT_LINE_WIDTH, void* aData = nullptr ) override;
 
     virtual void PenTo( const wxPoint& pos, char plume ) override;
 
@@ -1403,18 +1476,55 @@ protected:
     // The last aperture attribute generated (only one aperture attribute can be set)
     int           m_apertureAttribute;
 
-    FILE* workFile;
-    FILE* finalFile;
-    wxString m_workFilename;
+    /**
+     * Format a record in the body of the file (everything following the aperture list)
+     */
+    void bodyPrintf( const char* aFormat, ... );
 
     /**
      * Generate the table of D codes
      */
     void writeApertureList();
 
+    /**
+     * What identifies an aperture in m_apertureIndex: its type, size and attribute
+     */
+    struct APERTURE_KEY
+    {
+        APERTURE::APERTURE_TYPE m_Type;
+        wxSize                  m_Size;
+        int                     m_ApertureAttribute;
+
+        bool operator==( const APERTURE_KEY& aOther ) const
+        {
+            return m_Type == aOther.m_Type && m_Size == aOther.m_Size
+                   && m_ApertureAttribute == aOther.m_ApertureAttribute;
+        }
+    };
+
+    struct APERTURE_KEY_HASH
+    {
+        std::size_t operator()( const APERTURE_KEY& aKey ) const
+        {
+            std::size_t seed = std::hash<int>()( aKey.m_Type );
+
+            for( int value : { aKey.m_Size.x, aKey.m_Size.y, aKey.m_ApertureAttribute } )
+                seed ^= std::hash<int>()( value ) + 0x9e3779b9 + ( seed << 6 ) + ( seed >> 2 );
+
+            return seed;
+        }
+    };
+
+    // The body of the file is only written by EndPlot(), after the aperture list which is
+    // complete only then: until then it is kept here
+    std::string m_body;
+
     std::vector<APERTURE> m_apertures;  // The list of available apertures
     int m_currentApertureIdx;   // The index of the current aperture in m_apertures
 
+    // The index in m_apertures of each aperture
+    std::unordered_map<APERTURE_KEY, int, APERTURE_KEY_HASH> m_apertureIndex;
+
     bool     m_gerberUnitInch;  // true if the gerber units are inches, false for mm
     int      m_gerberUnitFmt;   // number of digits in mantissa.
                                 // usually 6 in Inches and 5 or 6  in mm
@@ -1483,6 +1593,11 @@ public:
                          int width = USE_DEFAULT_LINE_WIDTH ) override;
     virtual void PlotPoly( const std::vector< wxPoint >& aCornerList,
                            FILL_T aFill, int aWidth = USE_DEFAULT_LINE_WIDTH, void * aData = NULL ) override;
+    /**
+     * DXF polygon plotted straight from the chain vertices when it has no thick outline
+     */
+    virtual void PlotPoly( const SHAPE_LINE_CHAIN& aCornerList, FILL_T aFill,
+                           int aWidth = USE_DEFAULT_LINE_WIDTH, void* aData = nullptr ) override;
     virtual void ThickSegment( const wxPoint& start, const wxPoint& end, int width,
                                EDA_DRAW_MODE_T tracemode, void* aData ) override;
     virtual void Arc( const wxPoint& centre, double StAngle, double EndAngle,
@@ -0,0 +1,499 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __PACKED_RTREE_H
+#define __PACKED_RTREE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include <math/box2.h>
+
+/**
+ * PACKED_RTREE
+ *
+ * Static, bulk-loaded R-tree. Items are ordered along a Hilbert curve and grouped into nodes of
+ * NODE_CAPACITY entries, level by level, so the whole tree lives in a handful of contiguous
+ * arrays: the bounding boxes of all leaf entries followed by those of each upper level, stored
+ * as separate coordinate arrays (structure of arrays). The tree can't be modified once built -
+ * it is meant for read-mostly data sets that are rebuilt on change, where it beats the dynamic
+ * RTree on both memory footprint and query speed.
+ */
+template <class T, int NODE_CAPACITY = 16>
+class PACKED_RTREE
+{
+public:
+    PACKED_RTREE()
+    {
+    }
+
+    /**
+     * Function Reserve()
+     *
+     * Preallocates room for aCount items to be added before the next Build().
+     */
+    void Reserve( size_t aCount )
+    {
+        m_items.reserve( aCount );
+        m_boxes.reserve( aCount );
+    }
+
+    /**
+     * Function Add()
+     *
+     * Stages an item for the next Build(). Staged items are not searchable until then.
+     */
+    void Add( const BOX2I& aBox, T aItem )
+    {
+        BOX2I box( aBox );
+        box.Normalize();
+
+        m_boxes.push_back( box );
+        m_items.push_back( aItem );
+    }
+
+    /**
+     * Function Build()
+     *
+     * Bulk-loads the tree from all items staged by Add().
+     */
+    void Build();
+
+    /**
+     * Function Clear()
+     *
+     * Removes all items, built or staged.
+     */
+    void Clear()
+    {
+        m_items.clear();
+        m_boxes.clear();
+        m_minX.clear();
+        m_minY.clear();
+        m_maxX.clear();
+        m_maxY.clear();
+        m_levelEnds.clear();
+    }
+
+    size_t Size() const { return m_minX.empty() ? 0 : m_levelEnds[0]; }
+
+    bool Empty() const { return m_minX.empty(); }
+
+    /**
+     * Function Search()
+     *
+     * Calls aVisitor( T ) for each item whose bounding box overlaps aBox. The visitor returns
+     * false to stop the search.
+     * @return the number of items visited.
+     */
+    template <class V>
+    int Search( const BOX2I& aBox, V& aVisitor ) const;
+
+    /**
+     * Function BatchSearch()
+     *
+     * Runs all the queries in aBoxes within a single traversal of the tree, so that each node
+     * is fetched once per batch instead of once per query. Calls aVisitor( int aQueryIndex, T )
+     * for each overlapping (query, item) pair. Returning false from the visitor stops only the
+     * query it was called for.
+     * @return the total number of (query, item) pairs visited.
+     */
+    template <class V>
+    int BatchSearch( const std::vector<BOX2I>& aBoxes, V& aVisitor ) const;
+
+private:
+    ///> Maximum tree depth. NODE_CAPACITY^MAX_LEVELS is far above any realistic item count.
+    static const int MAX_LEVELS = 16;
+
+    static uint32_t hilbertIndex( uint32_t aX, uint32_t aY );
+
+    bool overlaps( size_t aNode, const BOX2I& aBox ) const
+    {
+        return !( m_minX[aNode] > aBox.GetRight() || m_maxX[aNode] < aBox.GetX()
+               || m_minY[aNode] > aBox.GetBottom() || m_maxY[aNode] < aBox.GetY() );
+    }
+
+    size_t levelStart( int aLevel ) const
+    {
+        return aLevel == 0 ? 0 : m_levelEnds[aLevel - 1];
+    }
+
+    ///> First child of node aNode at level aLevel (>= 1).
+    size_t firstChild( size_t aNode, int aLevel ) const
+    {
+        return levelStart( aLevel - 1 ) + ( aNode - levelStart( aLevel ) ) * NODE_CAPACITY;
+    }
+
+    ///> One past the last child of node aNode at level aLevel (>= 1).
+    size_t lastChild( size_t aNode, int aLevel ) const
+    {
+        return std::min( firstChild( aNode, aLevel ) + NODE_CAPACITY, m_levelEnds[aLevel - 1] );
+    }
+
+    template <class V>
+    void batchVisit( size_t aNode, int aLevel, size_t aActiveBegin, size_t aActiveEnd,
+                     const std::vector<BOX2I>& aBoxes, std::vector<int>& aActive,
+                     std::vector<char>& aDone, V& aVisitor, int& aCount ) const;
+
+    // Staged items. Once built, m_items[i] is the item of leaf entry i.
+    std::vector<T>     m_items;
+    std::vector<BOX2I> m_boxes;
+
+    // Bounding boxes of all entries, leaves first, then each level up to the root.
+    std::vector<int>   m_minX;
+    std::vector<int>   m_minY;
+    std::vector<int>   m_maxX;
+    std::vector<int>   m_maxY;
+
+    // One past the last entry of each level. The root is the single entry of the last level.
+    std::vector<size_t> m_levelEnds;
+};
+
+
+template <class T, int NODE_CAPACITY>
+uint32_t PACKED_RTREE<T, NODE_CAPACITY>::hilbertIndex( uint32_t aX, uint32_t aY )
+{
+    // Branch-free Hilbert curve index of a 16-bit point, after "Fast Hilbert curve generation"
+    // by Rawrunprotected (public domain).
+    uint32_t a = aX ^ aY;
+    uint32_t b = 0xFFFF ^ a;
+    uint32_t c = 0xFFFF ^ ( aX | aY );
+    uint32_t d = aX & ( aY ^ 0xFFFF );
+
+    uint32_t A = a | ( b >> 1 );
+    uint32_t B = ( a >> 1 ) ^ a;
+    uint32_t C = ( ( c >> 1 ) ^ ( b & ( d >> 1 ) ) ) ^ c;
+    uint32_t D = ( ( a & ( c >> 1 ) ) ^ ( d >> 1 ) ) ^ d;
+
+    a = A;
+    b = B;
+    c = C;
+    d = D;
+    A = ( ( a & ( a >> 2 ) ) ^ ( b & ( b >> 2 ) ) );
+    B = ( ( a & ( b >> 2 ) ) ^ ( b & ( ( a ^ b ) >> 2 ) ) );
+    C ^= ( ( a & ( c >> 2 ) ) ^ ( b & ( d >> 2 ) ) );
+    D ^= ( ( b & ( c >> 2 ) ) ^ ( ( a ^ b ) & ( d >> 2 ) ) );
+
+    a = A;
+    b = B;
+    c = C;
+    d = D;
+    A = ( ( a & ( a >> 4 ) ) ^ ( b & ( b >> 4 ) ) );
+    B = ( ( a & ( b >> 4 ) ) ^ ( b & ( ( a ^ b ) >> 4 ) ) );
+    C ^= ( ( a & ( c >> 4 ) ) ^ ( b & ( d >> 4 ) ) );
+    D ^= ( ( b & ( c >> 4 ) ) ^ ( ( a ^ b ) & ( d >> 4 ) ) );
+
+    a = A;
+    b = B;
+    c = C;
+    d = D;
+    C ^= ( ( a & ( c >> 8 ) ) ^ ( b & ( d >> 8 ) ) );
+    D ^= ( ( b & ( c >> 8 ) ) ^ ( ( a ^ b ) & ( d >> 8 ) ) );
+
+    a = C ^ ( C >> 1 );
+    b = D ^ ( D >> 1 );
+
+    uint32_t i0 = aX ^ aY;
+    uint32_t i1 = b | ( 0xFFFF ^ ( i0 | a ) );
+
+    i0 = ( i0 | ( i0 << 8 ) ) & 0x00FF00FF;
+    i0 = ( i0 | ( i0 << 4 ) ) & 0x0F0F0F0F;
+    i0 = ( i0 | ( i0 << 2 ) ) & 0x33333333;
+    i0 = ( i0 | ( i0 << 1 ) ) & 0x55555555;
+
+    i1 = ( i1 | ( i1 << 8 ) ) & 0x00FF00FF;
+    i1 = ( i1 | ( i1 << 4 ) ) & 0x0F0F0F0F;
+    i1 = ( i1 | ( i1 << 2 ) ) & 0x33333333;
+    i1 = ( i1 | ( i1 << 1 ) ) & 0x55555555;
+
+    return ( i1 << 1 ) | i0;
+}
+
+
+template <class T, int NODE_CAPACITY>
+void PACKED_RTREE<T, NODE_CAPACITY>::Build()
+{
+    const size_t n = m_items.size();
+
+    m_minX.clear();
+    m_minY.clear();
+    m_maxX.clear();
+    m_maxY.clear();
+    m_levelEnds.clear();
+
+    if( n == 0 )
+        return;
+
+    BOX2I extents = m_boxes[0];
+
+    for( const BOX2I& box : m_boxes )
+        extents.Merge( box );
+
+    // Sort the items along a Hilbert curve spanning the extents of the whole set, so that
+    // neighbouring leaves end up in the same nodes.
+    const int64_t w = std::max<int64_t>( 1, (int64_t) extents.GetWidth() );
+    const int64_t h = std::max<int64_t>( 1, (int64_t) extents.GetHeight() );
+
+    std::vector<uint32_t> keys( n );
+    std::vector<size_t>   order( n );
+
+    for( size_t i = 0; i < n; i++ )
+    {
+        const BOX2I& box = m_boxes[i];
+        int64_t      cx = ( (int64_t) box.GetX() + box.GetRight() ) / 2 - extents.GetX();
+        int64_t      cy = ( (int64_t) box.GetY() + box.GetBottom() ) / 2 - extents.GetY();
+
+        keys[i] = hilbertIndex( (uint32_t) ( cx * 0xFFFF / w ), (uint32_t) ( cy * 0xFFFF / h ) );
+    }
+
+    std::iota( order.begin(), order.end(), 0 );
+    std::sort( order.begin(), order.end(),
+               [&keys]( size_t a, size_t b )
+               {
+                   return keys[a] < keys[b];
+               } );
+
+    size_t total = n;
+
+    for( size_t count = n; count > 1; )
+    {
+        count = ( count + NODE_CAPACITY - 1 ) / NODE_CAPACITY;
+        total += count;
+    }
+
+    m_minX.reserve( total );
+    m_minY.reserve( total );
+    m_maxX.reserve( total );
+    m_maxY.reserve( total );
+
+    std::vector<T> items;
+    items.reserve( n );
+
+    for( size_t i : order )
+    {
+        const BOX2I& box = m_boxes[i];
+
+        m_minX.push_back( box.GetX() );
+        m_minY.push_back( box.GetY() );
+        m_maxX.push_back( box.GetRight() );
+        m_maxY.push_back( box.GetBottom() );
+        items.push_back( m_items[i] );
+    }
+
+    m_items = std::move( items );
+    m_boxes.clear();
+    m_boxes.shrink_to_fit();
+    m_levelEnds.push_back( n );
+
+    // Build each level on top of the previous one until a single root node remains.
+    for( size_t begin = 0, end = n; end - begin > 1; )
+    {
+        for( size_t i = begin; i < end; i += NODE_CAPACITY )
+        {
+            size_t last = std::min( i + NODE_CAPACITY, end );
+            int    minX = m_minX[i], minY = m_minY[i], maxX = m_maxX[i], maxY = m_maxY[i];
+
+            for( size_t j = i + 1; j < last; j++ )
+            {
+                minX = std::min( minX, m_minX[j] );
+                minY = std::min( minY, m_minY[j] );
+                maxX = std::max( maxX, m_maxX[j] );
+                maxY = std::max( maxY, m_maxY[j] );
+            }
+
+            m_minX.push_back( minX );
+            m_minY.push_back( minY );
+            m_maxX.push_back( maxX );
+            m_maxY.push_back( maxY );
+        }
+
+        begin = end;
+        end = m_minX.size();
+        m_levelEnds.push_back( end );
+    }
+}
+
+
+template <class T, int NODE_CAPACITY>
+template <class V>
+int PACKED_RTREE<T, NODE_CAPACITY>::Search( const BOX2I& aBox, V& aVisitor ) const
+{
+    if( m_minX.empty() )
+        return 0;
+
+    BOX2I box( aBox );
+    box.Normalize();
+
+    int    count = 0;
+    size_t root = m_minX.size() - 1;
+    int    rootLevel = (int) m_levelEnds.size() - 1;
+
+    if( !overlaps( root, box ) )
+        return 0;
+
+    if( rootLevel == 0 )
+    {
+        aVisitor( m_items[root] );
+        return 1;
+    }
+
+    // Each visited node pushes at most NODE_CAPACITY children, once per level
+    std::pair<size_t, int> stack[NODE_CAPACITY * MAX_LEVELS];
+    int                    sp = 0;
+
+    stack[sp++] = { root, rootLevel };
+
+    while( sp > 0 )
+    {
+        size_t node = stack[--sp].first;
+        int    level = stack[sp].second;
+        size_t last = lastChild( node, level );
+
+        for( size_t child = firstChild( node, level ); child < last; child++ )
+        {
+            if( !overlaps( child, box ) )
+                continue;
+
+            if( level == 1 )
+            {
+                count++;
+
+                if( !aVisitor( m_items[child] ) )
+                    return count;
+            }
+            else
+            {
+                stack[sp++] = { child, level - 1 };
+            }
+        }
+    }
+
+    return count;
+}
+
+
+template <class T, int NODE_CAPACITY>
+template <class V>
+int PACKED_RTREE<T, NODE_CAPACITY>::BatchSearch( const std::vector<BOX2I>& aBoxes,
+                                                 V& aVisitor ) const
+{
+    if( m_minX.empty() || aBoxes.empty() )
+        return 0;
+
+    std::vector<BOX2I> boxes( aBoxes );
+    std::vector<char>  done( boxes.size(), 0 );
+    std::vector<int>   active;
+    size_t             root = m_minX.size() - 1;
+    int                rootLevel = (int) m_levelEnds.size() - 1;
+    int                count = 0;
+
+    active.reserve( boxes.size() * ( rootLevel + 1 ) );
+
+    for( size_t q = 0; q < boxes.size(); q++ )
+    {
+        boxes[q].Normalize();
+
+        if( overlaps( root, boxes[q] ) )
+            active.push_back( (int) q );
+    }
+
+    if( active.empty() )
+        return 0;
+
+    if( rootLevel == 0 )
+    {
+        for( int q : active )
+        {
+            count++;
+            aVisitor( q, m_items[root] );
+        }
+
+        return count;
+    }
+
+    batchVisit( root, rootLevel, 0, active.size(), boxes, active, done, aVisitor, count );
+
+    return count;
+}
+
+
+template <class T, int NODE_CAPACITY>
+template <class V>
+void PACKED_RTREE<T, NODE_CAPACITY>::batchVisit( size_t aNode, int aLevel, size_t aActiveBegin,
+                                                 size_t aActiveEnd,
+                                                 const std::vector<BOX2I>& aBoxes,
+                                                 std::vector<int>& aActive,
+                                                 std::vector<char>& aDone, V& aVisitor,
+                                                 int& aCount ) const
+{
+    size_t first = firstChild( aNode, aLevel );
+    size_t last = lastChild( aNode, aLevel );
+
+    if( aLevel == 1 )
+    {
+        for( size_t child = first; child < last; child++ )
+        {
+            for( size_t i = aActiveBegin; i < aActiveEnd; i++ )
+            {
+                int q = aActive[i];
+
+                if( aDone[q] || !overlaps( child, aBoxes[q] ) )
+                    continue;
+
+                aCount++;
+
+                if( !aVisitor( q, m_items[child] ) )
+                    aDone[q] = 1;
+            }
+        }
+
+        return;
+    }
+
+    for( size_t child = first; child < last; child++ )
+    {
+        // The queries overlapping this child are appended past the parent's range and
+        // dropped again once the child is done, so the scratch list never outgrows the depth.
+        size_t begin = aActive.size();
+
+        for( size_t i = aActiveBegin; i < aActiveEnd; i++ )
+        {
+            int q = aActive[i];
+
+            if( !aDone[q] && overlaps( child, aBoxes[q] ) )
+                aActive.push_back( q );
+        }
+
+        if( aActive.size() > begin )
+        {
+            batchVisit( child, aLevel - 1, begin, aActive.size(), aBoxes, aActive, aDone,
+                        aVisitor, aCount );
+        }
+
+        aActive.resize( begin );
+    }
+}
+
+#endif // __PACKED_RTREE_H
@@ -0,0 +1,50 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __SEG_BATCH_H
+#define __SEG_BATCH_H
+
+#include <geometry/seg.h>
+#include <math/vector2d.h>
+
+/**
+ * Function FindCollidingSegment()
+ *
+ * Tests a segment against all the segments of an open polyline at once. The polyline
+ * vertices are used directly as a packed array of segments (segment i runs from aPoints[i]
+ * to aPoints[i + 1]): a SIMD bounding box test rejects whole groups of segments and only
+ * the remaining ones go through the exact SEG::Collide() check.
+ *
+ * The result is the same as testing every segment with a bounding box distance check
+ * followed by SEG::Collide(), as SHAPE_LINE_CHAIN::Collide() used to do.
+ *
+ * @param aSeg the segment to test
+ * @param aPoints the polyline vertices
+ * @param aPointCount number of vertices in aPoints
+ * @param aClearance the collision clearance
+ * @return index of the first segment colliding with aSeg, or -1 if there is none
+ */
+int FindCollidingSegment( const SEG& aSeg, const VECTOR2I* aPoints, int aPointCount,
+                          int aClearance );
+
+#endif // __SEG_BATCH_H
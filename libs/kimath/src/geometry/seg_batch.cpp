@@ -0,0 +1,167 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <climits>
+
+#include <geometry/seg_batch.h>
+#include <math/box2.h>
+
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define SEG_BATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+typedef SEG::ecoord ecoord;
+
+// The SIMD path loads vertices straight from the polyline as pairs of ints
+static_assert( sizeof( VECTOR2I ) == 2 * sizeof( int ), "VECTOR2I must be a packed pair of ints" );
+
+
+static inline int clampToInt( ecoord aValue )
+{
+    return (int) std::max<ecoord>( INT_MIN, std::min<ecoord>( INT_MAX, aValue ) );
+}
+
+
+namespace
+{
+
+/**
+ * The exact part of the test, run only for the segments which made it through the
+ * bounding box rejection.
+ */
+struct EXACT_TEST
+{
+    EXACT_TEST( const SEG& aSeg, int aClearance ) :
+            m_seg( aSeg ),
+            m_box( aSeg.A, aSeg.B - aSeg.A ),
+            m_distSq( (ecoord) aClearance * aClearance ),
+            m_clearance( aClearance )
+    {
+    }
+
+    bool operator()( const VECTOR2I& aA, const VECTOR2I& aB ) const
+    {
+        BOX2I box( aA, aB - aA );
+
+        if( m_box.SquaredDistance( box ) >= m_distSq )
+            return false;
+
+        return SEG( aA, aB ).Collide( m_seg, m_clearance );
+    }
+
+    const SEG& m_seg;
+    BOX2I      m_box;
+    ecoord     m_distSq;
+    int        m_clearance;
+};
+
+}
+
+
+int FindCollidingSegment( const SEG& aSeg, const VECTOR2I* aPoints, int aPointCount,
+                          int aClearance )
+{
+    if( aPointCount < 2 )
+        return -1;
+
+    EXACT_TEST exact( aSeg, aClearance );
+
+    // SEG::Collide() squares the clearance, so its sign doesn't matter
+    const ecoord margin = std::abs( (ecoord) aClearance );
+
+    // Bounding box of aSeg grown by the clearance: any segment whose own bounding box misses
+    // it is further than aClearance away from aSeg.
+    const int qMinX = clampToInt( std::min( aSeg.A.x, aSeg.B.x ) - margin );
+    const int qMinY = clampToInt( std::min( aSeg.A.y, aSeg.B.y ) - margin );
+    const int qMaxX = clampToInt( std::max( aSeg.A.x, aSeg.B.x ) + margin );
+    const int qMaxY = clampToInt( std::max( aSeg.A.y, aSeg.B.y ) + margin );
+
+    int i = 0;
+
+#ifdef SEG_BATCH_SSE2
+    const __m128i qMin = _mm_setr_epi32( qMinX, qMinY, qMinX, qMinY );
+    const __m128i qMax = _mm_setr_epi32( qMaxX, qMaxY, qMaxX, qMaxY );
+
+    // Returns a 4-bit mask, with the x and y bits of the segments ( aP, aP + 1 ) and
+    // ( aP + 1, aP + 2 ) set if the segment's bounding box is outside the query box.
+    auto rejectPair = [&]( const VECTOR2I* aP ) -> int
+    {
+        const __m128i a = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aP ) );
+        const __m128i b = _mm_loadu_si128( reinterpret_cast<const __m128i*>( aP + 1 ) );
+
+        // SSE2 has no 32-bit integer min/max, so blend through a compare
+        const __m128i gt = _mm_cmpgt_epi32( a, b );
+        const __m128i lo = _mm_or_si128( _mm_and_si128( gt, b ), _mm_andnot_si128( gt, a ) );
+        const __m128i hi = _mm_or_si128( _mm_and_si128( gt, a ), _mm_andnot_si128( gt, b ) );
+
+        const __m128i out = _mm_or_si128( _mm_cmpgt_epi32( lo, qMax ),
+                                          _mm_cmpgt_epi32( qMin, hi ) );
+
+        return _mm_movemask_ps( _mm_castsi128_ps( out ) );
+    };
+
+    // Four segments per iteration: vertices i ... i + 4 must all be valid
+    for( ; i + 4 < aPointCount; i += 4 )
+    {
+        const int reject = rejectPair( aPoints + i ) | ( rejectPair( aPoints + i + 2 ) << 4 );
+
+        // one bit per segment (at even positions), set if neither its x nor y range is out
+        int candidates = ~( reject | ( reject >> 1 ) ) & 0x55;
+
+        int seg = i;
+
+        while( candidates )
+        {
+            while( !( candidates & 1 ) )
+            {
+                candidates >>= 2;
+                seg++;
+            }
+
+            if( exact( aPoints[seg], aPoints[seg + 1] ) )
+                return seg;
+
+            candidates &= ~1;
+        }
+    }
+#endif
+
+    for( ; i + 1 < aPointCount; i++ )
+    {
+        const VECTOR2I& a = aPoints[i];
+        const VECTOR2I& b = aPoints[i + 1];
+
+        if( std::max( a.x, b.x ) < qMinX || std::min( a.x, b.x ) > qMaxX
+                || std::max( a.y, b.y ) < qMinY || std::min( a.y, b.y ) > qMaxY )
+        {
+            continue;
+        }
+
+        if( exact( a, b ) )
+            return i;
+    }
+
+    return -1;
+}
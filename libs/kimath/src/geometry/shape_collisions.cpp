@@ -227,8 +227,13 @@ static inline bool Collide( const SHAPE_CIRCLE& aA, const SHAPE_SEGMENT& aSeg, i
 static inline bool Collide( const SHAPE_LINE_CHAIN& aA, const SHAPE_LINE_CHAIN& aB, int aClearance,
                             bool aNeedMTV, VECTOR2I& aMTV )
 {
-    for( int i = 0; i < aB.SegmentCount(); i++ )
-        if( aA.Collide( aB.CSegment( i ), aClearance ) )
+    // Walk the shorter chain and batch-test each of its segments against the longer one
+    // (e.g. an approximated arc against a routed line).
+    const SHAPE_LINE_CHAIN& walk = aA.PointCount() < aB.PointCount() ? aA : aB;
+    const SHAPE_LINE_CHAIN& batch = aA.PointCount() < aB.PointCount() ? aB : aA;
+
+    for( int i = 0; i < walk.SegmentCount(); i++ )
+        if( batch.Collide( walk.CSegment( i ), aClearance ) )
             return true;
 
     return false;
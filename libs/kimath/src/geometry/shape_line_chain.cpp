@@ -29,6 +29,7 @@
 
 #include <clipper.hpp>
 #include <geometry/seg.h>    // for SEG, OPT_VECTOR2I
+#include <geometry/seg_batch.h>
 #include <geometry/shape_line_chain.h>
 #include <math/box2.h>       // for BOX2I
 #include <math/util.h>  // for rescale
@@ -109,21 +110,16 @@ void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 
 bool SHAPE_LINE_CHAIN::Collide( const SEG& aSeg, int aClearance ) const
 {
-    BOX2I box_a( aSeg.A, aSeg.B - aSeg.A );
-    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
-
-    for( int i = 0; i < SegmentCount(); i++ )
-    {
-        const SEG& s = CSegment( i );
-        BOX2I box_b( s.A, s.B - s.A );
+    if( m_points.empty() )
+        return false;
 
-        BOX2I::ecoord_type d = box_a.SquaredDistance( box_b );
+    if( FindCollidingSegment( aSeg, m_points.data(), m_points.size(), aClearance ) >= 0 )
+        return true;
 
-        if( d < dist_sq )
-        {
-            if( s.Collide( aSeg, aClearance ) )
-                return true;
-        }
+    if( m_closed )
+    {
+        const VECTOR2I closing[2] = { m_points.back(), m_points.front() };
+        return FindCollidingSegment( aSeg, closing, 2, aClearance ) >= 0;
     }
 
     return false;
@@ -31,10 +31,9 @@
 #include <mutex>
 #include <algorithm>
 #include <future>
+#include <map>
 
-#ifdef PROFILE
 #include <profile.h>
-#endif
 
 
 bool CN_CONNECTIVITY_ALGO::Remove( BOARD_ITEM* aItem )
@@ -547,37 +546,359 @@ void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std
     wxLogTrace( "CN", "Found %u isolated islands\n", (unsigned)aIslands.size() );
 }
 
+/**
+ * Anchors of the items taking part in the island test, bucketed by copper layer and net and
+ * sorted by X so that the anchors falling inside an island bounding box are found with a
+ * binary search instead of a scan of the whole board.
+ */
+class CN_ISLAND_ANCHOR_INDEX
+{
+public:
+    struct ENTRY
+    {
+        VECTOR2I m_pos;
+        int      m_cluster;
+    };
+
+    void Add( PCB_LAYER_ID aLayer, int aNet, const VECTOR2I& aPos, int aCluster )
+    {
+        m_buckets[aLayer][aNet].push_back( { aPos, aCluster } );
+    }
+
+    void Sort()
+    {
+        for( auto& layer : m_buckets )
+        {
+            for( auto& net : layer )
+            {
+                std::sort( net.second.begin(), net.second.end(),
+                        []( const ENTRY& a, const ENTRY& b )
+                        {
+                            return a.m_pos.x < b.m_pos.x;
+                        } );
+            }
+        }
+    }
+
+    template <class T>
+    void Query( PCB_LAYER_ID aLayer, int aNet, const BOX2I& aBox, T aFunc ) const
+    {
+        const auto it = m_buckets[aLayer].find( aNet );
+
+        if( it == m_buckets[aLayer].end() )
+            return;
+
+        const std::vector<ENTRY>& entries = it->second;
+
+        auto entry = std::lower_bound( entries.begin(), entries.end(), aBox.GetLeft(),
+                []( const ENTRY& a, int x )
+                {
+                    return a.m_pos.x < x;
+                } );
+
+        for( ; entry != entries.end() && entry->m_pos.x <= aBox.GetRight(); ++entry )
+        {
+            if( entry->m_pos.y >= aBox.GetTop() && entry->m_pos.y <= aBox.GetBottom() )
+                aFunc( *entry );
+        }
+    }
+
+private:
+    std::unordered_map<int, std::vector<ENTRY>> m_buckets[PCB_LAYER_ID_COUNT];
+};
+
+
+/**
+ * A filled subpolygon of one of the zones under test.
+ */
+struct CN_ISLAND
+{
+    ZONE_CONTAINER*                      m_zone;
+    int                                  m_subpolyIndex;
+    int                                  m_clearance;
+    BOX2I                                m_bbox;
+    std::unique_ptr<POLY_GRID_PARTITION> m_poly;
+    std::vector<int>                     m_links;    ///< union-find nodes touching the island
+};
+
+
 void CN_CONNECTIVITY_ALGO::FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones )
 {
-    for ( auto& z : aZones )
+    PROF_COUNTER timer;
+
+    // The zones under test are not added back to the item list: their subpolygons are
+    // hit-tested against the clusters formed by the rest of the board instead.
+    for( auto& z : aZones )
         Remove( z.m_zone );
 
-    for ( auto& z : aZones )
+    const CLUSTERS clusters = SearchClusters( CSM_CONNECTIVITY_CHECK );
+    double t_clusters = timer.msecs( true );
+
+    // These clusters leave out the zones under test, so they are not kept as m_connClusters;
+    // the previous ones may point to the items of these zones, which are now removed.
+    m_connClusters.clear();
+
+    struct OTHER_ZONE
+    {
+        CN_ZONE* m_item;
+        int      m_cluster;
+        BOX2I    m_bbox;
+    };
+
+    CN_ISLAND_ANCHOR_INDEX  anchors;
+    std::vector<OTHER_ZONE> otherZones[PCB_LAYER_ID_COUNT];
+
+    // Union-find set: one node per cluster followed by one node per island
+    std::vector<int>  root;
+    std::vector<char> hasPad;
+
+    for( int ii = 0; ii < (int) clusters.size(); ii++ )
     {
-        if( !z.m_zone->GetFilledPolysList().IsEmpty() )
-            Add( z.m_zone );
+        root.push_back( ii );
+        hasPad.push_back( !clusters[ii]->IsOrphaned() );
+
+        for( CN_ITEM* item : *clusters[ii] )
+        {
+            if( !item->Valid() )
+                continue;
+
+            if( item->Parent()->Type() == PCB_ZONE_AREA_T )
+            {
+                CN_ZONE*     zitem = static_cast<CN_ZONE*>( item );
+                PCB_LAYER_ID layer = static_cast<PCB_LAYER_ID>( zitem->Layer() );
+
+                for( const auto& anchor : zitem->Anchors() )
+                    anchors.Add( layer, item->Net(), anchor->Pos(), ii );
+
+                otherZones[layer].push_back( { zitem, ii, zitem->BBox() } );
+                continue;
+            }
+
+            LSEQ layers = ( item->Parent()->GetLayerSet() & LSET::AllCuMask() ).Seq();
+
+            for( int jj = 0; jj < item->AnchorCount(); jj++ )
+            {
+                VECTOR2I pos = item->GetAnchor( jj );
+
+                for( PCB_LAYER_ID layer : layers )
+                    anchors.Add( layer, item->Net(), pos, ii );
+            }
+        }
     }
 
-    m_connClusters = SearchClusters( CSM_CONNECTIVITY_CHECK );
+    anchors.Sort();
+    double t_index = timer.msecs( true );
+
+    const int                        islandBase = clusters.size();
+    std::vector<CN_ISLAND>           islands;
+    std::vector<std::pair<int, int>> zoneIslands;
+
+    for( auto& z : aZones )
+    {
+        ZONE_CONTAINER* zone = z.m_zone;
+        int             first = islands.size();
+
+        // By definition, zones with no net have no isolated islands
+        if( zone->GetNetCode() > 0 && zone->IsOnCopperLayer() )
+        {
+            int clearance = zone->GetFilledPolysUseThickness() ? zone->GetMinThickness() / 2 : 0;
+
+            for( int jj = 0; jj < zone->GetFilledPolysList().OutlineCount(); jj++ )
+            {
+                islands.emplace_back();
+                islands.back().m_zone = zone;
+                islands.back().m_subpolyIndex = jj;
+                islands.back().m_clearance = clearance;
+
+                root.push_back( root.size() );
+                hasPad.push_back( false );
+            }
+        }
+
+        zoneIslands.emplace_back( first, islands.size() );
+    }
+
+    auto forEachZone = [&]( const std::function<void( int )>& aFunc )
+    {
+        size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                       aZones.size() );
+        std::atomic<size_t> nextZone( 0 );
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        auto zone_lambda = [&]() -> size_t
+        {
+            for( size_t i = nextZone++; i < aZones.size(); i = nextZone++ )
+            {
+                for( int ii = zoneIslands[i].first; ii < zoneIslands[i].second; ii++ )
+                    aFunc( ii );
 
-    for ( auto& zone : aZones )
+                if( m_progressReporter )
+                    m_progressReporter->AdvanceProgress();
+            }
+
+            return 1;
+        };
+
+        if( m_progressReporter )
+            m_progressReporter->SetMaxProgress( aZones.size() );
+
+        if( parallelThreadCount <= 1 )
+            zone_lambda();
+        else
+        {
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+                returns[ii] = std::async( std::launch::async, zone_lambda );
+
+            for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            {
+                // Here we balance returns with a 100ms timeout to allow UI updating
+                std::future_status status;
+                do
+                {
+                    if( m_progressReporter )
+                        m_progressReporter->KeepRefreshing();
+
+                    status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+                } while( status != std::future_status::ready );
+            }
+        }
+    };
+
+    // Pass 1: partition each island and find the anchors of connected items inside it.
+    // Zones that are not under test are touched when one of the island corners lies inside
+    // them; the converse is covered by their outline anchors in the index.
+    forEachZone( [&]( int aIsland )
     {
-        if( zone.m_zone->GetFilledPolysList().IsEmpty() )
-            continue;
+        CN_ISLAND&              island = islands[aIsland];
+        const SHAPE_LINE_CHAIN& corners = island.m_zone->GetFilledPolysList().COutline(
+                                                  island.m_subpolyIndex );
+        PCB_LAYER_ID            layer = island.m_zone->GetLayer();
+        int                     net = island.m_zone->GetNetCode();
+        SHAPE_LINE_CHAIN        outline = corners;
+
+        outline.SetClosed( true );
+        outline.Simplify();
+
+        island.m_poly = std::make_unique<POLY_GRID_PARTITION>( outline, 16 );
+        island.m_bbox = island.m_poly->BBox();
+        island.m_bbox.Inflate( island.m_clearance );
+
+        anchors.Query( layer, net, island.m_bbox,
+                [&]( const CN_ISLAND_ANCHOR_INDEX::ENTRY& aEntry )
+                {
+                    if( island.m_poly->ContainsPoint( aEntry.m_pos, island.m_clearance ) )
+                        island.m_links.push_back( aEntry.m_cluster );
+                } );
 
-        for( const auto& cluster : m_connClusters )
+        for( const OTHER_ZONE& other : otherZones[layer] )
         {
-            if( cluster->Contains( zone.m_zone ) && cluster->IsOrphaned() )
+            if( other.m_item->Net() != net || !other.m_bbox.Intersects( island.m_bbox ) )
+                continue;
+
+            for( int jj = 0; jj < corners.PointCount(); jj++ )
             {
-                for( auto z : *cluster )
+                if( other.m_item->ContainsPoint( corners.CPoint( jj ) ) )
                 {
-                    if( z->Parent() == zone.m_zone )
-                    {
-                        zone.m_islands.push_back( static_cast<CN_ZONE*>(z)->SubpolyIndex() );
-                    }
+                    island.m_links.push_back( other.m_cluster );
+                    break;
+                }
+            }
+        }
+    } );
+
+    double t_islands = timer.msecs( true );
+
+    // Pass 2: overlapping islands of different zones under test.  Each island only tests
+    // its own corners, the opposite direction is done when visiting the other island.
+    std::map<std::pair<int, int>, std::vector<int>> islandsByLayerNet;
+
+    for( int ii = 0; ii < (int) islands.size(); ii++ )
+    {
+        const ZONE_CONTAINER* zone = islands[ii].m_zone;
+        islandsByLayerNet[ { zone->GetLayer(), zone->GetNetCode() } ].push_back( ii );
+    }
+
+    forEachZone( [&]( int aIsland )
+    {
+        CN_ISLAND&              island = islands[aIsland];
+        const SHAPE_LINE_CHAIN& corners = island.m_zone->GetFilledPolysList().COutline(
+                                                  island.m_subpolyIndex );
+        const auto&             candidates = islandsByLayerNet.at(
+                { island.m_zone->GetLayer(), island.m_zone->GetNetCode() } );
+
+        for( int idx : candidates )
+        {
+            CN_ISLAND& other = islands[idx];
+
+            if( other.m_zone == island.m_zone || !other.m_bbox.Intersects( island.m_bbox ) )
+                continue;
+
+            for( int jj = 0; jj < corners.PointCount(); jj++ )
+            {
+                if( other.m_poly->ContainsPoint( corners.CPoint( jj ), other.m_clearance ) )
+                {
+                    island.m_links.push_back( islandBase + idx );
+                    break;
                 }
             }
         }
+    } );
+
+    double t_links = timer.msecs( true );
+
+    auto findRoot = [&]( int aNode ) -> int
+    {
+        while( root[aNode] != aNode )
+        {
+            root[aNode] = root[root[aNode]];
+            aNode = root[aNode];
+        }
+
+        return aNode;
+    };
+
+    for( int ii = 0; ii < (int) islands.size(); ii++ )
+    {
+        for( int link : islands[ii].m_links )
+        {
+            int a = findRoot( islandBase + ii );
+            int b = findRoot( link );
+
+            if( a != b )
+            {
+                root[a] = b;
+                hasPad[b] = hasPad[b] || hasPad[a];
+            }
+        }
+    }
+
+    int islandCount = 0;
+
+    for( size_t ii = 0; ii < aZones.size(); ii++ )
+    {
+        for( int jj = zoneIslands[ii].first; jj < zoneIslands[ii].second; jj++ )
+        {
+            if( !hasPad[ findRoot( islandBase + jj ) ] )
+            {
+                aZones[ii].m_islands.push_back( islands[jj].m_subpolyIndex );
+                islandCount++;
+            }
+        }
+    }
+
+    double t_resolve = timer.msecs( true );
+
+    wxLogTrace( "CN", "Island test: %d islands, %d isolated; clusters %.1f ms, anchor index "
+                "%.1f ms, anchors %.1f ms, zone overlaps %.1f ms, resolve %.1f ms\n",
+                (int) islands.size(), islandCount, t_clusters, t_index, t_islands, t_links,
+                t_resolve );
+
+    if( m_progressReporter )
+    {
+        m_progressReporter->Report( wxString::Format(
+                _( "Found %d insulated copper islands in %.0f ms" ), islandCount,
+                t_clusters + t_index + t_islands + t_links + t_resolve ) );
+        m_progressReporter->KeepRefreshing();
     }
 }
 
@@ -147,6 +147,8 @@ private:
 
     std::unordered_map<const BOARD_ITEM*, ITEM_MAP_ENTRY> m_itemMap;
 
+    ///> Clusters of the last PropagateNets() or single zone FindIsolatedCopperIslands(), which
+    ///> search them again before use.  Cleared by the other FindIsolatedCopperIslands().
     CLUSTERS m_connClusters;
     CLUSTERS m_ratsnestClusters;
     std::vector<bool> m_dirtyNets;
@@ -236,6 +238,10 @@ public:
      * Finds the copper islands that are not connected to a net.  These are added to
      * the m_islands vector.
      * N.B. This must be called after aZones has been refreshed.
+     * The islands are hit-tested against the anchors of the other items instead of being
+     * added to the connectivity graph, so aZones are left out of it on return and the
+     * caller must Update() them once the islands have been removed.  m_connClusters is
+     * cleared, as it would not be valid after the call.
      * @param: aZones The set of zones to search for islands
      */
     void    FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones );
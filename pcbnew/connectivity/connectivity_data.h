@@ -154,6 +154,11 @@ public:
      * @param aIslands list of islands that have no connections (outline indices in the polygon set)
      */
     void FindIsolatedCopperIslands( ZONE_CONTAINER* aZone, std::vector<int>& aIslands );
+
+    /**
+     * Searches for the copper islands of several zones at once.  The zones are left out of the
+     * connectivity on return: Update() them once their islands are removed (or not).
+     */
     void FindIsolatedCopperIslands( std::vector<CN_ZONE_ISOLATED_ISLAND_LIST>& aZones );
 
     /**
@@ -92,6 +92,7 @@ bool DIALOG_GENDRILL::m_Merge_PTH_NPTH  = false;    // Only for Excellon format
 int DIALOG_GENDRILL::m_mapFileType      = 1;
 int DIALOG_GENDRILL::m_drillFileType    = 0;
 bool DIALOG_GENDRILL::m_UseRouteModeForOvalHoles = true;    // Use G00 route mode to "drill" oval holes
+bool DIALOG_GENDRILL::m_OptimizeDrillPath = false;
 
 DIALOG_GENDRILL::~DIALOG_GENDRILL()
 {
@@ -107,6 +108,7 @@ void DIALOG_GENDRILL::initDialog()
     m_Mirror                   = cfg->m_GenDrill.mirror;
     m_UnitDrillIsInch          = cfg->m_GenDrill.unit_drill_is_inch;
     m_UseRouteModeForOvalHoles = cfg->m_GenDrill.use_route_for_oval_holes;
+    m_OptimizeDrillPath        = cfg->m_GenDrill.optimize_drill_path;
     m_drillFileType            = cfg->m_GenDrill.drill_file_type;
     m_mapFileType              = cfg->m_GenDrill.map_file_type;
     m_ZerosFormat              = cfg->m_GenDrill.zeros_format;
@@ -135,6 +137,7 @@ void DIALOG_GENDRILL::InitDisplayParams()
     m_Check_Merge_PTH_NPTH->SetValue( m_Merge_PTH_NPTH );
     m_Choice_Drill_Map->SetSelection( m_mapFileType );
     m_radioBoxOvalHoleMode->SetSelection( m_UseRouteModeForOvalHoles ? 0 : 1 );
+    m_checkOptimizeDrillPath->SetValue( m_OptimizeDrillPath );
 
     m_platedPadsHoleCount    = 0;
     m_notplatedPadsHoleCount = 0;
@@ -243,6 +246,7 @@ void DIALOG_GENDRILL::UpdateConfig()
     cfg->m_GenDrill.mirror                   = m_Mirror;
     cfg->m_GenDrill.unit_drill_is_inch       = m_UnitDrillIsInch;
     cfg->m_GenDrill.use_route_for_oval_holes = m_UseRouteModeForOvalHoles;
+    cfg->m_GenDrill.optimize_drill_path      = m_OptimizeDrillPath;
     cfg->m_GenDrill.drill_file_type          = m_drillFileType;
     cfg->m_GenDrill.map_file_type            = m_mapFileType;
     cfg->m_GenDrill.zeros_format             = m_ZerosFormat;
@@ -343,6 +347,7 @@ void DIALOG_GENDRILL::UpdateDrillParams()
     m_Merge_PTH_NPTH = m_Check_Merge_PTH_NPTH->IsChecked();
     m_ZerosFormat = m_Choice_Zeros_Format->GetSelection();
     m_UseRouteModeForOvalHoles = m_radioBoxOvalHoleMode->GetSelection() == 0;
+    m_OptimizeDrillPath = m_checkOptimizeDrillPath->IsChecked();
 
     if( m_Choice_Drill_Offset->GetSelection() == 0 )
         m_FileDrillOffset = wxPoint( 0, 0 );
@@ -397,6 +402,7 @@ void DIALOG_GENDRILL::GenDrillAndMapFiles( bool aGenDrill, bool aGenMap )
                                   m_Precision.m_lhs, m_Precision.m_rhs );
         excellonWriter.SetOptions( m_Mirror, m_MinimalHeader, m_FileDrillOffset, m_Merge_PTH_NPTH );
         excellonWriter.SetRouteModeForOvalHoles( m_UseRouteModeForOvalHoles );
+        excellonWriter.SetDrillPathOptimization( m_OptimizeDrillPath );
         excellonWriter.SetMapFileFormat( filefmt[choice] );
 
         excellonWriter.CreateDrillandMapFilesSet( outputDir.GetFullPath(),
@@ -410,6 +416,7 @@ void DIALOG_GENDRILL::GenDrillAndMapFiles( bool aGenDrill, bool aGenMap )
         // the integer part precision is always 4, and units always mm
         gerberWriter.SetFormat( m_plotOpts.GetGerberPrecision() );
         gerberWriter.SetOptions( m_FileDrillOffset );
+        gerberWriter.SetDrillPathOptimization( m_OptimizeDrillPath );
         gerberWriter.SetMapFileFormat( filefmt[choice] );
 
         gerberWriter.CreateDrillandMapFilesSet( outputDir.GetFullPath(),
@@ -446,11 +453,13 @@ void DIALOG_GENDRILL::OnGenReportFile( wxCommandEvent& event )
     {
         EXCELLON_WRITER excellonWriter( m_board );
         excellonWriter.SetMergeOption( m_Merge_PTH_NPTH );
+        excellonWriter.SetDrillPathOptimization( m_OptimizeDrillPath );
         success = excellonWriter.GenDrillReportFile( dlg.GetPath() );
     }
     else
     {
         GERBER_WRITER gerberWriter( m_board );
+        gerberWriter.SetDrillPathOptimization( m_OptimizeDrillPath );
         success = gerberWriter.GenDrillReportFile( dlg.GetPath() );
     }
 
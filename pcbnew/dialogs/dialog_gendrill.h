@@ -54,6 +54,7 @@ public:
                                                  // or origin of the auxiliary axis
     static bool      m_UseRouteModeForOvalHoles; // True to use a G00 route command for oval holes
                                                  // False to use a G85 canned mode for oval holes
+    static bool      m_OptimizeDrillPath;        // True to sort the holes along a short path
 
 private:
     PCB_EDIT_FRAME*  m_pcbEditFrame;
@@ -136,6 +136,11 @@ DIALOG_GENDRILL_BASE::DIALOG_GENDRILL_BASE( wxWindow* parent, wxWindowID id, con
 
 	bLeftSizer->Add( fgSizer1, 0, wxEXPAND, 5 );
 
+	m_checkOptimizeDrillPath = new wxCheckBox( this, wxID_ANY, _("Optimize drill path"), wxDefaultPosition, wxDefaultSize, 0 );
+	m_checkOptimizeDrillPath->SetToolTip( _("Sort the holes of each tool to shorten the drill head travel.\nThe holes are otherwise sorted by footprint and by position.") );
+
+	bLeftSizer->Add( m_checkOptimizeDrillPath, 0, wxALL, 5 );
+
 
 	bmiddlerSizer->Add( bLeftSizer, 1, wxEXPAND, 5 );
 
@@ -56,6 +56,7 @@ class DIALOG_GENDRILL_BASE : public DIALOG_SHIM
 		wxRadioBox* m_Choice_Zeros_Format;
 		wxStaticText* m_staticTextTitle;
 		wxStaticText* m_staticTextPrecision;
+		wxCheckBox* m_checkOptimizeDrillPath;
 		wxStaticText* staticTextPlatedPads;
 		wxStaticText* m_PlatedPadsCountInfoMsg;
 		wxStaticText* staticTextNonPlatedPads;
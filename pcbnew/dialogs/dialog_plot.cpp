@@ -41,6 +41,7 @@
 #include <tool/tool_manager.h>
 #include <tools/zone_filler_tool.h>
 #include <math/util.h>      // for KiROUND
+#include <widgets/progress_reporter.h>
 
 
 DIALOG_PLOT::DIALOG_PLOT( PCB_EDIT_FRAME* aParent ) :
@@ -811,7 +812,8 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
     // Save the current plot options in the board
     m_parent->SetPlotSettings( m_plotOpts );
 
-    wxBusyCursor dummy;
+    wxBusyCursor          dummy;
+    std::vector<PLOT_JOB> jobs;
 
     for( LSEQ seq = m_plotOpts.GetLayerSelection().UIOrder();  seq;  ++seq )
     {
@@ -838,31 +840,35 @@ void DIALOG_PLOT::Plot( wxCommandEvent& event )
         wxString fullname = fn.GetFullName();
         jobfile_writer.AddGbrFile( layer, fullname );
 
-        LOCALE_IO toggle;
+        jobs.emplace_back( layer, m_plotOpts, fn.GetFullPath() );
+    }
+
+    // Each layer goes to its own file, so they are all plotted at once
+    {
+        WX_PROGRESS_REPORTER progressReporter( this, _( "Plotting" ), 1, false );
 
-        PLOTTER*    plotter = StartPlotBoard( board, &m_plotOpts, layer, fn.GetFullPath(), wxEmptyString );
+        PlotBoardLayers( board, jobs, 0, &progressReporter );
+    }
 
-        // Print diags in messages box:
+    // Print diags in messages box:
+    for( const PLOT_JOB& job : jobs )
+    {
         wxString msg;
 
-        if( plotter )
+        if( job.m_Success )
         {
-            PlotOneBoardLayer( board, plotter, layer, m_plotOpts );
-            plotter->EndPlot();
-            delete plotter;
-
-            msg.Printf( _( "Plot file \"%s\" created." ), fn.GetFullPath() );
+            msg.Printf( _( "Plot file \"%s\" created." ), job.m_FullFileName );
             reporter.Report( msg, RPT_SEVERITY_ACTION );
         }
         else
         {
-            msg.Printf( _( "Unable to create file \"%s\"." ), fn.GetFullPath() );
+            msg.Printf( _( "Unable to create file \"%s\"." ), job.m_FullFileName );
             reporter.Report( msg, RPT_SEVERITY_ERROR );
         }
-
-        wxSafeYield();      // displays report message.
     }
 
+    wxSafeYield();      // displays report message.
+
     if( m_plotOpts.GetFormat() == PLOT_FORMAT::GERBER && m_plotOpts.GetCreateGerberJobFile() )
     {
         // Pick the basename from the board file
@@ -24,10 +24,15 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <atomic>
 #include <cmath>
 #include <exception>
 #include <fstream>
+#include <future>
 #include <iomanip>
+#include <map>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <wx/dir.h>
 
@@ -62,15 +67,7 @@
 // offset for plating
 #define  PLATE_OFFSET 0.005
 
-static S3D_CACHE* cache;
-static bool USE_INLINES;            // true to use legacy inline{} behavior
-static bool USE_DEFS;               // true to reuse component definitions
-static bool USE_RELPATH;            // true to use relative paths in VRML inline{}
-static double WORLD_SCALE = 1.0;    // scaling from 0.1 in to desired VRML unit
-static double BOARD_SCALE;          // scaling from mm to desired VRML world scale
 static const int PRECISION = 6;     // legacy precision factor (now set to 6)
-static wxString SUBDIR_3D;          // legacy 3D subdirectory
-static wxString PROJ_DIR;           // project directory
 
 struct VRML_COLOR
 {
@@ -139,9 +136,6 @@ enum VRML_COLOR_INDEX
     VRML_COLOR_LAST
 };
 
-static VRML_COLOR colors[VRML_COLOR_LAST];
-static SGNODE* sgmaterial[VRML_COLOR_LAST] = { NULL };
-
 class MODEL_VRML
 {
 private:
@@ -176,8 +170,28 @@ public:
     LAYER_NUM m_text_layer;
     int m_text_width;
 
+    S3D_CACHE*  m_cache;
+    bool        m_useInlines;       // true to use legacy inline{} behavior
+    bool        m_reuseDefs;        // true to reuse component definitions
+    bool        m_useRelPaths;      // true to use relative paths in VRML inline{}
+    double      m_worldScale;       // scaling from 0.1 in to desired VRML unit
+    double      m_boardScale;       // scaling from mm to desired VRML world scale
+    wxString    m_subdir3D;         // legacy 3D subdirectory
+
+    VRML_COLOR  m_colors[VRML_COLOR_LAST];
+    SGNODE*     m_sgmaterial[VRML_COLOR_LAST];
+
+    // inline mode: the URLs of the 3D models already written to the 3D subdirectory, by
+    // model file name (empty if the model could not be written), and the DEF node names
+    // of the inline nodes, by URL
+    std::map<wxString, wxString> m_inlineFiles;
+    std::map<wxString, wxString> m_inlineDefs;
+
     MODEL_VRML() : m_OutputPCB( (SGNODE*) NULL )
     {
+        for( unsigned i = 0; i < arrayDim( m_sgmaterial );  ++i )
+            m_sgmaterial[i] = NULL;
+
         for( unsigned i = 0; i < arrayDim( m_layer_z );  ++i )
             m_layer_z[i] = 0;
 
@@ -187,16 +201,16 @@ public:
         m_brd_thickness = 1.6;
 
         // pcb green
-        colors[VRML_COLOR_PCB] = VRML_COLOR(
+        m_colors[VRML_COLOR_PCB] = VRML_COLOR(
                 0.07f, 0.3f, 0.12f, 0.01f, 0.03f, 0.01f, 0.0f, 0.0f, 0.0f, 0.8f, 0.0f, 0.02f );
         // track green
-        colors[VRML_COLOR_TRACK] = VRML_COLOR(
+        m_colors[VRML_COLOR_TRACK] = VRML_COLOR(
                 0.08f, 0.5f, 0.1f, 0.01f, 0.05f, 0.01f, 0.0f, 0.0f, 0.0f, 0.8f, 0.0f, 0.02f );
         // silkscreen white
-        colors[VRML_COLOR_SILK] = VRML_COLOR(
+        m_colors[VRML_COLOR_SILK] = VRML_COLOR(
                 0.9f, 0.9f, 0.9f, 0.1f, 0.1f, 0.1f, 0.0f, 0.0f, 0.0f, 0.9f, 0.0f, 0.02f );
         // pad silver
-        colors[VRML_COLOR_TIN] = VRML_COLOR( 0.749f, 0.756f, 0.761f, 0.749f, 0.756f, 0.761f, 0.0f,
+        m_colors[VRML_COLOR_TIN] = VRML_COLOR( 0.749f, 0.756f, 0.761f, 0.749f, 0.756f, 0.761f, 0.0f,
                 0.0f, 0.0f, 0.8f, 0.0f, 0.8f );
 
         m_plainPCB = false;
@@ -204,6 +218,13 @@ public:
         m_text_layer = F_Cu;
         m_text_width = 1;
         m_minLineWidth = MIN_VRML_LINEWIDTH;
+
+        m_cache = NULL;
+        m_useInlines = false;
+        m_reuseDefs = true;
+        m_useRelPaths = false;
+        m_worldScale = 1.0;
+        m_boardScale = MM_PER_IU;
     }
 
     ~MODEL_VRML()
@@ -211,10 +232,10 @@ public:
         // destroy any unassociated material appearances
         for( int j = 0; j < VRML_COLOR_LAST; ++j )
         {
-            if( sgmaterial[j] && NULL == S3D::GetSGNodeParent( sgmaterial[j] ) )
-                S3D::DestroyNode( sgmaterial[j] );
+            if( m_sgmaterial[j] && NULL == S3D::GetSGNodeParent( m_sgmaterial[j] ) )
+                S3D::DestroyNode( m_sgmaterial[j] );
 
-            sgmaterial[j] = NULL;
+            m_sgmaterial[j] = NULL;
         }
 
         if( !m_components.empty() )
@@ -234,7 +255,7 @@ public:
 
     VRML_COLOR& GetColor( VRML_COLOR_INDEX aIndex )
     {
-        return colors[aIndex];
+        return m_colors[aIndex];
     }
 
     void SetOffset( double aXoff, double aYoff )
@@ -273,7 +294,7 @@ public:
             throw( std::runtime_error( "WorldScale out of range (valid range is 0.001 to 10.0)" ) );
 
         m_OutputPCB.SetScale( aWorldScale * 2.54 );
-        WORLD_SCALE = aWorldScale * 2.54;
+        m_worldScale = aWorldScale * 2.54;
 
         return true;
     }
@@ -281,10 +302,6 @@ public:
 };
 
 
-// static var. for dealing with text
-static MODEL_VRML* model_vrml;
-
-
 // select the VRML layer object to draw on; return true if
 // a layer has been selected.
 static bool GetLayer( MODEL_VRML& aModel, LAYER_NUM layer, VRML_LAYER** vlayer )
@@ -314,10 +331,10 @@ static bool GetLayer( MODEL_VRML& aModel, LAYER_NUM layer, VRML_LAYER** vlayer )
     return true;
 }
 
-static void create_vrml_shell( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX colorID,
+static void create_vrml_shell( MODEL_VRML& aModel, VRML_COLOR_INDEX colorID,
     VRML_LAYER* layer, double top_z, double bottom_z );
 
-static void create_vrml_plane( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX colorID,
+static void create_vrml_plane( MODEL_VRML& aModel, VRML_COLOR_INDEX colorID,
     VRML_LAYER* layer, double aHeight, bool aTopPlane );
 
 static void write_triangle_bag( std::ostream& aOut_file, VRML_COLOR& aColor,
@@ -420,36 +437,112 @@ static void write_triangle_bag( std::ostream& aOut_file, VRML_COLOR& aColor,
 }
 
 
+/**
+ * Tesselate the board and the layers of \a aModel in parallel.
+ *
+ * The tesselation of a layer renumbers the vertices of the holes it is given, so each layer
+ * is given its own copy of the board holes, kept in \a aHoles until the layers are written.
+ */
+static void tesselate_layers( MODEL_VRML& aModel,
+                              std::vector<std::unique_ptr<VRML_LAYER>>& aHoles )
+{
+    std::vector<VRML_LAYER*> layers = { &aModel.m_board };
+
+    if( !aModel.m_plainPCB )
+    {
+        layers.insert( layers.end(), { &aModel.m_top_copper, &aModel.m_top_tin,
+                                       &aModel.m_bot_copper, &aModel.m_bot_tin,
+                                       &aModel.m_top_silk, &aModel.m_bot_silk } );
+    }
+
+    // The board itself uses the original holes
+    aHoles.clear();
+
+    for( size_t ii = 1; ii < layers.size(); ++ii )
+    {
+        aHoles.emplace_back( new VRML_LAYER );
+        aHoles.back()->CopyContours( aModel.m_holes );
+    }
+
+    // The plated holes are tesselated without holes, after the other layers
+    const size_t jobCount = aModel.m_plainPCB ? layers.size() : layers.size() + 1;
+
+    std::atomic<size_t> nextLayer( 0 );
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   jobCount );
+
+    auto tesselate_lambda = [&]() -> size_t
+    {
+        size_t num = 0;
+
+        for( size_t i = nextLayer++; i < jobCount; i = nextLayer++ )
+        {
+            if( i == layers.size() )
+                aModel.m_plated_holes.Tesselate( NULL, true );
+            else if( i == 0 )
+                layers[i]->Tesselate( &aModel.m_holes );
+            else
+                layers[i]->Tesselate( aHoles[i - 1].get() );
+
+            num++;
+        }
+
+        return num;
+    };
+
+    if( parallelThreadCount <= 1 )
+    {
+        tesselate_lambda();
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, tesselate_lambda );
+
+        // Finalize the threads
+        for( auto& ret : returns )
+            ret.wait();
+    }
+}
+
+
 static void write_layers( MODEL_VRML& aModel, BOARD* aPcb,
     const char* aFileName, OSTREAM* aOutputFile )
 {
+    std::vector<std::unique_ptr<VRML_LAYER>> holes;
+
+    tesselate_layers( aModel, holes );
+
+    // half of the offset of the art layers, in VRML units
+    const double art_offset = Millimeter2iu( ART_OFFSET / 2.0 ) * aModel.m_boardScale;
+
     // VRML_LAYER board;
-    aModel.m_board.Tesselate( &aModel.m_holes );
-    double brdz = aModel.m_brd_thickness / 2.0
-                  - ( Millimeter2iu( ART_OFFSET / 2.0 ) ) * BOARD_SCALE;
+    double brdz = aModel.m_brd_thickness / 2.0 - art_offset;
 
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_PCB ),
                             &aModel.m_board, false, false, brdz, -brdz );
     }
     else
     {
-        create_vrml_shell( aModel.m_OutputPCB, VRML_COLOR_PCB, &aModel.m_board, brdz, -brdz );
+        create_vrml_shell( aModel, VRML_COLOR_PCB, &aModel.m_board, brdz, -brdz );
     }
 
     if( aModel.m_plainPCB )
     {
-        if( !USE_INLINES )
-            S3D::WriteVRML( aFileName, true, aModel.m_OutputPCB.GetRawPtr(), USE_DEFS, true );
+        if( !aModel.m_useInlines )
+            S3D::WriteVRML( aFileName, true, aModel.m_OutputPCB.GetRawPtr(),
+                            aModel.m_reuseDefs, true );
 
         return;
     }
 
     // VRML_LAYER m_top_copper;
-    aModel.m_top_copper.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_TRACK ),
                            &aModel.m_top_copper, true, true,
@@ -457,31 +550,27 @@ static void write_layers( MODEL_VRML& aModel, BOARD* aPcb,
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_TRACK, &aModel.m_top_copper,
+        create_vrml_plane( aModel, VRML_COLOR_TRACK, &aModel.m_top_copper,
                            aModel.GetLayerZ( F_Cu ), true );
     }
 
     // VRML_LAYER m_top_tin;
-    aModel.m_top_tin.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_TIN ),
                             &aModel.m_top_tin, true, true,
-                            aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
+                            aModel.GetLayerZ( F_Cu ) + art_offset,
                             0 );
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_TIN, &aModel.m_top_tin,
-                           aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
+        create_vrml_plane( aModel, VRML_COLOR_TIN, &aModel.m_top_tin,
+                           aModel.GetLayerZ( F_Cu ) + art_offset,
                            true );
     }
 
     // VRML_LAYER m_bot_copper;
-    aModel.m_bot_copper.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_TRACK ),
                             &aModel.m_bot_copper, true, false,
@@ -489,75 +578,68 @@ static void write_layers( MODEL_VRML& aModel, BOARD* aPcb,
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_TRACK, &aModel.m_bot_copper,
+        create_vrml_plane( aModel, VRML_COLOR_TRACK, &aModel.m_bot_copper,
                            aModel.GetLayerZ( B_Cu ), false );
     }
 
     // VRML_LAYER m_bot_tin;
-    aModel.m_bot_tin.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_TIN ),
                             &aModel.m_bot_tin, true, false,
                             aModel.GetLayerZ( B_Cu )
-                            - Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
+                            - art_offset,
                             0 );
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_TIN, &aModel.m_bot_tin,
-                           aModel.GetLayerZ( B_Cu ) - Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
+        create_vrml_plane( aModel, VRML_COLOR_TIN, &aModel.m_bot_tin,
+                           aModel.GetLayerZ( B_Cu ) - art_offset,
                            false );
     }
 
     // VRML_LAYER PTH;
-    aModel.m_plated_holes.Tesselate( NULL, true );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_TIN ),
                             &aModel.m_plated_holes, false, false,
-                            aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
-                            aModel.GetLayerZ( B_Cu ) - Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE );
+                            aModel.GetLayerZ( F_Cu ) + art_offset,
+                            aModel.GetLayerZ( B_Cu ) - art_offset );
     }
     else
     {
-        create_vrml_shell( aModel.m_OutputPCB, VRML_COLOR_TIN, &aModel.m_plated_holes,
-                           aModel.GetLayerZ( F_Cu ) + Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE,
-                           aModel.GetLayerZ( B_Cu ) - Millimeter2iu( ART_OFFSET / 2.0 ) * BOARD_SCALE );
+        create_vrml_shell( aModel, VRML_COLOR_TIN, &aModel.m_plated_holes,
+                           aModel.GetLayerZ( F_Cu ) + art_offset,
+                           aModel.GetLayerZ( B_Cu ) - art_offset );
     }
 
     // VRML_LAYER m_top_silk;
-    aModel.m_top_silk.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_SILK ), &aModel.m_top_silk,
                             true, true, aModel.GetLayerZ( F_SilkS ), 0 );
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_SILK, &aModel.m_top_silk,
+        create_vrml_plane( aModel, VRML_COLOR_SILK, &aModel.m_top_silk,
                            aModel.GetLayerZ( F_SilkS ), true );
     }
 
     // VRML_LAYER m_bot_silk;
-    aModel.m_bot_silk.Tesselate( &aModel.m_holes );
-
-    if( USE_INLINES )
+    if( aModel.m_useInlines )
     {
         write_triangle_bag( *aOutputFile, aModel.GetColor( VRML_COLOR_SILK ), &aModel.m_bot_silk,
                             true, false, aModel.GetLayerZ( B_SilkS ), 0 );
     }
     else
     {
-        create_vrml_plane( aModel.m_OutputPCB, VRML_COLOR_SILK, &aModel.m_bot_silk,
+        create_vrml_plane( aModel, VRML_COLOR_SILK, &aModel.m_bot_silk,
                            aModel.GetLayerZ( B_SilkS ), false );
     }
 
-    if( !USE_INLINES )
-        S3D::WriteVRML( aFileName, true, aModel.m_OutputPCB.GetRawPtr(), true, true );
+    if( !aModel.m_useInlines )
+        S3D::WriteVRML( aFileName, true, aModel.m_OutputPCB.GetRawPtr(), aModel.m_reuseDefs,
+                        true );
 }
 
 
@@ -566,7 +648,7 @@ static void compute_layer_Zs( MODEL_VRML& aModel, BOARD* pcb )
     int copper_layers = pcb->GetCopperLayerCount();
 
     // We call it 'layer' thickness, but it's the whole board thickness!
-    aModel.m_brd_thickness = pcb->GetDesignSettings().GetBoardThickness() * BOARD_SCALE;
+    aModel.m_brd_thickness = pcb->GetDesignSettings().GetBoardThickness() * aModel.m_boardScale;
     double half_thickness = aModel.m_brd_thickness / 2;
 
     // Compute each layer's Z value, more or less like the 3d view
@@ -582,7 +664,7 @@ static void compute_layer_Zs( MODEL_VRML& aModel, BOARD* pcb )
 
     /* To avoid rounding interference, we apply an epsilon to each
      * successive layer */
-    double epsilon_z = Millimeter2iu( ART_OFFSET ) * BOARD_SCALE;
+    double epsilon_z = Millimeter2iu( ART_OFFSET ) * aModel.m_boardScale;
     aModel.SetLayerZ( B_Paste, -half_thickness - epsilon_z * 4 );
     aModel.SetLayerZ( B_Adhes, -half_thickness - epsilon_z * 3 );
     aModel.SetLayerZ( B_SilkS, -half_thickness - epsilon_z * 2 );
@@ -704,8 +786,8 @@ static void export_vrml_polygon( MODEL_VRML& aModel, LAYER_NUM layer,
 
         for( int j = 0; j < outline.PointCount(); j++ )
         {
-            if( !vlayer->AddVertex( seg, outline.CPoint( j ).x * BOARD_SCALE,
-                                     -outline.CPoint( j ).y * BOARD_SCALE ) )
+            if( !vlayer->AddVertex( seg, outline.CPoint( j ).x * aModel.m_boardScale,
+                                     -outline.CPoint( j ).y * aModel.m_boardScale ) )
                 throw( std::runtime_error( vlayer->GetError() ) );
         }
 
@@ -717,11 +799,11 @@ static void export_vrml_polygon( MODEL_VRML& aModel, LAYER_NUM layer,
 static void export_vrml_drawsegment( MODEL_VRML& aModel, DRAWSEGMENT* drawseg )
 {
     LAYER_NUM layer = drawseg->GetLayer();
-    double  w   = drawseg->GetWidth() * BOARD_SCALE;
-    double  x   = drawseg->GetStart().x * BOARD_SCALE;
-    double  y   = drawseg->GetStart().y * BOARD_SCALE;
-    double  xf  = drawseg->GetEnd().x * BOARD_SCALE;
-    double  yf  = drawseg->GetEnd().y * BOARD_SCALE;
+    double  w   = drawseg->GetWidth() * aModel.m_boardScale;
+    double  x   = drawseg->GetStart().x * aModel.m_boardScale;
+    double  y   = drawseg->GetStart().y * aModel.m_boardScale;
+    double  xf  = drawseg->GetEnd().x * aModel.m_boardScale;
+    double  yf  = drawseg->GetEnd().y * aModel.m_boardScale;
     double  r   = sqrt( pow( x - xf, 2 ) + pow( y - yf, 2 ) );
 
     // Items on the edge layer are handled elsewhere; just return
@@ -732,10 +814,10 @@ static void export_vrml_drawsegment( MODEL_VRML& aModel, DRAWSEGMENT* drawseg )
     {
     case S_ARC:
         export_vrml_arc( aModel, layer,
-                         (double) drawseg->GetCenter().x * BOARD_SCALE,
-                         (double) drawseg->GetCenter().y * BOARD_SCALE,
-                         (double) drawseg->GetArcStart().x * BOARD_SCALE,
-                         (double) drawseg->GetArcStart().y * BOARD_SCALE,
+                         (double) drawseg->GetCenter().x * aModel.m_boardScale,
+                         (double) drawseg->GetCenter().y * aModel.m_boardScale,
+                         (double) drawseg->GetArcStart().x * aModel.m_boardScale,
+                         (double) drawseg->GetArcStart().y * aModel.m_boardScale,
                          w, drawseg->GetAngle() / 10 );
         break;
 
@@ -757,24 +839,25 @@ static void export_vrml_drawsegment( MODEL_VRML& aModel, DRAWSEGMENT* drawseg )
 }
 
 
-/* C++ doesn't have closures and neither continuation forms... this is
- * for coupling the vrml_text_callback with the common parameters */
+/* C++ doesn't have closures and neither continuation forms... the model
+ * is passed to vrml_text_callback as its data, with the common parameters */
 static void vrml_text_callback( int x0, int y0, int xf, int yf, void* aData )
 {
-    LAYER_NUM m_text_layer = model_vrml->m_text_layer;
-    int m_text_width = model_vrml->m_text_width;
-
-    export_vrml_line( *model_vrml, m_text_layer,
-                      x0 * BOARD_SCALE, y0 * BOARD_SCALE,
-                      xf * BOARD_SCALE, yf * BOARD_SCALE,
-                      m_text_width * BOARD_SCALE );
+    MODEL_VRML& model = *static_cast<MODEL_VRML*>( aData );
+    LAYER_NUM m_text_layer = model.m_text_layer;
+    int m_text_width = model.m_text_width;
+
+    export_vrml_line( model, m_text_layer,
+                      x0 * model.m_boardScale, y0 * model.m_boardScale,
+                      xf * model.m_boardScale, yf * model.m_boardScale,
+                      m_text_width * model.m_boardScale );
 }
 
 
 static void export_vrml_pcbtext( MODEL_VRML& aModel, TEXTE_PCB* text )
 {
-    model_vrml->m_text_layer    = text->GetLayer();
-    model_vrml->m_text_width    = text->GetThickness();
+    aModel.m_text_layer    = text->GetLayer();
+    aModel.m_text_width    = text->GetThickness();
 
     wxSize size = text->GetTextSize();
 
@@ -796,14 +879,14 @@ static void export_vrml_pcbtext( MODEL_VRML& aModel, TEXTE_PCB* text )
             wxString& txt = strings_list.Item( ii );
             GRText( NULL, positions[ii], color, txt, text->GetTextAngle(), size,
                     text->GetHorizJustify(), text->GetVertJustify(), text->GetThickness(),
-                    text->IsItalic(), true, vrml_text_callback );
+                    text->IsItalic(), true, vrml_text_callback, &aModel );
         }
     }
     else
     {
         GRText( NULL, text->GetTextPos(), color, text->GetShownText(), text->GetTextAngle(),
                 size, text->GetHorizJustify(), text->GetVertJustify(), text->GetThickness(),
-                text->IsItalic(), true, vrml_text_callback );
+                text->IsItalic(), true, vrml_text_callback, &aModel );
     }
 }
 
@@ -858,8 +941,8 @@ static void export_vrml_board( MODEL_VRML& aModel, BOARD* aPcb )
 
         for( int j = 0; j < outline.PointCount(); j++ )
         {
-            aModel.m_board.AddVertex( seg, (double)outline.CPoint(j).x * BOARD_SCALE,
-                                        -((double)outline.CPoint(j).y * BOARD_SCALE ) );
+            aModel.m_board.AddVertex( seg, (double)outline.CPoint(j).x * aModel.m_boardScale,
+                                        -((double)outline.CPoint(j).y * aModel.m_boardScale ) );
 
         }
 
@@ -883,8 +966,8 @@ static void export_vrml_board( MODEL_VRML& aModel, BOARD* aPcb )
 
             for( int j = 0; j < hole.PointCount(); j++ )
             {
-                aModel.m_holes.AddVertex( seg, (double)hole.CPoint(j).x * BOARD_SCALE,
-                                          -((double)hole.CPoint(j).y * BOARD_SCALE ) );
+                aModel.m_holes.AddVertex( seg, (double)hole.CPoint(j).x * aModel.m_boardScale,
+                                          -((double)hole.CPoint(j).y * aModel.m_boardScale ) );
 
             }
 
@@ -944,10 +1027,10 @@ static void export_vrml_via( MODEL_VRML& aModel, BOARD* aPcb, const VIA* aVia )
     double      x, y, r, hole;
     PCB_LAYER_ID    top_layer, bottom_layer;
 
-    hole = aVia->GetDrillValue() * BOARD_SCALE / 2.0;
-    r   = aVia->GetWidth() * BOARD_SCALE / 2.0;
-    x   = aVia->GetStart().x * BOARD_SCALE;
-    y   = aVia->GetStart().y * BOARD_SCALE;
+    hole = aVia->GetDrillValue() * aModel.m_boardScale / 2.0;
+    r   = aVia->GetWidth() * aModel.m_boardScale / 2.0;
+    x   = aVia->GetStart().x * aModel.m_boardScale;
+    y   = aVia->GetStart().y * aModel.m_boardScale;
     aVia->LayerPair( &top_layer, &bottom_layer );
 
     // do not render a buried via
@@ -970,11 +1053,11 @@ static void export_vrml_tracks( MODEL_VRML& aModel, BOARD* pcb )
         else if( ( track->GetLayer() == B_Cu || track->GetLayer() == F_Cu )
                    && !aModel.m_plainPCB )
             export_vrml_line( aModel, track->GetLayer(),
-                              track->GetStart().x * BOARD_SCALE,
-                              track->GetStart().y * BOARD_SCALE,
-                              track->GetEnd().x * BOARD_SCALE,
-                              track->GetEnd().y * BOARD_SCALE,
-                              track->GetWidth() * BOARD_SCALE );
+                              track->GetStart().x * aModel.m_boardScale,
+                              track->GetStart().y * aModel.m_boardScale,
+                              track->GetEnd().x * aModel.m_boardScale,
+                              track->GetEnd().y * aModel.m_boardScale,
+                              track->GetWidth() * aModel.m_boardScale );
     }
 }
 
@@ -1010,8 +1093,8 @@ static void export_vrml_zones( MODEL_VRML& aModel, BOARD* aPcb )
 
             for( int j = 0; j < outline.PointCount(); j++ )
             {
-                if( !vl->AddVertex( seg, (double)outline.CPoint( j ).x * BOARD_SCALE,
-                                         -((double)outline.CPoint( j ).y * BOARD_SCALE ) ) )
+                if( !vl->AddVertex( seg, (double)outline.CPoint( j ).x * aModel.m_boardScale,
+                                         -((double)outline.CPoint( j ).y * aModel.m_boardScale ) ) )
                     throw( std::runtime_error( vl->GetError() ) );
 
             }
@@ -1022,7 +1105,7 @@ static void export_vrml_zones( MODEL_VRML& aModel, BOARD* aPcb )
 }
 
 
-static void export_vrml_text_module( TEXTE_MODULE* item )
+static void export_vrml_text_module( MODEL_VRML& aModel, TEXTE_MODULE* item )
 {
     if( item->IsVisible() )
     {
@@ -1031,12 +1114,12 @@ static void export_vrml_text_module( TEXTE_MODULE* item )
         if( item->IsMirrored() )
             size.x = -size.x;  // Text is mirrored
 
-        model_vrml->m_text_layer = item->GetLayer();
-        model_vrml->m_text_width = item->GetThickness();
+        aModel.m_text_layer = item->GetLayer();
+        aModel.m_text_width = item->GetThickness();
 
         GRText( NULL, item->GetTextPos(), BLACK, item->GetShownText(), item->GetDrawRotation(),
                 size, item->GetHorizJustify(), item->GetVertJustify(), item->GetThickness(),
-                item->IsItalic(), true, vrml_text_callback );
+                item->IsItalic(), true, vrml_text_callback, &aModel );
     }
 }
 
@@ -1045,11 +1128,11 @@ static void export_vrml_edge_module( MODEL_VRML& aModel, EDGE_MODULE* aOutline,
                                      MODULE* aModule )
 {
     LAYER_NUM layer = aOutline->GetLayer();
-    double  x   = aOutline->GetStart().x * BOARD_SCALE;
-    double  y   = aOutline->GetStart().y * BOARD_SCALE;
-    double  xf  = aOutline->GetEnd().x * BOARD_SCALE;
-    double  yf  = aOutline->GetEnd().y * BOARD_SCALE;
-    double  w   = aOutline->GetWidth() * BOARD_SCALE;
+    double  x   = aOutline->GetStart().x * aModel.m_boardScale;
+    double  y   = aOutline->GetStart().y * aModel.m_boardScale;
+    double  xf  = aOutline->GetEnd().x * aModel.m_boardScale;
+    double  yf  = aOutline->GetEnd().y * aModel.m_boardScale;
+    double  w   = aOutline->GetWidth() * aModel.m_boardScale;
 
     switch( aOutline->GetShape() )
     {
@@ -1080,15 +1163,15 @@ static void export_vrml_padshape( MODEL_VRML& aModel, VRML_LAYER* aTinLayer, D_P
 {
     // The (maybe offset) pad position
     wxPoint pad_pos = aPad->ShapePos();
-    double  pad_x   = pad_pos.x * BOARD_SCALE;
-    double  pad_y   = pad_pos.y * BOARD_SCALE;
+    double  pad_x   = pad_pos.x * aModel.m_boardScale;
+    double  pad_y   = pad_pos.y * aModel.m_boardScale;
     wxSize  pad_delta = aPad->GetDelta();
 
-    double  pad_dx  = pad_delta.x * BOARD_SCALE / 2.0;
-    double  pad_dy  = pad_delta.y * BOARD_SCALE / 2.0;
+    double  pad_dx  = pad_delta.x * aModel.m_boardScale / 2.0;
+    double  pad_dy  = pad_delta.y * aModel.m_boardScale / 2.0;
 
-    double  pad_w   = aPad->GetSize().x * BOARD_SCALE / 2.0;
-    double  pad_h   = aPad->GetSize().y * BOARD_SCALE / 2.0;
+    double  pad_w   = aPad->GetSize().x * aModel.m_boardScale / 2.0;
+    double  pad_h   = aPad->GetSize().y * aModel.m_boardScale / 2.0;
 
     switch( aPad->GetShape() )
     {
@@ -1120,8 +1203,8 @@ static void export_vrml_padshape( MODEL_VRML& aModel, VRML_LAYER* aTinLayer, D_P
 
         cornerList.reserve( poly.PointCount() );
         for( int ii = 0; ii < poly.PointCount(); ++ii )
-            cornerList.emplace_back(
-                    poly.CPoint( ii ).x * BOARD_SCALE, -poly.CPoint( ii ).y * BOARD_SCALE );
+            cornerList.emplace_back( poly.CPoint( ii ).x * aModel.m_boardScale,
+                                     -poly.CPoint( ii ).y * aModel.m_boardScale );
 
         // Close polygon
         cornerList.push_back( cornerList[0] );
@@ -1143,8 +1226,8 @@ static void export_vrml_padshape( MODEL_VRML& aModel, VRML_LAYER* aTinLayer, D_P
             cornerList.clear();
 
             for( int ii = 0; ii < poly.PointCount(); ++ii )
-                cornerList.emplace_back(
-                        poly.CPoint( ii ).x * BOARD_SCALE, -poly.CPoint( ii ).y * BOARD_SCALE );
+                cornerList.emplace_back( poly.CPoint( ii ).x * aModel.m_boardScale,
+                                         -poly.CPoint( ii ).y * aModel.m_boardScale );
 
             // Close polygon
             cornerList.push_back( cornerList[0] );
@@ -1210,11 +1293,11 @@ static void export_vrml_padshape( MODEL_VRML& aModel, VRML_LAYER* aTinLayer, D_P
 
 static void export_vrml_pad( MODEL_VRML& aModel, BOARD* aPcb, D_PAD* aPad )
 {
-    double  hole_drill_w    = (double) aPad->GetDrillSize().x * BOARD_SCALE / 2.0;
-    double  hole_drill_h    = (double) aPad->GetDrillSize().y * BOARD_SCALE / 2.0;
+    double  hole_drill_w    = (double) aPad->GetDrillSize().x * aModel.m_boardScale / 2.0;
+    double  hole_drill_h    = (double) aPad->GetDrillSize().y * aModel.m_boardScale / 2.0;
     double  hole_drill      = std::min( hole_drill_w, hole_drill_h );
-    double  hole_x          = aPad->GetPosition().x * BOARD_SCALE;
-    double  hole_y          = aPad->GetPosition().y * BOARD_SCALE;
+    double  hole_x          = aPad->GetPosition().x * aModel.m_boardScale;
+    double  hole_y          = aPad->GetPosition().y * aModel.m_boardScale;
 
     // Export the hole on the edge layer
     if( hole_drill > 0 )
@@ -1328,6 +1411,76 @@ static void compose_quat( double q1[4], double q2[4], double qr[4] )
 }
 
 
+/**
+ * Copy or translate the 3D model \a aFileName to the 3D subdirectory, once per export.
+ *
+ * @return the URL of the model file to use in inline nodes, or an empty string if the
+ *         model could not be written.
+ */
+static wxString inline_model_file( MODEL_VRML& aModel, const wxString& aFileName,
+                                   SGNODE* aModel3D )
+{
+    auto cached = aModel.m_inlineFiles.find( aFileName );
+
+    if( cached != aModel.m_inlineFiles.end() )
+        return cached->second;
+
+    wxString&  url = aModel.m_inlineFiles[aFileName];
+    wxFileName srcFile = aModel.m_cache->GetResolver()->ResolvePath( aFileName );
+    wxFileName dstFile;
+    dstFile.SetPath( aModel.m_subdir3D );
+    dstFile.SetName( srcFile.GetName() );
+    dstFile.SetExt( "wrl"  );
+
+    // copy the file if necessary
+    wxDateTime srcModTime = srcFile.GetModificationTime();
+    wxDateTime destModTime = srcModTime;
+
+    destModTime.SetToCurrent();
+
+    if( dstFile.FileExists() )
+        destModTime = dstFile.GetModificationTime();
+
+    if( srcModTime != destModTime )
+    {
+        wxLogDebug( "Copying 3D model %s to %s.",
+                    GetChars( srcFile.GetFullPath() ),
+                    GetChars( dstFile.GetFullPath() ) );
+
+        wxString fileExt = srcFile.GetExt();
+        fileExt.LowerCase();
+
+        // copy VRML models and use the scenegraph library to
+        // translate other model types
+        if( fileExt == "wrl" )
+        {
+            if( !wxCopyFile( srcFile.GetFullPath(), dstFile.GetFullPath() ) )
+                return url;
+        }
+        else
+        {
+            if( !S3D::WriteVRML( dstFile.GetFullPath().ToUTF8(), true, aModel3D,
+                                 aModel.m_reuseDefs, true ) )
+                return url;
+        }
+    }
+
+    if( aModel.m_useRelPaths )
+    {
+        wxFileName tmp = dstFile;
+        tmp.SetExt( "" );
+        tmp.SetName( "" );
+        tmp.RemoveLastDir();
+        dstFile.MakeRelativeTo( tmp.GetPath() );
+    }
+
+    url = dstFile.GetFullPath();
+    url.Replace( "\\", "/" );
+
+    return url;
+}
+
+
 static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
     MODULE* aModule, std::ostream* aOutputFile )
 {
@@ -1335,10 +1488,10 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
     {
         // Reference and value
         if( aModule->Reference().IsVisible() )
-            export_vrml_text_module( &aModule->Reference() );
+            export_vrml_text_module( aModel, &aModule->Reference() );
 
         if( aModule->Value().IsVisible() )
-            export_vrml_text_module( &aModule->Value() );
+            export_vrml_text_module( aModel, &aModule->Value() );
 
         // Export module edges
 
@@ -1347,7 +1500,7 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
             switch( item->Type() )
             {
                 case PCB_MODULE_TEXT_T:
-                    export_vrml_text_module( static_cast<TEXTE_MODULE*>( item ) );
+                    export_vrml_text_module( aModel, static_cast<TEXTE_MODULE*>( item ) );
                     break;
 
                 case PCB_MODULE_EDGE_T:
@@ -1371,11 +1524,9 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
     auto sM = aModule->Models().begin();
     auto eM = aModule->Models().end();
 
-    wxFileName subdir( SUBDIR_3D, "" );
-
     while( sM != eM )
     {
-        SGNODE* mod3d = (SGNODE*) cache->Load( sM->m_Filename );
+        SGNODE* mod3d = (SGNODE*) aModel.m_cache->Load( sM->m_Filename );
 
         if( NULL == mod3d )
         {
@@ -1429,48 +1580,18 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
         RotatePoint( &offsetx, &offsety, aModule->GetOrientation() );
 
         SGPOINT trans;
-        trans.x = ( offsetx + aModule->GetPosition().x ) * BOARD_SCALE + aModel.m_tx;
-        trans.y = -(offsety + aModule->GetPosition().y) * BOARD_SCALE - aModel.m_ty;
-        trans.z = (offsetz * BOARD_SCALE ) + aModel.GetLayerZ( aModule->GetLayer() );
+        trans.x = ( offsetx + aModule->GetPosition().x ) * aModel.m_boardScale + aModel.m_tx;
+        trans.y = -(offsety + aModule->GetPosition().y) * aModel.m_boardScale - aModel.m_ty;
+        trans.z = (offsetz * aModel.m_boardScale ) + aModel.GetLayerZ( aModule->GetLayer() );
 
-        if( USE_INLINES )
+        if( aModel.m_useInlines )
         {
-            wxFileName srcFile = cache->GetResolver()->ResolvePath( sM->m_Filename );
-            wxFileName dstFile;
-            dstFile.SetPath( SUBDIR_3D );
-            dstFile.SetName( srcFile.GetName() );
-            dstFile.SetExt( "wrl"  );
-
-            // copy the file if necessary
-            wxDateTime srcModTime = srcFile.GetModificationTime();
-            wxDateTime destModTime = srcModTime;
+            wxString fn = inline_model_file( aModel, sM->m_Filename, mod3d );
 
-            destModTime.SetToCurrent();
-
-            if( dstFile.FileExists() )
-                destModTime = dstFile.GetModificationTime();
-
-            if( srcModTime != destModTime )
+            if( fn.IsEmpty() )
             {
-                wxLogDebug( "Copying 3D model %s to %s.",
-                            GetChars( srcFile.GetFullPath() ),
-                            GetChars( dstFile.GetFullPath() ) );
-
-                wxString fileExt = srcFile.GetExt();
-                fileExt.LowerCase();
-
-                // copy VRML models and use the scenegraph library to
-                // translate other model types
-                if( fileExt == "wrl" )
-                {
-                    if( !wxCopyFile( srcFile.GetFullPath(), dstFile.GetFullPath() ) )
-                        continue;
-                }
-                else
-                {
-                    if( !S3D::WriteVRML( dstFile.GetFullPath().ToUTF8(), true, mod3d, USE_DEFS, true ) )
-                        continue;
-                }
+                ++sM;
+                continue;
             }
 
             (*aOutputFile) << "Transform {\n";
@@ -1492,20 +1613,29 @@ static void export_vrml_module( MODEL_VRML& aModel, BOARD* aPcb,
             (*aOutputFile) << sM->m_Scale.y << " ";
             (*aOutputFile) << sM->m_Scale.z << "\n";
 
-            (*aOutputFile) << "  children [\n    Inline {\n      url \"";
+            // the first instance of a model defines its inline node, the others reuse it
+            auto def = aModel.m_inlineDefs.find( fn );
 
-            if( USE_RELPATH )
+            if( aModel.m_reuseDefs && def != aModel.m_inlineDefs.end() )
+            {
+                (*aOutputFile) << "  children [\n    USE " << TO_UTF8( def->second ) << " ]\n";
+            }
+            else
             {
-                wxFileName tmp = dstFile;
-                tmp.SetExt( "" );
-                tmp.SetName( "" );
-                tmp.RemoveLastDir();
-                dstFile.MakeRelativeTo( tmp.GetPath() );
+                (*aOutputFile) << "  children [\n    ";
+
+                if( aModel.m_reuseDefs )
+                {
+                    wxString name = wxString::Format( "MODEL_%u",
+                                                      (unsigned) aModel.m_inlineDefs.size() );
+                    aModel.m_inlineDefs[fn] = name;
+                    (*aOutputFile) << "DEF " << TO_UTF8( name ) << " ";
+                }
+
+                (*aOutputFile) << "Inline {\n      url \"";
+                (*aOutputFile) << TO_UTF8( fn ) << "\"\n    } ]\n";
             }
 
-            wxString fn = dstFile.GetFullPath();
-            fn.Replace( "\\", "/" );
-            (*aOutputFile) << TO_UTF8( fn ) << "\"\n    } ]\n";
             (*aOutputFile) << "  }\n";
         }
         else
@@ -1544,25 +1674,23 @@ bool PCB_EDIT_FRAME::ExportVRML_File( const wxString& aFullFileName, double aMMt
     BOARD*          pcb = GetBoard();
     bool            ok  = true;
 
-    USE_INLINES = aExport3DFiles;
-    USE_DEFS = true;
-    USE_RELPATH = aUseRelativePaths;
-
-    cache = Prj().Get3DCacheManager();
-    PROJ_DIR = Prj().GetProjectPath();
-    SUBDIR_3D = a3D_Subdir;
     MODEL_VRML model3d;
-    model_vrml = &model3d;
+
+    model3d.m_useInlines = aExport3DFiles;
+    model3d.m_reuseDefs = true;
+    model3d.m_useRelPaths = aUseRelativePaths;
+    model3d.m_cache = Prj().Get3DCacheManager();
+    model3d.m_subdir3D = a3D_Subdir;
     model3d.SetScale( aMMtoWRMLunit );
 
-    if( USE_INLINES )
+    if( model3d.m_useInlines )
     {
-        BOARD_SCALE = MM_PER_IU / 2.54;
+        model3d.m_boardScale = MM_PER_IU / 2.54;
         model3d.SetOffset( -aXRef / 2.54, aYRef / 2.54 );
     }
     else
     {
-        BOARD_SCALE = MM_PER_IU;
+        model3d.m_boardScale = MM_PER_IU;
         model3d.SetOffset( -aXRef, aYRef );
     }
 
@@ -1589,10 +1717,10 @@ bool PCB_EDIT_FRAME::ExportVRML_File( const wxString& aFullFileName, double aMMt
         if( !aUsePlainPCB )
             export_vrml_zones( model3d, pcb);
 
-        if( USE_INLINES )
+        if( model3d.m_useInlines )
         {
             // check if the 3D Subdir exists - create if not
-            wxFileName subdir( SUBDIR_3D, "" );
+            wxFileName subdir( model3d.m_subdir3D, "" );
 
             if( ! subdir.DirExists() )
             {
@@ -1620,9 +1748,9 @@ bool PCB_EDIT_FRAME::ExportVRML_File( const wxString& aFullFileName, double aMMt
             output_file << "}\n";
             output_file << "Transform {\n";
             output_file << "  scale " << std::setprecision( PRECISION );
-            output_file << WORLD_SCALE << " ";
-            output_file << WORLD_SCALE << " ";
-            output_file << WORLD_SCALE << "\n";
+            output_file << model3d.m_worldScale << " ";
+            output_file << model3d.m_worldScale << " ";
+            output_file << model3d.m_worldScale << "\n";
             output_file << "  children [\n";
 
             // Export footprints
@@ -1660,18 +1788,18 @@ bool PCB_EDIT_FRAME::ExportVRML_File( const wxString& aFullFileName, double aMMt
 }
 
 
-static SGNODE* getSGColor( VRML_COLOR_INDEX colorIdx )
+static SGNODE* getSGColor( MODEL_VRML& aModel, VRML_COLOR_INDEX colorIdx )
 {
     if( colorIdx == -1 )
         colorIdx = VRML_COLOR_PCB;
     else if( colorIdx == VRML_COLOR_LAST )
         return NULL;
 
-    if( sgmaterial[colorIdx] )
-        return sgmaterial[colorIdx];
+    if( aModel.m_sgmaterial[colorIdx] )
+        return aModel.m_sgmaterial[colorIdx];
 
     IFSG_APPEARANCE vcolor( (SGNODE*) NULL );
-    VRML_COLOR* cp = &colors[colorIdx];
+    VRML_COLOR* cp = &aModel.m_colors[colorIdx];
 
     vcolor.SetSpecular( cp->spec_red, cp->spec_grn, cp->spec_blu );
     vcolor.SetDiffuse( cp->diffuse_red, cp->diffuse_grn, cp->diffuse_blu );
@@ -1681,13 +1809,13 @@ static SGNODE* getSGColor( VRML_COLOR_INDEX colorIdx )
     vcolor.SetAmbient( cp->ambient, cp->ambient, cp->ambient );
     vcolor.SetTransparency( cp->transp );
 
-    sgmaterial[colorIdx] = vcolor.GetRawPtr();
+    aModel.m_sgmaterial[colorIdx] = vcolor.GetRawPtr();
 
-    return sgmaterial[colorIdx];
+    return aModel.m_sgmaterial[colorIdx];
 }
 
 
-static void create_vrml_plane( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX colorID,
+static void create_vrml_plane( MODEL_VRML& aModel, VRML_COLOR_INDEX colorID,
     VRML_LAYER* layer, double top_z, bool aTopPlane )
 {
     std::vector< double > vertices;
@@ -1729,7 +1857,7 @@ static void create_vrml_plane( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX color
         vlist.emplace_back( vertices[j], vertices[j+1], vertices[j+2] );
 
     // create the intermediate scenegraph
-    IFSG_TRANSFORM tx0( PcbOutput.GetRawPtr() );    // tx0 = Transform for this outline
+    IFSG_TRANSFORM tx0( aModel.m_OutputPCB.GetRawPtr() );    // tx0 = Transform for this outline
     IFSG_SHAPE shape( tx0 );            // shape will hold (a) all vertices and (b) a local list of normals
     IFSG_FACESET face( shape );         // this face shall represent the top and bottom planes
     IFSG_COORDS cp( face );             // coordinates for all faces
@@ -1751,7 +1879,7 @@ static void create_vrml_plane( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX color
     }
 
     // assign a color from the palette
-    SGNODE* modelColor = getSGColor( colorID );
+    SGNODE* modelColor = getSGColor( aModel, colorID );
 
     if( NULL != modelColor )
     {
@@ -1765,7 +1893,7 @@ static void create_vrml_plane( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX color
 }
 
 
-static void create_vrml_shell( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX colorID,
+static void create_vrml_shell( MODEL_VRML& aModel, VRML_COLOR_INDEX colorID,
     VRML_LAYER* layer, double top_z, double bottom_z )
 {
     std::vector< double > vertices;
@@ -1816,7 +1944,7 @@ static void create_vrml_shell( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX color
         vlist.emplace_back( vertices[j], vertices[j+1], vertices[j+2] );
 
     // create the intermediate scenegraph
-    IFSG_TRANSFORM tx0( PcbOutput.GetRawPtr() );    // tx0 = Transform for this outline
+    IFSG_TRANSFORM tx0( aModel.m_OutputPCB.GetRawPtr() );    // tx0 = Transform for this outline
     IFSG_SHAPE shape( tx0 );            // shape will hold (a) all vertices and (b) a local list of normals
     IFSG_FACESET face( shape );         // this face shall represent the top and bottom planes
     IFSG_COORDS cp( face );             // coordinates for all faces
@@ -1837,7 +1965,7 @@ static void create_vrml_shell( IFSG_TRANSFORM& PcbOutput, VRML_COLOR_INDEX color
         norms.AddNormal( 0.0, 0.0, -1.0 );
 
     // assign a color from the palette
-    SGNODE* modelColor = getSGColor( colorID );
+    SGNODE* modelColor = getSGColor( aModel, colorID );
 
     if( NULL != modelColor )
     {
@@ -346,6 +346,7 @@ bool GENDRILL_WRITER_BASE::GenDrillReportFile( const wxString& aFullFileName )
             out.Print( 0, separator );
             totalHoleCount = printToolSummary( out, false );
             out.Print( 0, "    Total plated holes count %u\n", totalHoleCount );
+            out.Print( 0, "    Drill path length %.1f mm\n", getDrillPathLength() / IU_PER_MM );
         }
         else    // blind/buried
         {
@@ -361,6 +362,7 @@ bool GENDRILL_WRITER_BASE::GenDrillReportFile( const wxString& aFullFileName )
             out.Print( 0, separator );
             totalHoleCount = printToolSummary( out, false );
             out.Print( 0, "    Total plated holes count %u\n", totalHoleCount );
+            out.Print( 0, "    Drill path length %.1f mm\n", getDrillPathLength() / IU_PER_MM );
         }
 
         out.Print( 0, "\n\n" );
@@ -385,6 +387,7 @@ bool GENDRILL_WRITER_BASE::GenDrillReportFile( const wxString& aFullFileName )
     out.Print( 0, separator );
     totalHoleCount = printToolSummary( out, true );
     out.Print( 0, "    Total unplated holes count %u\n", totalHoleCount );
+    out.Print( 0, "    Drill path length %.1f mm\n", getDrillPathLength() / IU_PER_MM );
 
     return true;
 }
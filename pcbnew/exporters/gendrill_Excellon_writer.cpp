@@ -81,62 +81,29 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                                                  bool aGenDrill, bool aGenMap,
                                                  REPORTER * aReporter )
 {
-    wxFileName  fn;
-    wxString    msg;
-
     std::vector<DRILL_LAYER_PAIR> hole_sets = getUniqueLayerPairs();
 
     // append a pair representing the NPTH set of holes, for separate drill files.
     if( !m_merge_PTH_NPTH )
         hole_sets.emplace_back( F_Cu, B_Cu );
 
-    for( std::vector<DRILL_LAYER_PAIR>::const_iterator it = hole_sets.begin();
-         it != hole_sets.end();  ++it )
-    {
-        DRILL_LAYER_PAIR  pair = *it;
-        // For separate drill files, the last layer pair is the NPTH drill file.
-        bool doing_npth = m_merge_PTH_NPTH ? false : ( it == hole_sets.end() - 1 );
+    if( aGenDrill )
+        createDrillFiles( aPlotDirectory, hole_sets, !m_merge_PTH_NPTH, aReporter );
 
-        buildHolesList( pair, doing_npth );
+    if( aGenMap )
+        CreateMapFilesSet( aPlotDirectory, aReporter );
+}
 
-        // The file is created if it has holes, or if it is the non plated drill file
-        // to be sure the NPTH file is up to date in separate files mode.
-        if( getHolesCount() > 0 || doing_npth )
-        {
-            fn = getDrillFileName( pair, doing_npth, m_merge_PTH_NPTH );
-            fn.SetPath( aPlotDirectory );
 
-            if( aGenDrill )
-            {
-                wxString fullFilename = fn.GetFullPath();
-
-                FILE* file = wxFopen( fullFilename, wxT( "w" ) );
-
-                if( file == NULL )
-                {
-                    if( aReporter )
-                    {
-                        msg.Printf( _( "** Unable to create %s **\n" ), GetChars( fullFilename ) );
-                        aReporter->Report( msg );
-                    }
-                    break;
-                }
-                else
-                {
-                    if( aReporter )
-                    {
-                        msg.Printf( _( "Create file %s\n" ), GetChars( fullFilename ) );
-                        aReporter->Report( msg );
-                    }
-                }
-
-                createDrillFile( file, pair, doing_npth );
-            }
-        }
-    }
+int EXCELLON_WRITER::writeDrillFile( const wxString& aFullFilename, DRILL_LAYER_PAIR aLayerPair,
+                                     bool aIsNpth )
+{
+    FILE* file = wxFopen( aFullFilename, wxT( "w" ) );
 
-    if( aGenMap )
-        CreateMapFilesSet( aPlotDirectory, aReporter );
+    if( file == NULL )
+        return -1;
+
+    return createDrillFile( file, aLayerPair, aIsNpth );
 }
 
 
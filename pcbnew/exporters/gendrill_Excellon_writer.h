@@ -118,6 +118,12 @@ public:
                                     REPORTER * aReporter = NULL );
 
 
+protected:
+    int writeDrillFile( const wxString& aFullFilename, DRILL_LAYER_PAIR aLayerPair,
+                        bool aIsNpth ) override;
+
+    GENDRILL_WRITER_BASE* clone() const override { return new EXCELLON_WRITER( *this ); }
+
 private:
     /**
      * Function CreateDrillFile
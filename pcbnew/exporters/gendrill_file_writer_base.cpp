@@ -22,6 +22,13 @@
  * or you may write to the Free Software Foundation, Inc.,
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+
 #include <fctsys.h>
 
 #include <class_board.h>
@@ -29,6 +36,8 @@
 #include <class_track.h>
 #include <collectors.h>
 #include <reporter.h>
+#include <trigo.h>
+#include <math/util.h>      // for KiROUND
 
 #include <gendrill_file_writer_base.h>
 
@@ -191,6 +200,241 @@ void GENDRILL_WRITER_BASE::buildHolesList( DRILL_LAYER_PAIR aLayerPair,
         if( m_holeListBuffer[ii].m_Hole_Shape )
             m_toolListBuffer.back().m_OvalCount++;
     }
+
+    if( m_optimizeDrillPath )
+        optimizeDrillPath();
+}
+
+
+/* Helper function for the drill path optimization.
+ * Return the position of ( aX, aY ) along a Hilbert curve filling a 2^16 x 2^16 grid.
+ * Points close on the curve are close on the board, so drilling the holes in the curve
+ * order gives a short path, without the cost of a real travelling salesman search.
+ */
+static uint64_t hilbertDistance( uint32_t aX, uint32_t aY )
+{
+    const uint32_t n = 1 << 16;
+    uint64_t       d = 0;
+
+    for( uint32_t s = n / 2; s > 0; s /= 2 )
+    {
+        uint32_t rx = ( aX & s ) > 0;
+        uint32_t ry = ( aY & s ) > 0;
+
+        d += (uint64_t) s * s * ( ( 3 * rx ) ^ ry );
+
+        // Rotate the quadrant, so the curve is continuous
+        if( ry == 0 )
+        {
+            if( rx == 1 )
+            {
+                aX = n - 1 - aX;
+                aY = n - 1 - aY;
+            }
+
+            std::swap( aX, aY );
+        }
+    }
+
+    return d;
+}
+
+
+void GENDRILL_WRITER_BASE::optimizeDrillPath()
+{
+    if( m_holeListBuffer.size() < 3 )
+        return;
+
+    // Map the hole positions on the curve grid
+    wxPoint min_pos = m_holeListBuffer[0].m_Hole_Pos;
+    wxPoint max_pos = min_pos;
+
+    for( const HOLE_INFO& hole : m_holeListBuffer )
+    {
+        min_pos.x = std::min( min_pos.x, hole.m_Hole_Pos.x );
+        min_pos.y = std::min( min_pos.y, hole.m_Hole_Pos.y );
+        max_pos.x = std::max( max_pos.x, hole.m_Hole_Pos.x );
+        max_pos.y = std::max( max_pos.y, hole.m_Hole_Pos.y );
+    }
+
+    double span = std::max( max_pos.x - (double) min_pos.x, max_pos.y - (double) min_pos.y );
+    double scale = span > 0 ? 65535.0 / span : 0.0;
+
+    std::vector<HOLE_INFO>                      sorted;
+    std::vector<std::pair<uint64_t, unsigned>>  curve;     // curve position, hole index
+
+    sorted.reserve( m_holeListBuffer.size() );
+
+    // The drill head starts from the drill origin
+    wxPoint last_pos = m_offset;
+
+    // The holes of a tool are contiguous in the list: sort each tool on its own
+    for( unsigned first = 0; first < m_holeListBuffer.size(); )
+    {
+        int      tool = m_holeListBuffer[first].m_Tool_Reference;
+        unsigned end = first;
+
+        curve.clear();
+
+        for( ; end < m_holeListBuffer.size() && m_holeListBuffer[end].m_Tool_Reference == tool;
+             end++ )
+        {
+            const wxPoint& pos = m_holeListBuffer[end].m_Hole_Pos;
+
+            curve.emplace_back( hilbertDistance( KiROUND( ( pos.x - (double) min_pos.x ) * scale ),
+                                                 KiROUND( ( pos.y - (double) min_pos.y ) * scale ) ),
+                                end );
+        }
+
+        std::sort( curve.begin(), curve.end() );
+
+        // The curve can be followed both ways: start from the end closest to the last hole
+        const wxPoint& head = m_holeListBuffer[curve.front().second].m_Hole_Pos;
+        const wxPoint& tail = m_holeListBuffer[curve.back().second].m_Hole_Pos;
+
+        if( EuclideanNorm( tail - last_pos ) < EuclideanNorm( head - last_pos ) )
+            std::reverse( curve.begin(), curve.end() );
+
+        for( const auto& entry : curve )
+            sorted.push_back( m_holeListBuffer[entry.second] );
+
+        last_pos = sorted.back().m_Hole_Pos;
+        first = end;
+    }
+
+    m_holeListBuffer.swap( sorted );
+}
+
+
+double GENDRILL_WRITER_BASE::getDrillPathLength() const
+{
+    double length = 0.0;
+
+    for( unsigned ii = 1; ii < m_holeListBuffer.size(); ii++ )
+    {
+        const HOLE_INFO& prev = m_holeListBuffer[ii - 1];
+        const HOLE_INFO& hole = m_holeListBuffer[ii];
+
+        if( prev.m_Tool_Reference == hole.m_Tool_Reference )
+            length += EuclideanNorm( hole.m_Hole_Pos - prev.m_Hole_Pos );
+    }
+
+    return length;
+}
+
+
+void GENDRILL_WRITER_BASE::createDrillFiles( const wxString& aPlotDirectory,
+                                             const std::vector<DRILL_LAYER_PAIR>& aHoleSets,
+                                             bool aLastIsNPTH, REPORTER* aReporter )
+{
+    struct DRILL_FILE_JOB
+    {
+        DRILL_LAYER_PAIR m_Pair;
+        bool             m_IsNpth;
+        wxString         m_FullFilename;
+        int              m_HoleCount;       // -1 if the file cannot be created
+        double           m_PathLength;
+        bool             m_Written;         // false if skipped (no holes)
+    };
+
+    std::vector<DRILL_FILE_JOB> jobs;
+
+    for( unsigned ii = 0; ii < aHoleSets.size(); ii++ )
+    {
+        DRILL_FILE_JOB job;
+
+        job.m_Pair = aHoleSets[ii];
+        // For separate drill files, the last layer pair is the NPTH drill file.
+        job.m_IsNpth = aLastIsNPTH && ii == aHoleSets.size() - 1;
+        job.m_HoleCount = 0;
+        job.m_PathLength = 0.0;
+        job.m_Written = false;
+
+        wxFileName fn = getDrillFileName( job.m_Pair, job.m_IsNpth, m_merge_PTH_NPTH );
+        fn.SetPath( aPlotDirectory );
+        job.m_FullFilename = fn.GetFullPath();
+
+        jobs.push_back( job );
+    }
+
+    // The file writers switch to the C locale: do it once for all the threads
+    LOCALE_IO toggle;
+
+    std::atomic<size_t> nextJob( 0 );
+
+    auto write_lambda = [&]() -> size_t
+    {
+        std::unique_ptr<GENDRILL_WRITER_BASE> writer( clone() );
+        size_t                                written = 0;
+
+        for( auto i = nextJob++; i < jobs.size(); i = nextJob++ )
+        {
+            DRILL_FILE_JOB& job = jobs[i];
+
+            writer->buildHolesList( job.m_Pair, job.m_IsNpth );
+
+            // The file is created if it has holes, or if it is the non plated drill file
+            // to be sure the NPTH file is up to date in separate files mode.
+            if( writer->getHolesCount() == 0 && !job.m_IsNpth )
+                continue;
+
+            job.m_PathLength = writer->getDrillPathLength();
+            job.m_HoleCount = writer->writeDrillFile( job.m_FullFilename, job.m_Pair,
+                                                      job.m_IsNpth );
+            job.m_Written = true;
+            written++;
+        }
+
+        return written;
+    };
+
+    size_t parallelThreadCount = std::min<size_t>( std::thread::hardware_concurrency(),
+                                                   jobs.size() );
+
+    if( parallelThreadCount <= 1 )
+    {
+        write_lambda();
+    }
+    else
+    {
+        std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, write_lambda );
+
+        // Finalize the threads
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii].wait();
+    }
+
+    if( !aReporter )
+        return;
+
+    // Report in the layer pair order, from the calling thread
+    wxString msg;
+
+    for( const DRILL_FILE_JOB& job : jobs )
+    {
+        if( !job.m_Written )
+            continue;
+
+        if( job.m_HoleCount < 0 )
+        {
+            msg.Printf( _( "** Unable to create %s **\n" ), job.m_FullFilename );
+            aReporter->Report( msg );
+            continue;
+        }
+
+        msg.Printf( _( "Create file %s\n" ), job.m_FullFilename );
+        aReporter->Report( msg );
+
+        if( job.m_HoleCount > 0 )
+        {
+            msg.Printf( _( "    %d holes, drill path length %.1f mm\n" ), job.m_HoleCount,
+                        job.m_PathLength / IU_PER_MM );
+            aReporter->Report( msg );
+        }
+    }
 }
 
 
@@ -32,6 +32,7 @@
 #include <vector>
 
 class BOARD_ITEM;
+class REPORTER;
 
 
 // the DRILL_TOOL class  handles tools used in the excellon drill file:
@@ -143,6 +144,8 @@ protected:
                                                         // Excellon/Gerber units (i.e inches or mm)
     wxPoint                  m_offset;                  // Drill offset coordinates
     bool                     m_merge_PTH_NPTH;          // True to generate only one drill file
+    bool                     m_optimizeDrillPath;       // True to sort the holes of each tool
+                                                        // along a short drill head path
     std::vector<HOLE_INFO>   m_holeListBuffer;          // Buffer containing holes
     std::vector<DRILL_TOOL>  m_toolListBuffer;          // Buffer containing tools
 
@@ -160,6 +163,7 @@ protected:
         m_mapFileFmt      = PLOT_FORMAT::PDF;
         m_pageInfo        = NULL;
         m_merge_PTH_NPTH  = false;
+        m_optimizeDrillPath = false;
         m_zeroFormat      = DECIMAL_FORMAT;
     }
 
@@ -175,6 +179,14 @@ public:
      */
     void SetMergeOption( bool aMerge ) { m_merge_PTH_NPTH = aMerge; }
 
+    /**
+     * set the option to optimize the drill head path
+     * @param aOptimize = true to sort the holes of each tool along a space filling curve,
+     * which keeps the travel between holes short
+     * = false to keep the holes sorted by footprint and by position
+     */
+    void SetDrillPathOptimization( bool aOptimize ) { m_optimizeDrillPath = aOptimize; }
+
     /**
      * Return the plot offset (usually the position
      * of the auxiliary axis
@@ -296,6 +308,48 @@ protected:
 
     int  getHolesCount() const { return m_holeListBuffer.size(); }
 
+    /**
+     * Sort the holes of each tool of the current hole list along a Hilbert curve,
+     * each tool starting at the end of the curve closest to the last hole of the previous one.
+     * Called by buildHolesList() when the path optimization is enabled.
+     */
+    void optimizeDrillPath();
+
+    /**
+     * @return the length (in internal units) of the drill head travel between the holes
+     * of each tool of the current hole list.  Tool changes are not counted.
+     */
+    double getDrillPathLength() const;
+
+    /**
+     * Function createDrillFiles
+     * Build the hole list and write the drill file of each layer pair of aHoleSets.
+     * The files are written at the same time, each one by its own copy of this writer.
+     * @param aPlotDirectory = the output folder
+     * @param aHoleSets = the layer pairs to write
+     * @param aLastIsNPTH = true if the last layer pair is the NPTH drill file
+     * @param aReporter = a REPORTER to return activity or any message (can be NULL)
+     */
+    void createDrillFiles( const wxString& aPlotDirectory,
+                           const std::vector<DRILL_LAYER_PAIR>& aHoleSets,
+                           bool aLastIsNPTH, REPORTER* aReporter );
+
+    /**
+     * Write the drill file of the current hole list.
+     * @param aFullFilename = the full filename
+     * @param aLayerPair = first board layer and the last board layer for this drill file
+     * @param aIsNpth = true for a NPTH file, false for a PTH file
+     * @return hole count, or -1 if the file cannot be created
+     */
+    virtual int writeDrillFile( const wxString& aFullFilename, DRILL_LAYER_PAIR aLayerPair,
+                                bool aIsNpth ) = 0;
+
+    /**
+     * @return a copy of this writer, with the same format and options, used to write
+     * several drill files at the same time
+     */
+    virtual GENDRILL_WRITER_BASE* clone() const = 0;
+
     /** Helper function.
      * Writes the drill marks in HPGL, POSTSCRIPT or other supported formats
      * Each hole size has a symbol (circle, cross X, cross + ...) up to
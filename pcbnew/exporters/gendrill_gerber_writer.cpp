@@ -67,61 +67,26 @@ void GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
     // Note: In Gerber drill files, NPTH and PTH are always separate files
     m_merge_PTH_NPTH = false;
 
-    wxFileName  fn;
-    wxString    msg;
-
     std::vector<DRILL_LAYER_PAIR> hole_sets = getUniqueLayerPairs();
 
     // append a pair representing the NPTH set of holes, for separate drill files.
     // (Gerber drill files are separate files for PTH and NPTH)
     hole_sets.emplace_back( F_Cu, B_Cu );
 
-    for( std::vector<DRILL_LAYER_PAIR>::const_iterator it = hole_sets.begin();
-         it != hole_sets.end();  ++it )
-    {
-        DRILL_LAYER_PAIR  pair = *it;
-        // For separate drill files, the last layer pair is the NPTH drill file.
-        bool doing_npth = ( it == hole_sets.end() - 1 );
+    if( aGenDrill )
+        createDrillFiles( aPlotDirectory, hole_sets, true, aReporter );
 
-        buildHolesList( pair, doing_npth );
+    if( aGenMap )
+        CreateMapFilesSet( aPlotDirectory, aReporter );
+}
 
-        // The file is created if it has holes, or if it is the non plated drill file
-        // to be sure the NPTH file is up to date in separate files mode.
-        if( getHolesCount() > 0 || doing_npth )
-        {
-            fn = getDrillFileName( pair, doing_npth, false );
-            fn.SetPath( aPlotDirectory );
 
-            if( aGenDrill )
-            {
-                wxString fullFilename = fn.GetFullPath();
-
-                int result = createDrillFile( fullFilename, doing_npth, pair );
-
-                if( result < 0 )
-                {
-                    if( aReporter )
-                    {
-                        msg.Printf( _( "** Unable to create %s **\n" ), fullFilename );
-                        aReporter->Report( msg );
-                    }
-                    break;
-                }
-                else
-                {
-                    if( aReporter )
-                    {
-                        msg.Printf( _( "Create file %s\n" ), fullFilename );
-                        aReporter->Report( msg );
-                    }
-                }
-
-            }
-        }
-    }
+int GERBER_WRITER::writeDrillFile( const wxString& aFullFilename, DRILL_LAYER_PAIR aLayerPair,
+                                   bool aIsNpth )
+{
+    wxString fullFilename = aFullFilename;
 
-    if( aGenMap )
-        CreateMapFilesSet( aPlotDirectory, aReporter );
+    return createDrillFile( fullFilename, aIsNpth, aLayerPair );
 }
 
 // A helper class to transform an oblong hole to a segment
@@ -78,6 +78,12 @@ public:
                                     bool aGenDrill, bool aGenMap,
                                     REPORTER * aReporter = NULL );
 
+protected:
+    int writeDrillFile( const wxString& aFullFilename, DRILL_LAYER_PAIR aLayerPair,
+                        bool aIsNpth ) override;
+
+    GENDRILL_WRITER_BASE* clone() const override { return new GERBER_WRITER( *this ); }
+
 private:
     /**
      * Function createDrillFile
@@ -195,6 +195,9 @@ PCBNEW_SETTINGS::PCBNEW_SETTINGS() : APP_SETTINGS_BASE( "pcbnew", pcbnewSchemaVe
     m_params.emplace_back( new PARAM<bool>( "gen_drill.use_route_for_oval_holes",
             &m_GenDrill.use_route_for_oval_holes, true ) );
 
+    m_params.emplace_back( new PARAM<bool>( "gen_drill.optimize_drill_path",
+            &m_GenDrill.optimize_drill_path, false ) );
+
     m_params.emplace_back( new PARAM<int>(
             "gen_drill.drill_file_type", &m_GenDrill.drill_file_type, 0 ) );
 
@@ -120,6 +120,7 @@ public:
         bool mirror;
         bool unit_drill_is_inch;
         bool use_route_for_oval_holes;
+        bool optimize_drill_path;
         int  drill_file_type;
         int  map_file_type;
         int  zeros_format;
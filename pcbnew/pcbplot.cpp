@@ -433,6 +433,33 @@ void PLOT_CONTROLLER::ClosePlot()
 }
 
 
+bool PLOT_CONTROLLER::buildPlotFileName( const wxString& aSuffix, PLOT_FORMAT aFormat )
+{
+    // Compute the full filename for the output (after ensuring the output directory is OK)
+    wxString outputDirName = GetPlotOptions().GetOutputDirectory() ;
+    wxFileName outputDir = wxFileName::DirName( outputDirName );
+    wxString boardFilename = m_board->GetFileName();
+
+    if( !EnsureFileDirectoryExists( &outputDir, boardFilename ) )
+        return false;
+
+    // outputDir contains now the full path of plot files
+    m_plotFile = boardFilename;
+    m_plotFile.SetPath( outputDir.GetPath() );
+    wxString fileExt = GetDefaultPlotExtension( aFormat );
+
+    // Gerber format can use specific file ext, depending on layers
+    // (now not a good practice, because the official file ext is .gbr)
+    if( aFormat == PLOT_FORMAT::GERBER && GetPlotOptions().GetUseGerberProtelExtensions() )
+        fileExt = GetGerberProtelExtension( GetLayer() );
+
+    // Build plot filenames from the board name and layer names:
+    BuildPlotFileName( &m_plotFile, outputDir.GetPath(), aSuffix, fileExt );
+
+    return true;
+}
+
+
 bool PLOT_CONTROLLER::OpenPlotfile(
         const wxString& aSuffix, PLOT_FORMAT aFormat, const wxString& aSheetDesc )
 {
@@ -446,28 +473,9 @@ bool PLOT_CONTROLLER::OpenPlotfile(
     // Ensure that the previous plot is closed
     ClosePlot();
 
-    // Now compute the full filename for the output and start the plot
-    // (after ensuring the output directory is OK)
-    wxString outputDirName = GetPlotOptions().GetOutputDirectory() ;
-    wxFileName outputDir = wxFileName::DirName( outputDirName );
-    wxString boardFilename = m_board->GetFileName();
-
-    if( EnsureFileDirectoryExists( &outputDir, boardFilename ) )
+    // Now start the plot
+    if( buildPlotFileName( aSuffix, aFormat ) )
     {
-        // outputDir contains now the full path of plot files
-        m_plotFile = boardFilename;
-        m_plotFile.SetPath( outputDir.GetPath() );
-        wxString fileExt = GetDefaultPlotExtension( aFormat );
-
-        // Gerber format can use specific file ext, depending on layers
-        // (now not a good practice, because the official file ext is .gbr)
-        if( GetPlotOptions().GetFormat() == PLOT_FORMAT::GERBER
-                && GetPlotOptions().GetUseGerberProtelExtensions() )
-            fileExt = GetGerberProtelExtension( GetLayer() );
-
-        // Build plot filenames from the board name and layer names:
-        BuildPlotFileName( &m_plotFile, outputDir.GetPath(), aSuffix, fileExt );
-
         m_plotter = StartPlotBoard( m_board, &GetPlotOptions(), ToLAYER_ID( GetLayer() ),
                                     m_plotFile.GetFullPath(), aSheetDesc );
     }
@@ -491,6 +499,31 @@ bool PLOT_CONTROLLER::PlotLayer()
 }
 
 
+const wxString PLOT_CONTROLLER::AddPlotJob(
+        const wxString& aSuffix, PLOT_FORMAT aFormat, const wxString& aSheetDesc )
+{
+    GetPlotOptions().SetFormat( aFormat );
+
+    if( !buildPlotFileName( aSuffix, aFormat ) )
+        return wxEmptyString;
+
+    m_plotJobs.emplace_back( ToLAYER_ID( GetLayer() ), GetPlotOptions(),
+                             m_plotFile.GetFullPath(), aSheetDesc );
+
+    return m_plotFile.GetFullPath();
+}
+
+
+int PLOT_CONTROLLER::PlotJobs( int aThreadCount )
+{
+    int plotted = PlotBoardLayers( m_board, m_plotJobs, aThreadCount );
+
+    m_plotJobs.clear();
+
+    return plotted;
+}
+
+
 void PLOT_CONTROLLER::SetColorMode( bool aColorMode )
 {
     if( !m_plotter )
@@ -38,6 +38,8 @@
 #include <settings/settings_manager.h>
 #include <wx/filename.h>
 
+#include <vector>
+
 class PLOTTER;
 class TEXTE_PCB;
 class D_PAD;
@@ -50,6 +52,7 @@ class TEXTE_MODULE;
 class ZONE_CONTAINER;
 class BOARD;
 class REPORTER;
+class PROGRESS_REPORTER;
 
 
 // Define min and max reasonable values for plot/print scale
@@ -177,6 +180,43 @@ PLOTTER* StartPlotBoard( BOARD* aBoard,
 void PlotOneBoardLayer( BOARD *aBoard, PLOTTER* aPlotter, PCB_LAYER_ID aLayer,
                         const PCB_PLOT_PARAMS& aPlotOpt );
 
+/**
+ * A board layer to plot in its own file, for PlotBoardLayers()
+ */
+struct PLOT_JOB
+{
+    PLOT_JOB( PCB_LAYER_ID aLayer, const PCB_PLOT_PARAMS& aPlotOpts,
+              const wxString& aFullFileName, const wxString& aSheetDesc = wxEmptyString ) :
+            m_Layer( aLayer ),
+            m_PlotOpts( aPlotOpts ),
+            m_FullFileName( aFullFileName ),
+            m_SheetDesc( aSheetDesc ),
+            m_Success( false )
+    {
+    }
+
+    PCB_LAYER_ID    m_Layer;
+    PCB_PLOT_PARAMS m_PlotOpts;         ///< options of this plot, including the file format
+    wxString        m_FullFileName;
+    wxString        m_SheetDesc;
+    bool            m_Success;          ///< set by PlotBoardLayers() once the file is written
+};
+
+/**
+ * Function PlotBoardLayers
+ * plots each job of \a aJobs in its own file, with its own plotter.
+ * The jobs run concurrently: the board is only read while plotting, and starting the plots
+ * (which plots the frame references from the shared page layout) is serialized.
+ * @param aBoard = the board to plot
+ * @param aJobs = the layers to plot; their m_Success flag is updated
+ * @param aThreadCount = the number of threads to use, 0 to use all the cores
+ * @param aProgressReporter = if not null, advanced once per job and kept refreshing
+ *                            by the calling thread while the jobs run
+ * @return the number of plot files written
+ */
+int PlotBoardLayers( BOARD* aBoard, std::vector<PLOT_JOB>& aJobs, int aThreadCount = 0,
+                     PROGRESS_REPORTER* aProgressReporter = nullptr );
+
 /**
  * Function PlotStandardLayer
  * plot copper or technical layers.
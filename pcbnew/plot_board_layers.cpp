@@ -29,6 +29,13 @@
  */
 
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <fctsys.h>
 #include <common.h>
 #include <plotter.h>
@@ -53,6 +60,7 @@
 #include <pcbnew.h>
 #include <pcbplot.h>
 #include <gbr_metadata.h>
+#include <widgets/progress_reporter.h>
 
 /*
  * Plot a solder mask layer.  Solder mask layers have a minimum thickness value and cannot be
@@ -395,7 +403,7 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
                 else
                     delta.y = coord[1].x - coord[0].x;
 
-                pad->SetDelta( delta );
+                deltaSize = delta;
             }
             else
                 padPlotsSize = pad->GetSize() + extraSize;
@@ -412,30 +420,38 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             if( pad->GetLayerSet()[F_Cu] )
                 color = color.LegacyMix( aPlotOpt.ColorSettings()->GetColor( LAYER_PAD_FR ) );
 
-            // Temporary set the pad size to the required plot size:
-            wxSize tmppadsize = pad->GetSize();
+            // Plot a resized copy of the pad: the board pad itself is left untouched, as
+            // other layers can be plotted from it at the same time
+            std::unique_ptr<D_PAD> resizedPad;
+            D_PAD*                 plotPad = pad;
+
+            if( pad->GetShape() != PAD_SHAPE_CUSTOM
+                    && ( padPlotsSize != pad->GetSize() || deltaSize != pad->GetDelta() ) )
+            {
+                resizedPad = std::make_unique<D_PAD>( *pad );
+                resizedPad->SetSize( padPlotsSize );
+                resizedPad->SetDelta( deltaSize );
+                plotPad = resizedPad.get();
+            }
 
             switch( pad->GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
-                pad->SetSize( padPlotsSize );
-
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
                     ( aPlotOpt.GetDrillMarksType() == PCB_PLOT_PARAMS::NO_DRILL_SHAPE ) &&
-                    ( pad->GetSize() == pad->GetDrillSize() ) &&
-                    ( pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED ) )
+                    ( plotPad->GetSize() == plotPad->GetDrillSize() ) &&
+                    ( plotPad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED ) )
                     break;
 
-                itemplotter.PlotPad( pad, color, plotMode );
+                itemplotter.PlotPad( plotPad, color, plotMode );
                 break;
 
             case PAD_SHAPE_TRAPEZOID:
             case PAD_SHAPE_RECT:
             case PAD_SHAPE_ROUNDRECT:
             case PAD_SHAPE_CHAMFERED_RECT:
-                pad->SetSize( padPlotsSize );
-                itemplotter.PlotPad( pad, color, plotMode );
+                itemplotter.PlotPad( plotPad, color, plotMode );
                 break;
 
             case PAD_SHAPE_CUSTOM:
@@ -464,9 +480,6 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             }
                 break;
             }
-
-            pad->SetSize( tmppadsize );     // Restore the pad size
-            pad->SetDelta( deltaSize );
         }
 
         aPlotter->EndBlock( NULL );
@@ -707,25 +720,15 @@ void PlotLayerOutlines( BOARD* aBoard, PLOTTER* aPlotter, LSET aLayerMask,
 
         outlines.Simplify( SHAPE_POLY_SET::PM_FAST );
 
-        // Plot outlines
-        std::vector< wxPoint > cornerList;
-
-        // Now we have one or more basic polygons: plot each polygon
+        // Now we have one or more basic polygons: plot each polygon.  The contours of a
+        // polygon set are closed, so the plotter closes them itself.
         for( int ii = 0; ii < outlines.OutlineCount(); ii++ )
         {
             for(int kk = 0; kk <= outlines.HoleCount (ii); kk++ )
             {
-                cornerList.clear();
                 const SHAPE_LINE_CHAIN& path = (kk == 0) ? outlines.COutline( ii ) : outlines.CHole( ii, kk - 1 );
 
-                for( int jj = 0; jj < path.PointCount(); jj++ )
-                    cornerList.emplace_back( (wxPoint) path.CPoint( jj ) );
-
-                // Ensure the polygon is closed
-                if( cornerList[0] != cornerList[cornerList.size() - 1] )
-                    cornerList.push_back( cornerList[0] );
-
-                aPlotter->PlotPoly( cornerList, NO_FILL );
+                aPlotter->PlotPoly( path, NO_FILL );
             }
         }
 
@@ -1146,3 +1149,93 @@ PLOTTER* StartPlotBoard( BOARD *aBoard, PCB_PLOT_PARAMS *aPlotOpts, int aLayer,
     delete plotter;
     return NULL;
 }
+
+
+int PlotBoardLayers( BOARD* aBoard, std::vector<PLOT_JOB>& aJobs, int aThreadCount,
+                     PROGRESS_REPORTER* aProgressReporter )
+{
+    // The numeric locale is process wide: keep it to "C" until the last file is closed, so
+    // that the plotting threads don't switch it back and forth
+    LOCALE_IO toggle;
+
+    size_t parallelThreadCount = aThreadCount > 0 ? aThreadCount
+                                                  : std::thread::hardware_concurrency();
+    parallelThreadCount = std::min<size_t>( parallelThreadCount, aJobs.size() );
+
+    std::atomic<size_t> nextJob( 0 );
+    std::mutex          startLock;
+    std::vector<std::future<size_t>> returns( parallelThreadCount );
+
+    if( aProgressReporter )
+    {
+        aProgressReporter->Report( _( "Plotting layers..." ) );
+        aProgressReporter->SetMaxProgress( aJobs.size() );
+    }
+
+    auto plot_lambda = [&]( bool aRefresh ) -> size_t
+    {
+        size_t plotted = 0;
+
+        for( auto i = nextJob++; i < aJobs.size(); i = nextJob++ )
+        {
+            PLOT_JOB&                job = aJobs[i];
+            std::unique_ptr<PLOTTER> plotter;
+
+            // Plotting the frame reference fills the draw items of the global page layout
+            {
+                std::lock_guard<std::mutex> lock( startLock );
+
+                plotter.reset( StartPlotBoard( aBoard, &job.m_PlotOpts, job.m_Layer,
+                                               job.m_FullFileName, job.m_SheetDesc ) );
+            }
+
+            job.m_Success = ( plotter != nullptr );
+
+            if( plotter )
+            {
+                PlotOneBoardLayer( aBoard, plotter.get(), job.m_Layer, job.m_PlotOpts );
+                plotter->EndPlot();
+                plotted++;
+            }
+
+            if( aProgressReporter )
+            {
+                aProgressReporter->AdvanceProgress();
+
+                // Only the calling thread may touch the UI
+                if( aRefresh )
+                    aProgressReporter->KeepRefreshing();
+            }
+        }
+
+        return plotted;
+    };
+
+    size_t plotted = 0;
+
+    if( parallelThreadCount <= 1 )
+        plotted = plot_lambda( true );
+    else
+    {
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+            returns[ii] = std::async( std::launch::async, plot_lambda, false );
+
+        // Finalize the threads, keeping the progress reporter alive while they run
+        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        {
+            std::future_status status;
+
+            do
+            {
+                if( aProgressReporter )
+                    aProgressReporter->KeepRefreshing();
+
+                status = returns[ii].wait_for( std::chrono::milliseconds( 100 ) );
+            } while( status != std::future_status::ready );
+
+            plotted += returns[ii].get();
+        }
+    }
+
+    return plotted;
+}
@@ -716,9 +716,6 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone, SHAPE_POLY_SET& p
         }
     }
 
-    // We need a buffer to store corners coordinates:
-    std::vector< wxPoint > cornerList;
-
     m_plotter->SetColor( getColor( aZone->GetLayer() ) );
 
     /* Plot all filled areas: filled areas have a filled area and a thick
@@ -731,41 +728,37 @@ void BRDITEMS_PLOTTER::PlotFilledAreas( ZONE_CONTAINER* aZone, SHAPE_POLY_SET& p
 
     for( int idx = 0; idx < polysList.OutlineCount(); ++idx )
     {
-        SHAPE_LINE_CHAIN& outline = polysList.Outline( idx );
+        const SHAPE_LINE_CHAIN& outline = polysList.COutline( idx );
+        const int               count = outline.PointCount();
 
-        cornerList.clear();
-        cornerList.reserve( outline.PointCount() );
+        if( count == 0 )
+            continue;
 
-        for( int ic = 0; ic < outline.PointCount(); ++ic )
+        // Plot the current filled area and its outline.  The plotter reads the vertices
+        // from the outline and closes it.
+        if( GetPlotMode() == FILLED )
         {
-            cornerList.emplace_back( wxPoint( outline.CPoint( ic ) ) );
+            m_plotter->PlotPoly( outline, FILLED_SHAPE, outline_thickness, &gbr_metadata );
         }
-
-        if( cornerList.size() )   // Plot the current filled area outline
+        else
         {
-            // First, close the outline
-            if( cornerList[0] != cornerList[cornerList.size() - 1] )
-                cornerList.push_back( cornerList[0] );
-
-            // Plot the current filled area and its outline
-            if( GetPlotMode() == FILLED )
-            {
-                m_plotter->PlotPoly( cornerList, FILLED_SHAPE, outline_thickness, &gbr_metadata );
-            }
-            else
+            if( outline_thickness )
             {
-                if( outline_thickness )
+                for( int jj = 1; jj <= count; jj++ )
                 {
-                    for( unsigned jj = 1; jj < cornerList.size(); jj++ )
-                    {
-                        m_plotter->ThickSegment( cornerList[jj -1], cornerList[jj],
-                                                 outline_thickness,
-                                                 GetPlotMode(), &gbr_metadata );
-                    }
-                }
+                    const wxPoint start( outline.CPoint( jj - 1 ) );
+                    const wxPoint end( outline.CPoint( jj % count ) );
 
-                m_plotter->SetCurrentLineWidth( -1 );
+                    // The last segment closes the outline, if not already closed
+                    if( jj == count && start == end )
+                        break;
+
+                    m_plotter->ThickSegment( start, end, outline_thickness, GetPlotMode(),
+                                             &gbr_metadata );
+                }
             }
+
+            m_plotter->SetCurrentLineWidth( -1 );
         }
     }
 }
@@ -31,8 +31,11 @@
 #define PLOTCONTROLLER_H_
 
 #include <pcb_plot_params.h>
+#include <pcbplot.h>
 #include <layers_id_colors_and_visibility.h>
 
+#include <vector>
+
 class PLOTTER;
 class BOARD;
 
@@ -83,8 +86,32 @@ public:
      */
     bool PlotLayer();
 
+    /** Queue the plot of the current layer in its own file, to be done by PlotJobs().
+     * The current plot options are used for this plot, even if they are changed later.
+     * @param aSuffix is a string added to the base filename (derived from
+     * the board filename) to identify the plot file
+     * @param aFormat is the plot file format identifier
+     * @param aSheetDesc
+     * @return the full filename of the plot, or an empty string if the output
+     * directory cannot be created
+     */
+    const wxString AddPlotJob( const wxString& aSuffix, PLOT_FORMAT aFormat,
+                               const wxString& aSheetDesc );
+
+    /** Plot all the layers queued by AddPlotJob(), each one in its own file.
+     * The layers are plotted concurrently, then the queue is emptied.
+     * @param aThreadCount is the number of threads to use, 0 to use all the cores
+     * @return the number of plot files written
+     */
+    int PlotJobs( int aThreadCount = 0 );
+
     /**
-     * @return the current plot full filename, set by OpenPlotfile
+     * @return the number of plots queued by AddPlotJob()
+     */
+    int GetPlotJobCount() const { return (int) m_plotJobs.size(); }
+
+    /**
+     * @return the current plot full filename, set by OpenPlotfile or AddPlotJob
      */
     const wxString GetPlotFileName() { return m_plotFile.GetFullPath(); }
 
@@ -122,6 +149,14 @@ private:
 
     /// The current plot filename, set by OpenPlotfile
     wxFileName m_plotFile;
+
+    /// The plots queued by AddPlotJob
+    std::vector<PLOT_JOB> m_plotJobs;
+
+    /** Build the full filename of a plot in m_plotFile, and ensure its directory exists
+     * @return false if the output directory cannot be created
+     */
+    bool buildPlotFileName( const wxString& aSuffix, PLOT_FORMAT aFormat );
 };
 
 #endif
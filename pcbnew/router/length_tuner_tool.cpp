@@ -23,6 +23,9 @@
 
 #include "class_draw_panel_gal.h"
 #include "class_board.h"
+#include <html_messagebox.h>
+#include <kicad_string.h>
+#include <netclass.h>
 
 #include <pcb_edit_frame.h>
 #include <pcbnew_id.h>
@@ -36,6 +39,7 @@
 #include "pns_segment.h"
 #include "pns_router.h"
 #include "pns_meander_placer.h" // fixme: move settings to separate header
+#include "pns_topology.h"
 #include "pns_tune_status_popup.h"
 
 #include "length_tuner_tool.h"
@@ -68,6 +72,12 @@ static TOOL_ACTION ACT_Settings( "pcbnew.LengthTuner.Settings",
         _( "Length Tuning Settings..." ), _( "Sets the length tuning parameters for currently routed item." ),
         router_len_tuner_setup_xpm );
 
+static TOOL_ACTION ACT_LengthReport( "pcbnew.LengthTuner.LengthReport",
+        AS_CONTEXT,
+        0, "",
+        _( "Net Class Length Report..." ),
+        _( "Shows the routed length of all nets in the net class of the track under the cursor." ) );
+
 static TOOL_ACTION ACT_SpacingIncrease( "pcbnew.LengthTuner.SpacingIncrease",
         AS_CONTEXT,
         '1', LEGACY_HK_NAME( "Increase meander spacing by one step." ),
@@ -121,6 +131,7 @@ public:
         Add( ACT_AmplIncrease );
         Add( ACT_AmplDecrease );
         Add( ACT_Settings );
+        Add( ACT_LengthReport );
     }
 
 private:
@@ -300,6 +311,11 @@ int LENGTH_TUNER_TOOL::MainLoop( const TOOL_EVENT& aEvent )
             TOOL_EVENT dummy;
             meanderSettingsDialog( dummy );
         }
+        else if( evt->IsAction( &ACT_LengthReport ) )
+        {
+            updateStartItem( *evt );
+            netClassLengthReport();
+        }
     }
 
     frame()->UndoRedoBlock( false );
@@ -311,6 +327,77 @@ int LENGTH_TUNER_TOOL::MainLoop( const TOOL_EVENT& aEvent )
     return 0;
 }
 
+void LENGTH_TUNER_TOOL::netClassLengthReport()
+{
+    NETINFO_ITEM* startNet = nullptr;
+
+    if( m_startItem && m_startItem->Net() > 0 )
+        startNet = board()->FindNet( m_startItem->Net() );
+
+    if( !startNet || !startNet->GetNetClass() )
+    {
+        wxMessageBox( _( "Please select a track of the net class to report." ),
+                      _( "Net Class Length Report" ) );
+        return;
+    }
+
+    NETCLASSPTR           netclass = startNet->GetNetClass();
+    std::vector<int>      netCodes;
+    std::vector<wxString> netNames;
+
+    for( const wxString& name : *netclass )
+    {
+        if( NETINFO_ITEM* net = board()->FindNet( name ) )
+        {
+            netCodes.push_back( net->GetNet() );
+            netNames.push_back( name );
+        }
+    }
+
+    // All the nets of the class are measured in one go on the router's world
+    PNS::TOPOLOGY topo( m_router->GetWorld() );
+    auto          lengths = topo.NetLengths( netCodes );
+
+    const EDA_UNITS      units = frame()->GetUserUnits();
+    const long long int  target = m_savedMeanderSettings.m_targetLength;
+    const long long int  tolerance = m_savedMeanderSettings.m_lengthTolerance;
+
+    wxString html = wxString::Format( _( "<b>Net class %s</b>, target length %s<br><br>" ),
+                                      netclass->GetName(),
+                                      MessageTextFromValue( units, target, false ) );
+
+    html += "<table cellpadding=2>";
+    html += wxString::Format( "<tr><th align=left>%s</th><th>%s</th><th>%s</th><th>%s</th></tr>",
+                              _( "Net" ), _( "Length" ), _( "Delta" ), _( "Status" ) );
+
+    for( size_t i = 0; i < netCodes.size(); i++ )
+    {
+        long long int len = lengths[ netCodes[i] ];
+        wxString      status;
+
+        if( len < target - tolerance )
+            status = _( "Too short" );
+        else if( len > target + tolerance )
+            status = _( "Too long" );
+        else
+            status = _( "Tuned" );
+
+        html += wxString::Format( "<tr><td>%s</td><td align=right>%s</td>"
+                                  "<td align=right>%s</td><td>%s</td></tr>",
+                                  UnescapeString( netNames[i] ),
+                                  MessageTextFromValue( units, len, false ),
+                                  MessageTextFromValue( units, len - target, false ),
+                                  status );
+    }
+
+    html += "</table>";
+
+    HTML_MESSAGE_BOX dlg( frame(), _( "Net Class Length Report" ) );
+    dlg.AddHTML_Text( html );
+    dlg.ShowModal();
+}
+
+
 int LENGTH_TUNER_TOOL::meanderSettingsDialog( const TOOL_EVENT& aEvent )
 {
     PNS::MEANDER_PLACER_BASE* placer = static_cast<PNS::MEANDER_PLACER_BASE*>( m_router->Placer() );
@@ -43,6 +43,7 @@ public:
 private:
     void performTuning();
     void updateStatusPopup( PNS_TUNE_STATUS_POPUP& aPopup );
+    void netClassLengthReport();
 
     int routerOptionsDialog( const TOOL_EVENT& aEvent );
     int meanderSettingsDialog( const TOOL_EVENT& aEvent );
@@ -43,6 +43,7 @@ public:
     virtual void AddSegment( SEG aS, int aColor, const std::string aName = "" ) {};
     virtual void AddBox( BOX2I aB, int aColor, const std::string aName = "" ) {};
     virtual void AddDirections( VECTOR2D aP, int aMask, int aColor, const std::string aName = "" ) {};
+    virtual void AddCounter( const std::string aName, int64_t aValue ) {};
     virtual void Clear() {};
 };
 
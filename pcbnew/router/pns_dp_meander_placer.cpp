@@ -111,6 +111,10 @@ bool DP_MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
     m_padToDieP = GetTotalPadToDieLength( m_originPair.PLine() );
     m_padToDieN = GetTotalPadToDieLength( m_originPair.NLine() );
     m_padToDieLenth = std::max( m_padToDieP, m_padToDieN );
+    m_origPathLength = origPathLength();
+
+    m_cutP.Clear();
+    m_cutN.Clear();
 
     m_world->Remove( m_originPair.PLine() );
     m_world->Remove( m_originPair.NLine() );
@@ -128,21 +132,8 @@ void DP_MEANDER_PLACER::release()
 
 long long int DP_MEANDER_PLACER::origPathLength() const
 {
-    long long int totalP = m_padToDieLenth;
-    long long int totalN = m_padToDieLenth;
-
-    for( const ITEM* item : m_tunedPathP.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-            totalP += l->CLine().Length();
-
-    }
-
-    for( const ITEM* item : m_tunedPathN.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-            totalN += l->CLine().Length();
-    }
+    long long int totalP = m_padToDieLenth + pathLength( m_tunedPathP );
+    long long int totalN = m_padToDieLenth + pathLength( m_tunedPathN );
 
     return std::max( totalP, totalN );
 }
@@ -181,8 +172,8 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
     SHAPE_LINE_CHAIN preP, tunedP, postP;
     SHAPE_LINE_CHAIN preN, tunedN, postN;
 
-    cutTunedLine( m_originPair.CP(), m_currentStart, aP, preP, tunedP, postP );
-    cutTunedLine( m_originPair.CN(), m_currentStart, aP, preN, tunedN, postN );
+    cutTunedLine( m_originPair.CP(), m_currentStart, aP, preP, tunedP, postP, &m_cutP );
+    cutTunedLine( m_originPair.CN(), m_currentStart, aP, preN, tunedN, postN, &m_cutN );
 
     DIFF_PAIR tuned( m_originPair );
 
@@ -250,7 +241,7 @@ bool DP_MEANDER_PLACER::Move( const VECTOR2I& aP, ITEM* aEndItem )
     while( curIndexN < tunedN.PointCount() )
         m_result.AddCorner( tunedP.CPoint( -1 ), tunedN.CPoint( curIndexN++ ) );
 
-    long long int dpLen = origPathLength();
+    long long int dpLen = m_origPathLength;
 
     m_lastStatus = TUNED;
 
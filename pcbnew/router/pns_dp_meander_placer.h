@@ -143,6 +143,9 @@ private:
     LINE m_currentTraceN, m_currentTraceP;
     ITEM_SET m_tunedPath, m_tunedPathP, m_tunedPathN;
 
+    ///> cached splits of both lines of m_originPair at the current cursor position
+    TUNED_LINE_CUT m_cutP, m_cutN;
+
     SHAPE_LINE_CHAIN m_finalShapeP, m_finalShapeN;
     MEANDERED_LINE m_result;
     SEGMENT* m_initialSegment;
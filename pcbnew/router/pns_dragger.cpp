@@ -331,7 +331,7 @@ void DRAGGER::optimizeAndUpdateDraggedLine( LINE& dragged, const VECTOR2I& aP )
     {
         OPTIMIZER::Optimize( &dragged,
                 OPTIMIZER::MERGE_SEGMENTS | OPTIMIZER::KEEP_TOPOLOGY | OPTIMIZER::PRESERVE_VERTEX,
-                m_lastNode, lockV );
+                m_lastNode, lockV, Dbg() );
     }
 
     m_lastNode->Add( dragged );
@@ -471,7 +471,8 @@ bool DRAGGER::dragShove( const VECTOR2I& aP )
             {
                 OPTIMIZER::Optimize( &dragged, OPTIMIZER::MERGE_SEGMENTS 
                                             | OPTIMIZER::KEEP_TOPOLOGY
-                                            | OPTIMIZER::PRESERVE_VERTEX, m_lastNode, lockV );
+                                            | OPTIMIZER::PRESERVE_VERTEX, m_lastNode, lockV,
+                                     Dbg() );
             }
 
             m_lastNode->Add( dragged );
@@ -23,9 +23,13 @@
 
 namespace PNS {
 
-INDEX::INDEX()
+INDEX::INDEX() :
+    m_packed( false )
 {
     memset( m_subIndices, 0, sizeof( m_subIndices ) );
+
+    for( int i = 0; i < MaxSubIndices; ++i )
+        m_packedValid[i] = false;
 }
 
 
@@ -35,7 +39,7 @@ INDEX::~INDEX()
 }
 
 
-INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
+int INDEX::getSubindexId( const ITEM* aItem ) const
 {
     int idx_n = -1;
 
@@ -74,15 +78,110 @@ INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
     {
         wxASSERT( idx_n >= 0 );
         wxASSERT( idx_n < MaxSubIndices );
-        return nullptr;
+        return -1;
     }
 
+    return idx_n;
+}
+
+
+INDEX::ITEM_SHAPE_INDEX* INDEX::getSubindex( const ITEM* aItem )
+{
+    int idx_n = getSubindexId( aItem );
+
+    if( idx_n < 0 )
+        return nullptr;
+
     if( !m_subIndices[idx_n] )
         m_subIndices[idx_n] = new ITEM_SHAPE_INDEX;
 
+    m_packedValid[idx_n] = false;
+
     return m_subIndices[idx_n];
 }
 
+
+int INDEX::querySubindices( const ITEM* aItem, int* aIndices ) const
+{
+    const LAYER_RANGE& layers = aItem->Layers();
+    int n = 0;
+
+    aIndices[n++] = SI_Multilayer;
+
+    if( layers.IsMultilayer() )
+    {
+        aIndices[n++] = SI_PadsTop;
+        aIndices[n++] = SI_PadsBottom;
+
+        for( int i = layers.Start(); i <= layers.End(); ++i )
+            aIndices[n++] = SI_Traces + 2 * i + SI_SegStraight;
+    }
+    else
+    {
+        int l = layers.Start();
+
+        if( l == B_Cu )
+            aIndices[n++] = SI_PadsTop;
+        else if( l == F_Cu )
+            aIndices[n++] = SI_PadsBottom;
+
+        aIndices[n++] = SI_Traces + 2 * l + SI_SegStraight;
+    }
+
+    return n;
+}
+
+
+const INDEX::ITEM_PACKED_INDEX* INDEX::packedSubindex( int index )
+{
+    if( !m_packed || !m_subIndices[index] )
+        return nullptr;
+
+    if( !m_packedValid[index] )
+    {
+        // Queries may come from several threads at once, only one of them rebuilds.
+        std::lock_guard<std::mutex> lock( m_packMutex );
+
+        if( !m_packedValid[index] )
+        {
+            if( !m_packedIndices[index] )
+                m_packedIndices[index] = std::make_unique<ITEM_PACKED_INDEX>();
+
+            ITEM_PACKED_INDEX* packed = m_packedIndices[index].get();
+            ITEM_SHAPE_INDEX::Iterator iter = m_subIndices[index]->Begin();
+
+            packed->Clear();
+
+            while( !iter.IsNull() )
+            {
+                ITEM* item = *iter;
+                packed->Add( item->Shape()->BBox(), item );
+                iter++;
+            }
+
+            packed->Build();
+            m_packedValid[index] = true;
+        }
+    }
+
+    return m_packedIndices[index].get();
+}
+
+
+void INDEX::SetPacked( bool aPacked )
+{
+    m_packed = aPacked;
+
+    if( !m_packed )
+    {
+        for( int i = 0; i < MaxSubIndices; ++i )
+        {
+            m_packedIndices[i].reset();
+            m_packedValid[i] = false;
+        }
+    }
+}
+
 void INDEX::Add( ITEM* aItem )
 {
     ITEM_SHAPE_INDEX* idx = getSubindex( aItem );
@@ -132,6 +231,8 @@ void INDEX::Clear()
             delete idx;
 
         m_subIndices[i] = NULL;
+        m_packedIndices[i].reset();
+        m_packedValid[i] = false;
     }
 }
 
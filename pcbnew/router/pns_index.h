@@ -23,13 +23,19 @@
 #define __PNS_INDEX_H
 
 #include <layers_id_colors_and_visibility.h>
+#include <algorithm>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
+#include <vector>
 
 #include <boost/range/adaptor/map.hpp>
 
 #include <list>
 #include <geometry/shape_index.h>
+#include <geometry/packed_rtree.h>
 
 #include "pns_item.h"
 
@@ -42,12 +48,17 @@ namespace PNS {
  * Custom spatial index, holding our board items and allowing for very fast searches. Items
  * are assigned to separate R-Tree subindices depending on their type and spanned layers, reducing
  * overlap and improving search time.
+ *
+ * An index that is rarely modified (such as the one of the root NODE, which only changes on
+ * commits) can additionally keep a packed copy of each subindex, rebuilt lazily on the first
+ * query following a change. See SetPacked().
  **/
 class INDEX
 {
 public:
     typedef std::list<ITEM*>            NET_ITEMS_LIST;
     typedef SHAPE_INDEX<ITEM*>          ITEM_SHAPE_INDEX;
+    typedef PACKED_RTREE<ITEM*>         ITEM_PACKED_INDEX;
     typedef std::unordered_set<ITEM*>   ITEM_SET;
 
     INDEX();
@@ -106,6 +117,35 @@ public:
     template<class Visitor>
     int Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
+    /**
+     * Function QueryBatch()
+     *
+     * Searches items in the index that are in proximity of any of aItems, visiting each
+     * subindex once for the whole batch. For each (item, found item) pair, function object
+     * aVisitor( int aItemIndex, ITEM* aFound ) is called. Only items on overlapping layers
+     * are considered.
+     *
+     * @param aItems items to search against
+     * @param aMinDistance proximity distance (wrs to the item's shape)
+     * @param aVisitor function object called on each found pair. Return false from the visitor
+              to stop searching for the item it was called with.
+     * @return number of pairs found.
+     */
+    template<class Visitor>
+    int QueryBatch( const std::vector<const ITEM*>& aItems, int aMinDistance,
+                    Visitor& aVisitor );
+
+    /**
+     * Function SetPacked()
+     *
+     * Enables or disables searching the packed copies of the subindices. Packing trades
+     * a rebuild of the modified subindices on the next query for much faster searches, so
+     * it pays off only for indices that are queried far more often than modified.
+     */
+    void SetPacked( bool aPacked );
+
+    bool IsPacked() const { return m_packed; }
+
     /**
      * Function Clear()
      *
@@ -152,11 +192,29 @@ private:
     template <class Visitor>
     int querySingle( int index, const SHAPE* aShape, int aMinDistance, Visitor& aVisitor );
 
+    /**
+     * Stores the indices of the subindices aItem should be searched in, returning their count.
+     */
+    int querySubindices( const ITEM* aItem, int* aIndices ) const;
+
+    int getSubindexId( const ITEM* aItem ) const;
+
     ITEM_SHAPE_INDEX* getSubindex( const ITEM* aItem );
 
+    /**
+     * Returns the packed copy of a subindex, rebuilding it if necessary, or nullptr if packing
+     * is disabled or the subindex is empty.
+     */
+    const ITEM_PACKED_INDEX* packedSubindex( int index );
+
     ITEM_SHAPE_INDEX* m_subIndices[MaxSubIndices];
     std::map<int, NET_ITEMS_LIST> m_netMap;
     ITEM_SET m_allItems;
+
+    bool m_packed;
+    std::mutex m_packMutex;
+    std::unique_ptr<ITEM_PACKED_INDEX> m_packedIndices[MaxSubIndices];
+    std::atomic<bool> m_packedValid[MaxSubIndices];
 };
 
 
@@ -166,6 +224,14 @@ int INDEX::querySingle( int index, const SHAPE* aShape, int aMinDistance, Visito
     if( !m_subIndices[index] )
         return 0;
 
+    if( const ITEM_PACKED_INDEX* packed = packedSubindex( index ) )
+    {
+        BOX2I box = aShape->BBox();
+        box.Inflate( aMinDistance );
+
+        return packed->Search( box, aVisitor );
+    }
+
     return m_subIndices[index]->Query( aShape, aMinDistance, aVisitor, false );
 }
 
@@ -173,31 +239,12 @@ template<class Visitor>
 int INDEX::Query( const ITEM* aItem, int aMinDistance, Visitor& aVisitor )
 {
     const SHAPE* shape = aItem->Shape();
+    int indices[MaxSubIndices];
+    int n = querySubindices( aItem, indices );
     int total = 0;
 
-    total += querySingle( SI_Multilayer, shape, aMinDistance, aVisitor );
-
-    const LAYER_RANGE& layers = aItem->Layers();
-
-    if( layers.IsMultilayer() )
-    {
-        total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
-
-        for( int i = layers.Start(); i <= layers.End(); ++i )
-            total += querySingle( SI_Traces + 2 * i + SI_SegStraight, shape, aMinDistance, aVisitor );
-    }
-    else
-    {
-        int l = layers.Start();
-
-        if( l == B_Cu )
-            total += querySingle( SI_PadsTop, shape, aMinDistance, aVisitor );
-        else if( l == F_Cu )
-            total += querySingle( SI_PadsBottom, shape, aMinDistance, aVisitor );
-
-        total += querySingle(  SI_Traces + 2 * l + SI_SegStraight, shape, aMinDistance, aVisitor );
-    }
+    for( int i = 0; i < n; i++ )
+        total += querySingle( indices[i], shape, aMinDistance, aVisitor );
 
     return total;
 }
@@ -213,6 +260,81 @@ int INDEX::Query( const SHAPE* aShape, int aMinDistance, Visitor& aVisitor )
     return total;
 }
 
+template<class Visitor>
+int INDEX::QueryBatch( const std::vector<const ITEM*>& aItems, int aMinDistance,
+                       Visitor& aVisitor )
+{
+    // (subindex, item) pairs, grouped by subindex so that each one is traversed once
+    std::vector<std::pair<int, int>> queries;
+    int indices[MaxSubIndices];
+    int total = 0;
+
+    queries.reserve( aItems.size() * 2 );
+
+    for( int i = 0; i < (int) aItems.size(); i++ )
+    {
+        int n = querySubindices( aItems[i], indices );
+
+        for( int j = 0; j < n; j++ )
+        {
+            if( m_subIndices[indices[j]] )
+                queries.emplace_back( indices[j], i );
+        }
+    }
+
+    std::sort( queries.begin(), queries.end() );
+
+    std::vector<BOX2I> boxes;
+    std::vector<int> owners;
+
+    for( size_t first = 0, last; first < queries.size(); first = last )
+    {
+        int index = queries[first].first;
+
+        for( last = first; last < queries.size() && queries[last].first == index; last++ )
+            ;
+
+        if( const ITEM_PACKED_INDEX* packed = packedSubindex( index ) )
+        {
+            boxes.clear();
+            owners.clear();
+
+            for( size_t k = first; k < last; k++ )
+            {
+                BOX2I box = aItems[queries[k].second]->Shape()->BBox();
+                box.Inflate( aMinDistance );
+
+                boxes.push_back( box );
+                owners.push_back( queries[k].second );
+            }
+
+            auto visitOwner = [&]( int aQuery, ITEM* aItem ) -> bool
+            {
+                return aVisitor( owners[aQuery], aItem );
+            };
+
+            total += packed->BatchSearch( boxes, visitOwner );
+        }
+        else
+        {
+            for( size_t k = first; k < last; k++ )
+            {
+                int owner = queries[k].second;
+
+                auto visitOwner = [&]( ITEM* aItem ) -> bool
+                {
+                    return aVisitor( owner, aItem );
+                };
+
+                total += m_subIndices[index]->Query( aItems[owner]->Shape(), aMinDistance,
+                                                     visitOwner, false );
+            }
+        }
+    }
+
+    return total;
+}
+
 };
 
 #endif
@@ -505,6 +505,11 @@ public:
         m_view->Update( m_items );
     }
 
+    void AddCounter( const std::string aName, int64_t aValue ) override
+    {
+        wxLogTrace( "PNS", "%s: %lld", aName.c_str(), (long long) aValue );
+    }
+
     void Clear() override
     {
         if( m_view && m_items )
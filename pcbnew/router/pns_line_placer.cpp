@@ -33,6 +33,7 @@
 
 #include <class_board_item.h>
 
+#include <future>
 #include <memory>
 
 namespace PNS {
@@ -389,53 +390,79 @@ VECTOR2I closestProjectedPoint( const SHAPE_LINE_CHAIN& line, const VECTOR2I& p
 }
 
 
-bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
+struct LINE_PLACER::WALK_CANDIDATE
 {
-    LINE initTrack( m_head );
-    LINE walkFull( m_head );
-    int effort = 0;
-    bool rv = true, viaOk;
+    WALKAROUND::WALKAROUND_STATUS m_status;
+    LINE m_walk;
+    LINE m_line;
+    bool m_collides;
+
+    ///> Prefers clean lines, then the ones that reached their end point, then the shortest one
+    bool BetterThan( const WALK_CANDIDATE& aOther ) const
+    {
+        if( m_collides != aOther.m_collides )
+            return !m_collides;
+
+        bool stuck = ( m_status == WALKAROUND::STUCK );
+        bool otherStuck = ( aOther.m_status == WALKAROUND::STUCK );
+
+        if( stuck != otherStuck )
+            return !stuck;
+
+        return m_line.CLine().Length() < aOther.m_line.CLine().Length();
+    }
+};
 
-    viaOk = buildInitialLine( aP, initTrack );
 
+LINE_PLACER::WALK_CANDIDATE LINE_PLACER::walkCandidate( const LINE& aInitialPath,
+                                                        const VECTOR2I& aP, bool aCw,
+                                                        bool aPlaceVia, int aEffort )
+{
+    WALK_CANDIDATE cand;
     WALKAROUND walkaround( m_currentNode, Router() );
 
+    // No debug decorator nor logger here, they are not meant to be used from several
+    // threads at once.
     walkaround.SetSolidsOnly( false );
-    walkaround.SetDebugDecorator( Dbg() );
-    walkaround.SetLogger( Logger() );
     walkaround.SetIterationLimit( Settings().WalkaroundIterationLimit() );
+    walkaround.SetTimeLimit( Settings().WalkaroundTimeLimit() );
+    walkaround.SetForceWinding( true, aCw );
 
-    WALKAROUND::RESULT wr = walkaround.Route( initTrack );
-    //WALKAROUND::WALKAROUND_STATUS wf = walkaround.Route( initTrack, walkFull, false );
+    WALKAROUND::RESULT wr = walkaround.Route( aInitialPath );
 
-    auto l_cw = wr.lineCw.CLine();
-    auto l_ccw = wr.lineCcw.CLine();
+    cand.m_status = aCw ? wr.statusCw : wr.statusCcw;
+    cand.m_walk = aCw ? wr.lineCw : wr.lineCcw;
 
-    if( wr.statusCcw == WALKAROUND::ALMOST_DONE || wr.statusCw == WALKAROUND::ALMOST_DONE )
-    {
+    SHAPE_LINE_CHAIN l = cand.m_walk.CLine();
 
-        auto p_cw = closestProjectedPoint( l_cw, aP );
-        auto p_ccw = closestProjectedPoint( l_ccw, aP );
+    if( cand.m_status == WALKAROUND::ALMOST_DONE )
+    {
+        int idx = l.Split( closestProjectedPoint( l, aP ) );
+        l = l.Slice( 0, idx );
+    }
 
-        int idx_cw = l_cw.Split( p_cw );
-        int idx_ccw = l_ccw.Split( p_ccw );
+    cand.m_line = m_head;
+    cand.m_line.SetShape( l );
 
-        l_cw = l_cw.Slice( 0, idx_cw );
-        l_ccw = l_ccw.Slice( 0, idx_ccw );
+    if( cand.m_status == WALKAROUND::STUCK )
+        cand.m_line = cand.m_line.ClipToNearestObstacle( m_currentNode );
+    else if( aPlaceVia )
+        cand.m_line.AppendVia( makeVia( cand.m_line.CPoint( -1 ) ) );
 
-        //Dbg()->AddLine( wr.lineCw.CLine(), 3, 40000 );
+    OPTIMIZER::Optimize( &cand.m_line, aEffort, m_currentNode );
 
-        //Dbg()->AddPoint( p_cw, 4 );
-        //Dbg()->AddPoint( p_ccw, 5 );
+    cand.m_collides = static_cast<bool>( m_currentNode->CheckColliding( &cand.m_line ) );
 
-        Dbg()->AddLine( wr.lineCw.CLine(), 4, 1000 );
-        Dbg()->AddLine( wr.lineCcw.CLine(), 5, 1000 );
+    return cand;
+}
 
-    }
 
-    walkFull.SetShape( l_ccw.Length() < l_cw.Length() ? l_ccw : l_cw );
+bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
+{
+    LINE initTrack( m_head );
+    int effort = 0;
 
-    Dbg()->AddLine( walkFull.CLine(), 2, 100000, "walk-full" );
+    bool viaOk = buildInitialLine( aP, initTrack );
 
     switch( Settings().OptimizerEffort() )
     {
@@ -452,28 +479,37 @@ bool LINE_PLACER::rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead )
     if( Settings().SmartPads() )
         effort |= OPTIMIZER::SMART_PADS;
 
-    if( wr.statusCw == WALKAROUND::STUCK || wr.statusCcw == WALKAROUND::STUCK )
-    {
-        walkFull = walkFull.ClipToNearestObstacle( m_currentNode );
-        rv = true;
-    }
-    else if( m_placingVia && viaOk )
-    {
-        walkFull.AppendVia( makeVia( walkFull.CPoint( -1 ) ) );
-    }
+    bool placeVia = m_placingVia && viaOk;
+
+    // Walk around clockwise and counterclockwise at the same time, each within the walkaround
+    // time limit, and keep the best of the two. Both only read the current node.
+    std::future<WALK_CANDIDATE> ccw = std::async( std::launch::async,
+            [&]()
+            {
+                return walkCandidate( initTrack, aP, false, placeVia, effort );
+            } );
+
+    WALK_CANDIDATE best = walkCandidate( initTrack, aP, true, placeVia, effort );
+    WALK_CANDIDATE other = ccw.get();
 
-    OPTIMIZER::Optimize( &walkFull, effort, m_currentNode );
+    Dbg()->AddLine( best.m_walk.CLine(), 4, 1000 );
+    Dbg()->AddLine( other.m_walk.CLine(), 5, 1000 );
 
-    if( m_currentNode->CheckColliding( &walkFull ) )
+    if( other.BetterThan( best ) )
+        std::swap( best, other );
+
+    Dbg()->AddLine( best.m_line.CLine(), 2, 100000, "walk-full" );
+
+    if( best.m_collides )
     {
         aNewHead = m_head;
         return false;
     }
 
-    m_head = walkFull;
-    aNewHead = walkFull;
+    m_head = best.m_line;
+    aNewHead = best.m_line;
 
-    return rv;
+    return true;
 }
 
 
@@ -638,6 +674,8 @@ bool LINE_PLACER::rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead )
     
     OPTIMIZER optimizer( m_currentNode );
 
+    optimizer.SetDebugDecorator( Dbg() );
+
     WALKAROUND walkaround( m_currentNode, Router() );
 
     walkaround.SetSolidsOnly( true );
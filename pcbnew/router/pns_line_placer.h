@@ -374,9 +374,16 @@ private:
     bool rhStopAtNearestObstacle( const VECTOR2I& aP, LINE& aNewHead );
 
 
+    struct WALK_CANDIDATE;
+
     ///> route step, walkaround mode
     bool rhWalkOnly( const VECTOR2I& aP, LINE& aNewHead);
 
+    ///> walks around the obstacles in a single winding direction and cleans up the result.
+    ///> Only reads the current node, so several candidates can be evaluated concurrently.
+    WALK_CANDIDATE walkCandidate( const LINE& aInitialPath, const VECTOR2I& aP, bool aCw,
+                                  bool aPlaceVia, int aEffort );
+
     ///> route step, shove mode
     bool rhShoveOnly( const VECTOR2I& aP, LINE& aNewHead);
 
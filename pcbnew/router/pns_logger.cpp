@@ -26,12 +26,16 @@
 #include "pns_segment.h"
 #include "pns_solid.h"
 
+#include <board_connected_item.h>
+
 #include <geometry/shape.h>
 #include <geometry/shape_line_chain.h>
 #include <geometry/shape_rect.h>
 #include <geometry/shape_circle.h>
 #include <geometry/shape_simple.h>
 
+#include <fstream>
+
 namespace PNS {
 
 LOGGER::LOGGER( )
@@ -49,6 +53,7 @@ void LOGGER::Clear()
 {
     m_theLog.str( std::string() );
     m_groupOpened = false;
+    m_events.clear();
 }
 
 
@@ -133,6 +138,59 @@ void LOGGER::Log( const SHAPE_LINE_CHAIN *aL, int aKind, const std::string& aNam
 }
 
 
+void LOGGER::Log( LOGGER::EVENT_TYPE aEvent, const VECTOR2I& aPos, const ITEM* aItem,
+                  int aLayer, int aMode )
+{
+    EVENT_ENTRY ent;
+
+    ent.type = aEvent;
+    ent.p = aPos;
+    ent.layer = aLayer;
+    ent.mode = aMode;
+    ent.uuid = ( aItem && aItem->Parent() ) ? aItem->Parent()->m_Uuid : niluuid;
+
+    m_events.push_back( ent );
+
+    m_theLog << "event " << aEvent << " " << aPos.x << " " << aPos.y << " " << aLayer << " "
+             << aMode << " " << ent.uuid.AsString().ToStdString() << std::endl;
+}
+
+
+bool LOGGER::LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents )
+{
+    std::ifstream f( aFilename );
+
+    if( !f.is_open() )
+        return false;
+
+    std::string line;
+
+    while( std::getline( f, line ) )
+    {
+        std::istringstream str( line );
+        std::string        tag, uuid;
+        int                type;
+        EVENT_ENTRY        ent;
+
+        str >> tag;
+
+        if( tag != "event" )
+            continue;
+
+        str >> type >> ent.p.x >> ent.p.y >> ent.layer >> ent.mode >> uuid;
+
+        if( str.fail() )
+            continue;
+
+        ent.type = static_cast<EVENT_TYPE>( type );
+        ent.uuid = KIID( wxString( uuid ) );
+        aEvents.push_back( ent );
+    }
+
+    return true;
+}
+
+
 void LOGGER::Log( const VECTOR2I& aStart, const VECTOR2I& aEnd,
                       int aKind, const std::string& aName)
 {
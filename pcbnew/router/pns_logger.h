@@ -28,6 +28,7 @@
 #include <sstream>
 
 #include <math/vector2d.h>
+#include <common.h>
 
 class SHAPE_LINE_CHAIN;
 class SHAPE;
@@ -39,12 +40,45 @@ class ITEM;
 class LOGGER
 {
 public:
+    ///> Router events recorded so that an interactive session can be replayed later.
+    enum EVENT_TYPE
+    {
+        EVT_START_ROUTE = 0,
+        EVT_START_DRAG,
+        EVT_FIX,
+        EVT_MOVE,
+        EVT_ABORT
+    };
+
+    struct EVENT_ENTRY
+    {
+        EVENT_TYPE  type;
+        VECTOR2I    p;
+        int         layer;      ///< start layer (EVT_START_ROUTE only)
+        int         mode;       ///< router/drag mode or force-finish flag, depending on type
+        KIID        uuid;       ///< parent of the start/end item, niluuid if none
+    };
+
     LOGGER();
     ~LOGGER();
 
     void Save( const std::string& aFilename );
     void Clear();
 
+    void Log( EVENT_TYPE aEvent, const VECTOR2I& aPos, const ITEM* aItem = nullptr,
+              int aLayer = -1, int aMode = 0 );
+
+    const std::vector<EVENT_ENTRY>& GetEvents() const
+    {
+        return m_events;
+    }
+
+    /**
+     * Reads back the events from a log written by Save(). Geometry entries are skipped.
+     * @return false if the file cannot be opened.
+     */
+    static bool LoadEvents( const std::string& aFilename, std::vector<EVENT_ENTRY>& aEvents );
+
     void NewGroup( const std::string& aName, int aIter = 0 );
     void EndGroup();
 
@@ -58,6 +92,7 @@ private:
 
     bool m_groupOpened;
     std::stringstream m_theLog;
+    std::vector<EVENT_ENTRY> m_events;
 };
 
 }
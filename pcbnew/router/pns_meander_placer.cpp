@@ -81,6 +81,8 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
     TOPOLOGY topo( m_world );
     m_tunedPath = topo.AssembleTrivialPath( m_initialSegment );
+    m_origPathLength = origPathLength();
+    m_cut.Clear();
 
     m_world->Remove( m_originLine );
 
@@ -93,16 +95,7 @@ bool MEANDER_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
 
 long long int MEANDER_PLACER::origPathLength() const
 {
-    long long int total = m_padToDieLenth;
-    for( const ITEM* item : m_tunedPath.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-        {
-            total += l->CLine().Length();
-        }
-    }
-
-    return total;
+    return m_padToDieLenth + pathLength( m_tunedPath );
 }
 
 
@@ -121,7 +114,7 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int a
 
     m_currentNode = m_world->Branch();
 
-    cutTunedLine( m_originLine.CLine(), m_currentStart, aP, pre, tuned, post );
+    cutTunedLine( m_originLine.CLine(), m_currentStart, aP, pre, tuned, post, &m_cut );
 
     m_result = MEANDERED_LINE( this, false );
     m_result.SetWidth( m_originLine.Width() );
@@ -135,7 +128,7 @@ bool MEANDER_PLACER::doMove( const VECTOR2I& aP, ITEM* aEndItem, long long int a
         m_result.AddCorner( s.B );
     }
 
-    long long int lineLen = origPathLength();
+    long long int lineLen = m_origPathLength;
 
     m_lastLength = lineLen;
     m_lastStatus = TUNED;
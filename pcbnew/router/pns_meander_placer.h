@@ -114,6 +114,9 @@ protected:
     LINE     m_currentTrace;
     ITEM_SET m_tunedPath;
 
+    ///> cached split of m_originLine at the current cursor position
+    TUNED_LINE_CUT m_cut;
+
     SHAPE_LINE_CHAIN m_finalShape;
     MEANDERED_LINE   m_result;
     SEGMENT*         m_initialSegment;
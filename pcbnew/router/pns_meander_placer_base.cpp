@@ -32,6 +32,7 @@ MEANDER_PLACER_BASE::MEANDER_PLACER_BASE( ROUTER* aRouter ) :
     m_world = NULL;
     m_currentWidth = 0;
     m_padToDieLenth = 0;
+    m_origPathLength = 0;
 }
 
 
@@ -69,7 +70,8 @@ void MEANDER_PLACER_BASE::cutTunedLine( const SHAPE_LINE_CHAIN& aOrigin,
                                             const VECTOR2I& aCursorPos,
                                             SHAPE_LINE_CHAIN& aPre,
                                             SHAPE_LINE_CHAIN& aTuned,
-                                            SHAPE_LINE_CHAIN& aPost )
+                                            SHAPE_LINE_CHAIN& aPost,
+                                            TUNED_LINE_CUT* aCache )
 {
     VECTOR2I cp ( aCursorPos );
 
@@ -85,7 +87,29 @@ void MEANDER_PLACER_BASE::cutTunedLine( const SHAPE_LINE_CHAIN& aOrigin,
     }
 
     VECTOR2I n = aOrigin.NearestPoint( cp );
-    VECTOR2I m = aOrigin.NearestPoint( aTuneStart );
+
+    // The cut depends only on where the cursor and the start point project on the line
+    if( aCache && aCache->m_valid && aCache->m_cursorProj == n )
+    {
+        aPre = aCache->m_pre;
+        aTuned = aCache->m_tuned;
+        aPost = aCache->m_post;
+        return;
+    }
+
+    VECTOR2I m;
+
+    if( aCache && aCache->m_startProj )
+    {
+        m = *aCache->m_startProj;
+    }
+    else
+    {
+        m = aOrigin.NearestPoint( aTuneStart );
+
+        if( aCache )
+            aCache->m_startProj = m;
+    }
 
     SHAPE_LINE_CHAIN l( aOrigin );
     l.Split( n );
@@ -106,6 +130,29 @@ void MEANDER_PLACER_BASE::cutTunedLine( const SHAPE_LINE_CHAIN& aOrigin,
     aTuned = l.Slice( i_start, i_end );
 
     aTuned.Simplify();
+
+    if( aCache )
+    {
+        aCache->m_valid = true;
+        aCache->m_cursorProj = n;
+        aCache->m_pre = aPre;
+        aCache->m_tuned = aTuned;
+        aCache->m_post = aPost;
+    }
+}
+
+
+long long int MEANDER_PLACER_BASE::pathLength( const ITEM_SET& aPath )
+{
+    long long int total = 0;
+
+    for( const ITEM* item : aPath.CItems() )
+    {
+        if( const LINE* l = dyn_cast<const LINE*>( item ) )
+            total += l->CLine().Length();
+    }
+
+    return total;
 }
 
 
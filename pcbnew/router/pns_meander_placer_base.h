@@ -124,6 +124,31 @@ public:
 
 protected:
 
+    /**
+     * Struct TUNED_LINE_CUT
+     *
+     * Remembers the last split done by cutTunedLine() for a given line, so that
+     * events which don't move the end of the tuned span (cursor moving away from the
+     * track, amplitude/spacing changes) don't split the whole line again.
+     */
+    struct TUNED_LINE_CUT
+    {
+        TUNED_LINE_CUT() :
+            m_valid( false )
+        {}
+
+        void Clear()
+        {
+            m_valid = false;
+            m_startProj = OPT_VECTOR2I();
+        }
+
+        bool             m_valid;
+        OPT_VECTOR2I     m_startProj;  ///> tuning start projected on the line (never changes)
+        VECTOR2I         m_cursorProj; ///> cursor projected on the line, for the cached cut
+        SHAPE_LINE_CHAIN m_pre, m_tuned, m_post;
+    };
+
     /**
      * Function cutTunedLine()
      *
@@ -135,13 +160,24 @@ protected:
      * @param aPre part before the beginning of meanders
      * @param aTuned part to be meandered
      * @param aPost part after the end of meanders
+     * @param aCache optional cut of aOrigin from a previous call, reused if the tuned span
+     * didn't change
      */
     void cutTunedLine(  const SHAPE_LINE_CHAIN& aOrigin,
                         const VECTOR2I&         aTuneStart,
                         const VECTOR2I&         aCursorPos,
                         SHAPE_LINE_CHAIN&       aPre,
                         SHAPE_LINE_CHAIN&       aTuned,
-                        SHAPE_LINE_CHAIN&       aPost );
+                        SHAPE_LINE_CHAIN&       aPost,
+                        TUNED_LINE_CUT*         aCache = nullptr );
+
+    /**
+     * Function pathLength()
+     *
+     * Returns the total length of the lines in aPath, as assembled by
+     * TOPOLOGY::AssembleTrivialPath().
+     */
+    static long long int pathLength( const ITEM_SET& aPath );
 
     /**
      * Function tuneLineLength()
@@ -165,6 +201,10 @@ protected:
     ///> total length added by pad to die size
     int m_padToDieLenth;
 
+    ///> length of the tuned path(s) when the tuning started, including the pad to die
+    ///> lengths. The topology doesn't change while tuning, so it's only computed in Start().
+    long long int m_origPathLength;
+
     ///> width of the meandered trace(s)
     int m_currentWidth;
     ///> meandering settings
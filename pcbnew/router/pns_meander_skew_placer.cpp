@@ -105,6 +105,9 @@ bool MEANDER_SKEW_PLACER::Start( const VECTOR2I& aP, ITEM* aStartItem )
         m_coupledLength = itemsetLength( m_tunedPathP );
     }
 
+    m_origPathLength = origPathLength();
+    m_cut.Clear();
+
     return true;
 }
 
@@ -117,16 +120,7 @@ long long int MEANDER_SKEW_PLACER::origPathLength() const
 
 long long int MEANDER_SKEW_PLACER::itemsetLength( const ITEM_SET& aSet ) const
 {
-    long long int total = m_padToDieLenth;
-    for( const ITEM* item : aSet.CItems() )
-    {
-        if( const LINE* l = dyn_cast<const LINE*>( item ) )
-        {
-            total += l->CLine().Length();
-        }
-    }
-
-    return total;
+    return m_padToDieLenth + pathLength( aSet );
 }
 
 
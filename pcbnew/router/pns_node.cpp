@@ -52,7 +52,10 @@ NODE::NODE()
     m_parent = NULL;
     m_maxClearance = 800000;    // fixme: depends on how thick traces are.
     m_ruleResolver = NULL;
-    m_index = new INDEX;
+    m_queryCount = 0;
+    m_index = std::make_shared<INDEX>();
+    m_joints = std::make_shared<JOINT_MAP>();
+    m_override = std::make_shared<std::unordered_set<ITEM*>>();
 
 #ifdef DEBUG
     allocNodes.insert( this );
@@ -80,18 +83,20 @@ NODE::~NODE()
     allocNodes.erase( this );
 #endif
 
-    m_joints.clear();
+    m_joints.reset();
 
-    for( ITEM* item : *m_index )
+    // A shared index only holds items owned by the nodes it was inherited from
+    if( m_index.use_count() == 1 )
     {
-        if( item->BelongsTo( this ) )
-            delete item;
+        for( ITEM* item : *m_index )
+        {
+            if( item->BelongsTo( this ) )
+                delete item;
+        }
     }
 
     releaseGarbage();
     unlinkParent();
-
-    delete m_index;
 }
 
 int NODE::GetClearance( const ITEM* aA, const ITEM* aB ) const
@@ -117,26 +122,48 @@ NODE* NODE::Branch()
     child->m_root = isRoot() ? this : m_root;
     child->m_maxClearance = m_maxClearance;
 
-    // Immmediate offspring of the root branch needs not copy anything. For the rest, deep-copy
-    // joints, overridden item maps and pointers to stored items.
+    // Immmediate offspring of the root branch needs not copy anything. The rest shares the
+    // joints, overridden item maps and pointers to stored items with this node until one of
+    // the two is modified (see detach()).
     if( !isRoot() )
     {
-        JOINT_MAP::iterator j;
-
-        for( ITEM* item : *m_index )
-            child->m_index->Add( item );
-
+        child->m_index = m_index;
         child->m_joints = m_joints;
         child->m_override = m_override;
     }
+    else
+    {
+        // The root only changes on commits, while all of its branches keep searching it.
+        m_index->SetPacked( true );
+    }
 
     wxLogTrace( "PNS", "%d items, %d joints, %d overrides",
-            child->m_index->Size(), (int) child->m_joints.size(), (int) child->m_override.size() );
+            child->m_index->Size(), (int) child->m_joints->size(), (int) child->m_override->size() );
 
     return child;
 }
 
 
+void NODE::detach()
+{
+    if( m_index.use_count() > 1 )
+    {
+        std::shared_ptr<INDEX> index = std::make_shared<INDEX>();
+
+        for( ITEM* item : *m_index )
+            index->Add( item );
+
+        m_index = index;
+    }
+
+    if( m_joints.use_count() > 1 )
+        m_joints = std::make_shared<JOINT_MAP>( *m_joints );
+
+    if( m_override.use_count() > 1 )
+        m_override = std::make_shared<std::unordered_set<ITEM*>>( *m_override );
+}
+
+
 void NODE::unlinkParent()
 {
     if( isRoot() )
@@ -261,6 +288,8 @@ struct NODE::DEFAULT_OBSTACLE_VISITOR : public OBSTACLE_VISITOR
 
 int NODE::QueryColliding( const ITEM* aItem, OBSTACLE_VISITOR& aVisitor )
 {
+    m_root->m_queryCount++;
+
     aVisitor.SetWorld( this, NULL );
     m_index->Query( aItem, m_maxClearance, aVisitor );
 
@@ -284,6 +313,8 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
     assert( allocNodes.find( this ) != allocNodes.end() );
 #endif
 
+    m_root->m_queryCount++;
+
     visitor.SetCountLimit( aLimitCount );
     visitor.SetWorld( this, NULL );
     visitor.m_forceClearance = aForceClearance;
@@ -301,6 +332,64 @@ int NODE::QueryColliding( const ITEM* aItem, NODE::OBSTACLES& aObstacles, int aK
 }
 
 
+int NODE::QueryColliding( const std::vector<const ITEM*>& aItems, NODE::OBSTACLES& aObstacles,
+                          int aKindMask, int aLimitCount, bool aFirstCollidingOnly )
+{
+    std::vector<OBSTACLES> found( aItems.size() );
+    std::vector<DEFAULT_OBSTACLE_VISITOR> visitors;
+
+    // Index of the first item known to collide (if only its obstacles are wanted)
+    int firstColliding = (int) aItems.size();
+
+    m_root->m_queryCount += (int64_t) aItems.size();
+
+    visitors.reserve( aItems.size() );
+
+    for( size_t i = 0; i < aItems.size(); i++ )
+    {
+        visitors.emplace_back( found[i], aItems[i], aKindMask, true );
+        visitors.back().SetCountLimit( aLimitCount );
+        visitors.back().SetWorld( this, NULL );
+    }
+
+    auto visit = [&]( int aIndex, ITEM* aCandidate ) -> bool
+    {
+        DEFAULT_OBSTACLE_VISITOR& visitor = visitors[aIndex];
+
+        // The items after the first colliding one can't change the result
+        if( aIndex > firstColliding )
+            return false;
+
+        if( aLimitCount > 0 && visitor.m_matchCount >= aLimitCount )
+            return false;
+
+        bool more = visitor( aCandidate );
+
+        if( aFirstCollidingOnly && visitor.m_matchCount > 0 )
+            firstColliding = std::min( firstColliding, aIndex );
+
+        return more;
+    };
+
+    // first, look for colliding items in the local index
+    m_index->QueryBatch( aItems, m_maxClearance, visit );
+
+    // The first item collides in this node already, its obstacles in the root are not needed
+    if( !isRoot() && firstColliding > 0 )
+    {
+        for( DEFAULT_OBSTACLE_VISITOR& visitor : visitors )
+            visitor.SetWorld( m_root, this );
+
+        m_root->m_index->QueryBatch( aItems, m_maxClearance, visit );
+    }
+
+    for( int i = 0; i < (int) found.size() && i <= firstColliding; i++ )
+        aObstacles.insert( aObstacles.end(), found[i].begin(), found[i].end() );
+
+    return aObstacles.size();
+}
+
+
 NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
                                           const std::set<ITEM*>* aRestrictedSet )
 {
@@ -311,16 +400,22 @@ NODE::OPT_OBSTACLE NODE::NearestObstacle( const LINE* aItem, int aKindMask,
 
     obs_list.reserve( 100 );
 
-    int n = 0;
+    std::vector<SEGMENT> segs;
+    std::vector<const ITEM*> items;
+
+    segs.reserve( line.SegmentCount() );
+    items.reserve( line.SegmentCount() + 1 );
 
     for( int i = 0; i < line.SegmentCount(); i++ )
     {
-        const SEGMENT s( *aItem, line.CSegment( i ) );
-        n += QueryColliding( &s, obs_list, aKindMask );
+        segs.emplace_back( *aItem, line.CSegment( i ) );
+        items.push_back( &segs.back() );
     }
 
     if( aItem->EndsWithVia() )
-        n += QueryColliding( &aItem->Via(), obs_list, aKindMask );
+        items.push_back( &aItem->Via() );
+
+    int n = QueryColliding( items, obs_list, aKindMask );
 
     if( !n )
         return OPT_OBSTACLE();
@@ -432,26 +527,27 @@ NODE::OPT_OBSTACLE NODE::CheckColliding( const ITEM* aItemA, int aKindMask )
 
     if( aItemA->Kind() == ITEM::LINE_T )
     {
-        int n = 0;
         const LINE* line = static_cast<const LINE*>( aItemA );
         const SHAPE_LINE_CHAIN& l = line->CLine();
+        std::vector<SEGMENT> segs;
+        std::vector<const ITEM*> items;
+
+        segs.reserve( l.SegmentCount() );
+        items.reserve( l.SegmentCount() + 1 );
 
         for( int i = 0; i < l.SegmentCount(); i++ )
         {
-            const SEGMENT s( *line, l.CSegment( i ) );
-            n += QueryColliding( &s, obs, aKindMask, 1 );
-
-            if( n )
-                return OPT_OBSTACLE( obs[0] );
+            segs.emplace_back( *line, l.CSegment( i ) );
+            items.push_back( &segs.back() );
         }
 
         if( line->EndsWithVia() )
-        {
-            n += QueryColliding( &line->Via(), obs, aKindMask, 1 );
+            items.push_back( &line->Via() );
 
-            if( n )
-                return OPT_OBSTACLE( obs[0] );
-        }
+        // obstacles come ordered by the item they collide with, so the first one still
+        // belongs to the first colliding segment.  The segments after it are not searched.
+        if( QueryColliding( items, obs, aKindMask, 1, true ) > 0 )
+            return OPT_OBSTACLE( obs[0] );
     }
     else if( QueryColliding( aItemA, obs, aKindMask, 1 ) > 0 )
         return OPT_OBSTACLE( obs[0] );
@@ -538,6 +634,8 @@ const ITEM_SET NODE::HitTest( const VECTOR2I& aPoint ) const
 
 void NODE::addSolid( SOLID* aSolid )
 {
+    detach();
+
     if( aSolid->IsRoutable() )
         linkJoint( aSolid->Pos(), aSolid->Layers(), aSolid->Net(), aSolid );
 
@@ -552,6 +650,8 @@ void NODE::Add( std::unique_ptr< SOLID > aSolid )
 
 void NODE::addVia( VIA* aVia )
 {
+    detach();
+
     linkJoint( aVia->Pos(), aVia->Layers(), aVia->Net(), aVia );
     m_index->Add( aVia );
 }
@@ -611,6 +711,8 @@ void NODE::Add( LINE& aLine, bool aAllowRedundant )
 
 void NODE::addSegment( SEGMENT* aSeg )
 {
+    detach();
+
     linkJoint( aSeg->Seg().A, aSeg->Layers(), aSeg->Net(), aSeg );
     linkJoint( aSeg->Seg().B, aSeg->Layers(), aSeg->Net(), aSeg );
 
@@ -636,6 +738,8 @@ bool NODE::Add( std::unique_ptr< SEGMENT > aSegment, bool aAllowRedundant )
 
 void NODE::addArc( ARC* aArc )
 {
+    detach();
+
     linkJoint( aArc->Anchor( 0 ), aArc->Layers(), aArc->Net(), aArc );
     linkJoint( aArc->Anchor( 1 ), aArc->Layers(), aArc->Net(), aArc );
 
@@ -673,7 +777,7 @@ void NODE::doRemove( ITEM* aItem )
     // case 1: removing an item that is stored in the root node from any branch:
     // mark it as overridden, but do not remove
     if( aItem->BelongsTo( m_root ) && !isRoot() )
-        m_override.insert( aItem );
+        m_override->insert( aItem );
 
     // case 2: the item belongs to this branch or a parent, non-root branch,
     // or the root itself and we are the root: remove from the index
@@ -719,9 +823,9 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
     do
     {
         split = false;
-        auto range = m_joints.equal_range( tag );
+        auto range = m_joints->equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == m_joints->end() )
             break;
 
         // find and remove all joints containing the via to be removed
@@ -730,7 +834,7 @@ void NODE::rebuildJoint( JOINT* aJoint, ITEM* aItem )
         {
             if( aItem->LayersOverlap( &f->second ) )
             {
-                m_joints.erase( f );
+                m_joints->erase( f );
                 split = true;
                 break;
             }
@@ -777,24 +881,28 @@ void NODE::Replace( LINE& aOldLine, LINE& aNewLine )
 
 void NODE::Remove( SOLID* aSolid )
 {
+    detach();
     removeSolidIndex( aSolid );
     doRemove( aSolid );
 }
 
 void NODE::Remove( VIA* aVia )
 {
+    detach();
     removeViaIndex( aVia );
     doRemove( aVia );
 }
 
 void NODE::Remove( SEGMENT* aSegment )
 {
+    detach();
     removeSegmentIndex( aSegment );
     doRemove( aSegment );
 }
 
 void NODE::Remove( ARC* aArc )
 {
+    detach();
     removeArcIndex( aArc );
     doRemove( aArc );
 }
@@ -1031,12 +1139,12 @@ JOINT* NODE::FindJoint( const VECTOR2I& aPos, int aLayer, int aNet )
     tag.net = aNet;
     tag.pos = aPos;
 
-    JOINT_MAP::iterator f = m_joints.find( tag ), end = m_joints.end();
+    JOINT_MAP::iterator f = m_joints->find( tag ), end = m_joints->end();
 
     if( f == end && !isRoot() )
     {
-        end = m_root->m_joints.end();
-        f = m_root->m_joints.find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
+        end = m_root->m_joints->end();
+        f = m_root->m_joints->find( tag );    // m_root->FindJoint(aPos, aLayer, aNet);
     }
 
     if( f == end )
@@ -1063,23 +1171,25 @@ void NODE::LockJoint( const VECTOR2I& aPos, const ITEM* aItem, bool aLock )
 
 JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int aNet )
 {
+    detach();
+
     JOINT::HASH_TAG tag;
 
     tag.pos = aPos;
     tag.net = aNet;
 
     // try to find the joint in this node.
-    JOINT_MAP::iterator f = m_joints.find( tag );
+    JOINT_MAP::iterator f = m_joints->find( tag );
 
     std::pair<JOINT_MAP::iterator, JOINT_MAP::iterator> range;
 
     // not found and we are not root? find in the root and copy results here.
-    if( f == m_joints.end() && !isRoot() )
+    if( f == m_joints->end() && !isRoot() )
     {
-        range = m_root->m_joints.equal_range( tag );
+        range = m_root->m_joints->equal_range( tag );
 
         for( f = range.first; f != range.second; ++f )
-            m_joints.insert( *f );
+            m_joints->insert( *f );
     }
 
     // now insert and combine overlapping joints
@@ -1090,9 +1200,9 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     do
     {
         merged  = false;
-        range   = m_joints.equal_range( tag );
+        range   = m_joints->equal_range( tag );
 
-        if( range.first == m_joints.end() )
+        if( range.first == m_joints->end() )
             break;
 
         for( f = range.first; f != range.second; ++f )
@@ -1100,7 +1210,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
             if( aLayers.Overlaps( f->second.Layers() ) )
             {
                 jt.Merge( f->second );
-                m_joints.erase( f );
+                m_joints->erase( f );
                 merged = true;
                 break;
             }
@@ -1108,7 +1218,7 @@ JOINT& NODE::touchJoint( const VECTOR2I& aPos, const LAYER_RANGE& aLayers, int a
     }
     while( merged );
 
-    return m_joints.insert( TagJointPair( tag, jt ) )->second;
+    return m_joints->insert( TagJointPair( tag, jt ) )->second;
 }
 
 
@@ -1162,7 +1272,7 @@ void NODE::Dump( bool aLong )
     JOINT_MAP::iterator j;
 
     if( aLong )
-        for( j = m_joints.begin(); j != m_joints.end(); ++j )
+        for( j = m_joints->begin(); j != m_joints->end(); ++j )
         {
             wxLogTrace( "PNS", "joint : %s, links : %d\n",
                     j->second.GetPos().Format().c_str(), j->second.LinkCount() );
@@ -1214,7 +1324,7 @@ void NODE::Dump( bool aLong )
         lines_count++;
     }
 
-    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints.size(), lines_count );
+    wxLogTrace( "PNS", "Local joints: %d, lines : %d \n", m_joints->size(), lines_count );
 #endif
 }
 
@@ -1224,13 +1334,13 @@ void NODE::GetUpdatedItems( ITEM_VECTOR& aRemoved, ITEM_VECTOR& aAdded )
     if( isRoot() )
         return;
 
-    if( m_override.size() )
-        aRemoved.reserve( m_override.size() );
+    if( m_override->size() )
+        aRemoved.reserve( m_override->size() );
     
     if( m_index->Size() )
         aAdded.reserve( m_index->Size() );
 
-    for( ITEM* item : m_override )
+    for( ITEM* item : *m_override )
         aRemoved.push_back( item );
 
     for( INDEX::ITEM_SET::iterator i = m_index->begin(); i != m_index->end(); ++i )
@@ -1270,7 +1380,7 @@ void NODE::Commit( NODE* aNode )
         if( aNode->isRoot() )
             return;
 
-        for( ITEM* item : aNode->m_override )
+        for( ITEM* item : *aNode->m_override )
             Remove( item );
 
         for( auto i : *aNode->m_index )
@@ -1410,7 +1520,7 @@ int NODE::QueryJoints( const BOX2I& aBox,
 
     aJoints.clear();
 
-    for( auto j = m_joints.begin(); j != m_joints.end(); ++j )
+    for( auto j = m_joints->begin(); j != m_joints->end(); ++j )
     {
         if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
         {
@@ -1423,7 +1533,7 @@ int NODE::QueryJoints( const BOX2I& aBox,
     if ( isRoot() )
         return n;
 
-    for( auto j = m_root->m_joints.begin(); j != m_root->m_joints.end(); ++j )
+    for( auto j = m_root->m_joints->begin(); j != m_root->m_joints->end(); ++j )
     {
         if( ! Overrides( &j->second) )
         {   if ( aBox.Contains(j->second.Pos()) && j->second.LinkCount ( aKindMask ) )
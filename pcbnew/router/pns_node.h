@@ -26,6 +26,8 @@
 #include <list>
 #include <unordered_set>
 #include <unordered_map>
+#include <memory>
+#include <atomic>
 
 #include <core/optional.h>
 
@@ -181,7 +183,7 @@ public:
     ///> Returns the number of joints
     int JointCount() const
     {
-        return m_joints.size();
+        return m_joints->size();
     }
 
     ///> Returns the number of nodes in the inheritance chain (wrs to the root node)
@@ -190,6 +192,18 @@ public:
         return m_depth;
     }
 
+    ///> Returns the number of collision queries run against the root node and all of its
+    ///> branches since the last ResetQueryCount()
+    int64_t QueryCount() const
+    {
+        return m_root->m_queryCount;
+    }
+
+    void ResetQueryCount()
+    {
+        m_root->m_queryCount = 0;
+    }
+
     /**
      * Function QueryColliding()
      *
@@ -207,6 +221,26 @@ public:
                         bool         aDifferentNetsOnly = true,
                         int          aForceClearance = -1 );
 
+    /**
+     * Function QueryColliding()
+     *
+     * Batched version of the above, searching the spatial index once for the whole set of items.
+     * @param aItems items to check collisions against (e.g. all segments of a line)
+     * @param aObstacles set of colliding objects found, in the order of the items they collide with
+     * @param aKindMask mask of obstacle types to take into account
+     * @param aLimitCount stop looking for collisions with an item after finding this number of
+     *                    items colliding with it
+     * @param aFirstCollidingOnly only the obstacles of the first colliding item of aItems are
+     *                            wanted: the search stops for the items after it as soon as it
+     *                            is found
+     * @return number of obstacles found
+     */
+    int QueryColliding( const std::vector<const ITEM*>& aItems,
+                        OBSTACLES&                      aObstacles,
+                        int                             aKindMask = ITEM::ANY_T,
+                        int                             aLimitCount = -1,
+                        bool                            aFirstCollidingOnly = false );
+
     int QueryJoints( const BOX2I& aBox, std::vector<JOINT*> & aJoints, int aLayerMask = -1, int aKindMask = ITEM::ANY_T);
 
     int QueryColliding( const ITEM* aItem,
@@ -332,6 +366,8 @@ public:
      * Creates a lightweight copy (called branch) of self that tracks
      * the changes (added/removed items) wrs to the root. Note that if there are
      * any branches in use, their parents must NOT be deleted.
+     * The branch shares the parent's item index and joints until one of the two
+     * nodes is modified, so creating a branch that is only queried costs nothing.
      * @return the new branch
      */
     NODE* Branch();
@@ -433,7 +469,7 @@ public:
     ///> from the root branch.
     bool Overrides( ITEM* aItem ) const
     {
-        return m_override.find( aItem ) != m_override.end();
+        return m_override->find( aItem ) != m_override->end();
     }
 
 private:
@@ -491,9 +527,15 @@ private:
     void followLine( LINKED_ITEM* aCurrent, int aScanDirection, int& aPos, int aLimit, VECTOR2I* aCorners,
             LINKED_ITEM** aSegments, bool& aGuardHit, bool aStopAtLockedJoints );
 
+    ///> makes private copies of the joint map, the override set and the index if they
+    ///> are still shared with the branch this node was created from. Must be called
+    ///> before any of them is modified.
+    void detach();
+
     ///> hash table with the joints, linking the items. Joints are hashed by
-    ///> their position, layer set and net.
-    JOINT_MAP m_joints;
+    ///> their position, layer set and net. Shared (copy-on-write) with the parent
+    ///> branch until either of them is modified.
+    std::shared_ptr<JOINT_MAP> m_joints;
 
     ///> node this node was branched from
     NODE* m_parent;
@@ -504,8 +546,8 @@ private:
     ///> list of nodes branched from this one
     std::set<NODE*> m_children;
 
-    ///> hash of root's items that have been changed in this node
-    std::unordered_set<ITEM*> m_override;
+    ///> hash of root's items that have been changed in this node (copy-on-write)
+    std::shared_ptr<std::unordered_set<ITEM*>> m_override;
 
     ///> worst case item-item clearance
     int m_maxClearance;
@@ -513,13 +555,16 @@ private:
     ///> Design rules resolver
     RULE_RESOLVER* m_ruleResolver;
 
-    ///> Geometric/Net index of the items
-    INDEX* m_index;
+    ///> Geometric/Net index of the items (copy-on-write)
+    std::shared_ptr<INDEX> m_index;
 
     ///> depth of the node (number of parent nodes in the inheritance chain)
     int m_depth;
 
     std::unordered_set<ITEM*> m_garbageItems;
+
+    ///> collision query statistics, kept in the root node
+    std::atomic<int64_t> m_queryCount;
 };
 
 }
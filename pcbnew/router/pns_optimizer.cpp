@@ -24,12 +24,16 @@
 #include <geometry/shape_simple.h>
 #include <geometry/shape_file_io.h>
 
+#include <algorithm>
 #include <cmath>
 
+#include <boost/functional/hash.hpp>
+
 #include "pns_arc.h"
 #include "pns_line.h"
 #include "pns_diff_pair.h"
 #include "pns_node.h"
+#include "pns_segment.h"
 #include "pns_solid.h"
 #include "pns_optimizer.h"
 
@@ -41,7 +45,6 @@
 namespace PNS {
 
 
-static DEBUG_DECORATOR *g_dbg;
 /**
  *  Cost Estimator Methods
  */
@@ -135,7 +138,10 @@ OPTIMIZER::OPTIMIZER( NODE* aWorld ) :
     m_collisionKindMask( ITEM::ANY_T ),
     m_effortLevel( MERGE_SEGMENTS ),
     m_keepPostures( false ),
-    m_restrictAreaActive( false )
+    m_restrictAreaActive( false ),
+    m_collisionCacheHits( 0 ),
+    m_collisionQueries( 0 ),
+    m_debugDecorator( nullptr )
 {
 }
 
@@ -428,13 +434,118 @@ bool KEEP_TOPOLOGY_CONSTRAINT::Check ( int aVertex1, int aVertex2, LINE* aOrigin
     return true;
 }
 
+size_t OPTIMIZER::COLLISION_KEY_HASH::operator()( const COLLISION_KEY& aKey ) const
+{
+    size_t seed = 0;
+
+    for( int v : { aKey.m_a.x, aKey.m_a.y, aKey.m_b.x, aKey.m_b.y, aKey.m_width, aKey.m_net,
+                   aKey.m_layerStart, aKey.m_layerEnd } )
+    {
+        boost::hash_combine( seed, v );
+    }
+
+    return seed;
+}
+
+
 bool OPTIMIZER::checkColliding( ITEM* aItem, bool aUpdateCache )
 {
-    CACHE_VISITOR v( aItem, m_world, m_collisionKindMask );
+    if( aItem->Kind() == ITEM::LINE_T )
+        return checkCollidingCached( static_cast<LINE*>( aItem ) );
+
+    m_collisionQueries++;
 
     return static_cast<bool>( m_world->CheckColliding( aItem ) );
 }
 
+
+bool OPTIMIZER::checkCollidingCached( LINE* aLine )
+{
+    const SHAPE_LINE_CHAIN& l = aLine->CLine();
+    const LAYER_RANGE& layers = aLine->Layers();
+
+    std::vector<SEGMENT> segs;
+    std::vector<COLLISION_KEY> keys;
+
+    // The candidate paths tried while merging share most of their segments: only query the
+    // world for the ones not seen before.
+    for( int i = 0; i < l.SegmentCount(); i++ )
+    {
+        const SEG& s = l.CSegment( i );
+        COLLISION_KEY key = { s.A, s.B, aLine->Width(), aLine->Net(), layers.Start(),
+                              layers.End() };
+
+        auto it = m_collisionCache.find( key );
+
+        if( it != m_collisionCache.end() )
+        {
+            m_collisionCacheHits++;
+
+            if( it->second )
+                return true;
+
+            continue;
+        }
+
+        segs.emplace_back( *aLine, s );
+        keys.push_back( key );
+    }
+
+    bool colliding = false;
+
+    if( !segs.empty() )
+    {
+        std::vector<const ITEM*> items;
+        NODE::OBSTACLES obs;
+
+        for( const SEGMENT& seg : segs )
+            items.push_back( &seg );
+
+        m_collisionQueries += segs.size();
+        m_world->QueryColliding( items, obs, ITEM::ANY_T, 1 );
+
+        for( size_t i = 0; i < segs.size(); i++ )
+            m_collisionCache[keys[i]] = false;
+
+        for( const OBSTACLE& o : obs )
+        {
+            auto seg = std::find( items.begin(), items.end(), o.m_head );
+
+            if( seg != items.end() )
+                m_collisionCache[keys[seg - items.begin()]] = true;
+        }
+
+        colliding = !obs.empty();
+    }
+
+    if( !colliding && aLine->EndsWithVia() )
+    {
+        m_collisionQueries++;
+        colliding = static_cast<bool>( m_world->CheckColliding( &aLine->Via() ) );
+    }
+
+    return colliding;
+}
+
+
+void OPTIMIZER::resetCollisionCache()
+{
+    // The counters are per Optimize() call, like the cache
+    m_collisionCache.clear();
+    m_collisionCacheHits = 0;
+    m_collisionQueries = 0;
+}
+
+
+void OPTIMIZER::reportCounters()
+{
+    if( !m_debugDecorator )
+        return;
+
+    m_debugDecorator->AddCounter( "optimizer-collision-queries", m_collisionQueries );
+    m_debugDecorator->AddCounter( "optimizer-collision-cache-hits", m_collisionCacheHits );
+}
+
 void OPTIMIZER::ClearConstraints()
 {
     for (auto c : m_constraints)
@@ -605,6 +716,7 @@ bool OPTIMIZER::Optimize( LINE* aLine, LINE* aResult )
         *aResult = *aLine;
 
     m_keepPostures = false;
+    resetCollisionCache();
 
     bool rv = false;
 
@@ -620,6 +732,8 @@ bool OPTIMIZER::Optimize( LINE* aLine, LINE* aResult )
     if( m_effortLevel & FANOUT_CLEANUP )
         rv |= fanoutCleanup( aResult );
 
+    reportCounters();
+
     return rv;
 }
 
@@ -1011,12 +1125,12 @@ bool OPTIMIZER::runSmartPads( LINE* aLine )
 }
 
 
-bool OPTIMIZER::Optimize( LINE* aLine, int aEffortLevel, NODE* aWorld, const VECTOR2I aV )
+bool OPTIMIZER::Optimize( LINE* aLine, int aEffortLevel, NODE* aWorld, const VECTOR2I aV,
+                          DEBUG_DECORATOR* aDbg )
 {
     OPTIMIZER opt( aWorld );
 
-    g_dbg = ROUTER::GetInstance()->GetInterface()->GetDebugDecorator();
-
+    opt.SetDebugDecorator( aDbg );
     opt.SetEffortLevel( aEffortLevel );
     opt.SetCollisionMask( -1 );
 
@@ -1293,7 +1407,13 @@ bool OPTIMIZER::mergeDpSegments( DIFF_PAIR* aPair )
 
 bool OPTIMIZER::Optimize( DIFF_PAIR* aPair )
 {
-    return mergeDpSegments( aPair );
+    resetCollisionCache();
+
+    bool rv = mergeDpSegments( aPair );
+
+    reportCounters();
+
+    return rv;
 }
 
 static int64_t shovedArea( const SHAPE_LINE_CHAIN& aOld, const SHAPE_LINE_CHAIN& aNew )
@@ -22,6 +22,7 @@
 #ifndef __PNS_OPTIMIZER_H
 #define __PNS_OPTIMIZER_H
 
+#include <cstdint>
 #include <unordered_map>
 #include <memory>
 
@@ -39,6 +40,7 @@ class LINE;
 class DIFF_PAIR;
 class ITEM;
 class JOINT;
+class DEBUG_DECORATOR;
 
 /**
  * COST_ESTIMATOR
@@ -109,13 +111,34 @@ public:
     ~OPTIMIZER();
 
     ///> a quick shortcut to optmize a line without creating and setting up an optimizer
-    static bool Optimize( LINE* aLine, int aEffortLevel, NODE* aWorld, const VECTOR2I aV = VECTOR2I(0, 0) );
-    
+    static bool Optimize( LINE* aLine, int aEffortLevel, NODE* aWorld,
+                          const VECTOR2I aV = VECTOR2I(0, 0), DEBUG_DECORATOR* aDbg = nullptr );
+
     bool Optimize( LINE* aLine, LINE* aResult = NULL );
     bool Optimize( DIFF_PAIR* aPair );
 
 
-    void SetWorld( NODE* aNode ) { m_world = aNode; }
+    void SetWorld( NODE* aNode )
+    {
+        m_world = aNode;
+        m_collisionCache.clear();
+    }
+
+    /**
+     * Function SetDebugDecorator()
+     *
+     * Assigns a debug decorator, receiving the collision cache counters after each Optimize().
+     */
+    void SetDebugDecorator( DEBUG_DECORATOR* aDecorator )
+    {
+        m_debugDecorator = aDecorator;
+    }
+
+    ///> Returns the number of collision checks answered from the cache in the last Optimize()
+    int64_t CollisionCacheHits() const { return m_collisionCacheHits; }
+
+    ///> Returns the number of collision queries sent to the world node in the last Optimize()
+    int64_t CollisionQueries() const { return m_collisionQueries; }
     void CacheStaticItem( ITEM* aItem );
     void CacheRemove( ITEM* aItem );
     void ClearCache( bool aStaticOnly = false );
@@ -156,6 +179,30 @@ private:
         bool m_isStatic;
     };
 
+    /**
+     * Identifies a track segment for the purpose of collision checking: two segments with equal
+     * keys collide with exactly the same items of a given world.
+     */
+    struct COLLISION_KEY
+    {
+        VECTOR2I m_a, m_b;
+        int m_width;
+        int m_net;
+        int m_layerStart, m_layerEnd;
+
+        bool operator==( const COLLISION_KEY& aOther ) const
+        {
+            return m_a == aOther.m_a && m_b == aOther.m_b && m_width == aOther.m_width
+                   && m_net == aOther.m_net && m_layerStart == aOther.m_layerStart
+                   && m_layerEnd == aOther.m_layerEnd;
+        }
+    };
+
+    struct COLLISION_KEY_HASH
+    {
+        size_t operator()( const COLLISION_KEY& aKey ) const;
+    };
+
     bool mergeObtuse( LINE* aLine );
     bool mergeFull( LINE* aLine );
     bool removeUglyCorners( LINE* aLine );
@@ -167,6 +214,9 @@ private:
 
     bool checkColliding( ITEM* aItem, bool aUpdateCache = true );
     bool checkColliding( LINE* aLine, const SHAPE_LINE_CHAIN& aOptPath );
+    bool checkCollidingCached( LINE* aLine );
+    void resetCollisionCache();
+    void reportCounters();
 
     void cacheAdd( ITEM* aItem, bool aIsStatic );
     void removeCachedSegments( LINE* aLine, int aStartVertex = 0, int aEndVertex = -1 );
@@ -190,6 +240,14 @@ private:
     std::vector<OPT_CONSTRAINT*> m_constraints;
     typedef std::unordered_map<ITEM*, CACHED_ITEM> CachedItemTags;
     CachedItemTags m_cacheTags;
+
+    ///> Memoized collision status of track segments against m_world, valid for a single
+    ///> Optimize() call (the world may change in between).
+    std::unordered_map<COLLISION_KEY, bool, COLLISION_KEY_HASH> m_collisionCache;
+    int64_t m_collisionCacheHits;
+    int64_t m_collisionQueries;
+    DEBUG_DECORATOR* m_debugDecorator;
+
     NODE* m_world;
     int m_collisionKindMask;
     int m_effortLevel;
@@ -40,6 +40,7 @@
 #include <geometry/shape_rect.h>
 #include <geometry/shape_circle.h>
 #include <geometry/convex_hull.h>
+#include <profile.h>
 
 #include "pns_node.h"
 #include "pns_line_placer.h"
@@ -139,6 +140,11 @@ bool ROUTER::StartDragging( const VECTOR2I& aP, ITEM_SET aStartItems, int aDragM
     if( aStartItems.Empty() )
         return false;
 
+#ifdef DEBUG
+    m_logger.Clear();
+    m_logger.Log( LOGGER::EVT_START_DRAG, aP, aStartItems[0], -1, aDragMode );
+#endif
+
     if( aStartItems.Count( ITEM::SOLID_T ) == aStartItems.Size() )
     {
         m_dragger = std::make_unique<COMPONENT_DRAGGER>( this );
@@ -199,6 +205,11 @@ bool ROUTER::StartRouting( const VECTOR2I& aP, ITEM* aStartItem, int aLayer )
 
     m_forceMarkObstaclesMode = false;
 
+#ifdef DEBUG
+    m_logger.Clear();
+    m_logger.Log( LOGGER::EVT_START_ROUTE, aP, aStartItem, aLayer, m_mode );
+#endif
+
     switch( m_mode )
     {
         case PNS_MODE_ROUTE_SINGLE:
@@ -245,6 +256,11 @@ void ROUTER::DisplayItems( const ITEM_SET& aItems )
 
 void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
 {
+    PROF_COUNTER cnt;
+
+#ifdef DEBUG
+    m_logger.Log( LOGGER::EVT_MOVE, aP, endItem );
+#endif
     m_currentEnd = aP;
 
     switch( m_state )
@@ -260,6 +276,8 @@ void ROUTER::Move( const VECTOR2I& aP, ITEM* endItem )
     default:
         break;
     }
+
+    wxLogTrace( "PNS", "ROUTER::Move took %.3f ms", cnt.msecs() );
 }
 
 
@@ -392,6 +410,10 @@ bool ROUTER::FixRoute( const VECTOR2I& aP, ITEM* aEndItem, bool aForceFinish )
 {
     bool rv = false;
 
+#ifdef DEBUG
+    m_logger.Log( LOGGER::EVT_FIX, aP, aEndItem, -1, aForceFinish ? 1 : 0 );
+#endif
+
     switch( m_state )
     {
     case ROUTE_TRACK:
@@ -445,6 +467,10 @@ void ROUTER::StopRouting()
     if( !RoutingInProgress() )
         return;
 
+#ifdef DEBUG
+    m_logger.Log( LOGGER::EVT_ABORT, m_currentEnd );
+#endif
+
     m_placer.reset();
     m_dragger.reset();
 
@@ -525,6 +551,8 @@ void ROUTER::DumpLog()
 
     if( logger )
         logger->Save( "/tmp/shove.log" );
+
+    m_logger.Save( "/tmp/pns_events.log" );
 }
 
 
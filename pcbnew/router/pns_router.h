@@ -36,6 +36,7 @@
 #include "pns_item.h"
 #include "pns_itemset.h"
 #include "pns_node.h"
+#include "pns_logger.h"
 
 namespace KIGFX
 {
@@ -171,6 +172,13 @@ public:
 
     void DumpLog();
 
+    ///> Returns the log of router events (start, moves, fix) of the current session.  The
+    ///> events are only recorded in debug builds, and saved by DumpLog().
+    LOGGER* Logger()
+    {
+        return &m_logger;
+    }
+
     RULE_RESOLVER* GetRuleResolver() const
     {
         return m_iface->GetRuleResolver();
@@ -283,6 +291,8 @@ private:
 
     wxString m_toolStatusbarName;
     wxString m_failureReason;
+
+    LOGGER m_logger;
 };
 
 }
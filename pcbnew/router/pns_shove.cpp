@@ -1525,6 +1525,8 @@ void SHOVE::runOptimizer( NODE* aNode )
     int optFlags = 0;
     int n_passes = 0;
 
+    optimizer.SetDebugDecorator( Dbg() );
+
     PNS_OPTIMIZATION_EFFORT effort = Settings().OptimizerEffort();
 
     OPT_BOX2I area = totalAffectedArea();
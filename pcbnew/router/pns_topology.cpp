@@ -19,6 +19,7 @@
  * with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "pns_arc.h"
 #include "pns_line.h"
 #include "pns_segment.h"
 #include "pns_node.h"
@@ -271,6 +272,35 @@ const ITEM_SET TOPOLOGY::AssembleTrivialPath( ITEM* aStart )
 }
 
 
+const std::map<int, long long int> TOPOLOGY::NetLengths( const std::vector<int>& aNets )
+{
+    std::map<int, long long int> lengths;
+    std::set<ITEM*>              items;
+
+    for( int net : aNets )
+    {
+        long long int total = 0;
+
+        items.clear();
+        m_world->AllItemsInNet( net, items );
+
+        for( const ITEM* item : items )
+        {
+            if( const SEGMENT* seg = dyn_cast<const SEGMENT*>( item ) )
+                total += seg->Seg().Length();
+            else if( const ARC* arc = dyn_cast<const ARC*>( item ) )
+                total += arc->CLine().Length();
+            else if( const SOLID* solid = dyn_cast<const SOLID*>( item ) )
+                total += solid->GetPadToDie();
+        }
+
+        lengths[net] = total;
+    }
+
+    return lengths;
+}
+
+
 const ITEM_SET TOPOLOGY::ConnectedItems( JOINT* aStart, int aKindMask )
 {
     return ITEM_SET();
@@ -22,6 +22,7 @@
 #ifndef __PNS_TOPOLOGY_H
 #define __PNS_TOPOLOGY_H
 
+#include <map>
 #include <vector>
 #include <set>
 
@@ -65,6 +66,14 @@ public:
 
     const std::set<ITEM*> AssembleCluster( ITEM* aStart, int aLayer );
 
+    /**
+     * Function NetLengths()
+     *
+     * Returns the routed length (tracks and arcs, plus the pad to die lengths of the
+     * net's pads) of each net in aNets, e.g. all the nets of a net class.
+     */
+    const std::map<int, long long int> NetLengths( const std::vector<int>& aNets );
+
 private:
     bool followTrivialPath( LINE* aLine, bool aLeft, ITEM_SET& aSet, std::set<ITEM*>& aVisited );
 
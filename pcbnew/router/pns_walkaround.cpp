@@ -153,7 +153,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::singleStep( LINE& aPath,
 
 
 
-bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
+static bool clipToLoopStart( SHAPE_LINE_CHAIN& l, DEBUG_DECORATOR* aDbg )
 {
     auto ip = l.SelfIntersecting();
 
@@ -166,8 +166,8 @@ bool clipToLoopStart( SHAPE_LINE_CHAIN& l )
 
         int pidx2 = tail.Split( ip->p );
         
-        auto dbg = ROUTER::GetInstance()->GetInterface()->GetDebugDecorator();
-        dbg->AddPoint( ip->p, 5 );
+        if( aDbg )
+            aDbg->AddPoint( ip->p, 5 );
         
         l = lead;
         l.Append( tail.Slice( 0, pidx2 ) );
@@ -228,14 +228,14 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
         
         auto old = path_cw.CLine();
 
-        if( clipToLoopStart( path_cw.Line() ))
+        if( clipToLoopStart( path_cw.Line(), Dbg() ) )
         {
             //printf("ClipCW\n");
             //Dbg()->AddLine( old, 1, 40000 );
             s_cw = ALMOST_DONE;
         }
 
-        if( clipToLoopStart( path_ccw.Line() ))
+        if( clipToLoopStart( path_ccw.Line(), Dbg() ) )
         {
             //printf("ClipCCW\n");
             s_ccw = ALMOST_DONE;
@@ -257,6 +257,9 @@ const WALKAROUND::RESULT WALKAROUND::Route( const LINE& aInitialPath )
         if( s_cw != IN_PROGRESS && s_ccw != IN_PROGRESS )
             break;
 
+        if( timedOut() )
+            break;
+
         m_iteration++;
     }
 
@@ -306,6 +309,7 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     LINE path_cw( aInitialPath ), path_ccw( aInitialPath );
     WALKAROUND_STATUS s_cw = IN_PROGRESS, s_ccw = IN_PROGRESS;
     SHAPE_LINE_CHAIN best_path;
+    bool timeout = false;
 
     // special case for via-in-the-middle-of-track placement
     if( aInitialPath.PointCount() <= 1 )
@@ -364,10 +368,16 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
             break;
         }
 
+        if( timedOut() )
+        {
+            timeout = true;
+            break;
+        }
+
         m_iteration++;
     }
 
-    if( m_iteration == m_iterationLimit )
+    if( m_iteration == m_iterationLimit || timeout )
     {
         int len_cw  = path_cw.CLine().Length();
         int len_ccw = path_ccw.CLine().Length();
@@ -426,7 +436,8 @@ WALKAROUND::WALKAROUND_STATUS WALKAROUND::Route( const LINE& aInitialPath,
     if( st == DONE )
     {
         if( aOptimize )
-            OPTIMIZER::Optimize( &aWalkPath, OPTIMIZER::MERGE_OBTUSE, m_world );
+            OPTIMIZER::Optimize( &aWalkPath, OPTIMIZER::MERGE_OBTUSE, m_world, VECTOR2I( 0, 0 ),
+                                 Dbg() );
     }
 
     return st;
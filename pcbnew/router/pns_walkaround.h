@@ -29,6 +29,7 @@
 #include "pns_router.h"
 #include "pns_logger.h"
 #include "pns_algo_base.h"
+#include "time_limit.h"
 
 namespace PNS {
 
@@ -89,6 +90,17 @@ public:
         m_iterationLimit = aIterLimit;
     }
 
+    /**
+     * Function SetTimeLimit()
+     *
+     * Stops walking after the given time has elapsed, returning the paths found so far as if
+     * the iteration limit had been reached.
+     */
+    void SetTimeLimit( const TIME_LIMIT& aTimeLimit )
+    {
+        m_timeLimit = aTimeLimit;
+    }
+
     void SetSolidsOnly( bool aSolidsOnly )
     {
         if( aSolidsOnly )
@@ -144,6 +156,11 @@ private:
     WALKAROUND_STATUS singleStep( LINE& aPath, bool aWindingDirection );
     NODE::OPT_OBSTACLE nearestObstacle( const LINE& aPath );
 
+    bool timedOut() const
+    {
+        return m_timeLimit && m_timeLimit->Expired();
+    }
+
     NODE* m_world;
 
     int m_recursiveBlockageCount;
@@ -159,6 +176,7 @@ private:
     NODE::OPT_OBSTACLE m_currentObstacle[2];
     bool m_recursiveCollision[2];
     std::set<ITEM*> m_restrictedSet;
+    OPT<TIME_LIMIT> m_timeLimit;
 };
 
 }
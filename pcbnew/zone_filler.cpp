@@ -259,8 +259,17 @@ bool ZONE_FILLER::Fill( const std::vector<ZONE_CONTAINER*>& aZones, bool aCheck
 
         if( dlg.ShowModal() == wxID_CANCEL )
         {
+            // The island search left the zones out of the connectivity; the revert puts them
+            // back, otherwise it must be done here
             if( m_commit )
+            {
                 m_commit->Revert();
+            }
+            else
+            {
+                for( auto& i : toFill )
+                    connectivity->Update( i.m_zone );
+            }
 
             connectivity->SetProgressReporter( nullptr );
             return false;
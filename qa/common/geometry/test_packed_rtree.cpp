@@ -0,0 +1,179 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/packed_rtree.h>
+
+#include <random>
+#include <set>
+
+
+/**
+ * Brute-force reference for the items of aBoxes overlapping aQuery
+ */
+static std::set<int> overlapping( const std::vector<BOX2I>& aBoxes, const BOX2I& aQuery )
+{
+    std::set<int> found;
+
+    for( int i = 0; i < (int) aBoxes.size(); i++ )
+    {
+        const BOX2I& b = aBoxes[i];
+
+        if( b.GetX() <= aQuery.GetRight() && b.GetRight() >= aQuery.GetX()
+                && b.GetY() <= aQuery.GetBottom() && b.GetBottom() >= aQuery.GetY() )
+            found.insert( i );
+    }
+
+    return found;
+}
+
+
+BOOST_AUTO_TEST_SUITE( PackedRTree )
+
+
+BOOST_AUTO_TEST_CASE( Empty )
+{
+    PACKED_RTREE<int> tree;
+    tree.Build();
+
+    int  count = 0;
+    auto visitor = [&count]( int ) -> bool
+    {
+        count++;
+        return true;
+    };
+
+    BOOST_CHECK( tree.Empty() );
+    BOOST_CHECK_EQUAL( tree.Search( BOX2I( VECTOR2I( 0, 0 ), VECTOR2I( 10, 10 ) ), visitor ), 0 );
+    BOOST_CHECK_EQUAL( count, 0 );
+}
+
+
+/**
+ * Check that single and batch searches find exactly the overlapping items, for trees of
+ * one, a partial, a full and several levels of nodes.
+ */
+BOOST_AUTO_TEST_CASE( MatchesBruteForce )
+{
+    std::mt19937 rng( 42 );
+    std::uniform_int_distribution<int> pos( -100000, 100000 );
+    std::uniform_int_distribution<int> size( 0, 5000 );
+
+    for( int n : { 1, 5, 16, 17, 257, 3000 } )
+    {
+        BOOST_TEST_CONTEXT( n << " items" )
+        {
+            PACKED_RTREE<int>  tree;
+            std::vector<BOX2I> boxes;
+
+            for( int i = 0; i < n; i++ )
+            {
+                boxes.emplace_back( VECTOR2I( pos( rng ), pos( rng ) ),
+                                    VECTOR2I( size( rng ), size( rng ) ) );
+                tree.Add( boxes.back(), i );
+            }
+
+            tree.Build();
+
+            BOOST_CHECK_EQUAL( tree.Size(), (size_t) n );
+
+            std::vector<BOX2I> queries;
+
+            for( int i = 0; i < 100; i++ )
+            {
+                queries.emplace_back( VECTOR2I( pos( rng ), pos( rng ) ),
+                                      VECTOR2I( size( rng ) * 4, size( rng ) * 4 ) );
+            }
+
+            std::vector<std::set<int>> batchFound( queries.size() );
+
+            auto batchVisitor = [&batchFound]( int aQuery, int aItem ) -> bool
+            {
+                batchFound[aQuery].insert( aItem );
+                return true;
+            };
+
+            tree.BatchSearch( queries, batchVisitor );
+
+            for( size_t q = 0; q < queries.size(); q++ )
+            {
+                std::set<int> found;
+
+                auto visitor = [&found]( int aItem ) -> bool
+                {
+                    found.insert( aItem );
+                    return true;
+                };
+
+                tree.Search( queries[q], visitor );
+
+                std::set<int> expected = overlapping( boxes, queries[q] );
+
+                BOOST_CHECK( found == expected );
+                BOOST_CHECK( batchFound[q] == expected );
+            }
+        }
+    }
+}
+
+
+/**
+ * Check that returning false from the visitor stops the search (or, for batches, only the
+ * query it was called for).
+ */
+BOOST_AUTO_TEST_CASE( EarlyExit )
+{
+    PACKED_RTREE<int> tree;
+
+    for( int i = 0; i < 100; i++ )
+        tree.Add( BOX2I( VECTOR2I( i * 10, 0 ), VECTOR2I( 5, 5 ) ), i );
+
+    tree.Build();
+
+    BOX2I all( VECTOR2I( -10, -10 ), VECTOR2I( 2000, 20 ) );
+    int   count = 0;
+
+    auto visitor = [&count]( int ) -> bool
+    {
+        return ++count < 3;
+    };
+
+    BOOST_CHECK_EQUAL( tree.Search( all, visitor ), 3 );
+
+    std::vector<int> perQuery( 2, 0 );
+
+    auto batchVisitor = [&perQuery]( int aQuery, int ) -> bool
+    {
+        perQuery[aQuery]++;
+        return aQuery == 1 || perQuery[aQuery] < 3;
+    };
+
+    tree.BatchSearch( { all, all }, batchVisitor );
+
+    BOOST_CHECK_EQUAL( perQuery[0], 3 );
+    BOOST_CHECK_EQUAL( perQuery[1], 100 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <geometry/seg_batch.h>
+#include <geometry/shape_line_chain.h>
+#include <math/box2.h>
+
+#include <random>
+
+
+/**
+ * Reference for FindCollidingSegment(): the segment-by-segment loop
+ * SHAPE_LINE_CHAIN::Collide() used before.
+ */
+static int findCollidingRef( const SEG& aSeg, const std::vector<VECTOR2I>& aPts, int aClearance )
+{
+    BOX2I              box_a( aSeg.A, aSeg.B - aSeg.A );
+    BOX2I::ecoord_type dist_sq = (BOX2I::ecoord_type) aClearance * aClearance;
+
+    for( int i = 0; i + 1 < (int) aPts.size(); i++ )
+    {
+        SEG   s( aPts[i], aPts[i + 1] );
+        BOX2I box_b( s.A, s.B - s.A );
+
+        if( box_a.SquaredDistance( box_b ) < dist_sq && s.Collide( aSeg, aClearance ) )
+            return i;
+    }
+
+    return -1;
+}
+
+
+/**
+ * A random 45-degree polyline, like a routed track
+ */
+static std::vector<VECTOR2I> makeTrack( int aCount, int aRange, std::mt19937& aRng )
+{
+    std::uniform_int_distribution<int> pos( -aRange, aRange );
+    std::uniform_int_distribution<int> len( -aRange / 10, aRange / 10 );
+    std::uniform_int_distribution<int> dir( 0, 3 );
+
+    std::vector<VECTOR2I> pts;
+    VECTOR2I              p( pos( aRng ), pos( aRng ) );
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        pts.push_back( p );
+
+        int l = len( aRng );
+
+        switch( dir( aRng ) )
+        {
+        case 0:  p += VECTOR2I( l, 0 ); break;
+        case 1:  p += VECTOR2I( 0, l ); break;
+        case 2:  p += VECTOR2I( l, l ); break;
+        default: p += VECTOR2I( l, -l ); break;
+        }
+    }
+
+    return pts;
+}
+
+
+BOOST_AUTO_TEST_SUITE( SegBatch )
+
+
+BOOST_AUTO_TEST_CASE( Degenerate )
+{
+    const SEG             seg( VECTOR2I( 0, 0 ), VECTOR2I( 100, 0 ) );
+    std::vector<VECTOR2I> pts = { VECTOR2I( 50, 5 ) };
+
+    BOOST_CHECK_EQUAL( FindCollidingSegment( seg, nullptr, 0, 10 ), -1 );
+    BOOST_CHECK_EQUAL( FindCollidingSegment( seg, pts.data(), 1, 10 ), -1 );
+
+    pts.push_back( VECTOR2I( 50, 5 ) );
+    BOOST_CHECK_EQUAL( FindCollidingSegment( seg, pts.data(), 2, 10 ), 0 );
+    BOOST_CHECK_EQUAL( FindCollidingSegment( seg, pts.data(), 2, 4 ), -1 );
+}
+
+
+BOOST_AUTO_TEST_CASE( MatchesReference )
+{
+    std::mt19937 rng( 3 );
+
+    std::uniform_int_distribution<int> count( 1, 40 );
+    std::uniform_int_distribution<int> clearance( -200, 2000 );
+
+    for( int range : { 10000, 1000000, 100000000 } )
+    {
+        for( int iter = 0; iter < 2000; iter++ )
+        {
+            std::vector<VECTOR2I> pts = makeTrack( count( rng ), range, rng );
+            std::vector<VECTOR2I> q = makeTrack( 2, range, rng );
+            SEG                   seg( q[0], q[1] );
+            int                   cl = clearance( rng ) * ( range / 10000 );
+
+            BOOST_CHECK_EQUAL( FindCollidingSegment( seg, pts.data(), pts.size(), cl ),
+                               findCollidingRef( seg, pts, cl ) );
+        }
+    }
+}
+
+
+BOOST_AUTO_TEST_CASE( ClosedChain )
+{
+    const std::vector<VECTOR2I> square = { VECTOR2I( 0, 0 ), VECTOR2I( 1000, 0 ),
+                                           VECTOR2I( 1000, 1000 ), VECTOR2I( 0, 1000 ) };
+
+    SHAPE_LINE_CHAIN chain( square );
+
+    // close to the segment joining the last point to the first one only
+    const SEG seg( VECTOR2I( -50, 400 ), VECTOR2I( -50, 600 ) );
+
+    BOOST_CHECK( !chain.Collide( seg, 10 ) );
+
+    chain.SetClosed( true );
+    BOOST_CHECK( chain.Collide( seg, 60 ) );
+    BOOST_CHECK( !chain.Collide( seg, 40 ) );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
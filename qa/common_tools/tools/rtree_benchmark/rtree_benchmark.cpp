@@ -0,0 +1,273 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <wx/wx.h>
+#include <wx/cmdline.h>
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <geometry/packed_rtree.h>
+#include <geometry/rtree.h>
+#include <profile.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * Generates aCount track-like bounding boxes (short segments with a typical track width)
+ * spread over a 100 x 100 mm board.
+ */
+static std::vector<BOX2I> makeTracks( int aCount, std::mt19937& aRng )
+{
+    const int boardSize = 100000000;
+    const int maxLength = 5000000;
+    const int width = 200000;
+
+    std::uniform_int_distribution<int> pos( 0, boardSize );
+    std::uniform_int_distribution<int> len( -maxLength, maxLength );
+    std::uniform_int_distribution<int> dir( 0, 3 );
+
+    std::vector<BOX2I> boxes;
+    boxes.reserve( aCount );
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        VECTOR2I a( pos( aRng ), pos( aRng ) );
+        VECTOR2I d;
+
+        // horizontal, vertical or diagonal, like 45-degree routed tracks
+        switch( dir( aRng ) )
+        {
+        case 0:  d = VECTOR2I( len( aRng ), 0 ); break;
+        case 1:  d = VECTOR2I( 0, len( aRng ) ); break;
+        default: { int l = len( aRng ); d = VECTOR2I( l, dir( aRng ) & 1 ? l : -l ); } break;
+        }
+
+        BOX2I box( a, d );
+        box.Normalize();
+        box.Inflate( width / 2 );
+        boxes.push_back( box );
+    }
+
+    return boxes;
+}
+
+
+/**
+ * Generates query windows around the segments of aCount random lines of aBatch segments each,
+ * the way the router checks a line being placed against the world.
+ */
+static std::vector<BOX2I> makeQueries( int aCount, int aBatch, std::mt19937& aRng )
+{
+    const int boardSize = 100000000;
+    const int maxLength = 2000000;
+    const int clearance = 800000;
+
+    std::uniform_int_distribution<int> pos( 0, boardSize );
+    std::uniform_int_distribution<int> len( -maxLength, maxLength );
+
+    std::vector<BOX2I> queries;
+    queries.reserve( aCount * aBatch );
+
+    for( int i = 0; i < aCount; i++ )
+    {
+        VECTOR2I p( pos( aRng ), pos( aRng ) );
+
+        for( int j = 0; j < aBatch; j++ )
+        {
+            // alternate straight and diagonal segments, each starting where the last one ended
+            int      l = len( aRng );
+            VECTOR2I d = ( j % 2 ) ? VECTOR2I( l, l ) : VECTOR2I( l, 0 );
+
+            BOX2I box( p, d );
+            box.Normalize();
+            box.Inflate( clearance );
+            queries.push_back( box );
+
+            p += d;
+        }
+    }
+
+    return queries;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "n",
+            "items",
+            _( "number of indexed items (default 100000)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "q",
+            "queries",
+            _( "number of query batches (default 10000)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "b",
+            "batch",
+            _( "number of queries per batch (default 8)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+            wxCMD_LINE_PARAM_OPTIONAL,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+static int rtree_benchmark_main_func( int argc, char** argv )
+{
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText( _( "Compare the dynamic and the packed R-tree spatial indices" ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long itemCount = 100000;
+    long queryCount = 10000;
+    long batchSize = 8;
+
+    cl_parser.Found( "items", &itemCount );
+    cl_parser.Found( "queries", &queryCount );
+    cl_parser.Found( "batch", &batchSize );
+
+    if( itemCount <= 0 || queryCount <= 0 || batchSize <= 0 )
+        return KI_TEST::RET_CODES::BAD_CMDLINE;
+
+    std::mt19937       rng( 1 );
+    std::vector<BOX2I> items = makeTracks( itemCount, rng );
+    std::vector<BOX2I> queries = makeQueries( queryCount, batchSize, rng );
+
+    RTree<int, int, 2, double> rtree;
+    PACKED_RTREE<int>          packed;
+
+    PROF_COUNTER cnt( "rtree" );
+
+    for( int i = 0; i < (int) items.size(); i++ )
+    {
+        int min[2] = { items[i].GetX(), items[i].GetY() };
+        int max[2] = { items[i].GetRight(), items[i].GetBottom() };
+        rtree.Insert( min, max, i );
+    }
+
+    double rtreeBuild = cnt.msecs( true );
+
+    packed.Reserve( items.size() );
+
+    for( int i = 0; i < (int) items.size(); i++ )
+        packed.Add( items[i], i );
+
+    packed.Build();
+
+    double packedBuild = cnt.msecs( true );
+
+    // The accumulated item ids double as a check that all the methods found the same items
+    long long rtreeAcc = 0, packedAcc = 0, batchAcc = 0;
+
+    auto rtreeVisitor = [&rtreeAcc]( int aItem ) -> bool
+    {
+        rtreeAcc += aItem;
+        return true;
+    };
+
+    for( const BOX2I& box : queries )
+    {
+        int min[2] = { box.GetX(), box.GetY() };
+        int max[2] = { box.GetRight(), box.GetBottom() };
+        rtree.Search( min, max, rtreeVisitor );
+    }
+
+    double rtreeQuery = cnt.msecs( true );
+
+    auto visitor = [&packedAcc]( int aItem ) -> bool
+    {
+        packedAcc += aItem;
+        return true;
+    };
+
+    for( const BOX2I& box : queries )
+        packed.Search( box, visitor );
+
+    double packedQuery = cnt.msecs( true );
+
+    auto batchVisitor = [&batchAcc]( int aQuery, int aItem ) -> bool
+    {
+        batchAcc += aItem;
+        return true;
+    };
+
+    std::vector<BOX2I> batch( batchSize );
+
+    for( long i = 0; i < queryCount; i++ )
+    {
+        std::copy( queries.begin() + i * batchSize, queries.begin() + ( i + 1 ) * batchSize,
+                   batch.begin() );
+        packed.BatchSearch( batch, batchVisitor );
+    }
+
+    double batchQuery = cnt.msecs( true );
+
+    printf( "%ld items, %ld batches of %ld queries\n", itemCount, queryCount, batchSize );
+    printf( "  %-16s build %10.3f ms, query %10.3f ms\n", "rtree", rtreeBuild, rtreeQuery );
+    printf( "  %-16s build %10.3f ms, query %10.3f ms\n", "packed", packedBuild, packedQuery );
+    printf( "  %-16s                      query %10.3f ms\n", "packed (batch)", batchQuery );
+
+    if( rtreeAcc != packedAcc || rtreeAcc != batchAcc )
+    {
+        printf( "Result mismatch: %lld / %lld / %lld\n", rtreeAcc, packedAcc, batchAcc );
+        return KI_TEST::RET_CODES::TOOL_SPECIFIC;
+    }
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+/*
+ * Define the tool interface
+ */
+static bool registered = UTILITY_REGISTRY::Register( {
+        "rtree_benchmark",
+        "Benchmark the dynamic and packed R-tree spatial indices",
+        rtree_benchmark_main_func,
+} );
@@ -0,0 +1,512 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for CONNECTION_GRAPH
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+#include <functional>
+#include <map>
+#include <set>
+
+// Code under test
+#include <connection_graph.h>
+
+#include <class_libentry.h>
+#include <erc.h>
+#include <erc_item.h>
+#include <erc_settings.h>
+#include <general.h>
+#include <lib_pin.h>
+#include <profile.h>
+#include <sch_component.h>
+#include <sch_line.h>
+#include <sch_marker.h>
+#include <sch_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_text.h>
+
+
+/**
+ * The nets of a connection graph.  They are copied out of the graph, since the connections
+ * of the items are shared by all the graphs built from them.
+ */
+struct NET_SNAPSHOT
+{
+    /// Net name to net code
+    std::map<wxString, int> m_codes;
+
+    /// Net name to the sheet path and the items of each of its subgraphs
+    std::map<wxString, std::set<std::pair<wxString, std::set<SCH_ITEM*>>>> m_subgraphs;
+
+    /// Sheet path and item to the net name and code of the connection of the item
+    std::map<std::pair<wxString, SCH_ITEM*>, std::pair<wxString, int>> m_items;
+};
+
+
+/**
+ * An in-memory schematic, and the connection graph of it
+ */
+class TEST_CONNECTION_GRAPH_FIXTURE
+{
+public:
+    TEST_CONNECTION_GRAPH_FIXTURE() : m_screen( new SCH_SCREEN( nullptr ) ), m_graph( nullptr )
+    {
+        m_root.SetScreen( m_screen );
+        m_path.push_back( &m_root );
+
+        m_prevRootSheet = g_RootSheet;
+        m_prevErcSettings = g_ErcSettings;
+        g_RootSheet = &m_root;
+        g_ErcSettings = &m_ercSettings;
+
+        // Each test enables the checks it is about.  Most of the others need a frame.
+        for( auto& severity : m_ercSettings.m_Severities )
+            severity.second = RPT_SEVERITY_IGNORE;
+    }
+
+    ~TEST_CONNECTION_GRAPH_FIXTURE()
+    {
+        g_RootSheet = m_prevRootSheet;
+        g_ErcSettings = m_prevErcSettings;
+    }
+
+    /**
+     * Add a sub-sheet with a new screen to the root sheet
+     *
+     * @return the path of the sub-sheet
+     */
+    SCH_SHEET_PATH AddSheet( const wxString& aName, const wxPoint& aPos )
+    {
+        SCH_SHEET* sheet = new SCH_SHEET( aPos );
+
+        sheet->GetFields()[SHEETNAME].SetText( aName );
+        sheet->SetFileName( aName + ".sch" );
+        sheet->SetScreen( new SCH_SCREEN( nullptr ) );
+        m_screen->Append( sheet );
+
+        SCH_SHEET_PATH path = m_path;
+        path.push_back( sheet );
+
+        return path;
+    }
+
+    /**
+     * Add a component with a single pin at its origin
+     *
+     * @param aPower makes it a power symbol, with an invisible power pin
+     * @param aPath is the sheet of the component, nullptr for the root sheet
+     */
+    SCH_COMPONENT* AddComponent( const wxString& aRef, const wxString& aPinName,
+                                 ELECTRICAL_PINTYPE aType, const wxPoint& aPos,
+                                 bool aPower = false, SCH_SHEET_PATH* aPath = nullptr )
+    {
+        if( !aPath )
+            aPath = &m_path;
+
+        LIB_PART part( aPower ? aPinName : wxString( "part" ) );
+        LIB_PIN* pin = new LIB_PIN( &part );
+
+        pin->SetNumber( "1" );
+        pin->SetName( aPinName );
+        pin->SetType( aType );
+
+        if( aPower )
+        {
+            part.SetPower();
+            pin->SetVisible( false );
+        }
+
+        part.AddDrawItem( pin );
+
+        SCH_COMPONENT* comp = new SCH_COMPONENT( part, LIB_ID( "test", part.GetName() ), aPath,
+                                                 1, 0, aPos );
+        comp->SetRef( aPath, aRef );
+        aPath->LastScreen()->Append( comp );
+
+        return comp;
+    }
+
+    SCH_PIN* GetPin( SCH_COMPONENT* aComponent )
+    {
+        return aComponent->GetSchPins( &m_path ).front();
+    }
+
+    /**
+     * @param aPath is the sheet of the label, nullptr for the root sheet
+     */
+    template<typename LABEL>
+    LABEL* AddLabel( const wxString& aText, const wxPoint& aPos,
+                     SCH_SHEET_PATH* aPath = nullptr )
+    {
+        LABEL* label = new LABEL( aPos, aText );
+        ( aPath ? aPath->LastScreen() : m_screen )->Append( label );
+
+        return label;
+    }
+
+    SCH_LINE* AddWire( const wxPoint& aStart, const wxPoint& aEnd, const SCH_SHEET_PATH& aPath )
+    {
+        SCH_LINE* wire = new SCH_LINE( aStart, LAYER_WIRE );
+        wire->SetEndPoint( aEnd );
+        aPath.LastScreen()->Append( wire );
+
+        return wire;
+    }
+
+    /**
+     * Run the enabled ERC checks on the whole schematic
+     */
+    void RunERC()
+    {
+        m_graph.Recalculate( SCH_SHEET_LIST( &m_root ), true );
+        m_graph.RunERC();
+    }
+
+    /**
+     * @return the markers of the sheet with \a aErrorCode
+     */
+    std::vector<SCH_MARKER*> GetMarkers( int aErrorCode )
+    {
+        std::vector<SCH_MARKER*> markers;
+
+        for( SCH_ITEM* item : m_screen->Items().OfType( SCH_MARKER_T ) )
+        {
+            SCH_MARKER* marker = static_cast<SCH_MARKER*>( item );
+
+            if( marker->GetRCItem()->GetErrorCode() == aErrorCode )
+                markers.push_back( marker );
+        }
+
+        return markers;
+    }
+
+    /**
+     * @return true if \a aMarker is about \a aItemA and \a aItemB, in either order
+     */
+    static bool MarkerLinks( const SCH_MARKER* aMarker, const EDA_ITEM* aItemA,
+                             const EDA_ITEM* aItemB )
+    {
+        const KIID mainId = aMarker->GetRCItem()->GetMainItemID();
+        const KIID auxId = aMarker->GetRCItem()->GetAuxItemID();
+
+        return ( mainId == aItemA->m_Uuid && auxId == aItemB->m_Uuid )
+               || ( mainId == aItemB->m_Uuid && auxId == aItemA->m_Uuid );
+    }
+
+    static NET_SNAPSHOT Snapshot( const CONNECTION_GRAPH& aGraph )
+    {
+        NET_SNAPSHOT nets;
+
+        for( const auto& net : aGraph.GetNetMap() )
+        {
+            const wxString& name = net.first.first;
+
+            BOOST_CHECK_MESSAGE( !nets.m_codes.count( name ), "Net " << name << " has two codes" );
+            nets.m_codes[name] = net.first.second;
+
+            for( const CONNECTION_SUBGRAPH* subgraph : net.second )
+            {
+                wxString path = subgraph->m_sheet.PathAsString();
+
+                nets.m_subgraphs[name].emplace( path, std::set<SCH_ITEM*>(
+                        subgraph->m_items.begin(), subgraph->m_items.end() ) );
+
+                for( SCH_ITEM* item : subgraph->m_items )
+                {
+                    SCH_CONNECTION* conn = item->Connection( subgraph->m_sheet );
+
+                    if( conn )
+                        nets.m_items[{ path, item }] = { conn->Name(), conn->NetCode() };
+                }
+            }
+        }
+
+        return nets;
+    }
+
+    /**
+     * Check that the nets are the same, with the same items, up to a renumbering of the net
+     * codes: a graph built from scratch numbers the nets in its own order.
+     */
+    static void CheckSameNets( const NET_SNAPSHOT& aNets, const NET_SNAPSHOT& aExpected )
+    {
+        std::map<int, int> codes;
+        std::map<int, int> expectedCodes;
+
+        auto checkCode = [&]( int aCode, int aExpectedCode )
+        {
+            BOOST_CHECK_EQUAL( codes.emplace( aCode, aExpectedCode ).first->second,
+                               aExpectedCode );
+            BOOST_CHECK_EQUAL( expectedCodes.emplace( aExpectedCode, aCode ).first->second,
+                               aCode );
+        };
+
+        BOOST_CHECK_EQUAL( aNets.m_codes.size(), aExpected.m_codes.size() );
+
+        for( const auto& net : aExpected.m_codes )
+        {
+            auto it = aNets.m_codes.find( net.first );
+
+            BOOST_CHECK_MESSAGE( it != aNets.m_codes.end(), "Missing net " << net.first );
+
+            if( it != aNets.m_codes.end() )
+                checkCode( it->second, net.second );
+        }
+
+        BOOST_CHECK( aNets.m_subgraphs == aExpected.m_subgraphs );
+        BOOST_REQUIRE_EQUAL( aNets.m_items.size(), aExpected.m_items.size() );
+
+        for( const auto& item : aExpected.m_items )
+        {
+            auto it = aNets.m_items.find( item.first );
+
+            BOOST_REQUIRE( it != aNets.m_items.end() );
+            BOOST_CHECK_EQUAL( it->second.first, item.second.first );
+            checkCode( it->second.second, item.second.second );
+        }
+    }
+
+    /**
+     * Apply an edit, update the graph incrementally and check the result against a graph
+     * recalculated from scratch.
+     *
+     * @param aUntouchedNet is a net that the edit doesn't affect, whose subgraphs must be kept
+     */
+    void CheckIncrementalUpdate( const std::function<void()>& aEdit,
+                                 const wxString& aUntouchedNet )
+    {
+        m_graph.Recalculate( SCH_SHEET_LIST( &m_root ), true );
+
+        NET_SNAPSHOT                      previous = Snapshot( m_graph );
+        std::vector<CONNECTION_SUBGRAPH*> untouched = netSubgraphs( m_graph, aUntouchedNet );
+
+        BOOST_REQUIRE( !untouched.empty() );
+
+        aEdit();
+
+        SCH_SHEET_LIST sheets( &m_root );
+        PROF_COUNTER   incrementalTime;
+
+        m_graph.Recalculate( sheets );
+        incrementalTime.Stop();
+
+        NET_SNAPSHOT incremental = Snapshot( m_graph );
+
+        // A full rebuild (after the incremental update fell back to it) would have replaced
+        // all the subgraphs, and renumbered the nets
+        BOOST_CHECK( netSubgraphs( m_graph, aUntouchedNet ) == untouched );
+
+        for( const auto& net : incremental.m_codes )
+        {
+            if( previous.m_codes.count( net.first ) )
+                BOOST_CHECK_EQUAL( net.second, previous.m_codes.at( net.first ) );
+        }
+
+        CONNECTION_GRAPH full( nullptr );
+        PROF_COUNTER     fullTime;
+
+        full.Recalculate( sheets, true );
+        fullTime.Stop();
+
+        BOOST_TEST_MESSAGE( "Incremental update " << incrementalTime.msecs()
+                            << " ms, full recalculation " << fullTime.msecs() << " ms" );
+
+        CheckSameNets( incremental, Snapshot( full ) );
+    }
+
+    SCH_SHEET        m_root;
+    SCH_SCREEN*      m_screen;   ///< Owned by m_root
+    SCH_SHEET_PATH   m_path;
+    ERC_SETTINGS     m_ercSettings;
+    CONNECTION_GRAPH m_graph;
+
+    SCH_SHEET*       m_prevRootSheet;
+    ERC_SETTINGS*    m_prevErcSettings;
+
+private:
+    static std::vector<CONNECTION_SUBGRAPH*> netSubgraphs( const CONNECTION_GRAPH& aGraph,
+                                                           const wxString& aNetName )
+    {
+        for( const auto& net : aGraph.GetNetMap() )
+        {
+            if( net.first.first == aNetName )
+                return net.second;
+        }
+
+        return {};
+    }
+};
+
+
+/**
+ * Declare the test suite
+ */
+BOOST_FIXTURE_TEST_SUITE( ConnectionGraph, TEST_CONNECTION_GRAPH_FIXTURE )
+
+
+/**
+ * A global label and a power symbol with the same name in another case
+ */
+BOOST_AUTO_TEST_CASE( SimilarLabelAndPowerPin )
+{
+    m_ercSettings.m_Severities[ERCE_SIMILAR_LABELS] = RPT_SEVERITY_WARNING;
+
+    SCH_COMPONENT*   power = AddComponent( "#PWR01", "VCC", ELECTRICAL_PINTYPE::PT_POWER_IN,
+                                           wxPoint( 0, 0 ), true );
+    SCH_GLOBALLABEL* label = AddLabel<SCH_GLOBALLABEL>( "vcc", wxPoint( 10000, 0 ) );
+
+    // Identical names are fine
+    AddLabel<SCH_GLOBALLABEL>( "GND", wxPoint( 20000, 0 ) );
+    AddComponent( "#PWR02", "GND", ELECTRICAL_PINTYPE::PT_POWER_IN, wxPoint( 30000, 0 ), true );
+
+    RunERC();
+    std::vector<SCH_MARKER*> markers = GetMarkers( ERCE_SIMILAR_LABELS );
+
+    BOOST_REQUIRE_EQUAL( markers.size(), 1 );
+    BOOST_CHECK( MarkerLinks( markers[0], label, GetPin( power ) ) );
+}
+
+
+/**
+ * A bus member and a label of the same sheet which differ only by case
+ */
+BOOST_AUTO_TEST_CASE( SimilarLabelAndBusMember )
+{
+    m_ercSettings.m_Severities[ERCE_SIMILAR_LABELS] = RPT_SEVERITY_WARNING;
+
+    SCH_LABEL* bus = AddLabel<SCH_LABEL>( "D[0..3]", wxPoint( 0, 0 ) );
+    SCH_LABEL* label = AddLabel<SCH_LABEL>( "d2", wxPoint( 10000, 0 ) );
+
+    // Identical to a member
+    AddLabel<SCH_LABEL>( "D1", wxPoint( 20000, 0 ) );
+
+    RunERC();
+    std::vector<SCH_MARKER*> markers = GetMarkers( ERCE_SIMILAR_LABELS );
+
+    BOOST_REQUIRE_EQUAL( markers.size(), 1 );
+    BOOST_CHECK( MarkerLinks( markers[0], label, bus ) );
+}
+
+
+/**
+ * Pin to pin conflicts are reported with the level of the pin conflicts map, once per pair,
+ * and nets without a driver once per net
+ */
+BOOST_AUTO_TEST_CASE( PinConflicts )
+{
+    m_ercSettings.m_Severities[ERCE_PIN_NOT_DRIVEN] = RPT_SEVERITY_ERROR;
+    m_ercSettings.m_Severities[ERCE_PIN_TO_PIN_WARNING] = RPT_SEVERITY_WARNING;
+    m_ercSettings.m_Severities[ERCE_PIN_TO_PIN_ERROR] = RPT_SEVERITY_ERROR;
+
+    // Two outputs driving the same net
+    SCH_COMPONENT* u1 = AddComponent( "U1", "OUT", ELECTRICAL_PINTYPE::PT_OUTPUT,
+                                       wxPoint( 0, 0 ) );
+    SCH_COMPONENT* u2 = AddComponent( "U2", "OUT", ELECTRICAL_PINTYPE::PT_OUTPUT,
+                                       wxPoint( 0, 0 ) );
+
+    // Two inputs and nothing driving them
+    AddComponent( "U3", "IN", ELECTRICAL_PINTYPE::PT_INPUT, wxPoint( 10000, 0 ) );
+    AddComponent( "U4", "IN", ELECTRICAL_PINTYPE::PT_INPUT, wxPoint( 10000, 0 ) );
+
+    RunERC();
+
+    std::vector<SCH_MARKER*> errors = GetMarkers( ERCE_PIN_TO_PIN_ERROR );
+
+    BOOST_REQUIRE_EQUAL( errors.size(), 1 );
+    BOOST_CHECK( MarkerLinks( errors[0], GetPin( u1 ), GetPin( u2 ) ) );
+    BOOST_CHECK_EQUAL( GetMarkers( ERCE_PIN_TO_PIN_WARNING ).size(), 0 );
+    BOOST_CHECK_EQUAL( GetMarkers( ERCE_PIN_NOT_DRIVEN ).size(), 1 );
+}
+
+
+/**
+ * Edits of a sub-sheet, updated incrementally, give the same nets as a full recalculation
+ */
+BOOST_AUTO_TEST_CASE( IncrementalUpdate )
+{
+    // Root sheet: a global net, a local net and a sheet pin
+    AddComponent( "U1", "OUT", ELECTRICAL_PINTYPE::PT_OUTPUT, wxPoint( 0, 0 ) );
+    AddLabel<SCH_GLOBALLABEL>( "SIG", wxPoint( 0, 0 ) );
+
+    AddComponent( "U2", "A", ELECTRICAL_PINTYPE::PT_PASSIVE, wxPoint( 10000, 0 ) );
+    AddLabel<SCH_LABEL>( "KEEP", wxPoint( 10000, 0 ) );
+
+    SCH_SHEET_PATH sub = AddSheet( "sub", wxPoint( 50000, 0 ) );
+    SCH_SHEET_PIN* sheetPin = new SCH_SHEET_PIN( sub.Last(), wxPoint( 50000, 1000 ), "LINK" );
+    sub.Last()->AddPin( sheetPin );
+
+    AddComponent( "U3", "B", ELECTRICAL_PINTYPE::PT_PASSIVE, sheetPin->GetPosition() );
+
+    // Sub-sheet: the other end of the sheet pin, a local net, a lone pin and the global net
+    AddLabel<SCH_HIERLABEL>( "LINK", wxPoint( 0, 0 ), &sub );
+    AddComponent( "U4", "IN", ELECTRICAL_PINTYPE::PT_INPUT, wxPoint( 0, 0 ), false, &sub );
+
+    SCH_LABEL* label = AddLabel<SCH_LABEL>( "X", wxPoint( 10000, 0 ), &sub );
+    AddComponent( "U5", "C", ELECTRICAL_PINTYPE::PT_PASSIVE, wxPoint( 10000, 0 ), false, &sub );
+    AddComponent( "U6", "D", ELECTRICAL_PINTYPE::PT_PASSIVE, wxPoint( 20000, 0 ), false, &sub );
+
+    SCH_GLOBALLABEL* global = AddLabel<SCH_GLOBALLABEL>( "SIG", wxPoint( 30000, 0 ), &sub );
+    AddComponent( "U7", "E", ELECTRICAL_PINTYPE::PT_INPUT, wxPoint( 30000, 0 ), false, &sub );
+
+    SCH_LINE* wire = nullptr;
+
+    // A new wire joins the lone pin to the local net
+    CheckIncrementalUpdate(
+            [&]()
+            {
+                wire = AddWire( wxPoint( 10000, 0 ), wxPoint( 20000, 0 ), sub );
+            },
+            "/KEEP" );
+
+    // A renamed label joins the local net to the net of the sheet pin
+    CheckIncrementalUpdate(
+            [&]()
+            {
+                label->SetText( "LINK" );
+                label->SetConnectivityDirty();
+            },
+            "/KEEP" );
+
+    // A renamed global label leaves the global net
+    CheckIncrementalUpdate(
+            [&]()
+            {
+                global->SetText( "SIG2" );
+                global->SetConnectivityDirty();
+            },
+            "/KEEP" );
+
+    // A deleted wire splits the net again
+    CheckIncrementalUpdate(
+            [&]()
+            {
+                sub.LastScreen()->DeleteItem( wire );
+            },
+            "/KEEP" );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
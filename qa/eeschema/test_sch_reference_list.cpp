@@ -0,0 +1,180 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file
+ * Test suite for SCH_REFERENCE_LIST annotation
+ */
+
+#include <unit_test_utils/unit_test_utils.h>
+
+// Code under test
+#include <sch_reference_list.h>
+
+#include <profile.h>
+#include <reporter.h>
+
+#include <memory>
+#include <set>
+
+
+class TEST_SCH_REFERENCE_LIST_FIXTURE
+{
+public:
+    TEST_SCH_REFERENCE_LIST_FIXTURE() :
+            m_resistor( "R", nullptr ),
+            m_quad( "LM324", nullptr )
+    {
+        m_quad.SetUnitCount( 4 );
+    }
+
+    /**
+     * Add a component using \a aPart to the reference list, with reference \a aRef
+     * (such as "R?" or "R12") and value \a aValue.
+     */
+    void addComponent( LIB_PART& aPart, const wxString& aRef, const wxString& aValue )
+    {
+        int x = m_components.size() * 1000;
+
+        m_components.emplace_back( new SCH_COMPONENT( wxPoint( x, 0 ) ) );
+
+        SCH_COMPONENT* comp = m_components.back().get();
+        comp->SetLibId( LIB_ID( "lib", aPart.GetName() ) );
+        comp->GetField( VALUE )->SetText( aValue );
+        comp->SetRef( &m_path, aRef );
+
+        SCH_REFERENCE ref( comp, &aPart, m_path );
+        m_refs.AddItem( ref );
+    }
+
+    void annotate()
+    {
+        m_refs.SplitReferences();
+        m_refs.SortByXCoordinate();
+        m_refs.Annotate( false, 0, 0, SCH_MULTI_UNIT_REFERENCE_MAP() );
+        m_refs.UpdateAnnotation();
+    }
+
+    /// The annotated references, as reference + unit
+    std::multiset<wxString> fullRefs()
+    {
+        std::multiset<wxString> refs;
+
+        for( unsigned i = 0; i < m_refs.GetCount(); i++ )
+        {
+            SCH_COMPONENT* comp = m_refs[i].GetComp();
+            refs.insert( comp->GetRef( &m_path )
+                         + LIB_PART::SubReference( comp->GetUnitSelection( &m_path ) ) );
+        }
+
+        return refs;
+    }
+
+    LIB_PART m_resistor;
+    LIB_PART m_quad;
+
+    SCH_SHEET_PATH                               m_path;
+    std::vector<std::unique_ptr<SCH_COMPONENT>> m_components;
+    SCH_REFERENCE_LIST                           m_refs;
+};
+
+
+BOOST_FIXTURE_TEST_SUITE( SchReferenceList, TEST_SCH_REFERENCE_LIST_FIXTURE )
+
+
+/**
+ * New references fill the holes left by the existing ones, then carry on after them
+ */
+BOOST_AUTO_TEST_CASE( FillHoles )
+{
+    addComponent( m_resistor, "R?", "10k" );
+    addComponent( m_resistor, "R1", "10k" );
+    addComponent( m_resistor, "R?", "10k" );
+    addComponent( m_resistor, "R4", "10k" );
+    addComponent( m_resistor, "R?", "10k" );
+    addComponent( m_resistor, "R?", "10k" );
+
+    annotate();
+
+    std::set<wxString> refs;
+
+    for( const auto& comp : m_components )
+        refs.insert( comp->GetRef( &m_path ) );
+
+    BOOST_CHECK( refs == std::set<wxString>( { "R1", "R2", "R3", "R4", "R5", "R6" } ) );
+    BOOST_CHECK_EQUAL( m_components[1]->GetRef( &m_path ), "R1" );
+    BOOST_CHECK_EQUAL( m_components[3]->GetRef( &m_path ), "R4" );
+}
+
+
+/**
+ * Units of the same value are grouped in packages, different values are not mixed
+ */
+BOOST_AUTO_TEST_CASE( MultiUnit )
+{
+    for( int i = 0; i < 5; i++ )
+        addComponent( m_quad, "U?", "LM324" );
+
+    addComponent( m_quad, "U?", "TL074" );
+
+    annotate();
+
+    std::multiset<wxString> expected( { "U1A", "U1B", "U1C", "U1D", "U2A", "U3A" } );
+
+    BOOST_CHECK( fullRefs() == expected );
+    BOOST_CHECK_EQUAL( m_components[5]->GetRef( &m_path ), "U3" );
+}
+
+
+/**
+ * Annotate a large synthetic design, checking the result with CheckAnnotation()
+ */
+BOOST_AUTO_TEST_CASE( LargeDesign )
+{
+    const int count = 30000;
+
+    for( int i = 0; i < count; i++ )
+    {
+        switch( i % 4 )
+        {
+        case 0:  addComponent( m_quad, "U?", "LM324" ); break;
+        case 1:  addComponent( m_resistor, "C?", "100n" ); break;
+        default: addComponent( m_resistor, "R?", wxString::Format( "%dk", i % 7 ) ); break;
+        }
+    }
+
+    PROF_COUNTER timer;
+
+    annotate();
+
+    timer.Stop();
+
+    BOOST_TEST_MESSAGE( "Annotated " << count << " symbols in " << timer.msecs() << " ms" );
+
+    NULL_REPORTER reporter;
+
+    BOOST_CHECK_EQUAL( m_refs.CheckAnnotation( reporter ), 0 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
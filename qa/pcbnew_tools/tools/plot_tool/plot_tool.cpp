@@ -0,0 +1,152 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <iostream>
+#include <string>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <pcbnew_utils/board_file_utils.h>
+#include <plotcontroller.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * Queue the plot of every enabled layer of the board in \a aController
+ */
+static void addLayerJobs( PLOT_CONTROLLER& aController, BOARD& aBoard, PLOT_FORMAT aFormat )
+{
+    for( LSEQ seq = aBoard.GetEnabledLayers().UIOrder(); seq; ++seq )
+    {
+        aController.SetLayer( *seq );
+        aController.AddPlotJob( aBoard.GetLayerName( *seq ), aFormat, wxEmptyString );
+    }
+}
+
+
+/**
+ * Plot all the layers with \a aThreadCount threads
+ *
+ * @return the number of files written
+ */
+static int plotLayers( PLOT_CONTROLLER& aController, BOARD& aBoard, PLOT_FORMAT aFormat,
+                       int aThreadCount )
+{
+    addLayerJobs( aController, aBoard, aFormat );
+
+    const int jobs = aController.GetPlotJobCount();
+
+    PROF_COUNTER timer;
+    const int    plotted = aController.PlotJobs( aThreadCount );
+    timer.Stop();
+
+    std::cout << "Plotted " << plotted << "/" << jobs << " layers with "
+              << ( aThreadCount ? std::to_string( aThreadCount ) : std::string( "all" ) )
+              << " threads in " << timer.msecs() << " ms" << std::endl;
+
+    return plotted;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_SWITCH, "s", "serial",
+            _( "also plot the layers on a single thread, for comparison" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "p", "pdf", _( "plot PDF files instead of Gerber files" ).mb_str() },
+    { wxCMD_LINE_OPTION, "j", "threads", _( "number of threads (default: all the cores)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "o", "output-dir", _( "output directory (default: plot)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PLOT_TOOL_RET_CODES
+{
+    PLOT_TOOL_LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+    PLOT_TOOL_PLOT_FAILED,
+};
+
+
+int plot_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program plots all the enabled layers of a board in their own files, "
+               "using several threads.  It is meant to benchmark the plot jobs." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    const std::string filename = cl_parser.GetParam( 0 ).ToStdString();
+
+    std::unique_ptr<BOARD> board = KI_TEST::ReadBoardFromFileOrStream( filename );
+
+    if( !board )
+        return PLOT_TOOL_RET_CODES::PLOT_TOOL_LOAD_FAILED;
+
+    // The plot file names are built from the board file name
+    wxFileName fn( filename );
+    fn.MakeAbsolute();
+    board->SetFileName( fn.GetFullPath() );
+
+    long     threads = 0;
+    wxString outputDir = "plot";
+
+    cl_parser.Found( "threads", &threads );
+    cl_parser.Found( "output-dir", &outputDir );
+
+    const PLOT_FORMAT format = cl_parser.Found( "pdf" ) ? PLOT_FORMAT::PDF : PLOT_FORMAT::GERBER;
+
+    PLOT_CONTROLLER controller( board.get() );
+    controller.GetPlotOptions().SetOutputDirectory( outputDir );
+    controller.GetPlotOptions().SetPlotFrameRef( false );
+
+    const int layerCount = board->GetEnabledLayers().count();
+
+    if( cl_parser.Found( "serial" ) && plotLayers( controller, *board, format, 1 ) != layerCount )
+        return PLOT_TOOL_RET_CODES::PLOT_TOOL_PLOT_FAILED;
+
+    if( plotLayers( controller, *board, format, threads ) != layerCount )
+        return PLOT_TOOL_RET_CODES::PLOT_TOOL_PLOT_FAILED;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register(
+        { "plot", "Plot all the layers of a PCB, to benchmark the plot jobs", plot_main_func } );
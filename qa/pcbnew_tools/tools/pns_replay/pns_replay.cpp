@@ -0,0 +1,418 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <class_board.h>
+#include <pcbnew_settings.h>
+#include <pcbnew_utils/board_file_utils.h>
+
+#include <router/pns_debug_decorator.h>
+#include <router/pns_kicad_iface.h>
+#include <router/pns_logger.h>
+#include <router/pns_router.h>
+#include <router/pns_routing_settings.h>
+#include <router/pns_sizes_settings.h>
+
+#include <qa_utils/utility_program.h>
+
+
+/*
+ * Allocation counter.  The router allocates through the standard containers, so only the
+ * global allocation functions see all of its allocations.  They are replaced for the whole
+ * program, which is why the replay is not one of the qa_pcbnew_tools, but they behave as the
+ * default ones and only count the allocations of a thread while it replays a session (see
+ * ALLOC_COUNTER).
+ */
+static thread_local bool    s_countAllocs = false;
+static thread_local int64_t s_allocCount = 0;
+
+
+void* operator new( std::size_t aSize )
+{
+    if( s_countAllocs )
+        s_allocCount++;
+
+    if( aSize == 0 )
+        aSize = 1;
+
+    while( true )
+    {
+        if( void* p = std::malloc( aSize ) )
+            return p;
+
+        std::new_handler handler = std::get_new_handler();
+
+        if( !handler )
+            throw std::bad_alloc();
+
+        handler();
+    }
+}
+
+
+void operator delete( void* aPtr ) noexcept
+{
+    std::free( aPtr );
+}
+
+
+void operator delete( void* aPtr, std::size_t ) noexcept
+{
+    std::free( aPtr );
+}
+
+
+/**
+ * Counts the allocations made by the current thread during its lifetime.
+ */
+class ALLOC_COUNTER
+{
+public:
+    ALLOC_COUNTER() : m_start( s_allocCount )
+    {
+        s_countAllocs = true;
+    }
+
+    ~ALLOC_COUNTER()
+    {
+        s_countAllocs = false;
+    }
+
+    int64_t Count() const
+    {
+        return s_allocCount - m_start;
+    }
+
+private:
+    int64_t m_start;
+};
+
+
+/**
+ * Router interface that syncs the world from a #BOARD but never touches the board or any
+ * view: committed items only update the router's own world.
+ */
+class PNS_REPLAY_IFACE : public PNS_KICAD_IFACE_BASE
+{
+public:
+    PNS_REPLAY_IFACE()
+    {
+        SetDebugDecorator( &m_decorator );
+    }
+
+    void AddItem( PNS::ITEM* aItem ) override
+    {
+        m_committedItems++;
+    }
+
+    void RemoveItem( PNS::ITEM* aItem ) override
+    {
+        m_committedItems++;
+    }
+
+    int m_committedItems = 0;
+
+private:
+    PNS::DEBUG_DECORATOR m_decorator;
+};
+
+
+/**
+ * Cost of a single replayed router event.
+ */
+struct PNS_REPLAY_SAMPLE
+{
+    PNS::LOGGER::EVENT_TYPE m_type;
+    double                  m_msecs;
+    int64_t                 m_queries;
+    int64_t                 m_allocs;
+};
+
+
+/**
+ * Replays a recorded router session against a board.
+ */
+class PNS_REPLAY_RUNNER
+{
+public:
+    PNS_REPLAY_RUNNER( BOARD* aBoard ) :
+            m_board( aBoard ),
+            m_routingSettings( &m_appSettings, "tools.pns" )
+    {
+        m_router.SetInterface( &m_iface );
+        m_router.LoadSettings( &m_routingSettings );
+        m_iface.SetBoard( m_board );
+    }
+
+    void SetMode( PNS::PNS_MODE aMode )
+    {
+        m_routingSettings.SetMode( aMode );
+    }
+
+    void Replay( const std::vector<PNS::LOGGER::EVENT_ENTRY>& aEvents )
+    {
+        // Each replay starts from the unmodified board
+        m_router.SyncWorld();
+
+        for( const auto& evt : aEvents )
+        {
+            PNS::ITEM* item = findItem( evt.uuid );
+
+            m_router.GetWorld()->ResetQueryCount();
+
+            ALLOC_COUNTER allocs;
+            PROF_COUNTER  cnt;
+
+            switch( evt.type )
+            {
+            case PNS::LOGGER::EVT_START_ROUTE:
+            {
+                PNS::SIZES_SETTINGS sizes( m_router.Sizes() );
+                sizes.Init( m_board, item );
+                m_router.UpdateSizes( sizes );
+                m_router.SetMode( static_cast<PNS::ROUTER_MODE>( evt.mode ) );
+                m_router.StartRouting( evt.p, item, evt.layer );
+                break;
+            }
+
+            case PNS::LOGGER::EVT_START_DRAG:
+                m_router.StartDragging( evt.p, item, evt.mode );
+                break;
+
+            case PNS::LOGGER::EVT_MOVE:
+                m_router.Move( evt.p, item );
+                break;
+
+            case PNS::LOGGER::EVT_FIX:
+                m_router.FixRoute( evt.p, item, evt.mode != 0 );
+                break;
+
+            case PNS::LOGGER::EVT_ABORT:
+                m_router.StopRouting();
+                break;
+            }
+
+            cnt.Stop();
+
+            m_samples.push_back( { evt.type, cnt.msecs(), m_router.GetWorld()->QueryCount(),
+                                   allocs.Count() } );
+        }
+
+        m_router.StopRouting();
+    }
+
+    void Report( std::ostream& aStream ) const
+    {
+        static const std::map<PNS::LOGGER::EVENT_TYPE, std::string> names = {
+            { PNS::LOGGER::EVT_START_ROUTE, "start-route" },
+            { PNS::LOGGER::EVT_START_DRAG, "start-drag" },
+            { PNS::LOGGER::EVT_MOVE, "move" },
+            { PNS::LOGGER::EVT_FIX, "fix" },
+            { PNS::LOGGER::EVT_ABORT, "abort" },
+        };
+
+        aStream << std::setw( 12 ) << "event" << std::setw( 8 ) << "count"
+                << std::setw( 10 ) << "p50 ms" << std::setw( 10 ) << "p90 ms"
+                << std::setw( 10 ) << "p99 ms" << std::setw( 10 ) << "max ms"
+                << std::setw( 12 ) << "queries" << std::setw( 12 ) << "allocs" << std::endl;
+
+        for( const auto& name : names )
+        {
+            std::vector<double> times;
+            int64_t             queries = 0;
+            int64_t             allocs = 0;
+
+            for( const auto& sample : m_samples )
+            {
+                if( sample.m_type != name.first )
+                    continue;
+
+                times.push_back( sample.m_msecs );
+                queries += sample.m_queries;
+                allocs += sample.m_allocs;
+            }
+
+            if( times.empty() )
+                continue;
+
+            std::sort( times.begin(), times.end() );
+
+            auto percentile = [&]( double aP ) -> double
+            {
+                return times[ std::min<size_t>( times.size() - 1, aP * times.size() ) ];
+            };
+
+            aStream << std::setw( 12 ) << name.second << std::setw( 8 ) << times.size()
+                    << std::fixed << std::setprecision( 3 )
+                    << std::setw( 10 ) << percentile( 0.5 ) << std::setw( 10 ) << percentile( 0.9 )
+                    << std::setw( 10 ) << percentile( 0.99 ) << std::setw( 10 ) << times.back()
+                    << std::setw( 12 ) << queries / (int64_t) times.size()
+                    << std::setw( 12 ) << allocs / (int64_t) times.size() << std::endl;
+        }
+
+        aStream << "items committed: " << m_iface.m_committedItems << std::endl;
+    }
+
+private:
+    PNS::ITEM* findItem( const KIID& aUuid )
+    {
+        if( aUuid == niluuid )
+            return nullptr;
+
+        BOARD_ITEM* parent = m_board->GetItem( aUuid );
+
+        if( !parent || !parent->IsConnected() )
+            return nullptr;
+
+        return m_router.GetWorld()->FindItemByParent(
+                static_cast<BOARD_CONNECTED_ITEM*>( parent ) );
+    }
+
+    BOARD*                         m_board;
+    PCBNEW_SETTINGS                m_appSettings;
+    PNS::ROUTING_SETTINGS          m_routingSettings;
+    PNS_REPLAY_IFACE               m_iface;
+    PNS::ROUTER                    m_router;
+    std::vector<PNS_REPLAY_SAMPLE> m_samples;
+};
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    {
+            wxCMD_LINE_SWITCH,
+            "h",
+            "help",
+            _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE,
+            wxCMD_LINE_OPTION_HELP,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "m",
+            "mode",
+            _( "routing mode: walkaround (default), shove or highlight" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_OPTION,
+            "r",
+            "repeat",
+            _( "number of times the session is replayed" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "input board file" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    {
+            wxCMD_LINE_PARAM,
+            nullptr,
+            nullptr,
+            _( "router event log (as written by PNS::ROUTER::DumpLog())" ).mb_str(),
+            wxCMD_LINE_VAL_STRING,
+    },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * Tool-specific return codes
+ */
+enum PNS_REPLAY_RET_CODES
+{
+    LOAD_FAILED = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int main( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program replays a recorded interactive router session on a board "
+               "and reports the latency of each router event." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    std::unique_ptr<BOARD> board =
+            KI_TEST::ReadBoardFromFileOrStream( cl_parser.GetParam( 0 ).ToStdString() );
+
+    if( !board )
+        return PNS_REPLAY_RET_CODES::LOAD_FAILED;
+
+    std::vector<PNS::LOGGER::EVENT_ENTRY> events;
+
+    if( !PNS::LOGGER::LoadEvents( cl_parser.GetParam( 1 ).ToStdString(), events ) )
+    {
+        std::cerr << "Can't read router event log" << std::endl;
+        return PNS_REPLAY_RET_CODES::LOAD_FAILED;
+    }
+
+    PNS::PNS_MODE mode = PNS::RM_Walkaround;
+    wxString      modeName;
+
+    if( cl_parser.Found( "mode", &modeName ) )
+    {
+        if( modeName == "shove" )
+            mode = PNS::RM_Shove;
+        else if( modeName == "highlight" )
+            mode = PNS::RM_MarkObstacles;
+    }
+
+    long repeat = 1;
+    cl_parser.Found( "repeat", &repeat );
+
+    PNS_REPLAY_RUNNER runner( board.get() );
+    runner.SetMode( mode );
+
+    for( long i = 0; i < repeat; i++ )
+        runner.Replay( events );
+
+    runner.Report( std::cout );
+
+    return KI_TEST::RET_CODES::OK;
+}
+
@@ -0,0 +1,340 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <common.h>
+#include <profile.h>
+
+#include <wx/cmdline.h>
+
+#include <3d_rendering/ctrack_ball.h>
+#include <3d_rendering/3d_render_raytracing/cmaterial.h>
+#include <3d_rendering/3d_render_raytracing/accelerators/cbvh_pbrt.h>
+#include <3d_rendering/3d_render_raytracing/shapes3D/ctriangle.h>
+
+#include <qa_utils/utility_registry.h>
+
+
+/**
+ * @return the X (or Y) coordinate of the column (or row) \a aIndex of vertices of the grid
+ */
+static float gridCoord( int aIndex, int aGridSize )
+{
+    return 2.0f * aIndex / aGridSize - 1.0f;
+}
+
+
+/**
+ * Fill \a aContainer with a bumpy square of 2 * aGridSize * aGridSize triangles, from -1 to 1
+ * in X and Y, facing the default camera
+ */
+static void buildScene( CCONTAINER& aContainer, const CMATERIAL* aMaterial, int aGridSize )
+{
+    auto vertex = [aGridSize]( int aX, int aY ) {
+        const float x = gridCoord( aX, aGridSize );
+        const float y = gridCoord( aY, aGridSize );
+
+        return SFVEC3F( x, y, 0.05f * std::sin( 12.0f * x ) * std::cos( 9.0f * y ) );
+    };
+
+    for( int y = 0; y < aGridSize; ++y )
+    {
+        for( int x = 0; x < aGridSize; ++x )
+        {
+            CTRIANGLE* lower = new CTRIANGLE( vertex( x, y ), vertex( x + 1, y ),
+                                              vertex( x, y + 1 ) );
+            CTRIANGLE* upper = new CTRIANGLE( vertex( x + 1, y ), vertex( x + 1, y + 1 ),
+                                              vertex( x, y + 1 ) );
+
+            lower->SetMaterial( aMaterial );
+            upper->SetMaterial( aMaterial );
+
+            aContainer.Add( lower );
+            aContainer.Add( upper );
+        }
+    }
+}
+
+
+static void resetHits( HITINFO_PACKET* aHitPacket )
+{
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        aHitPacket[i].m_HitInfo.m_tHit = std::numeric_limits<float>::infinity();
+        aHitPacket[i].m_HitInfo.m_acc_node_info = 0;
+        aHitPacket[i].m_hitresult = false;
+    }
+}
+
+
+/**
+ * Trace all the ray packets of the image \a aIterations times
+ *
+ * @param aHits the hits of the last iteration, one per pixel
+ * @return the time taken, in ms
+ */
+static double tracePackets( const CBVH_PBRT& aBvh, const CCAMERA& aCamera, const wxSize& aSize,
+                            int aIterations, std::vector<HITINFO_PACKET>& aHits )
+{
+    const int packetsX = aSize.x / RAYPACKET_DIM;
+    const int packetsY = aSize.y / RAYPACKET_DIM;
+
+    aHits.resize( packetsX * packetsY * RAYPACKET_RAYS_PER_PACKET );
+
+    PROF_COUNTER timer;
+
+    for( int iteration = 0; iteration < aIterations; ++iteration )
+    {
+        for( int y = 0; y < packetsY; ++y )
+        {
+            for( int x = 0; x < packetsX; ++x )
+            {
+                const RAYPACKET rayPacket( aCamera, SFVEC2I( x * RAYPACKET_DIM,
+                                                             y * RAYPACKET_DIM ) );
+
+                HITINFO_PACKET* hitPacket =
+                        &aHits[( y * packetsX + x ) * RAYPACKET_RAYS_PER_PACKET];
+
+                resetHits( hitPacket );
+                aBvh.Intersect( rayPacket, hitPacket );
+            }
+        }
+    }
+
+    timer.Stop();
+
+    return timer.msecs();
+}
+
+
+/**
+ * Trace packets of rays going straight down from the vertices of the grid.  These rays are
+ * parallel to the X and Y planes of the boxes around them, and start on some of these planes,
+ * which the box tests must accept.  Every other packet has -0 for the X and Y directions.
+ *
+ * @param aCamera only gives the packets their initial rays, which are then replaced
+ */
+static void traceVertexPackets( const CBVH_PBRT& aBvh, const CCAMERA& aCamera, int aGridSize,
+                                std::vector<HITINFO_PACKET>& aHits )
+{
+    const int packets = std::max( aGridSize / RAYPACKET_DIM, 1 );
+
+    aHits.resize( packets * packets * RAYPACKET_RAYS_PER_PACKET );
+
+    for( int y = 0; y < packets; ++y )
+    {
+        for( int x = 0; x < packets; ++x )
+        {
+            RAYPACKET     rayPacket( aCamera, SFVEC2I( 0, 0 ) );
+            const float   zero = ( ( x + y ) % 2 ) ? -0.0f : 0.0f;
+            const SFVEC3F dir( zero, zero, -1.0f );
+
+            for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+            {
+                const int column = x * RAYPACKET_DIM + i % RAYPACKET_DIM;
+                const int row = y * RAYPACKET_DIM + i / RAYPACKET_DIM;
+
+                rayPacket.m_ray[i].Init( SFVEC3F( gridCoord( column, aGridSize ),
+                                                  gridCoord( row, aGridSize ), 1.0f ),
+                                         dir );
+            }
+
+            rayPacket.m_Frustum.GenerateFrustum(
+                    rayPacket.m_ray[0], rayPacket.m_ray[RAYPACKET_DIM - 1],
+                    rayPacket.m_ray[RAYPACKET_RAYS_PER_PACKET - RAYPACKET_DIM],
+                    rayPacket.m_ray[RAYPACKET_RAYS_PER_PACKET - 1] );
+
+            HITINFO_PACKET* hitPacket = &aHits[( y * packets + x ) * RAYPACKET_RAYS_PER_PACKET];
+
+            resetHits( hitPacket );
+            aBvh.Intersect( rayPacket, hitPacket );
+        }
+    }
+}
+
+
+/**
+ * @return the number of rays that do not hit the same triangle at the same distance
+ */
+static int countMismatches( const std::vector<HITINFO_PACKET>& aReference,
+                            const std::vector<HITINFO_PACKET>& aHits )
+{
+    int mismatches = 0;
+
+    for( size_t i = 0; i < aReference.size(); ++i )
+    {
+        if( aHits[i].m_hitresult != aReference[i].m_hitresult )
+            mismatches++;
+        else if( aHits[i].m_hitresult
+                 && ( aHits[i].m_HitInfo.m_tHit != aReference[i].m_HitInfo.m_tHit
+                      || aHits[i].m_HitInfo.pHitObject != aReference[i].m_HitInfo.pHitObject ) )
+            mismatches++;
+    }
+
+    return mismatches;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "x", "width", _( "width of the image (default: 1024)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "y", "height", _( "height of the image (default: 768)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "g", "grid",
+            _( "cells of the triangle grid along each side (default: 256)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "n", "iterations",
+            _( "number of times the image is traced (default: 10)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum PACKET_TRAVERSAL_RET_CODES
+{
+    PACKET_TRAVERSAL_MISMATCH = KI_TEST::RET_CODES::TOOL_SPECIFIC,
+};
+
+
+int packet_traversal_main_func( int argc, char** argv )
+{
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program traces the ray packets of a fixed scene of triangles through the "
+               "BVH with each of the packet traversals that this CPU supports, and checks "
+               "that they all give the same hits.  Rays going straight down from the vertices "
+               "of the grid check the rays that start on the planes of the boxes." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KI_TEST::RET_CODES::OK : KI_TEST::RET_CODES::BAD_CMDLINE;
+    }
+
+    long width = 1024;
+    long height = 768;
+    long gridSize = 256;
+    long iterations = 10;
+
+    cl_parser.Found( "width", &width );
+    cl_parser.Found( "height", &height );
+    cl_parser.Found( "grid", &gridSize );
+    cl_parser.Found( "iterations", &iterations );
+
+    CBLINN_PHONG_MATERIAL material;
+    CCONTAINER            container;
+
+    buildScene( container, &material, gridSize );
+
+    PROF_COUNTER    timer;
+    const CBVH_PBRT bvh( container );
+    timer.Stop();
+
+    std::cout << "Built the BVH of " << container.GetList().size() << " triangles in "
+              << timer.msecs() << " ms" << std::endl;
+
+    // Look at the grid from below and aside, so the packets see it at different depths
+    CTRACK_BALL  camera( 1.0f );
+    const wxSize size( width, height );
+
+    camera.SetCurWindowSize( size );
+    camera.RotateX( glm::radians( 30.0f ) );
+    camera.RotateZ( glm::radians( 20.0f ) );
+
+    const PACKET_TRAVERSAL defaultTraversal = CBVH_PBRT::GetPacketTraversal();
+
+    static const struct
+    {
+        PACKET_TRAVERSAL m_traversal;
+        const char*      m_name;
+    } traversals[] = {
+        { PACKET_TRAVERSAL::SCALAR, "scalar" },
+        { PACKET_TRAVERSAL::SSE, "sse" },
+        { PACKET_TRAVERSAL::AVX, "avx" },
+    };
+
+    std::vector<HITINFO_PACKET> reference;
+    std::vector<HITINFO_PACKET> vertexReference;
+    double                      referenceTime = 0.0;
+    bool                        ok = true;
+
+    for( const auto& traversal : traversals )
+    {
+        if( !CBVH_PBRT::SetPacketTraversal( traversal.m_traversal ) )
+        {
+            std::cout << traversal.m_name << ": not supported" << std::endl;
+            continue;
+        }
+
+        std::vector<HITINFO_PACKET> hits;
+        std::vector<HITINFO_PACKET> vertexHits;
+        const double time = tracePackets( bvh, camera, size, iterations, hits );
+        const double rays = (double) hits.size() * iterations;
+
+        traceVertexPackets( bvh, camera, gridSize, vertexHits );
+
+        std::cout << traversal.m_name << ": " << time << " ms, " << rays / time / 1000.0
+                  << " Mrays/s";
+
+        if( traversal.m_traversal == PACKET_TRAVERSAL::SCALAR )
+        {
+            reference.swap( hits );
+            vertexReference.swap( vertexHits );
+            referenceTime = time;
+        }
+        else
+        {
+            const int mismatches = countMismatches( reference, hits );
+            const int vertexMismatches = countMismatches( vertexReference, vertexHits );
+
+            std::cout << ", x" << referenceTime / time << ", " << mismatches << " mismatches, "
+                      << vertexMismatches << " on the grid vertices";
+
+            ok = ok && mismatches == 0 && vertexMismatches == 0;
+        }
+
+        std::cout << std::endl;
+    }
+
+    CBVH_PBRT::SetPacketTraversal( defaultTraversal );
+
+    if( !ok )
+        return PACKET_TRAVERSAL_RET_CODES::PACKET_TRAVERSAL_MISMATCH;
+
+    return KI_TEST::RET_CODES::OK;
+}
+
+
+static bool registered = UTILITY_REGISTRY::Register(
+        { "rt_packets", "Benchmark the ray packet traversals of the raytracer BVH",
+          packet_traversal_main_func } );
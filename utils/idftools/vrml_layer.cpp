@@ -269,6 +269,31 @@ void VRML_LAYER::Clear( void )
 }
 
 
+
+// replace the contours with a copy of the contours of another layer
+void VRML_LAYER::CopyContours( const VRML_LAYER& aLayer )
+{
+    Clear();
+
+    offsetX = aLayer.offsetX;
+    offsetY = aLayer.offsetY;
+    fix     = aLayer.fix;
+    idx     = aLayer.idx;
+
+    vertices.reserve( aLayer.vertices.size() );
+
+    for( VERTEX_3D* vp : aLayer.vertices )
+        vertices.push_back( new VERTEX_3D( *vp ) );
+
+    contours.reserve( aLayer.contours.size() );
+
+    for( std::list<int>* cp : aLayer.contours )
+        contours.push_back( new std::list<int>( *cp ) );
+
+    pth = aLayer.pth;
+    areas = aLayer.areas;
+}
+
 // clear ephemeral data in between invocations of the tesselation routine
 void VRML_LAYER::clearTmp( void )
 {
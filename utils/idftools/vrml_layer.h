@@ -185,6 +185,16 @@ public:
      */
     void Clear( void );
 
+    /**
+     * Function CopyContours
+     * replaces the contours of this layer with a copy of the contours of another layer.
+     * A layer renumbers the vertices of the holes it is tesselated with, so layers which
+     * are tesselated concurrently must each use their own copy of the holes.
+     *
+     * @param aLayer is the layer to copy
+     */
+    void CopyContours( const VRML_LAYER& aLayer );
+
     /**
      * Function GetSize
      * returns the total number of vertices indexed
@@ -0,0 +1,398 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+#include <wx/init.h>
+
+#include <common.h>
+#include <kiface_i.h>
+#include <kiway.h>
+#include <pgm_base.h>
+#include <profile.h>
+#include <project.h>
+#include <reporter.h>
+#include <richio.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+#include <connection_graph.h>
+#include <eeschema_settings.h>
+#include <general.h>
+#include <netlist_exporter_generic.h>
+#include <netlist_exporter_kicad.h>
+#include <netlist_object.h>
+#include <sch_io_mgr.h>
+#include <sch_reference_list.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <symbol_lib_table.h>
+
+
+/**
+ * The program of kicad-netlist.  The kiface of eeschema is linked in, and gets it from
+ * KIFACE_GETTER like any other program.
+ */
+static struct PGM_KICAD_NETLIST : public PGM_BASE
+{
+    bool OnPgmInit() override
+    {
+        return InitPgm( true );
+    }
+
+    void OnPgmExit() override
+    {
+        Destroy();
+    }
+
+    void MacOpenFile( const wxString& aFileName ) override
+    {
+    }
+} program;
+
+
+/**
+ * Options for a netlist run
+ */
+struct SCH_NETLIST_OPTIONS
+{
+    bool     m_netlist;
+    bool     m_bom;
+    bool     m_verbose;
+    bool     m_incremental;
+    wxString m_outputDir;
+};
+
+
+static void reportTime( const SCH_NETLIST_OPTIONS& aOpts, const char* aStep, PROF_COUNTER& aTimer )
+{
+    aTimer.Stop();
+
+    if( aOpts.m_verbose )
+        std::cout << "  " << aStep << ": " << aTimer.msecs() << " ms" << std::endl;
+
+    aTimer.Start();
+}
+
+
+static wxFileName outputFile( const SCH_NETLIST_OPTIONS& aOpts, const wxFileName& aSchematic,
+                              const wxString& aExt )
+{
+    wxFileName fn = aSchematic;
+    fn.SetExt( aExt );
+
+    if( !aOpts.m_outputDir.IsEmpty() )
+        fn.SetPath( aOpts.m_outputDir );
+
+    return fn;
+}
+
+
+/**
+ * Compare the time of a full recalculation of the connection graph with that of the
+ * incremental updates after an edit of each sheet, simulated by marking the connectivity of
+ * one of its items dirty
+ */
+static void timeIncrementalUpdates( const SCH_SHEET_LIST& aSheets )
+{
+    PROF_COUNTER timer;
+
+    g_ConnectionGraph->Recalculate( aSheets, true );
+    timer.Stop();
+
+    double full = timer.msecs();
+    double total = 0.0;
+    double slowest = 0.0;
+    int    count = 0;
+
+    for( const SCH_SHEET_PATH& sheet : aSheets )
+    {
+        SCH_ITEM* edited = nullptr;
+
+        for( SCH_ITEM* item : sheet.LastScreen()->Items() )
+        {
+            if( item->IsConnectable() )
+            {
+                edited = item;
+                break;
+            }
+        }
+
+        if( !edited )
+            continue;
+
+        edited->SetConnectivityDirty();
+
+        timer.Start();
+        g_ConnectionGraph->Recalculate( aSheets );
+        timer.Stop();
+
+        total += timer.msecs();
+        slowest = std::max( slowest, timer.msecs() );
+        count++;
+    }
+
+    std::cout << "  full recalculation: " << full << " ms" << std::endl;
+
+    if( count > 0 )
+    {
+        std::cout << "  incremental update of " << count << " sheets: " << total / count
+                  << " ms average, " << slowest << " ms slowest" << std::endl;
+    }
+}
+
+
+/**
+ * Load a schematic hierarchy, build its connectivity and write the requested netlists
+ *
+ * @return true if all the requested files were written
+ */
+static bool processSchematic( KIWAY& aKiway, const wxFileName& aSchematic,
+                              const SCH_NETLIST_OPTIONS& aOpts )
+{
+    PROF_COUNTER total;
+    PROF_COUNTER timer;
+
+    wxFileName pro = aSchematic;
+    pro.SetExt( ProjectFileExtension );
+
+    // Changing the project drops the symbol libraries of the previous one
+    aKiway.Prj().SetProjectFullName( pro.GetFullPath() );
+
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_LEGACY ) );
+    std::unique_ptr<SCH_SHEET>      root;
+
+    try
+    {
+        root.reset( pi->Load( aSchematic.GetFullPath(), &aKiway ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading " << aSchematic.GetFullPath() << ": " << ioe.What()
+                  << std::endl;
+        return false;
+    }
+
+    if( !pi->GetError().IsEmpty() )
+        std::cerr << "Some sheets could not be loaded:\n" << pi->GetError() << std::endl;
+
+    SCH_SHEET_PATH rootPath;
+    rootPath.push_back( root.get() );
+
+    g_RootSheet = root.get();
+    g_CurrentSheet = &rootPath;
+
+    reportTime( aOpts, "load", timer );
+
+    SCH_SCREENS screens;
+    screens.UpdateSymbolLinks( true );
+
+    reportTime( aOpts, "symbol links", timer );
+
+    SCH_SHEET_LIST sheets( g_RootSheet );
+    sheets.AnnotatePowerSymbols();
+
+    SCH_REFERENCE_LIST refs;
+    sheets.GetComponents( refs, false );
+
+    if( refs.CheckAnnotation( NULL_REPORTER::GetInstance() ) > 0 )
+        std::cerr << "Warning: " << aSchematic.GetFullName() << " is not fully annotated"
+                  << std::endl;
+
+    g_ConnectionGraph->Reset();
+    g_ConnectionGraph->Recalculate( sheets, true );
+
+    reportTime( aOpts, "connectivity", timer );
+
+    SYMBOL_LIB_TABLE* libTable = aKiway.Prj().SchSymbolLibTable();
+    bool              ok = true;
+
+    // Only the connection graph is used to build the nets, so the flat netlist the exporters
+    // take ownership of is left empty.
+    if( aOpts.m_netlist )
+    {
+        wxFileName             fn = outputFile( aOpts, aSchematic, NetlistFileExtension );
+        NETLIST_EXPORTER_KICAD exporter( libTable, new NETLIST_OBJECT_LIST, g_ConnectionGraph );
+
+        try
+        {
+            FILE_OUTPUTFORMATTER formatter( fn.GetFullPath() );
+            exporter.Format( &formatter, GNL_ALL );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            std::cerr << "Error writing " << fn.GetFullPath() << ": " << ioe.What() << std::endl;
+            ok = false;
+        }
+
+        reportTime( aOpts, "netlist", timer );
+    }
+
+    if( aOpts.m_bom )
+    {
+        wxFileName fn = outputFile( aOpts, aSchematic, GENERIC_INTERMEDIATE_NETLIST_EXT );
+        NETLIST_EXPORTER_GENERIC exporter( libTable, new NETLIST_OBJECT_LIST, g_ConnectionGraph );
+
+        if( !exporter.WriteNetlist( fn.GetFullPath(), 0 ) )
+        {
+            std::cerr << "Error writing " << fn.GetFullPath() << std::endl;
+            ok = false;
+        }
+
+        reportTime( aOpts, "bom xml", timer );
+    }
+
+    total.Stop();
+
+    std::cout << aSchematic.GetFullPath() << ": " << sheets.size() << " sheets, "
+              << refs.GetCount() << " symbols, " << g_ConnectionGraph->GetNetMap().size()
+              << " nets in " << total.msecs() << " ms" << std::endl;
+
+    if( aOpts.m_incremental )
+        timeIncrementalUpdates( sheets );
+
+    // The graph holds pointers to the schematic items
+    g_ConnectionGraph->Reset();
+    g_CurrentSheet = nullptr;
+    g_RootSheet = nullptr;
+
+    return ok;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_SWITCH, "v", "verbose", _( "print the time taken by each step" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "n", "netlist", _( "write the KiCad netlist" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "b", "bom", _( "write the XML netlist used by BOM plugins" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "i", "incremental",
+            _( "time the incremental connectivity updates after an edit of each sheet" ).mb_str() },
+    { wxCMD_LINE_OPTION, "o", "output-dir",
+            _( "output directory (default: next to each schematic)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "schematic file" ).mb_str(), wxCMD_LINE_VAL_STRING,
+            wxCMD_LINE_PARAM_MULTIPLE },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum KICAD_NETLIST_RET_CODES
+{
+    KICAD_NETLIST_OK = 0,
+    KICAD_NETLIST_BAD_CMDLINE,
+    KICAD_NETLIST_INIT_FAILED,
+    KICAD_NETLIST_FAILED,
+};
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        std::cerr << "Failed to initialize wxWidgets" << std::endl;
+        return KICAD_NETLIST_INIT_FAILED;
+    }
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program loads schematic hierarchies and writes their netlists "
+               "without the schematic editor.  When neither --netlist nor --bom is given, "
+               "both files are written." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KICAD_NETLIST_OK : KICAD_NETLIST_BAD_CMDLINE;
+    }
+
+    SCH_NETLIST_OPTIONS opts;
+    opts.m_netlist = cl_parser.Found( "netlist" );
+    opts.m_bom = cl_parser.Found( "bom" );
+    opts.m_verbose = cl_parser.Found( "verbose" );
+    opts.m_incremental = cl_parser.Found( "incremental" );
+    cl_parser.Found( "output-dir", &opts.m_outputDir );
+
+    if( !opts.m_netlist && !opts.m_bom )
+        opts.m_netlist = opts.m_bom = true;
+
+    if( !program.OnPgmInit() )
+        return KICAD_NETLIST_INIT_FAILED;
+
+    // Do what OnKifaceStart() does for the schematics, without its dialogs
+    int kifaceVersion = 0;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+    Kiface().InitSettings( new EESCHEMA_SETTINGS );
+    program.GetSettingsManager().RegisterSettings( Kiface().KifaceSettings() );
+
+    try
+    {
+        SYMBOL_LIB_TABLE::LoadGlobalTable( SYMBOL_LIB_TABLE::GetGlobalLibTable() );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << "Error loading the global symbol library table: " << ioe.What()
+                  << std::endl;
+    }
+
+    bool ok = true;
+
+    {
+        KIWAY            kiway( &program, KFCTL_STANDALONE );
+        CONNECTION_GRAPH graph( nullptr );
+
+        g_ConnectionGraph = &graph;
+
+        PROF_COUNTER timer;
+
+        for( unsigned i = 0; i < cl_parser.GetParamCount(); i++ )
+        {
+            wxFileName fn( cl_parser.GetParam( i ) );
+            fn.MakeAbsolute();
+
+            ok = processSchematic( kiway, fn, opts ) && ok;
+        }
+
+        timer.Stop();
+
+        std::cout << "Processed " << cl_parser.GetParamCount() << " schematics in "
+                  << timer.msecs() << " ms" << std::endl;
+
+        g_ConnectionGraph = nullptr;
+    }
+
+    program.OnPgmExit();
+
+    return ok ? KICAD_NETLIST_OK : KICAD_NETLIST_FAILED;
+}
+
@@ -0,0 +1,311 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2020 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <iostream>
+#include <memory>
+
+#include <wx/cmdline.h>
+#include <wx/init.h>
+
+#include <common.h>
+#include <kiface_i.h>
+#include <kiway.h>
+#include <pgm_base.h>
+#include <profile.h>
+#include <reporter.h>
+#include <settings/settings_manager.h>
+#include <wildcards_and_files_ext.h>
+
+#include <class_board.h>
+#include <io_mgr.h>
+#include <pcbnew_settings.h>
+
+#include <3d_canvas/cinfo3d_visu.h>
+#include <3d_rendering/3d_render_raytracing/c3d_render_raytracing.h>
+
+
+/**
+ * The program of kicad-render.  The kiface of pcbnew is linked in, and gets it from
+ * KIFACE_GETTER like any other program.
+ */
+static struct PGM_KICAD_RENDER : public PGM_BASE
+{
+    bool OnPgmInit() override
+    {
+        return InitPgm( true );
+    }
+
+    void OnPgmExit() override
+    {
+        Destroy();
+    }
+
+    void MacOpenFile( const wxString& aFileName ) override
+    {
+    }
+} program;
+
+
+/**
+ * Prints the warnings of the render on stderr, and remembers if an error was reported.
+ */
+class RENDER_REPORTER : public REPORTER
+{
+public:
+    RENDER_REPORTER() :
+            m_hasError( false )
+    {
+    }
+
+    REPORTER& Report( const wxString& aText, SEVERITY aSeverity = RPT_SEVERITY_UNDEFINED ) override
+    {
+        // The 3D viewer reports an empty message when the board outline is fine
+        if( !aText.IsEmpty() )
+            std::cerr << aText << std::endl;
+
+        if( aSeverity == RPT_SEVERITY_ERROR )
+            m_hasError = true;
+
+        return *this;
+    }
+
+    bool HasMessage() const override
+    {
+        return m_hasError;
+    }
+
+private:
+    bool m_hasError;
+};
+
+
+static void reportTime( const char* aPhase, unsigned int aMicroSecs )
+{
+    std::cout << "  " << aPhase << ": " << aMicroSecs / 1000.0 << " ms" << std::endl;
+}
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] = {
+    { wxCMD_LINE_SWITCH, "h", "help", _( "displays help on the command line parameters" ).mb_str(),
+            wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "x", "width", _( "width of the image (default: 1600)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "y", "height", _( "height of the image (default: 1200)" ).mb_str(),
+            wxCMD_LINE_VAL_NUMBER },
+    { wxCMD_LINE_OPTION, "r", "rotate-x",
+            _( "rotation of the camera around the X axis, in degrees" ).mb_str(),
+            wxCMD_LINE_VAL_DOUBLE },
+    { wxCMD_LINE_OPTION, "z", "rotate-z",
+            _( "rotation of the camera around the Z axis, in degrees" ).mb_str(),
+            wxCMD_LINE_VAL_DOUBLE },
+    { wxCMD_LINE_SWITCH, "f", "fast",
+            _( "disable the shadows, reflections, refractions and post processing" ).mb_str() },
+    { wxCMD_LINE_SWITCH, "m", "no-models", _( "do not render the 3D models" ).mb_str() },
+    { wxCMD_LINE_OPTION, "o", "output",
+            _( "output PNG file (default: the board file name)" ).mb_str(),
+            wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_PARAM, nullptr, nullptr, _( "input file" ).mb_str(), wxCMD_LINE_VAL_STRING },
+    { wxCMD_LINE_NONE }
+};
+
+
+enum KICAD_RENDER_RET_CODES
+{
+    KICAD_RENDER_OK = 0,
+    KICAD_RENDER_BAD_CMDLINE,
+    KICAD_RENDER_INIT_FAILED,
+    KICAD_RENDER_LOAD_FAILED,
+    KICAD_RENDER_RENDER_FAILED,
+    KICAD_RENDER_SAVE_FAILED,
+};
+
+
+/**
+ * Load a board and raytrace it with the options of the command line
+ *
+ * @return the return code of the program
+ */
+static int renderBoard( KIWAY& aKiway, const wxFileName& aBoardFile,
+                        const wxCmdLineParser& aParser )
+{
+    // The 3D models are resolved against the project of the board
+    wxFileName projectName( aBoardFile );
+
+    projectName.SetExt( ProjectFileExtension );
+    aKiway.Prj().SetProjectFullName( projectName.GetFullPath() );
+
+    PROF_COUNTER           timer;
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        IO_MGR::PCB_FILE_T fileType = aBoardFile.GetExt() == KiCadPcbFileExtension
+                                              ? IO_MGR::KICAD_SEXP
+                                              : IO_MGR::LEGACY;
+
+        board.reset( IO_MGR::Load( fileType, aBoardFile.GetFullPath() ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        std::cerr << ioe.What() << std::endl;
+    }
+
+    if( !board )
+        return KICAD_RENDER_LOAD_FAILED;
+
+    board->BuildConnectivity();
+    board->BuildListOfNets();
+    board->SynchronizeNetsAndNetClasses();
+
+    timer.Stop();
+    std::cout << "Loaded " << aBoardFile.GetFullPath() << " in " << timer.msecs() << " ms"
+              << std::endl;
+
+    long       width = 1600;
+    long       height = 1200;
+    double     rotateX = 0.0;
+    double     rotateZ = 0.0;
+    wxFileName output( aBoardFile );
+
+    output.SetExt( "png" );
+
+    wxString outputName;
+
+    if( aParser.Found( "output", &outputName ) )
+        output = outputName;
+
+    aParser.Found( "width", &width );
+    aParser.Found( "height", &height );
+    aParser.Found( "rotate-x", &rotateX );
+    aParser.Found( "rotate-z", &rotateZ );
+
+    // The other settings keep the defaults of CINFO3D_VISU
+    CINFO3D_VISU settings;
+    settings.SetBoard( board.get() );
+    settings.Set3DCacheManager( aKiway.Prj().Get3DCacheManager() );
+    settings.RenderEngineSet( RENDER_ENGINE::RAYTRACING );
+    settings.SetFlag( FL_RENDER_RAYTRACING_PROCEDURAL_TEXTURES, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING, true );
+
+    if( aParser.Found( "no-models" ) )
+    {
+        settings.SetFlag( FL_MODULE_ATTRIBUTES_NORMAL, false );
+        settings.SetFlag( FL_MODULE_ATTRIBUTES_NORMAL_INSERT, false );
+        settings.SetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL, false );
+    }
+
+    if( !aParser.Found( "fast" ) )
+    {
+        settings.SetFlag( FL_RENDER_RAYTRACING_SHADOWS, true );
+        settings.SetFlag( FL_RENDER_RAYTRACING_REFLECTIONS, true );
+        settings.SetFlag( FL_RENDER_RAYTRACING_REFRACTIONS, true );
+        settings.SetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING, true );
+    }
+
+    settings.CameraGet().RotateX( glm::radians( (float) rotateX ) );
+    settings.CameraGet().RotateZ( glm::radians( (float) rotateZ ) );
+
+    C3D_RENDER_RAYTRACING renderer( settings );
+    RENDER_REPORTER       reporter;
+    RT_RENDER_TIMES       times;
+    wxImage               image;
+
+    renderer.ReloadRequest();
+
+    timer.Start();
+    renderer.RenderToImage( wxSize( width, height ), image, &times, nullptr, &reporter );
+    timer.Stop();
+
+    if( reporter.HasMessage() )
+        return KICAD_RENDER_RENDER_FAILED;
+
+    std::cout << "Rendered " << image.GetWidth() << "x" << image.GetHeight() << " pixels in "
+              << timer.msecs() << " ms" << std::endl;
+
+    reportTime( "scene", times.m_scene );
+    reportTime( "bvh", times.m_accelerator );
+    reportTime( "trace", times.m_trace );
+    reportTime( "post shading", times.m_postShade );
+
+    if( !wxImage::FindHandler( wxBITMAP_TYPE_PNG ) )
+        wxImage::AddHandler( new wxPNGHandler );
+
+    if( !image.SaveFile( output.GetFullPath(), wxBITMAP_TYPE_PNG ) )
+    {
+        std::cerr << "Error writing " << output.GetFullPath() << std::endl;
+        return KICAD_RENDER_SAVE_FAILED;
+    }
+
+    return KICAD_RENDER_OK;
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        std::cerr << "Failed to initialize wxWidgets" << std::endl;
+        return KICAD_RENDER_INIT_FAILED;
+    }
+
+    wxMessageOutput::Set( new wxMessageOutputStderr );
+    wxCmdLineParser cl_parser( argc, argv );
+    cl_parser.SetDesc( g_cmdLineDesc );
+    cl_parser.AddUsageText(
+            _( "This program raytraces a board to a PNG file, without OpenGL, and prints the "
+               "time taken by each phase of the render." ) );
+
+    int cmd_parsed_ok = cl_parser.Parse();
+
+    if( cmd_parsed_ok != 0 )
+    {
+        // Help and invalid input both stop here
+        return ( cmd_parsed_ok == -1 ) ? KICAD_RENDER_OK : KICAD_RENDER_BAD_CMDLINE;
+    }
+
+    if( !program.OnPgmInit() )
+        return KICAD_RENDER_INIT_FAILED;
+
+    // Do what OnKifaceStart() does for the board and the 3D models, without its dialogs
+    int kifaceVersion = 0;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+    Kiface().InitSettings( new PCBNEW_SETTINGS );
+    program.GetSettingsManager().RegisterSettings( Kiface().KifaceSettings() );
+
+    wxFileName filename( cl_parser.GetParam( 0 ) );
+    int        ret;
+
+    filename.MakeAbsolute();
+
+    {
+        KIWAY kiway( &program, KFCTL_STANDALONE );
+
+        ret = renderBoard( kiway, filename, cl_parser );
+    }
+
+    program.OnPgmExit();
+
+    return ret;
+}